@@ -43,11 +43,11 @@ uint32 FAssetParseThreadWorker::Run()
 	const static bool bForceSingleThread = false;
 	const int32 TotalCount = Files.Num();
 	
-	TMultiMap<FName, FName> DependsMap;
+	TArray<FPackageDependency> Dependencies;
 	TMap<FName, FName> ClassMap;
 
 	// Parse assets
-	ParallelFor(TotalCount, [this, &DependsMap, &ClassMap, &Mutex](int32 InIndex){
+	ParallelFor(TotalCount, [this, &Dependencies, &ClassMap, &Mutex](int32 InIndex){
 		if (StopTaskCounter.GetValue() > 0)return;
 
 		FPakFileEntryPtr File = Files[InIndex];
@@ -60,7 +60,7 @@ uint32 FAssetParseThreadWorker::Run()
 		const FString PakFilePath = Summary.PakFilePath;
 
 
-		FString PackagePath = File->Path;
+		FString PackagePath = File->GetPath();
 		FPackageReader::EOpenPackageResult ErrorCode;
 		FPackageReader Reader;
 		
@@ -151,12 +151,14 @@ uint32 FAssetParseThreadWorker::Run()
 				UE_LOG(LogPakAnalyzer, Error, TEXT("Error reading export table for package file %s"), *PackagePath);
 			}
 
-			//获取depend数据
+			//获取depend数据, 只保留依赖的package
+			const FName RootPackageFName = *RootPackageName;
+			File->AssetSummary->PackageId = PackageDependencies.IsValid() ? PackageDependencies->FindOrAddPackage(RootPackageFName) : INDEX_NONE;
 			if (Reader.GetDependsMap(Tables.DependsMap))
 			{
+				TArray<FPackageDependency> FileDependencies;
 				for (int32 ExportIndex = 0; ExportIndex < Tables.ExportMap.Num(); ++ExportIndex)
 				{
-					FString ExportPath = PackageIndexToObjectPath(FPackageIndex::FromExport(ExportIndex)).ToString();
 					int32 NumDepends = Tables.DependsMap[ExportIndex].Num();
 					if (NumDepends == 0)continue;
 					
@@ -164,12 +166,16 @@ uint32 FAssetParseThreadWorker::Run()
 					{
 						FSoftObjectPath DependsPath = PackageIndexToObjectPath(Tables.DependsMap[ExportIndex][DependsIndex]);
 
-						FPackageInfoPtr Depends = MakeShared<FPackageInfo>();
-						Depends->PackageName = *DependsPath.ToString();
-	
-						File->AssetSummary->DependencyList.Add(Depends);
+						const FName DependsPackage = DependsPath.GetLongPackageFName();
+						if (!DependsPackage.IsNone() && DependsPackage != RootPackageFName)
+						{
+							FileDependencies.Add({ RootPackageFName, DependsPackage });
+						}
 					}
 				}
+
+				FScopeLock ScopeLock(&Mutex);
+				Dependencies.Append(FileDependencies);
 			}
 			else
 			{
@@ -183,6 +189,11 @@ uint32 FAssetParseThreadWorker::Run()
 		}
 	}, bForceSingleThread);
 
+	if (StopTaskCounter.GetValue() <= 0 && PackageDependencies.IsValid())
+	{
+		PackageDependencies->Update(TArrayView<const FName>(), Dependencies);
+	}
+
 	OnParseFinish.ExecuteIfBound(StopTaskCounter.GetValue() > 0, ClassMap);
 
 	StopTaskCounter.Reset();
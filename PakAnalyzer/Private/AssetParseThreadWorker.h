@@ -5,6 +5,7 @@
 #include "Misc/AES.h"
 
 #include "Misc/Guid.h"
+#include "PackageGraph.h"
 #include "PakFileEntry.h"
 
 typedef TMap<FName, FName> ClassTypeMap;
@@ -26,6 +27,7 @@ public:
 	void StartParse(TArray<FPakFileEntryPtr>& InFiles, TArray<FPakFileSumary>& InSummaries);
 
 	FOnParseFinish OnParseFinish;
+	FPackageDependenciesPtr PackageDependencies;
 
 protected:
 	class FRunnableThread* Thread;
@@ -1,15 +1,28 @@
 #include "BaseAnalyzer.h"
 
 #include "AssetRegistry/AssetRegistryState.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProcess.h"
 #include "Json.h"
 #include "Misc/Base64.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/SecureHash.h"
+#include "Misc/StringBuilder.h"
 #include "Serialization/ArrayReader.h"
 
 #include "CommonDefines.h"
+#include "ExportWriter.h"
+#include "PakExportFormat.h"
+#include "PakSearchIndex.h"
 
 FBaseAnalyzer::FBaseAnalyzer()
+	: PackageDependencies(MakeShared<FPackageDependencies, ESPMode::ThreadSafe>())
 {
 
 }
@@ -21,10 +34,49 @@ FBaseAnalyzer::~FBaseAnalyzer()
 
 bool FBaseAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TArray<FString>& InDefaultAESKeys, int32 ContainerStartIndex)
 {
-	Reset();
 	return false;
 }
 
+FPakLoadJobPtr FBaseAnalyzer::LoadPakFilesAsync(const TArray<FString>& InPakPaths, const TArray<FString>& InDefaultAESKeys)
+{
+	check(IsInGameThread());
+
+	CancelLoad();
+
+	// Cleared here while no load thread runs, the load thread only appends built paks
+	Reset();
+
+	FPakLoadJobPtr Job = MakeShared<FPakLoadJob, ESPMode::ThreadSafe>();
+	LoadJob = Job;
+
+	// Views drop the old paks before the first OnPakLoaded arrives
+	FPakAnalyzerDelegates::OnPakLoadStart.Broadcast();
+
+	LoadTask = Async(EAsyncExecution::Thread, [this, Job, InPakPaths, InDefaultAESKeys]()
+		{
+			const bool bResult = LoadPakFiles(InPakPaths, InDefaultAESKeys);
+			Job->Finish(bResult && !Job->IsCancelled());
+		});
+
+	return Job;
+}
+
+void FBaseAnalyzer::CancelLoad()
+{
+	// Also cancels a finished job, game thread tasks it queued and not run yet are dropped
+	if (LoadJob.IsValid())
+	{
+		LoadJob->Cancel();
+	}
+
+	// The load thread never waits on the game thread once cancelled, see RequestAESKey
+	if (LoadTask.IsValid())
+	{
+		LoadTask.Wait();
+		LoadTask.Reset();
+	}
+}
+
 void FBaseAnalyzer::GetFiles(const FString& InFilterText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InPakIndexFilter, TArray<FPakFileEntryPtr>& OutFiles) const
 {
 	FScopeLock Lock(const_cast<FCriticalSection*>(&CriticalSection));
@@ -35,17 +87,24 @@ void FBaseAnalyzer::GetFiles(const FString& InFilterText, const TMap<FName, bool
 	}
 }
 
-const TArray<FPakFileSumaryPtr>& FBaseAnalyzer::GetPakFileSumary() const
+TArray<FPakFileSumaryPtr> FBaseAnalyzer::GetPakFileSumary() const
 {
+	FScopeLock Lock(const_cast<FCriticalSection*>(&CriticalSection));
 	return PakFileSummaries;
 }
 
-const TArray<FPakTreeEntryPtr>& FBaseAnalyzer::GetPakTreeRootNode() const
+TArray<FPakTreeEntryPtr> FBaseAnalyzer::GetPakTreeRootNode() const
 {
+	FScopeLock Lock(const_cast<FCriticalSection*>(&CriticalSection));
 	return PakTreeRoots;
 }
 
 bool FBaseAnalyzer::LoadAssetRegistry(const FString& InRegristryPath)
+{
+	return LoadAssetRegistry(InRegristryPath, GetPakTreeRootNode());
+}
+
+bool FBaseAnalyzer::LoadAssetRegistry(const FString& InRegristryPath, const TArray<FPakTreeEntryPtr>& InTreeRoots)
 {
 	FArrayReader ContentReader;
 	if (!FFileHelper::LoadFileToArray(ContentReader, *InRegristryPath))
@@ -60,11 +119,11 @@ bool FBaseAnalyzer::LoadAssetRegistry(const FString& InRegristryPath)
 
 	AssetRegistryPath = FPaths::ConvertRelativePathToFull(InRegristryPath);
 
-	for (FPakTreeEntryPtr TreeRoot : PakTreeRoots)
+	for (FPakTreeEntryPtr TreeRoot : InTreeRoots)
 	{
-		RefreshClassMap(TreeRoot, TreeRoot);
-		RefreshPackageDependency(TreeRoot, TreeRoot);
+		RefreshClassMap(TreeRoot);
 	}
+	RefreshPackageDependency(InTreeRoots);
 	
 	return true;
 }
@@ -88,108 +147,192 @@ bool FBaseAnalyzer::LoadAssetRegistry(FArrayReader& InData)
 	return false;
 }
 
-void FBaseAnalyzer::RefreshPackageDependency(FPakTreeEntryPtr InTreeRoot, FPakTreeEntryPtr InRoot)
+void FBaseAnalyzer::RefreshPackageDependency(const TArray<FPakTreeEntryPtr>& InTreeRoots)
 {
 	if (!AssetRegistryState.IsValid())
 	{
 		return;
 	}
 
-	for (auto& Pair : InRoot->ChildrenMap)
+	// The asset registry replaces what was known about its packages, referencers outside the loaded paks are kept as their edges
+	TArray<FName> ClearedPackages;
+	TArray<FPackageDependency> Dependencies;
+	TArray<FAssetIdentifier> Identifiers;
+	for (const FPakTreeEntryPtr& TreeRoot : InTreeRoots)
 	{
-		FPakTreeEntryPtr Child = Pair.Value;
-
-		if (Child->bIsDirectory)
+		if (!TreeRoot->FileTable.IsValid())
 		{
-			RefreshPackageDependency(InTreeRoot, Child);
+			continue;
 		}
-		else
+
+		for (FPakTreeEntry* Child : TreeRoot->FileTable->Entries)
 		{
-			TArray<FAssetIdentifier> Dependencies;
-			if (AssetRegistryState->GetDependencies(Child->PackagePath, Dependencies, UE::AssetRegistry::EDependencyCategory::All))
+			bool bFound = false;
+
+			Identifiers.Reset();
+			if (AssetRegistryState->GetDependencies(Child->PackagePath, Identifiers, UE::AssetRegistry::EDependencyCategory::All))
 			{
-				if (!Child->AssetSummary.IsValid())
+				bFound = true;
+				ClearedPackages.Add(Child->PackagePath);
+				for (const FAssetIdentifier& Identifier : Identifiers)
 				{
-					Child->AssetSummary = MakeShared<FAssetSummary>();
+					Dependencies.Add({ Child->PackagePath, Identifier.PackageName });
 				}
-				else
+			}
+
+			Identifiers.Reset();
+			if (AssetRegistryState->GetReferencers(Child->PackagePath, Identifiers, UE::AssetRegistry::EDependencyCategory::All))
+			{
+				bFound = true;
+				for (const FAssetIdentifier& Identifier : Identifiers)
 				{
-					Child->AssetSummary->DependencyList.Empty();
+					Dependencies.Add({ Identifier.PackageName, Child->PackagePath });
 				}
+			}
 
-				for (const FAssetIdentifier& Identifier : Dependencies)
-				{
-					FPackageInfoPtr Depends = MakeShared<FPackageInfo>();
-					Depends->PackageName = Identifier.PackageName;
+			if (bFound && !Child->AssetSummary.IsValid())
+			{
+				Child->AssetSummary = MakeShared<FAssetSummary>();
+			}
+		}
+	}
 
-					Child->AssetSummary->DependencyList.Add(Depends);
-				}
+	PackageDependencies->Update(ClearedPackages, Dependencies);
+
+	for (const FPakTreeEntryPtr& TreeRoot : InTreeRoots)
+	{
+		AssignPackageIds(TreeRoot);
+	}
+}
+
+void FBaseAnalyzer::AssignPackageIds(FPakTreeEntryPtr InTreeRoot)
+{
+	if (!InTreeRoot.IsValid() || !InTreeRoot->FileTable.IsValid())
+	{
+		return;
+	}
+
+	for (FPakTreeEntry* File : InTreeRoot->FileTable->Entries)
+	{
+		if (File->AssetSummary.IsValid())
+		{
+			File->AssetSummary->PackageId = PackageDependencies->FindOrAddPackage(File->PackagePath);
+		}
+	}
+}
+
+FPackageGraphPtr FBaseAnalyzer::GetPackageGraph() const
+{
+	return PackageDependencies->GetGraph();
+}
+
+FPackageLoadCostsPtr FBaseAnalyzer::GetPackageLoadCosts() const
+{
+	FScopeLock Lock(&LoadCostsLock);
+	return PackageLoadCosts;
+}
+
+FPackageLoadCostsPtr FBaseAnalyzer::UpdateExportLoadCosts()
+{
+	const FPakLoadJobPtr ExportLoadJob = LoadJob;
+	return UpdatePackageLoadCosts([&ExportLoadJob]() { return ExportLoadJob.IsValid() && ExportLoadJob->IsCancelled(); });
+}
+
+FPackageLoadCostsPtr FBaseAnalyzer::UpdatePackageLoadCosts(TFunctionRef<bool()> IsAborted)
+{
+	FScopeLock UpdateScope(&LoadCostsUpdateLock);
+
+	const FPackageGraphPtr PackageGraph = GetPackageGraph();
+	{
+		FScopeLock Lock(&LoadCostsLock);
+		if (PackageLoadCosts.IsValid() && PackageLoadCosts->GetGraph() == PackageGraph)
+		{
+			return PackageLoadCosts;
+		}
+	}
+
+	// Every file of a package counts, the .uexp and .ubulk of an asset included
+	TArray<int64> ExclusiveSizes;
+	ExclusiveSizes.SetNumZeroed(PackageGraph->Num() * 2);
+	{
+		FScopeLock Lock(&CriticalSection);
+		for (const FPakTreeEntryPtr& TreeRoot : PakTreeRoots)
+		{
+			const FPakFileTable* FileTable = TreeRoot.IsValid() ? TreeRoot->FileTable.Get() : nullptr;
+			if (!FileTable)
+			{
+				continue;
 			}
 
-			TArray<FAssetIdentifier> Dependents;
-			if (AssetRegistryState->GetReferencers(Child->PackagePath, Dependents, UE::AssetRegistry::EDependencyCategory::All))
+			// Files of a package sit next to each other in the table, one lookup per run of them
+			FName LastPackagePath;
+			int32 PackageId = INDEX_NONE;
+			for (int32 Index = 0; Index < FileTable->Num(); ++Index)
 			{
-				if (!Child->AssetSummary.IsValid())
-				{
-					Child->AssetSummary = MakeShared<FAssetSummary>();
-				}
-				else
+				// Ids handed out after this graph was built have no row yet
+				const FPakTreeEntry* File = FileTable->Entries[Index];
+				if (Index == 0 || File->PackagePath != LastPackagePath)
 				{
-					Child->AssetSummary->DependentList.Empty();
+					LastPackagePath = File->PackagePath;
+					PackageId = PackageDependencies->FindPackage(LastPackagePath);
 				}
-
-				for (const FAssetIdentifier& Identifier : Dependents)
+				if (PackageGraph->IsValidPackage(PackageId))
 				{
-					FPackageInfoPtr Depends = MakeShared<FPackageInfo>();
-					Depends->PackageName = Identifier.PackageName;
-
-					Child->AssetSummary->DependentList.Add(Depends);
+					ExclusiveSizes[PackageId * 2] += File->PakEntry.UncompressedSize;
+					ExclusiveSizes[PackageId * 2 + 1] += File->PakEntry.Size;
 				}
 			}
 		}
 	}
+
+	FPackageLoadCostsPtr NewLoadCosts = FPackageLoadCosts::Compute(PackageGraph, MoveTemp(ExclusiveSizes), IsAborted);
+	if (NewLoadCosts.IsValid())
+	{
+		FScopeLock Lock(&LoadCostsLock);
+		// A reset during the computation leaves a graph nobody reads anymore
+		if (GetPackageGraph() == PackageGraph)
+		{
+			PackageLoadCosts = NewLoadCosts;
+		}
+	}
+
+	return NewLoadCosts;
+}
+
+void FBaseAnalyzer::SetPackageDependencies(FPackageDependenciesPtr InPackageDependencies)
+{
+	PackageDependencies = InPackageDependencies;
+	bSharedPackageDependencies = true;
 }
 
 bool FBaseAnalyzer::ExportToJson(const FString& InOutputPath, const TArray<FPakFileEntryPtr>& InFiles)
 {
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Export to json: %s."), *InOutputPath);
 
-	TSharedRef<FJsonObject> RootObject = MakeShareable(new FJsonObject);
-	RootObject->SetNumberField(TEXT("Exported File Count"), InFiles.Num());
+	LoadFileHashes(InFiles);
 
-	TArray<TSharedPtr<FJsonValue>> FileObjects;
+	const FPackageLoadCostsPtr LoadCosts = UpdateExportLoadCosts();
+	if (!LoadCosts.IsValid())
+	{
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Export to json: %s aborted, the paks were unloaded."), *InOutputPath);
+		return false;
+	}
 
+	// Totals and classes come before the files in the document, they only need a pass over the numbers
 	int64 TotalSize = 0;
 	int64 TotalCompressedSize = 0;
 
 	TMap<FName, FPakClassEntry> ExportedClassMap;
 
-	for (const FPakFileEntryPtr It : InFiles)
+	for (const FPakFileEntryPtr& It : InFiles)
 	{
 		const FPakEntry& PakEntry = It->PakEntry;
 
-		TSharedRef<FJsonObject> FileObject = MakeShareable(new FJsonObject);
-
-		FileObject->SetStringField(TEXT("Name"), It->Filename.ToString());
-		FileObject->SetStringField(TEXT("Path"), It->Path);
-		FileObject->SetNumberField(TEXT("Offset"), PakEntry.Offset);
-		FileObject->SetNumberField(TEXT("Size"), PakEntry.UncompressedSize);
-		FileObject->SetNumberField(TEXT("Compressed Size"), PakEntry.Size);
-		FileObject->SetNumberField(TEXT("Compressed Block Count"), PakEntry.CompressionBlocks.Num());
-		FileObject->SetNumberField(TEXT("Compressed Block Size"), PakEntry.CompressionBlockSize);
-		FileObject->SetStringField(TEXT("SHA1"), BytesToHex(PakEntry.Hash, sizeof(PakEntry.Hash)));
-		FileObject->SetStringField(TEXT("IsEncrypted"), PakEntry.IsEncrypted() ? TEXT("True") : TEXT("False"));
-		FileObject->SetStringField(TEXT("Class"), It->Class.ToString());
-		FileObject->SetNumberField(TEXT("Dependency Count"), It->AssetSummary.IsValid() ? It->AssetSummary->DependencyList.Num() : 0);
-		FileObject->SetNumberField(TEXT("Dependent Count"), It->AssetSummary.IsValid() ? It->AssetSummary->DependentList.Num() : 0);
-		FileObject->SetStringField(TEXT("OwnerPak"), PakFileSummaries.IsValidIndex(It->OwnerPakIndex) ? FPaths::GetCleanFilename(PakFileSummaries[It->OwnerPakIndex]->PakFilePath) : TEXT(""));
-
-		FileObjects.Add(MakeShareable(new FJsonValueObject(FileObject)));
-
 		TotalSize += PakEntry.UncompressedSize;
 		TotalCompressedSize += PakEntry.Size;
 
-		FPakClassEntry* ClassEntry = ExportedClassMap.Find(It->Class);
+		const FName Class = It->GetClass();
+		FPakClassEntry* ClassEntry = ExportedClassMap.Find(Class);
 		if (ClassEntry)
 		{
 			ClassEntry->FileCount += 1;
@@ -198,46 +341,87 @@ bool FBaseAnalyzer::ExportToJson(const FString& InOutputPath, const TArray<FPakF
 		}
 		else
 		{
-			ExportedClassMap.Add(It->Class, FPakClassEntry(It->Class, PakEntry.UncompressedSize, PakEntry.Size, 1));
+			ExportedClassMap.Add(Class, FPakClassEntry(Class, PakEntry.UncompressedSize, PakEntry.Size, 1));
 		}
 	}
 
-	RootObject->SetNumberField(TEXT("Exported Total Size"), TotalSize);
-	RootObject->SetNumberField(TEXT("Exported Total Compressed Size"), TotalCompressedSize);
-
 	ExportedClassMap.ValueSort(
 		[](const FPakClassEntry& A, const FPakClassEntry& B) -> bool
 		{
 			return A.CompressedSize > B.CompressedSize;
 		});
 
-	TArray<TSharedPtr<FJsonValue>> ClassObjects;
+	FExportWriter ExportWriter;
+	if (!ExportWriter.Open(InOutputPath))
+	{
+		return false;
+	}
+
+	// Same document the FJsonObject serializer wrote, numbers go through the writer as doubles like SetNumberField stored them
+	FString Text;
+	TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&Text);
+	JsonWriter->WriteObjectStart();
+	JsonWriter->WriteValue(TEXT("Exported File Count"), (double)InFiles.Num());
+	JsonWriter->WriteValue(TEXT("Exported Total Size"), (double)TotalSize);
+	JsonWriter->WriteValue(TEXT("Exported Total Compressed Size"), (double)TotalCompressedSize);
+
+	JsonWriter->WriteArrayStart(TEXT("Group By Class"));
 	for (const auto& Pair : ExportedClassMap)
 	{
 		const FPakClassEntry& ClassEntry = Pair.Value;
 
-		TSharedRef<FJsonObject> ClassObject = MakeShareable(new FJsonObject);
-		ClassObject->SetStringField(TEXT("Class"), ClassEntry.Class.ToString());
-		ClassObject->SetNumberField(TEXT("File Count"), ClassEntry.FileCount);
-		ClassObject->SetNumberField(TEXT("Size"), ClassEntry.Size);
-		ClassObject->SetNumberField(TEXT("Compressed Size"), ClassEntry.CompressedSize);
-		ClassObject->SetNumberField(TEXT("Compressed Size Percent Of Exported"), TotalCompressedSize > 0 ? 100 * (float)ClassEntry.CompressedSize / TotalCompressedSize : 0.f);
-
-		ClassObjects.Add(MakeShareable(new FJsonValueObject(ClassObject)));
+		JsonWriter->WriteObjectStart();
+		JsonWriter->WriteValue(TEXT("Class"), ClassEntry.Class.ToString());
+		JsonWriter->WriteValue(TEXT("File Count"), (double)ClassEntry.FileCount);
+		JsonWriter->WriteValue(TEXT("Size"), (double)ClassEntry.Size);
+		JsonWriter->WriteValue(TEXT("Compressed Size"), (double)ClassEntry.CompressedSize);
+		JsonWriter->WriteValue(TEXT("Compressed Size Percent Of Exported"), (double)(TotalCompressedSize > 0 ? 100 * (float)ClassEntry.CompressedSize / TotalCompressedSize : 0.f));
+		JsonWriter->WriteObjectEnd();
 	}
+	JsonWriter->WriteArrayEnd();
 
-	RootObject->SetArrayField(TEXT("Group By Class"), ClassObjects);
-	RootObject->SetArrayField(TEXT("Files"), FileObjects);
+	JsonWriter->WriteArrayStart(TEXT("Files"));
+	ExportWriter.Write(Text);
 
-	bool bExportResult = false;
-
-	FString FileContents;
-	TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&FileContents);
-	if (FJsonSerializer::Serialize(RootObject, JsonWriter))
+	const TArray<FString> OwnerPakNames = GetOwnerPakNames();
+	const FPackageGraphPtr& PackageGraph = LoadCosts->GetGraph();
+	ExportWriter.WriteRows(InFiles.Num(), [&InFiles, &OwnerPakNames, &PackageGraph, &LoadCosts](int32 StartRow, int32 EndRow, FString& OutText)
 	{
-		JsonWriter->Close();
-		bExportResult = FFileHelper::SaveStringToFile(FileContents, *InOutputPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
-	}
+		// The chunk writer starts at the indent of the array items, the separator before its first item is written here
+		OutText += StartRow == 0 ? LINE_TERMINATOR TEXT("\t\t") : TEXT(",") LINE_TERMINATOR TEXT("\t\t");
+
+		TSharedRef<TJsonWriter<>> RowWriter = TJsonWriterFactory<>::Create(&OutText, 2);
+		for (int32 Row = StartRow; Row < EndRow; ++Row)
+		{
+			const FPakFileEntryPtr& It = InFiles[Row];
+			const FPakEntry& PakEntry = It->PakEntry;
+
+			RowWriter->WriteObjectStart();
+			RowWriter->WriteValue(TEXT("Name"), It->GetFilename());
+			RowWriter->WriteValue(TEXT("Path"), It->GetPath());
+			RowWriter->WriteValue(TEXT("Offset"), (double)PakEntry.Offset);
+			RowWriter->WriteValue(TEXT("Size"), (double)PakEntry.UncompressedSize);
+			RowWriter->WriteValue(TEXT("Compressed Size"), (double)PakEntry.Size);
+			RowWriter->WriteValue(TEXT("Compressed Block Count"), (double)It->GetCompressionBlockCount());
+			RowWriter->WriteValue(TEXT("Compressed Block Size"), (double)PakEntry.CompressionBlockSize);
+			RowWriter->WriteValue(TEXT("SHA1"), BytesToHex(PakEntry.Hash, sizeof(PakEntry.Hash)));
+			RowWriter->WriteValue(TEXT("IsEncrypted"), FString(PakEntry.IsEncrypted() ? TEXT("True") : TEXT("False")));
+			RowWriter->WriteValue(TEXT("Class"), It->GetClass().ToString());
+			RowWriter->WriteValue(TEXT("Dependency Count"), (double)PackageGraph->GetDependencyCount(It->GetPackageId()));
+			RowWriter->WriteValue(TEXT("Dependent Count"), (double)PackageGraph->GetDependentCount(It->GetPackageId()));
+			RowWriter->WriteValue(TEXT("Exclusive Size"), (double)LoadCosts->GetExclusiveSize(It->GetPackageId()));
+			RowWriter->WriteValue(TEXT("Exclusive Compressed Size"), (double)LoadCosts->GetExclusiveCompressedSize(It->GetPackageId()));
+			RowWriter->WriteValue(TEXT("Transitive Size"), (double)LoadCosts->GetTransitiveSize(It->GetPackageId()));
+			RowWriter->WriteValue(TEXT("Transitive Compressed Size"), (double)LoadCosts->GetTransitiveCompressedSize(It->GetPackageId()));
+			RowWriter->WriteValue(TEXT("OwnerPak"), OwnerPakNames.IsValidIndex(It->OwnerPakIndex) ? OwnerPakNames[It->OwnerPakIndex] : FString());
+			RowWriter->WriteObjectEnd();
+		}
+	});
+
+	// Closing brackets as TJsonWriter writes them after the last item, an empty array stays on one line
+	ExportWriter.Write(InFiles.Num() > 0 ? LINE_TERMINATOR TEXT("\t]") LINE_TERMINATOR TEXT("}") : TEXT("]") LINE_TERMINATOR TEXT("}"));
+
+	const bool bExportResult = ExportWriter.Close();
 
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Export to json: %s finished, file count: %d, result: %d."), *InOutputPath, InFiles.Num(), bExportResult);
 
@@ -248,181 +432,609 @@ bool FBaseAnalyzer::ExportToCsv(const FString& InOutputPath, const TArray<FPakFi
 {
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Export to csv: %s."), *InOutputPath);
 
-	TArray<FString> Lines;
-	Lines.Empty(InFiles.Num() + 2);
-	Lines.Add(TEXT("Id, Name, Path, Offset, Class, Size, Compressed Size, Compressed Block Count, Compressed Block Size, SHA1, IsEncrypted, Dependency Count, Dependent Count, OwnerPak"));
+	LoadFileHashes(InFiles);
 
-	int32 Index = 1;
-	for (const FPakFileEntryPtr It : InFiles)
+	const FPackageLoadCostsPtr LoadCosts = UpdateExportLoadCosts();
+	if (!LoadCosts.IsValid())
 	{
-		const FPakEntry& PakEntry = It->PakEntry;
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Export to csv: %s aborted, the paks were unloaded."), *InOutputPath);
+		return false;
+	}
+
+	FExportWriter ExportWriter;
+	if (!ExportWriter.Open(InOutputPath))
+	{
+		return false;
+	}
 
-		Lines.Add(FString::Printf(TEXT("%d, %s, %s, %lld, %s, %lld, %lld, %d, %d, %s, %s, %d, %d, %s"),
-			Index,
-			*It->Filename.ToString(),
-			*It->Path,
-			PakEntry.Offset,
-			*It->Class.ToString(),
-			PakEntry.UncompressedSize,
-			PakEntry.Size,
-			PakEntry.CompressionBlocks.Num(),
-			PakEntry.CompressionBlockSize,
-			*BytesToHex(PakEntry.Hash, sizeof(PakEntry.Hash)),
-			PakEntry.IsEncrypted() ? TEXT("True") : TEXT("False"),
-			It->AssetSummary.IsValid() ? It->AssetSummary->DependencyList.Num() : 0,
-			It->AssetSummary.IsValid() ? It->AssetSummary->DependentList.Num() : 0,
-			PakFileSummaries.IsValidIndex(It->OwnerPakIndex) ? *FPaths::GetCleanFilename(PakFileSummaries[It->OwnerPakIndex]->PakFilePath) : TEXT(""))
-			);
-		++Index;
-	}
-
-	const bool bExportResult = FFileHelper::SaveStringArrayToFile(Lines, *InOutputPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	ExportWriter.Write(TEXT("Id, Name, Path, Offset, Class, Size, Compressed Size, Compressed Block Count, Compressed Block Size, SHA1, IsEncrypted, Dependency Count, Dependent Count, Exclusive Size, Exclusive Compressed Size, Transitive Size, Transitive Compressed Size, OwnerPak") LINE_TERMINATOR);
+
+	const TArray<FString> OwnerPakNames = GetOwnerPakNames();
+	const FPackageGraphPtr& PackageGraph = LoadCosts->GetGraph();
+	ExportWriter.WriteRows(InFiles.Num(), [&InFiles, &OwnerPakNames, &PackageGraph, &LoadCosts](int32 StartRow, int32 EndRow, FString& OutText)
+	{
+		for (int32 Row = StartRow; Row < EndRow; ++Row)
+		{
+			const FPakFileEntryPtr& It = InFiles[Row];
+			const FPakEntry& PakEntry = It->PakEntry;
+
+			OutText.Appendf(TEXT("%d, %s, %s, %lld, %s, %lld, %lld, %d, %d, %s, %s, %d, %d, %lld, %lld, %lld, %lld, %s") LINE_TERMINATOR,
+				Row + 1,
+				*It->GetFilename(),
+				*It->GetPath(),
+				PakEntry.Offset,
+				*It->GetClass().ToString(),
+				PakEntry.UncompressedSize,
+				PakEntry.Size,
+				It->GetCompressionBlockCount(),
+				PakEntry.CompressionBlockSize,
+				*BytesToHex(PakEntry.Hash, sizeof(PakEntry.Hash)),
+				PakEntry.IsEncrypted() ? TEXT("True") : TEXT("False"),
+				PackageGraph->GetDependencyCount(It->GetPackageId()),
+				PackageGraph->GetDependentCount(It->GetPackageId()),
+				LoadCosts->GetExclusiveSize(It->GetPackageId()),
+				LoadCosts->GetExclusiveCompressedSize(It->GetPackageId()),
+				LoadCosts->GetTransitiveSize(It->GetPackageId()),
+				LoadCosts->GetTransitiveCompressedSize(It->GetPackageId()),
+				OwnerPakNames.IsValidIndex(It->OwnerPakIndex) ? *OwnerPakNames[It->OwnerPakIndex] : TEXT(""));
+		}
+	});
+
+	const bool bExportResult = ExportWriter.Close();
 
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Export to csv: %s finished, file count: %d, result: %d."), *InOutputPath, InFiles.Num(), bExportResult);
 
 	return bExportResult;
 }
 
-FString FBaseAnalyzer::GetAssetRegistryPath() const
+// Distinct UTF-8 strings of one dictionary column and the entry of every row
+struct FExportDictionary
 {
-	return AssetRegistryPath;
+	FExportDictionary()
+	{
+		Offsets.Add(0);
+	}
+
+	uint32 Add(FStringView InText)
+	{
+		FTCHARToUTF8 Converted(InText.GetData(), InText.Len());
+		Chars.Append((const UTF8CHAR*)Converted.Get(), Converted.Length());
+		Offsets.Add(Chars.Num());
+		return Offsets.Num() - 2;
+	}
+
+	uint32 Num() const { return Offsets.Num() - 1; }
+	uint64 GetSize() const { return Offsets.Num() * sizeof(uint32) + Chars.Num(); }
+
+	TArray<uint32> Offsets;
+	TArray<UTF8CHAR> Chars;
+	TArray<uint32> Rows;
+};
+
+// Sections are laid out before anything is written, a column landing elsewhere means the layout and the writes disagree
+static bool IsAtExportSection(const FExportWriter& InWriter, uint64 InOffset, const FPakExportColumn& InColumn)
+{
+	if ((uint64)InWriter.Tell() == InOffset)
+	{
+		return true;
+	}
+
+	UE_LOG(LogPakAnalyzer, Error, TEXT("Export to binary failed! Column %s is written at %lld instead of %llu."), ANSI_TO_TCHAR(InColumn.Name), InWriter.Tell(), InOffset);
+	return false;
 }
 
-void FBaseAnalyzer::RefreshClassMap(FPakTreeEntryPtr InTreeRoot, FPakTreeEntryPtr InRoot)
+// Fixed width rows written through a small reused buffer
+template <typename ElementType, typename GetterType>
+static bool WriteExportColumn(FExportWriter& InWriter, const FPakExportColumn& InColumn, const TArray<FPakFileEntryPtr>& InFiles, GetterType Getter)
 {
-	InRoot->FileClassMap.Empty();
+	if (InColumn.ElementSize != sizeof(ElementType))
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Export to binary failed! Column %s has %u byte rows, not %d."), ANSI_TO_TCHAR(InColumn.Name), InColumn.ElementSize, (int32)sizeof(ElementType));
+		return false;
+	}
 
-	for (auto& Pair : InRoot->ChildrenMap)
+	if (!IsAtExportSection(InWriter, InColumn.DataOffset, InColumn))
 	{
-		FPakTreeEntryPtr Child = Pair.Value;
+		return false;
+	}
 
-		if (Child->bIsDirectory)
-		{
-			RefreshClassMap(InTreeRoot, Child);
-			for (auto& ClassPair : Child->FileClassMap)
-			{
-				InsertClassInfo(InTreeRoot, InRoot, ClassPair.Key, ClassPair.Value->FileCount, ClassPair.Value->Size, ClassPair.Value->CompressedSize);
-			}
-		}
-		else
+	TArray<ElementType> Buffer;
+	Buffer.Reserve(4096);
+	for (const FPakFileEntryPtr& File : InFiles)
+	{
+		Buffer.Add(Getter(*File));
+		if (Buffer.Num() == 4096)
 		{
-			Child->Class = GetAssetClass(Child->Path, Child->PackagePath);
-			InsertClassInfo(InTreeRoot, InRoot, Child->Class, 1, Child->Size, Child->CompressedSize);
+			InWriter.Write(Buffer.GetData(), Buffer.Num() * sizeof(ElementType));
+			Buffer.Reset();
 		}
 	}
+	InWriter.Write(Buffer.GetData(), Buffer.Num() * sizeof(ElementType));
+	InWriter.Align(8);
+	return true;
 }
 
-void FBaseAnalyzer::RefreshTreeNode(FPakTreeEntryPtr InRoot)
+bool FBaseAnalyzer::ExportToBinary(const FString& InOutputPath, const TArray<FPakFileEntryPtr>& InFiles)
 {
-	for (auto& Pair : InRoot->ChildrenMap)
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Export to binary: %s."), *InOutputPath);
+
+	LoadFileHashes(InFiles);
+
+	const FPackageLoadCostsPtr LoadCosts = UpdateExportLoadCosts();
+	if (!LoadCosts.IsValid())
+	{
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Export to binary: %s aborted, the paks were unloaded."), *InOutputPath);
+		return false;
+	}
+
+	FExportDictionary Names;
+	FExportDictionary Directories;
+	FExportDictionary Classes;
+	FExportDictionary CompressionMethods;
+	FExportDictionary OwnerPaks;
+
+	const TArray<FString> OwnerPakNames = GetOwnerPakNames();
+	for (const FString& OwnerPakName : OwnerPakNames)
 	{
-		FPakTreeEntryPtr Child = Pair.Value;
-		if (Child->bIsDirectory)
+		OwnerPaks.Add(OwnerPakName);
+	}
+	const uint32 UnknownOwnerPak = OwnerPaks.Add(TEXT(""));
+
+	TMap<FString, uint32> NameLookup;
+	TMap<FName, uint32> ClassLookup;
+	TMap<FName, uint32> CompressionMethodLookup;
+	TMap<FString, uint32> DirectoryLookup;
+	TMap<TPair<const FPakFileTable*, int32>, uint32> TableDirectoryLookup;
+
+	auto FindOrAddName = [](FExportDictionary& InDictionary, TMap<FName, uint32>& InLookup, FName InName)
+	{
+		if (const uint32* Found = InLookup.Find(InName))
 		{
-			RefreshTreeNode(Child);
+			return *Found;
 		}
-		else
+		return InLookup.Add(InName, InDictionary.Add(InName.ToString()));
+	};
+
+	Names.Rows.Reserve(InFiles.Num());
+	Directories.Rows.Reserve(InFiles.Num());
+	Classes.Rows.Reserve(InFiles.Num());
+	CompressionMethods.Rows.Reserve(InFiles.Num());
+	OwnerPaks.Rows.Reserve(InFiles.Num());
+
+	TStringBuilder<256> PathBuilder;
+	for (const FPakFileEntryPtr& File : InFiles)
+	{
+		const FString Filename = File->GetFilename();
+		const uint32* FoundName = NameLookup.Find(Filename);
+		Names.Rows.Add(FoundName ? *FoundName : NameLookup.Add(Filename, Names.Add(Filename)));
+		Classes.Rows.Add(FindOrAddName(Classes, ClassLookup, File->GetClass()));
+		CompressionMethods.Rows.Add(FindOrAddName(CompressionMethods, CompressionMethodLookup, File->CompressionMethod));
+		OwnerPaks.Rows.Add(OwnerPakNames.IsValidIndex(File->OwnerPakIndex) ? File->OwnerPakIndex : UnknownOwnerPak);
+
+		// Directory path as AppendFilePath writes it in front of the file name
+		const FPakFileTable* FileTable = File->FileTable.Get();
+		const int32 DirectoryIndex = FileTable && FileTable->ParentDirectories.IsValidIndex(File->FileIndex) ? FileTable->ParentDirectories[File->FileIndex] : INDEX_NONE;
+		const TPair<const FPakFileTable*, int32> TableDirectory(FileTable, DirectoryIndex);
+		if (const uint32* Found = TableDirectoryLookup.Find(TableDirectory))
 		{
-			Child->FileCount = 1;
-			Child->Size = Child->PakEntry.UncompressedSize;
-			Child->CompressedSize = Child->PakEntry.Size;
+			Directories.Rows.Add(*Found);
+			continue;
 		}
 
-		InRoot->FileCount += Child->FileCount;
-		InRoot->Size += Child->Size;
-		InRoot->CompressedSize += Child->CompressedSize;
-	}
-
-	InRoot->ChildrenMap.ValueSort([](const FPakTreeEntryPtr& A, const FPakTreeEntryPtr& B) -> bool
+		PathBuilder.Reset();
+		if (DirectoryIndex != INDEX_NONE)
 		{
-			if (A->bIsDirectory == B->bIsDirectory)
+			FileTable->AppendDirectoryPath(DirectoryIndex, PathBuilder);
+			if (PathBuilder.Len() > 0 && PathBuilder.LastChar() != TEXT('/') && PathBuilder.LastChar() != TEXT('\\'))
 			{
-				return A->Filename.LexicalLess(B->Filename);
+				PathBuilder << TEXT('/');
 			}
+		}
 
-			return (int32)A->bIsDirectory > (int32)B->bIsDirectory;
-		});
+		const FString DirectoryPath(PathBuilder.ToView());
+		const uint32* FoundPath = DirectoryLookup.Find(DirectoryPath);
+		const uint32 DirectoryId = FoundPath ? *FoundPath : DirectoryLookup.Add(DirectoryPath, Directories.Add(DirectoryPath));
+		TableDirectoryLookup.Add(TableDirectory, DirectoryId);
+		Directories.Rows.Add(DirectoryId);
+	}
+
+	struct FColumnInfo
+	{
+		const ANSICHAR* Name;
+		EPakExportColumnType Type;
+		uint32 ElementSize;
+		const FExportDictionary* Dictionary;
+	};
+
+	// Write order of the rows below must follow this table
+	const FColumnInfo ColumnInfos[] =
+	{
+		{ "Name", EPakExportColumnType::Dictionary, sizeof(uint32), &Names },
+		{ "Directory", EPakExportColumnType::Dictionary, sizeof(uint32), &Directories },
+		{ "Class", EPakExportColumnType::Dictionary, sizeof(uint32), &Classes },
+		{ "CompressionMethod", EPakExportColumnType::Dictionary, sizeof(uint32), &CompressionMethods },
+		{ "OwnerPak", EPakExportColumnType::Dictionary, sizeof(uint32), &OwnerPaks },
+		{ "Offset", EPakExportColumnType::Int64, sizeof(int64), nullptr },
+		{ "Size", EPakExportColumnType::Int64, sizeof(int64), nullptr },
+		{ "CompressedSize", EPakExportColumnType::Int64, sizeof(int64), nullptr },
+		{ "CompressionBlockCount", EPakExportColumnType::Int32, sizeof(int32), nullptr },
+		{ "CompressionBlockSize", EPakExportColumnType::Int32, sizeof(int32), nullptr },
+		{ "SHA1", EPakExportColumnType::Hash, sizeof(FSHAHash), nullptr },
+		{ "IsEncrypted", EPakExportColumnType::Bool, sizeof(uint8), nullptr },
+		{ "DependencyCount", EPakExportColumnType::Int32, sizeof(int32), nullptr },
+		{ "DependentCount", EPakExportColumnType::Int32, sizeof(int32), nullptr },
+		{ "ExclusiveSize", EPakExportColumnType::Int64, sizeof(int64), nullptr },
+		{ "ExclusiveCompressedSize", EPakExportColumnType::Int64, sizeof(int64), nullptr },
+		{ "TransitiveSize", EPakExportColumnType::Int64, sizeof(int64), nullptr },
+		{ "TransitiveCompressedSize", EPakExportColumnType::Int64, sizeof(int64), nullptr },
+	};
+
+	FPakExportHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = PakExport::Magic;
+	Header.Version = PakExport::Version;
+	Header.RowCount = InFiles.Num();
+	Header.ColumnCount = UE_ARRAY_COUNT(ColumnInfos);
+
+	// Rows of every column first, then the dictionaries, each section 8 byte aligned
+	TArray<FPakExportColumn> Columns;
+	Columns.AddZeroed(UE_ARRAY_COUNT(ColumnInfos));
+	uint64 Offset = Align(sizeof(FPakExportHeader) + Columns.Num() * sizeof(FPakExportColumn), 8);
+	for (int32 Index = 0; Index < Columns.Num(); ++Index)
+	{
+		FPakExportColumn& Column = Columns[Index];
+		FCStringAnsi::Strncpy(Column.Name, ColumnInfos[Index].Name, sizeof(Column.Name));
+		Column.Type = ColumnInfos[Index].Type;
+		Column.ElementSize = ColumnInfos[Index].ElementSize;
+		Column.DataOffset = Offset;
+		Offset = Align(Offset + Header.RowCount * Column.ElementSize, 8);
+	}
+
+	for (int32 Index = 0; Index < Columns.Num(); ++Index)
+	{
+		if (const FExportDictionary* Dictionary = ColumnInfos[Index].Dictionary)
+		{
+			Columns[Index].DictionaryOffset = Offset;
+			Columns[Index].DictionaryCount = Dictionary->Num();
+			Offset = Align(Offset + Dictionary->GetSize(), 8);
+		}
+	}
+
+	FExportWriter ExportWriter;
+	if (!ExportWriter.Open(InOutputPath))
+	{
+		return false;
+	}
+
+	ExportWriter.Write(&Header, sizeof(Header));
+	ExportWriter.Write(Columns.GetData(), Columns.Num() * sizeof(FPakExportColumn));
+	ExportWriter.Align(8);
+
+	// Columns are written in table order, dictionary columns come first
+	bool bLayoutMatched = true;
+	int32 ColumnIndex = 0;
+	for (; bLayoutMatched && ColumnIndex < Columns.Num() && ColumnInfos[ColumnIndex].Dictionary; ++ColumnIndex)
+	{
+		const FExportDictionary* Dictionary = ColumnInfos[ColumnIndex].Dictionary;
+		bLayoutMatched = IsAtExportSection(ExportWriter, Columns[ColumnIndex].DataOffset, Columns[ColumnIndex]);
+		ExportWriter.Write(Dictionary->Rows.GetData(), Dictionary->Rows.Num() * sizeof(uint32));
+		ExportWriter.Align(8);
+	}
+
+	const FPackageGraphPtr& PackageGraph = LoadCosts->GetGraph();
+	bLayoutMatched = bLayoutMatched
+		&& WriteExportColumn<int64>(ExportWriter, Columns[ColumnIndex++], InFiles, [](const FPakFileEntry& File) { return File.PakEntry.Offset; })
+		&& WriteExportColumn<int64>(ExportWriter, Columns[ColumnIndex++], InFiles, [](const FPakFileEntry& File) { return File.PakEntry.UncompressedSize; })
+		&& WriteExportColumn<int64>(ExportWriter, Columns[ColumnIndex++], InFiles, [](const FPakFileEntry& File) { return File.PakEntry.Size; })
+		&& WriteExportColumn<int32>(ExportWriter, Columns[ColumnIndex++], InFiles, [](const FPakFileEntry& File) { return File.GetCompressionBlockCount(); })
+		&& WriteExportColumn<int32>(ExportWriter, Columns[ColumnIndex++], InFiles, [](const FPakFileEntry& File) { return (int32)File.PakEntry.CompressionBlockSize; })
+		&& WriteExportColumn<FSHAHash>(ExportWriter, Columns[ColumnIndex++], InFiles, [](const FPakFileEntry& File)
+		{
+			FSHAHash Hash;
+			FMemory::Memcpy(Hash.Hash, File.PakEntry.Hash, sizeof(Hash.Hash));
+			return Hash;
+		})
+		&& WriteExportColumn<uint8>(ExportWriter, Columns[ColumnIndex++], InFiles, [](const FPakFileEntry& File) { return (uint8)(File.PakEntry.IsEncrypted() ? 1 : 0); })
+		&& WriteExportColumn<int32>(ExportWriter, Columns[ColumnIndex++], InFiles, [&PackageGraph](const FPakFileEntry& File) { return PackageGraph->GetDependencyCount(File.GetPackageId()); })
+		&& WriteExportColumn<int32>(ExportWriter, Columns[ColumnIndex++], InFiles, [&PackageGraph](const FPakFileEntry& File) { return PackageGraph->GetDependentCount(File.GetPackageId()); })
+		&& WriteExportColumn<int64>(ExportWriter, Columns[ColumnIndex++], InFiles, [&LoadCosts](const FPakFileEntry& File) { return LoadCosts->GetExclusiveSize(File.GetPackageId()); })
+		&& WriteExportColumn<int64>(ExportWriter, Columns[ColumnIndex++], InFiles, [&LoadCosts](const FPakFileEntry& File) { return LoadCosts->GetExclusiveCompressedSize(File.GetPackageId()); })
+		&& WriteExportColumn<int64>(ExportWriter, Columns[ColumnIndex++], InFiles, [&LoadCosts](const FPakFileEntry& File) { return LoadCosts->GetTransitiveSize(File.GetPackageId()); })
+		&& WriteExportColumn<int64>(ExportWriter, Columns[ColumnIndex++], InFiles, [&LoadCosts](const FPakFileEntry& File) { return LoadCosts->GetTransitiveCompressedSize(File.GetPackageId()); });
+
+	if (bLayoutMatched && ColumnIndex != Columns.Num())
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Export to binary failed! %d of %d columns written."), ColumnIndex, Columns.Num());
+		bLayoutMatched = false;
+	}
+
+	for (int32 Index = 0; bLayoutMatched && Index < Columns.Num(); ++Index)
+	{
+		if (const FExportDictionary* Dictionary = ColumnInfos[Index].Dictionary)
+		{
+			bLayoutMatched = IsAtExportSection(ExportWriter, Columns[Index].DictionaryOffset, Columns[Index]);
+			ExportWriter.Write(Dictionary->Offsets.GetData(), Dictionary->Offsets.Num() * sizeof(uint32));
+			ExportWriter.Write(Dictionary->Chars.GetData(), Dictionary->Chars.Num());
+			ExportWriter.Align(8);
+		}
+	}
+
+	// A reader maps the file and trusts the offsets of its header, a file that doesn't follow them is not left behind
+	if (!bLayoutMatched)
+	{
+		ExportWriter.Close();
+		IFileManager::Get().Delete(*InOutputPath);
+		return false;
+	}
+
+	const bool bExportResult = ExportWriter.Close();
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Export to binary: %s finished, file count: %d, result: %d."), *InOutputPath, InFiles.Num(), bExportResult);
+
+	return bExportResult;
 }
 
-void FBaseAnalyzer::RefreshTreeNodeSizePercent(FPakTreeEntryPtr InTreeRoot, FPakTreeEntryPtr InRoot)
+TArray<FString> FBaseAnalyzer::GetOwnerPakNames() const
 {
-	for (auto& Pair : InRoot->ChildrenMap)
+	FScopeLock Lock(const_cast<FCriticalSection*>(&CriticalSection));
+
+	TArray<FString> OwnerPakNames;
+	OwnerPakNames.Reserve(PakFileSummaries.Num());
+	for (const FPakFileSumaryPtr& Summary : PakFileSummaries)
 	{
-		FPakTreeEntryPtr Child = Pair.Value;
-		Child->CompressedSizePercentOfTotal = InTreeRoot->CompressedSize > 0 ? (float)Child->CompressedSize / InTreeRoot->CompressedSize : 0.f;
-		Child->CompressedSizePercentOfParent = InRoot->CompressedSize > 0 ? (float)Child->CompressedSize / InRoot->CompressedSize : 0.f;
+		OwnerPakNames.Add(FPaths::GetCleanFilename(Summary->PakFilePath));
+	}
+
+	return OwnerPakNames;
+}
+
+FString FBaseAnalyzer::GetAssetRegistryPath() const
+{
+	return AssetRegistryPath;
+}
 
-		if (Child->bIsDirectory)
+void FBaseAnalyzer::RefreshClassMap(FPakTreeEntryPtr InTreeRoot)
+{
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	if (!FileTable.IsValid())
+	{
+		return;
+	}
+
+	static const EParallelForFlags ParallelForFlags = FPlatformMisc::IsDebuggerPresent() ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced;
+
+	// Class lookup only reads the asset registry and the default class map
+	TArray<FName> FileClasses;
+	FileClasses.AddDefaulted(FileTable->Num());
+	ParallelFor(FileTable->Num(), [this, &FileTable, &FileClasses](int32 Index)
+	{
+		const FPakTreeEntry* File = FileTable->Entries[Index];
+		FileClasses[Index] = GetAssetClass(File->Filename.ToString(), File->PackagePath);
+	}, ParallelForFlags);
+
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		for (int32 Index = 0; Index < FileTable->Num(); ++Index)
 		{
-			RefreshTreeNodeSizePercent(InTreeRoot, Child);
+			FileTable->ClassIds[Index] = FileTable->FindOrAddClass(FileClasses[Index]);
 		}
 	}
+
+	RefreshClassInfo(InTreeRoot);
 }
 
-void FBaseAnalyzer::RetriveFiles(FPakTreeEntryPtr InRoot, const FString& InFilterText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InPakIndexFilter, TArray<FPakFileEntryPtr>& OutFiles) const
+void FBaseAnalyzer::RefreshClassInfo(FPakTreeEntryPtr InTreeRoot)
 {
-	for (auto& Pair : InRoot->ChildrenMap)
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	if (!FileTable.IsValid())
 	{
-		FPakTreeEntryPtr Child = Pair.Value;
-		if (Child->bIsDirectory)
+		return;
+	}
+
+	for (FPakTreeEntry* Directory : FileTable->Directories)
+	{
+		Directory->FileClassMap.Empty();
+	}
+
+	for (int32 Index = 0; Index < FileTable->Num(); ++Index)
+	{
+		InsertClassInfo(FileTable->Directories[FileTable->ParentDirectories[Index]], FileTable->Classes[FileTable->ClassIds[Index]], 1, FileTable->Entries[Index]->PakEntry.UncompressedSize, FileTable->Entries[Index]->PakEntry.Size);
+	}
+
+	// Fold every directory into its parent, children always come after their parent
+	for (int32 DirectoryIndex = FileTable->Directories.Num() - 1; DirectoryIndex > 0; --DirectoryIndex)
+	{
+		FPakTreeEntry* Directory = FileTable->Directories[DirectoryIndex];
+		FPakTreeEntry* Parent = FileTable->Directories[FileTable->DirectoryParents[DirectoryIndex]];
+
+		for (const auto& ClassPair : Directory->FileClassMap)
 		{
-			RetriveFiles(Child, InFilterText, InClassFilterMap, InPakIndexFilter, OutFiles);
+			InsertClassInfo(Parent, ClassPair.Key, ClassPair.Value->FileCount, ClassPair.Value->Size, ClassPair.Value->CompressedSize);
 		}
-		else
+	}
+
+	for (FPakTreeEntry* Directory : FileTable->Directories)
+	{
+		for (auto& ClassPair : Directory->FileClassMap)
 		{
-			const bool* bShow = InClassFilterMap.Find(Child->Class);
-			const bool* bShowIndex = InPakIndexFilter.Find(Child->OwnerPakIndex);
-			const bool bMatchClass = (InClassFilterMap.Num() <= 0 || (bShow && *bShow));
-			const bool bMatchIndex = (InPakIndexFilter.Num() <= 0) || (bShowIndex && *bShowIndex);
+			FPakClassEntryPtr& ClassEntry = ClassPair.Value;
+			ClassEntry->PercentOfTotal = InTreeRoot->CompressedSize > 0 ? (float)ClassEntry->CompressedSize / InTreeRoot->CompressedSize : 0.f;
+			ClassEntry->PercentOfParent = Directory->CompressedSize > 0 ? (float)ClassEntry->CompressedSize / Directory->CompressedSize : 0.f;
+		}
+	}
+}
+
+void FBaseAnalyzer::RefreshTreeNode(FPakTreeEntryPtr InTreeRoot)
+{
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	if (!FileTable.IsValid())
+	{
+		return;
+	}
 
-			if (bMatchClass && bMatchIndex && (InFilterText.IsEmpty() || /*Child->Filename.Contains(InFilterText) ||*/ Child->Path.Contains(InFilterText)))
+	for (FPakTreeEntry* Directory : FileTable->Directories)
+	{
+		Directory->FileCount = 0;
+		Directory->Size = 0;
+		Directory->CompressedSize = 0;
+	}
+
+	for (int32 Index = 0; Index < FileTable->Num(); ++Index)
+	{
+		FPakTreeEntry* File = FileTable->Entries[Index];
+		File->FileCount = 1;
+		File->Size = File->PakEntry.UncompressedSize;
+		File->CompressedSize = File->PakEntry.Size;
+
+		FPakTreeEntry* Parent = FileTable->Directories[FileTable->ParentDirectories[Index]];
+		Parent->FileCount += 1;
+		Parent->Size += File->Size;
+		Parent->CompressedSize += File->CompressedSize;
+	}
+
+	// Fold every directory into its parent, children always come after their parent
+	for (int32 DirectoryIndex = FileTable->Directories.Num() - 1; DirectoryIndex > 0; --DirectoryIndex)
+	{
+		FPakTreeEntry* Directory = FileTable->Directories[DirectoryIndex];
+		FPakTreeEntry* Parent = FileTable->Directories[FileTable->DirectoryParents[DirectoryIndex]];
+
+		Parent->FileCount += Directory->FileCount;
+		Parent->Size += Directory->Size;
+		Parent->CompressedSize += Directory->CompressedSize;
+	}
+
+	static const EParallelForFlags ParallelForFlags = FPlatformMisc::IsDebuggerPresent() ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced;
+	ParallelFor(FileTable->Directories.Num(), [&FileTable](int32 DirectoryIndex)
+	{
+		FileTable->Directories[DirectoryIndex]->ChildrenMap.ValueSort([](const FPakTreeEntryPtr& A, const FPakTreeEntryPtr& B) -> bool
 			{
-				OutFiles.Add(Child);
-			}
-		}
+				if (A->bIsDirectory == B->bIsDirectory)
+				{
+					return A->Filename.LexicalLess(B->Filename);
+				}
+
+				return (int32)A->bIsDirectory > (int32)B->bIsDirectory;
+			});
+	}, ParallelForFlags);
+}
+
+void FBaseAnalyzer::RefreshTreeNodeSizePercent(FPakTreeEntryPtr InTreeRoot)
+{
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	if (!FileTable.IsValid())
+	{
+		return;
+	}
+
+	for (int32 DirectoryIndex = 1; DirectoryIndex < FileTable->Directories.Num(); ++DirectoryIndex)
+	{
+		FPakTreeEntry* Directory = FileTable->Directories[DirectoryIndex];
+		const FPakTreeEntry* Parent = FileTable->Directories[FileTable->DirectoryParents[DirectoryIndex]];
+
+		Directory->CompressedSizePercentOfTotal = InTreeRoot->CompressedSize > 0 ? (float)Directory->CompressedSize / InTreeRoot->CompressedSize : 0.f;
+		Directory->CompressedSizePercentOfParent = Parent->CompressedSize > 0 ? (float)Directory->CompressedSize / Parent->CompressedSize : 0.f;
+	}
+
+	for (int32 Index = 0; Index < FileTable->Num(); ++Index)
+	{
+		FPakTreeEntry* File = FileTable->Entries[Index];
+		const FPakTreeEntry* Parent = FileTable->Directories[FileTable->ParentDirectories[Index]];
+
+		File->CompressedSizePercentOfTotal = InTreeRoot->CompressedSize > 0 ? (float)File->CompressedSize / InTreeRoot->CompressedSize : 0.f;
+		File->CompressedSizePercentOfParent = Parent->CompressedSize > 0 ? (float)File->CompressedSize / Parent->CompressedSize : 0.f;
 	}
 }
 
-void FBaseAnalyzer::RetriveUAssetFiles(FPakTreeEntryPtr InRoot, TArray<FPakFileEntryPtr>& OutFiles) const
+void FBaseAnalyzer::RetriveFiles(FPakTreeEntryPtr InTreeRoot, const FString& InFilterText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InPakIndexFilter, TArray<FPakFileEntryPtr>& OutFiles) const
 {
-	for (auto& Pair : InRoot->ChildrenMap)
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	if (!FileTable.IsValid())
 	{
-		FPakTreeEntryPtr Child = Pair.Value;
-		if (Child->bIsDirectory)
+		return;
+	}
+
+	if (InPakIndexFilter.Num() > 0)
+	{
+		const bool* bShowIndex = InPakIndexFilter.Find(FileTable->PakIndex);
+		if (!bShowIndex || !*bShowIndex)
 		{
-			RetriveUAssetFiles(Child, OutFiles);
+			return;
 		}
-		else
+	}
+
+	// Resolve the class filter once per class id instead of once per file
+	TArray<bool> ClassVisibility;
+	ClassVisibility.AddUninitialized(FileTable->Classes.Num());
+	for (int32 ClassId = 0; ClassId < FileTable->Classes.Num(); ++ClassId)
+	{
+		const bool* bShow = InClassFilterMap.Find(FileTable->Classes[ClassId]);
+		ClassVisibility[ClassId] = InClassFilterMap.Num() <= 0 || (bShow && *bShow);
+	}
+
+	if (InFilterText.IsEmpty())
+	{
+		for (int32 Index = 0; Index < FileTable->Num(); ++Index)
 		{
-			if (Child->Filename.ToString().EndsWith(TEXT(".uasset")) || Child->Filename.ToString().EndsWith(TEXT(".umap")))
+			if (ClassVisibility[FileTable->ClassIds[Index]])
 			{
-				OutFiles.Add(Child);
+				OutFiles.Add(FileTable->Entries[Index]->AsShared());
 			}
 		}
+		return;
+	}
+
+	if (!FileTable->SearchIndex.IsValid())
+	{
+		// Tables published without PublishPak, callers hold CriticalSection
+		FileTable->SearchIndex = MakeShared<FPakSearchIndex>();
+		FileTable->SearchIndex->Build(*FileTable);
+	}
+
+	TArray<int32> MatchedFiles;
+	FileTable->SearchIndex->Search(*FileTable, InFilterText, MatchedFiles);
+	for (int32 Index : MatchedFiles)
+	{
+		if (ClassVisibility[FileTable->ClassIds[Index]])
+		{
+			OutFiles.Add(FileTable->Entries[Index]->AsShared());
+		}
 	}
 }
 
-void FBaseAnalyzer::InsertClassInfo(FPakTreeEntryPtr InTreeRoot, FPakTreeEntryPtr InRoot, FName InClassName, int32 InFileCount, int64 InSize, int64 InCompressedSize)
+void FBaseAnalyzer::RetriveUAssetFiles(FPakTreeEntryPtr InTreeRoot, TArray<FPakFileEntryPtr>& OutFiles) const
 {
-	FPakClassEntryPtr* ClassEntryPtr = InRoot->FileClassMap.Find(InClassName);
-	FPakClassEntryPtr ClassEntry = nullptr;
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	if (!FileTable.IsValid())
+	{
+		return;
+	}
 
+	for (FPakTreeEntry* File : FileTable->Entries)
+	{
+		const FString Filename = File->Filename.ToString();
+		if (Filename.EndsWith(TEXT(".uasset")) || Filename.EndsWith(TEXT(".umap")))
+		{
+			OutFiles.Add(File->AsShared());
+		}
+	}
+}
+
+void FBaseAnalyzer::InsertClassInfo(FPakTreeEntry* InDirectory, FName InClassName, int32 InFileCount, int64 InSize, int64 InCompressedSize)
+{
+	FPakClassEntryPtr* ClassEntryPtr = InDirectory->FileClassMap.Find(InClassName);
 	if (!ClassEntryPtr)
 	{
-		ClassEntry = MakeShared<FPakClassEntry>(InClassName, InSize, InCompressedSize, InFileCount);
-		InRoot->FileClassMap.Add(InClassName, ClassEntry);
+		InDirectory->FileClassMap.Add(InClassName, MakeShared<FPakClassEntry>(InClassName, InSize, InCompressedSize, InFileCount));
 	}
 	else
 	{
-		ClassEntry = *ClassEntryPtr;
+		FPakClassEntryPtr ClassEntry = *ClassEntryPtr;
 		ClassEntry->Class = InClassName;
 		ClassEntry->FileCount += InFileCount;
 		ClassEntry->Size += InSize;
 		ClassEntry->CompressedSize += InCompressedSize;
 	}
-
-	ClassEntry->PercentOfTotal = InTreeRoot->CompressedSize > 0 ? (float)ClassEntry->CompressedSize / InTreeRoot->CompressedSize : 0.f;
-	ClassEntry->PercentOfParent = InRoot->CompressedSize > 0 ? (float)ClassEntry->CompressedSize / InRoot->CompressedSize : 0.f;
 }
 
 FName FBaseAnalyzer::GetAssetClass(const FString& InFilename, FName InPackagePath)
@@ -472,23 +1084,208 @@ FName FBaseAnalyzer::GetPackagePath(const FString& InFilePath)
 
 void FBaseAnalyzer::Reset()
 {
-	for (FPakFileSumaryPtr Summary : PakFileSummaries)
 	{
-		Summary.Reset();
+		FScopeLock Lock(&CriticalSection);
+		PakFileSummaries.Empty();
+		PakTreeRoots.Empty();
+		DefaultClassMap.Empty();
 	}
 
-	for (FPakTreeEntryPtr Root : PakTreeRoots)
+	AssetRegistryState.Reset();
+
+	AssetRegistryPath = TEXT("");
+
+	if (!bSharedPackageDependencies)
 	{
-		Root.Reset();
+		PackageDependencies->Reset();
 	}
 
-	PakFileSummaries.Empty();
-	PakTreeRoots.Empty();
+	{
+		FScopeLock Lock(&LoadCostsLock);
+		PackageLoadCosts.Reset();
+	}
+}
 
-	AssetRegistryState.Reset();
+FExtractJobPtr FBaseAnalyzer::BeginExtractJob(const FString& InOutputPath)
+{
+	if (!bSharedExtractJob)
+	{
+		// Workers of the previous extraction are stopped by now, releasing its manifest writes what is left
+		ExtractManifest.Reset();
+		ExtractArchive.Reset();
 
-	AssetRegistryPath = TEXT("");
-	DefaultClassMap.Empty();
+		if (FExtractArchiveWriter::IsArchivePath(InOutputPath))
+		{
+			// Entries are streamed into one file, there is no folder to create and nothing to resume
+			ExtractArchive = FExtractArchiveWriter::Open(InOutputPath);
+			if (!ExtractArchive)
+			{
+				return nullptr;
+			}
+		}
+		else
+		{
+			if (!FPaths::DirectoryExists(InOutputPath))
+			{
+				IFileManager::Get().MakeDirectory(*InOutputPath, true);
+			}
+
+			ExtractManifest = FExtractManifest::Open(InOutputPath);
+		}
+
+		ExtractJob = MakeShared<FExtractJob, ESPMode::ThreadSafe>();
+		FPakAnalyzerDelegates::OnExtractStart.ExecuteIfBound();
+	}
+
+	return ExtractJob;
+}
+
+bool FBaseAnalyzer::IsLoadCancelled() const
+{
+	return LoadJob.IsValid() && LoadJob->IsCancelled();
+}
+
+void FBaseAnalyzer::SetLoadPhase(EPakLoadPhase InPhase)
+{
+	if (LoadJob.IsValid())
+	{
+		LoadJob->SetPhase(InPhase);
+	}
+}
+
+void FBaseAnalyzer::AddLoadSteps(int32 InStepCount)
+{
+	if (LoadJob.IsValid())
+	{
+		LoadJob->AddSteps(InStepCount);
+	}
+}
+
+void FBaseAnalyzer::AdvanceLoadStep()
+{
+	if (LoadJob.IsValid())
+	{
+		LoadJob->AdvanceStep();
+	}
+}
+
+int32 FBaseAnalyzer::PublishPak(FPakFileSumaryPtr InSummary, FPakTreeEntryPtr InTreeRoot, int32 InPakIndexBase)
+{
+	// The index only reads names and directories, which are final once the tree is built
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	if (FileTable.IsValid() && !FileTable->SearchIndex.IsValid())
+	{
+		TSharedPtr<FPakSearchIndex> SearchIndex = MakeShared<FPakSearchIndex>();
+		SearchIndex->Build(*FileTable);
+		FileTable->SearchIndex = SearchIndex;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
+	// Readers never see a tree before it has its final index
+	const int32 PakIndex = InPakIndexBase + PakFileSummaries.Num();
+	if (InTreeRoot->OwnerPakIndex != PakIndex)
+	{
+		SetOwnerPakIndex(InTreeRoot, PakIndex);
+	}
+
+	PakFileSummaries.Add(InSummary);
+	PakTreeRoots.Add(InTreeRoot);
+
+	// Taken inside the lock of the part, so the owner gets the paks in the same order
+	if (PublishOwner)
+	{
+		FScopeLock OwnerLock(&PublishOwner->CriticalSection);
+		ensure(PublishOwner->PakFileSummaries.Num() == PakIndex);
+		PublishOwner->PakFileSummaries.Add(InSummary);
+		PublishOwner->PakTreeRoots.Add(InTreeRoot);
+	}
+
+	return PakIndex;
+}
+
+void FBaseAnalyzer::SetOwnerPakIndex(const FPakTreeEntryPtr& InRoot, int32 InPakIndex)
+{
+	FPakFileTable& FileTable = *InRoot->FileTable;
+	FileTable.PakIndex = InPakIndex;
+
+	for (FPakTreeEntry* Directory : FileTable.Directories)
+	{
+		Directory->OwnerPakIndex = InPakIndex;
+	}
+
+	for (FPakTreeEntry* File : FileTable.Entries)
+	{
+		File->OwnerPakIndex = InPakIndex;
+	}
+}
+
+void FBaseAnalyzer::NotifyPakLoaded(FPakFileSumaryPtr InSummary, FPakTreeEntryPtr InTreeRoot)
+{
+	if (!LoadJob.IsValid())
+	{
+		return;
+	}
+
+	RunOnGameThreadForLoad([InSummary, InTreeRoot]()
+		{
+			FPakAnalyzerDelegates::OnPakLoaded.Broadcast(InSummary, InTreeRoot);
+		});
+}
+
+void FBaseAnalyzer::RunOnGameThreadForLoad(TUniqueFunction<void()>&& InFunction)
+{
+	// The job outlives the analyzer, it is cancelled by the next load and by the destructor
+	FPakLoadJobPtr Job = LoadJob;
+	RunOnGameThread([Job, Function = MoveTemp(InFunction)]()
+		{
+			if (!Job.IsValid() || !Job->IsCancelled())
+			{
+				Function();
+			}
+		});
+}
+
+FString FBaseAnalyzer::RequestAESKey(const FString& InPakPath, const FGuid& InKeyGuid, bool& bOutCancel)
+{
+	bOutCancel = true;
+
+	if (IsInGameThread())
+	{
+		return FPakAnalyzerDelegates::OnGetAESKey.Execute(InPakPath, InKeyGuid, bOutCancel);
+	}
+
+	// Owned by the dialog task too, it may still run after this thread gave up on it
+	struct FKeyRequest
+	{
+		FString Key;
+		bool bCancel = true;
+	};
+	TSharedRef<FKeyRequest, ESPMode::ThreadSafe> Request = MakeShared<FKeyRequest, ESPMode::ThreadSafe>();
+
+	FPakLoadJobPtr Job = LoadJob;
+	FGraphEventRef DialogTask = FFunctionGraphTask::CreateAndDispatchWhenReady([Request, Job, InPakPath, InKeyGuid]()
+		{
+			if (!Job.IsValid() || !Job->IsCancelled())
+			{
+				Request->Key = FPakAnalyzerDelegates::OnGetAESKey.Execute(InPakPath, InKeyGuid, Request->bCancel);
+			}
+		},
+		TStatId(), nullptr, ENamedThreads::GameThread);
+
+	// CancelLoad joins this thread from the game thread, which then never runs the dialog
+	while (!DialogTask->IsComplete())
+	{
+		if (IsLoadCancelled())
+		{
+			return TEXT("");
+		}
+
+		FPlatformProcess::Sleep(0.01f);
+	}
+
+	bOutCancel = Request->bCancel;
+	return Request->Key;
 }
 
 FString FBaseAnalyzer::ResolveCompressionMethod(const FPakFileSumary& Summary, const FPakEntry* InPakEntry) const
@@ -503,26 +1300,62 @@ FString FBaseAnalyzer::ResolveCompressionMethod(const FPakFileSumary& Summary, c
 	}
 }
 
+FPakTreeEntryPtr FBaseAnalyzer::MakeTreeRoot(const FString& InPakPath, const FString& InMountPoint, int32 InPakIndex) const
+{
+	FPakTreeEntryPtr TreeRoot = MakeShared<FPakTreeEntry>(*FPaths::GetCleanFilename(InPakPath), true);
+
+	TreeRoot->FileTable = MakeShared<FPakFileTable>();
+	TreeRoot->FileTable->PakIndex = InPakIndex;
+	TreeRoot->FileTable->MountPoint = InMountPoint;
+	TreeRoot->DirectoryIndex = TreeRoot->FileTable->AddDirectory(TreeRoot.Get(), INDEX_NONE, FStringView());
+	TreeRoot->OwnerPakIndex = InPakIndex;
+
+	return TreeRoot;
+}
+
 FPakTreeEntryPtr FBaseAnalyzer::InsertFileToTree(FPakTreeEntryPtr InRoot, const FPakFileSumary& Summary, const FString& InFullPath, const FPakEntry& InPakEntry)
 {
-	static const TCHAR* Delims[2] = { TEXT("\\"), TEXT("/") };
+	const FPakFileTablePtr& FileTable = InRoot->FileTable;
+	check(FileTable.IsValid());
+
+	auto IsDelim = [](TCHAR InChar) { return InChar == TEXT('/') || InChar == TEXT('\\'); };
+
+	// Walk the path in place, existing components are found by FName without building any string, new ones keep the case of InFullPath in the table
+	const TCHAR* PathData = *InFullPath;
+	const int32 PathLen = InFullPath.Len();
 
-	TArray<FString> PathItems;
-	InFullPath.ParseIntoArray(PathItems, Delims, 2);
+	int32 Start = 0;
+	while (Start < PathLen && IsDelim(PathData[Start]))
+	{
+		++Start;
+	}
 
-	if (PathItems.Num() <= 0)
+	if (Start >= PathLen)
 	{
 		return nullptr;
 	}
 
-	FString CurrentPath;
 	FPakTreeEntryPtr Parent = InRoot;
 
-	for (int32 i = 0; i < PathItems.Num(); ++i)
+	while (Start < PathLen)
 	{
-		CurrentPath = CurrentPath / PathItems[i];
+		int32 End = Start;
+		while (End < PathLen && !IsDelim(PathData[End]))
+		{
+			++End;
+		}
+
+		int32 NextStart = End;
+		while (NextStart < PathLen && IsDelim(PathData[NextStart]))
+		{
+			++NextStart;
+		}
 
-		FPakTreeEntryPtr* Child = Parent->ChildrenMap.Find(*PathItems[i]);
+		const FStringView ItemString(PathData + Start, End - Start);
+		const FName ItemName(ItemString.Len(), ItemString.GetData());
+		Start = NextStart;
+
+		FPakTreeEntryPtr* Child = Parent->ChildrenMap.Find(ItemName);
 		if (Child)
 		{
 			Parent = *Child;
@@ -530,17 +1363,37 @@ FPakTreeEntryPtr FBaseAnalyzer::InsertFileToTree(FPakTreeEntryPtr InRoot, const
 		}
 		else
 		{
-			const bool bLastItem = (i == PathItems.Num() - 1);
+			const bool bLastItem = (NextStart >= PathLen);
+
+			FPakTreeEntryPtr NewChild = MakeShared<FPakTreeEntry>(ItemName, !bLastItem);
+			NewChild->FileTable = FileTable;
+			NewChild->OwnerPakIndex = FileTable->PakIndex;
 
-			FPakTreeEntryPtr NewChild = MakeShared<FPakTreeEntry>(*PathItems[i], CurrentPath, !bLastItem);
 			if (bLastItem)
 			{
-				NewChild->PakEntry = InPakEntry;
+				// Compression blocks stay on disk, readers take them from the payload header
+				FPakEntry& PakEntry = NewChild->PakEntry;
+				PakEntry.Offset = InPakEntry.Offset;
+				PakEntry.Size = InPakEntry.Size;
+				PakEntry.UncompressedSize = InPakEntry.UncompressedSize;
+				PakEntry.CompressionMethodIndex = InPakEntry.CompressionMethodIndex;
+				PakEntry.CompressionBlockSize = InPakEntry.CompressionBlockSize;
+				PakEntry.Flags = InPakEntry.Flags;
+				FMemory::Memcpy(PakEntry.Hash, InPakEntry.Hash, sizeof(PakEntry.Hash));
+
 				NewChild->CompressionMethod = *ResolveCompressionMethod(Summary, &InPakEntry);
-				NewChild->PackagePath = GetPackagePath(CurrentPath);
+				NewChild->FileIndex = FileTable->AddFile(NewChild.Get(), Parent->DirectoryIndex, ItemString, InPakEntry.CompressionBlocks.Num(), NAME_None);
+
+				TStringBuilder<256> RelativePath;
+				FileTable->AppendFilePath(NewChild->FileIndex, RelativePath, false);
+				NewChild->PackagePath = GetPackagePath(RelativePath.ToString());
+			}
+			else
+			{
+				NewChild->DirectoryIndex = FileTable->AddDirectory(NewChild.Get(), Parent->DirectoryIndex, ItemString);
 			}
 
-			Parent->ChildrenMap.Add(*PathItems[i], NewChild);
+			Parent->ChildrenMap.Add(ItemName, NewChild);
 			Parent = NewChild;
 		}
 	}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 
+#include "Async/Future.h"
 #include "HAL/CriticalSection.h"
 #include "Misc/AES.h"
 #include "Misc/Guid.h"
@@ -11,6 +12,9 @@
 
 #include "AssetRegistry/AssetRegistryState.h"
 
+#include "CommonDefines.h"
+#include "ExtractArchiveWriter.h"
+#include "ExtractManifest.h"
 #include "IPakAnalyzer.h"
 
 class FArrayReader;
@@ -22,35 +26,96 @@ public:
 	virtual ~FBaseAnalyzer();
 
 	virtual bool LoadPakFiles(const TArray<FString>& InPakPaths, const TArray<FString>& InDefaultAESKeys, int32 ContainerStartIndex = 0) override;
+	virtual FPakLoadJobPtr LoadPakFilesAsync(const TArray<FString>& InPakPaths, const TArray<FString>& InDefaultAESKeys) override;
+	virtual void CancelLoad() override;
 	virtual void GetFiles(const FString& InFilterText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InPakIndexFilter, TArray<FPakFileEntryPtr>& OutFiles) const override;
-	virtual const TArray<FPakFileSumaryPtr>& GetPakFileSumary() const override;
-	virtual const TArray<FPakTreeEntryPtr>& GetPakTreeRootNode() const override;
+	virtual TArray<FPakFileSumaryPtr> GetPakFileSumary() const override;
+	virtual TArray<FPakTreeEntryPtr> GetPakTreeRootNode() const override;
 	virtual bool LoadAssetRegistry(const FString& InRegristryPath) override;
 	virtual bool ExportToJson(const FString& InOutputPath, const TArray<FPakFileEntryPtr>& InFiles) override;
 	virtual bool ExportToCsv(const FString& InOutputPath, const TArray<FPakFileEntryPtr>& InFiles) override;
+	virtual bool ExportToBinary(const FString& InOutputPath, const TArray<FPakFileEntryPtr>& InFiles) override;
 	virtual FString GetAssetRegistryPath() const override;
 	virtual void ExtractFiles(const FString& InOutputPath, TArray<FPakFileEntryPtr>& InFiles) override {}
 	virtual void CancelExtract() override {}
+	virtual FExtractJobPtr GetExtractJob() const override { return ExtractJob; }
 	virtual void SetExtractThreadCount(int32 InThreadCount) override {}
+	virtual void LoadFileHashes(const TArray<FPakFileEntryPtr>& InFiles) override {}
+	virtual FPackageGraphPtr GetPackageGraph() const override;
+	virtual FPackageLoadCostsPtr GetPackageLoadCosts() const override;
+	virtual FPackageLoadCostsPtr UpdatePackageLoadCosts(TFunctionRef<bool()> IsAborted) override;
+	virtual FPakLoadJobPtr GetLoadJob() const override { return LoadJob; }
+
+	// An owning analyzer shares the job, manifest and archive of each extraction with its parts before extracting them, so the window shows the sum of both
+	void SetExtractJob(FExtractJobPtr InExtractJob, FExtractManifestPtr InExtractManifest, FExtractArchiveWriterPtr InExtractArchive)
+	{
+		ExtractJob = InExtractJob;
+		ExtractManifest = InExtractManifest;
+		ExtractArchive = InExtractArchive;
+		bSharedExtractJob = true;
+	}
+	// An owning analyzer shares its load job with its parts before loading them
+	void SetLoadJob(FPakLoadJobPtr InLoadJob) { LoadJob = InLoadJob; }
+	// Paks a part publishes are appended to its owning analyzer at the same time, so the owner's getters see them as early
+	void SetPublishOwner(FBaseAnalyzer* InOwner) { PublishOwner = InOwner; }
+	// An owning analyzer shares its package dependencies with its parts and resets them itself
+	void SetPackageDependencies(FPackageDependenciesPtr InPackageDependencies);
 
 protected:
 	virtual void Reset();
 	virtual FString ResolveCompressionMethod(const FPakFileSumary& Summary, const FPakEntry* InPakEntry) const;
 
+	FPakTreeEntryPtr MakeTreeRoot(const FString& InPakPath, const FString& InMountPoint, int32 InPakIndex) const;
 	FPakTreeEntryPtr InsertFileToTree(FPakTreeEntryPtr InRoot, const FPakFileSumary& Summary, const FString& InFullPath, const FPakEntry& InPakEntry);
 
 	//加载 AssetRegistry.bin
 	bool LoadAssetRegistry(FArrayReader& InData);
-	void RefreshPackageDependency(FPakTreeEntryPtr InTreeRoot, FPakTreeEntryPtr InRoot);
-	void RefreshClassMap(FPakTreeEntryPtr InTreeRoot, FPakTreeEntryPtr InRoot);
-	void RefreshTreeNode(FPakTreeEntryPtr InRoot);
-	void RefreshTreeNodeSizePercent(FPakTreeEntryPtr InTreeRoot, FPakTreeEntryPtr InRoot);
-	void RetriveFiles(FPakTreeEntryPtr InRoot, const FString& InFilterText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InPakIndexFilter, TArray<FPakFileEntryPtr>& OutFiles) const;
-	void RetriveUAssetFiles(FPakTreeEntryPtr InRoot, TArray<FPakFileEntryPtr>& OutFiles) const;
-	void InsertClassInfo(FPakTreeEntryPtr InTreeRoot, FPakTreeEntryPtr InRoot, FName InClassName, int32 InFileCount, int64 InSize, int64 InCompressedSize);
+	// Refreshes the classes and dependencies of InTreeRoots, a load passes its trees before publishing them
+	bool LoadAssetRegistry(const FString& InRegristryPath, const TArray<FPakTreeEntryPtr>& InTreeRoots);
+	void RefreshPackageDependency(const TArray<FPakTreeEntryPtr>& InTreeRoots);
+	// Gives every asset summary of the tree its row in the package graph
+	void AssignPackageIds(FPakTreeEntryPtr InTreeRoot);
+	void RefreshClassMap(FPakTreeEntryPtr InTreeRoot);
+	// Class size/count per directory from the class column of the file table
+	void RefreshClassInfo(FPakTreeEntryPtr InTreeRoot);
+	void RefreshTreeNode(FPakTreeEntryPtr InTreeRoot);
+	void RefreshTreeNodeSizePercent(FPakTreeEntryPtr InTreeRoot);
+	void RetriveFiles(FPakTreeEntryPtr InTreeRoot, const FString& InFilterText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InPakIndexFilter, TArray<FPakFileEntryPtr>& OutFiles) const;
+	void RetriveUAssetFiles(FPakTreeEntryPtr InTreeRoot, TArray<FPakFileEntryPtr>& OutFiles) const;
+	// Clean file name of every pak, indexed by OwnerPakIndex
+	TArray<FString> GetOwnerPakNames() const;
+	void InsertClassInfo(FPakTreeEntry* InDirectory, FName InClassName, int32 InFileCount, int64 InSize, int64 InCompressedSize);
 	FName GetAssetClass(const FString& InFilename, const FName InPackagePath);
 	FName GetPackagePath(const FString& InFilePath);
 
+	// Job of a new extraction, or the one shared by the owning analyzer, which opens the progress window once for all of its parts
+	// Also creates the output folder and opens its manifest, see ExtractManifest, or opens the archive for a .tar or .zip path. Null when the archive can't be written.
+	FExtractJobPtr BeginExtractJob(const FString& InOutputPath);
+	// Workers hold the archive from now on, the last one to finish closes it
+	void ReleaseExtractArchive() { ExtractArchive.Reset(); }
+
+	// Stops once the load of the exported paks is cancelled or replaced, null then
+	FPackageLoadCostsPtr UpdateExportLoadCosts();
+
+	// Load job helpers, all of them do nothing for a synchronous load
+	bool IsLoadCancelled() const;
+	void SetLoadPhase(EPakLoadPhase InPhase);
+	void AddLoadSteps(int32 InStepCount);
+	void AdvanceLoadStep();
+	void NotifyPakLoaded(FPakFileSumaryPtr InSummary, FPakTreeEntryPtr InTreeRoot);
+	// Dropped when the load was cancelled or replaced before the game thread gets to it
+	void RunOnGameThreadForLoad(TUniqueFunction<void()>&& InFunction);
+	// Asks OnGetAESKey on the game thread, a load thread stops waiting for the dialog once the load is cancelled
+	FString RequestAESKey(const FString& InPakPath, const FGuid& InKeyGuid, bool& bOutCancel);
+
+	// Appends one pak to the getters as soon as its tree is built, classes and dependencies may follow later.
+	// Builds the substring index of its paths first. Paks are numbered in the order they are published, from InPakIndexBase on, the tree is renumbered under the lock. Returns the pak index
+	int32 PublishPak(FPakFileSumaryPtr InSummary, FPakTreeEntryPtr InTreeRoot, int32 InPakIndexBase = 0);
+	static void SetOwnerPakIndex(const FPakTreeEntryPtr& InRoot, int32 InPakIndex);
+
+	// Runs right away on the game thread, queued to it from any other thread
+	static void RunOnGameThread(TUniqueFunction<void()>&& InFunction);
+
 protected:
 	FCriticalSection CriticalSection;
 
@@ -61,4 +126,25 @@ protected:
 	FString AssetRegistryPath;
 
 	TSharedPtr<class FAssetRegistryState> AssetRegistryState;
+
+	FExtractJobPtr ExtractJob;
+	// Null when the manifest of the output folder can't be written, every file is extracted then
+	FExtractManifestPtr ExtractManifest;
+	// Only set while an extraction to an archive is being started
+	FExtractArchiveWriterPtr ExtractArchive;
+	bool bSharedExtractJob = false;
+
+	FPackageDependenciesPtr PackageDependencies;
+	bool bSharedPackageDependencies = false;
+
+	// LoadCostsLock guards the pointer, LoadCostsUpdateLock keeps one computation at a time
+	mutable FCriticalSection LoadCostsLock;
+	FCriticalSection LoadCostsUpdateLock;
+	FPackageLoadCostsPtr PackageLoadCosts;
+
+	FPakLoadJobPtr LoadJob;
+	// Only set on the parts of an owning analyzer, see SetPublishOwner
+	FBaseAnalyzer* PublishOwner = nullptr;
+	// Only valid on the analyzer that started the load thread
+	TFuture<void> LoadTask;
 };
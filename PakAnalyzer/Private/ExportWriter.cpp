@@ -0,0 +1,123 @@
+#include "ExportWriter.h"
+
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMisc.h"
+
+#include "CommonDefines.h"
+
+FExportWriter::FExportWriter()
+{
+
+}
+
+FExportWriter::~FExportWriter()
+{
+	Close();
+}
+
+bool FExportWriter::Open(const FString& InOutputPath)
+{
+	Close();
+
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*InOutputPath));
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Export failed, can't open %s for write."), *InOutputPath);
+		return false;
+	}
+
+	// One batch keeps every worker busy, the buffers of a batch are reused by the next one
+	Chunks.SetNum(FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads()) * 2);
+	return true;
+}
+
+bool FExportWriter::Close()
+{
+	if (!Writer.IsValid())
+	{
+		return false;
+	}
+
+	const bool bResult = Writer->Close();
+	Writer.Reset();
+	Chunks.Empty();
+	Utf8Buffer.Empty();
+
+	return bResult;
+}
+
+void FExportWriter::Write(FStringView InText)
+{
+	ConvertToUtf8(InText, Utf8Buffer);
+	Write(Utf8Buffer.GetData(), Utf8Buffer.Num());
+}
+
+void FExportWriter::Write(const void* InData, int64 InSize)
+{
+	if (Writer.IsValid() && InSize > 0)
+	{
+		Writer->Serialize(const_cast<void*>(InData), InSize);
+	}
+}
+
+void FExportWriter::Align(int64 InAlignment)
+{
+	static const uint8 Zeros[16] = { 0 };
+
+	const int64 Position = Tell();
+	for (int64 Remaining = ::Align(Position, InAlignment) - Position; Remaining > 0; Remaining -= sizeof(Zeros))
+	{
+		Write(Zeros, FMath::Min<int64>(Remaining, sizeof(Zeros)));
+	}
+}
+
+int64 FExportWriter::Tell() const
+{
+	return Writer.IsValid() ? Writer->Tell() : 0;
+}
+
+void FExportWriter::WriteRows(int32 InRowCount, TFunctionRef<void(int32 StartRow, int32 EndRow, FString& OutText)> InFormatRows)
+{
+	if (!Writer.IsValid())
+	{
+		return;
+	}
+
+	static const EParallelForFlags ParallelForFlags = FPlatformMisc::IsDebuggerPresent() ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced;
+
+	const int32 ChunkCount = FMath::DivideAndRoundUp(InRowCount, RowsPerChunk);
+	for (int32 FirstChunk = 0; FirstChunk < ChunkCount && !Writer->IsError(); FirstChunk += Chunks.Num())
+	{
+		const int32 BatchChunkCount = FMath::Min(Chunks.Num(), ChunkCount - FirstChunk);
+		ParallelFor(BatchChunkCount, [this, &InFormatRows, InRowCount, FirstChunk](int32 Index)
+		{
+			const int32 StartRow = (FirstChunk + Index) * RowsPerChunk;
+			const int32 EndRow = FMath::Min(InRowCount, StartRow + RowsPerChunk);
+
+			FChunk& Chunk = Chunks[Index];
+			Chunk.Text.Reset();
+			InFormatRows(StartRow, EndRow, Chunk.Text);
+			ConvertToUtf8(Chunk.Text, Chunk.Utf8);
+		}, ParallelForFlags);
+
+		for (int32 Index = 0; Index < BatchChunkCount; ++Index)
+		{
+			Write(Chunks[Index].Utf8.GetData(), Chunks[Index].Utf8.Num());
+		}
+	}
+}
+
+void FExportWriter::ConvertToUtf8(FStringView InText, TArray<UTF8CHAR>& OutUtf8)
+{
+	// Reset keeps the allocation, so a reused buffer stops growing once it fits the largest chunk
+	OutUtf8.Reset();
+	if (InText.Len() <= 0)
+	{
+		return;
+	}
+
+	OutUtf8.AddUninitialized(FPlatformString::ConvertedLength<UTF8CHAR>(InText.GetData(), InText.Len()));
+	FPlatformString::Convert(OutUtf8.GetData(), OutUtf8.Num(), InText.GetData(), InText.Len());
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+class FArchive;
+
+/**
+ * Streams an export file in constant memory.
+ * Rows are formatted in parallel chunks into text and UTF-8 buffers that are reused batch after batch, then written in row order.
+ */
+class FExportWriter
+{
+public:
+	FExportWriter();
+	~FExportWriter();
+
+	bool Open(const FString& InOutputPath);
+	// Flushes and closes the file, false if any write failed
+	bool Close();
+
+	void Write(FStringView InText);
+	void Write(const void* InData, int64 InSize);
+	// Zero bytes up to the next multiple of InAlignment
+	void Align(int64 InAlignment);
+	int64 Tell() const;
+
+	// InFormatRows appends the text of rows [StartRow, EndRow) to OutText, it runs on several threads at once
+	void WriteRows(int32 InRowCount, TFunctionRef<void(int32 StartRow, int32 EndRow, FString& OutText)> InFormatRows);
+
+protected:
+	static const int32 RowsPerChunk = 1024;
+
+	struct FChunk
+	{
+		FString Text;
+		TArray<UTF8CHAR> Utf8;
+	};
+
+	static void ConvertToUtf8(FStringView InText, TArray<UTF8CHAR>& OutUtf8);
+
+protected:
+	TUniquePtr<FArchive> Writer;
+	TArray<FChunk> Chunks;
+	TArray<UTF8CHAR> Utf8Buffer;
+};
@@ -0,0 +1,611 @@
+#include "ExtractArchiveWriter.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Crc.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryWriter.h"
+
+#include "CommonDefines.h"
+
+static constexpr int32 TarBlockSize = 512;
+// Largest size the 11 octal digits of a ustar header hold, larger ones go to a pax header
+static constexpr int64 TarMaxOctalSize = 077777777777LL;
+// Zip sizes and offsets from this one on go to the zip64 extra field
+static constexpr int64 ZipMaxSize32 = 0xFFFFFFFFLL;
+static constexpr uint16 ZipMethodStore = 0;
+static constexpr uint16 ZipMethodDeflate = 8;
+// Entry names are UTF-8
+static constexpr uint16 ZipFlagUtf8 = 1 << 11;
+
+static const uint8 ZeroBlock[TarBlockSize] = {};
+
+template <typename ValueType>
+static void WriteValue(FArchive& Ar, ValueType InValue)
+{
+	Ar << InValue;
+}
+
+static uint32 MemCrc32Large(const uint8* InData, int64 InSize, uint32 InCrc)
+{
+	while (InSize > 0)
+	{
+		const int32 ChunkSize = (int32)FMath::Min<int64>(InSize, MAX_int32);
+		InCrc = FCrc::MemCrc32(InData, ChunkSize, InCrc);
+		InData += ChunkSize;
+		InSize -= ChunkSize;
+	}
+
+	return InCrc;
+}
+
+// Digits fill the field but its last byte, which stays zero
+static void WriteTarOctal(uint8* OutField, int32 InFieldSize, int64 InValue)
+{
+	OutField[InFieldSize - 1] = 0;
+	for (int32 Index = InFieldSize - 2; Index >= 0; --Index)
+	{
+		OutField[Index] = '0' + (InValue & 7);
+		InValue >>= 3;
+	}
+}
+
+static void MakeTarHeader(uint8* OutBlock, const uint8* InName, int32 InNameSize, const uint8* InPrefix, int32 InPrefixSize, int64 InSize, int64 InTime, uint8 InTypeFlag)
+{
+	FMemory::Memzero(OutBlock, TarBlockSize);
+	FMemory::Memcpy(OutBlock, InName, FMath::Min(InNameSize, 100));
+	WriteTarOctal(OutBlock + 100, 8, 0644);
+	WriteTarOctal(OutBlock + 108, 8, 0);
+	WriteTarOctal(OutBlock + 116, 8, 0);
+	WriteTarOctal(OutBlock + 124, 12, FMath::Min(InSize, TarMaxOctalSize));
+	WriteTarOctal(OutBlock + 136, 12, InTime);
+	OutBlock[156] = InTypeFlag;
+	FMemory::Memcpy(OutBlock + 257, "ustar", 6);
+	FMemory::Memcpy(OutBlock + 263, "00", 2);
+	FMemory::Memcpy(OutBlock + 345, InPrefix, FMath::Min(InPrefixSize, 155));
+
+	// The checksum counts its own field as spaces, it is 6 digits, a zero and a space
+	FMemory::Memset(OutBlock + 148, ' ', 8);
+	uint32 Checksum = 0;
+	for (int32 Index = 0; Index < TarBlockSize; ++Index)
+	{
+		Checksum += OutBlock[Index];
+	}
+	WriteTarOctal(OutBlock + 148, 7, Checksum);
+}
+
+// "<length> <key>=<value>\n", the length counts its own digits
+static void AppendPaxRecord(TArray<uint8>& OutRecords, const TCHAR* InKey, const uint8* InValue, int32 InValueSize)
+{
+	const int32 BodySize = 1 + FCString::Strlen(InKey) + 1 + InValueSize + 1;
+
+	int32 Length = BodySize;
+	while (Length != BodySize + FString::FromInt(Length).Len())
+	{
+		Length = BodySize + FString::FromInt(Length).Len();
+	}
+
+	const FString Prefix = FString::Printf(TEXT("%d %s="), Length, InKey);
+	for (const TCHAR Char : Prefix)
+	{
+		OutRecords.Add((uint8)Char);
+	}
+	OutRecords.Append(InValue, InValueSize);
+	OutRecords.Add('\n');
+}
+
+// Resolves the . and .. segments of the whole path, a path that still leaves the root or names nothing gets no entry
+static bool MakeEntryName(const FString& InRelativePath, TArray<uint8>& OutName)
+{
+	TArray<FString> Segments;
+	InRelativePath.Replace(TEXT("\\"), TEXT("/")).ParseIntoArray(Segments, TEXT("/"), true);
+
+	TArray<FString> ResolvedSegments;
+	for (const FString& Segment : Segments)
+	{
+		if (Segment == TEXT("."))
+		{
+			continue;
+		}
+
+		if (Segment == TEXT(".."))
+		{
+			if (ResolvedSegments.Num() <= 0)
+			{
+				return false;
+			}
+			ResolvedSegments.Pop(false);
+			continue;
+		}
+
+		ResolvedSegments.Add(Segment);
+	}
+
+	if (ResolvedSegments.Num() <= 0)
+	{
+		return false;
+	}
+
+	FTCHARToUTF8 Utf8Path(*FString::Join(ResolvedSegments, TEXT("/")));
+	OutName = TArray<uint8>((const uint8*)Utf8Path.Get(), Utf8Path.Length());
+	return true;
+}
+
+// Forwards the content of a streamed member to the archive, counting it and summing its crc on the way
+class FExtractArchiveMemberWriter : public FArchive
+{
+public:
+	explicit FExtractArchiveMemberWriter(FArchive& InInner)
+		: Inner(InInner)
+	{
+		SetIsSaving(true);
+		SetIsPersistent(true);
+	}
+
+	virtual void Serialize(void* V, int64 Length) override
+	{
+		if (IsError() || Length <= 0)
+		{
+			return;
+		}
+
+		Crc = MemCrc32Large((const uint8*)V, Length, Crc);
+		Size += Length;
+		Inner.Serialize(V, Length);
+		if (Inner.IsError())
+		{
+			SetError();
+		}
+	}
+
+	uint32 Crc = 0;
+	int64 Size = 0;
+
+protected:
+	FArchive& Inner;
+};
+
+// A zlib stream is a raw deflate stream between a 2 byte header and a 4 byte adler32, zip members hold the raw one
+static bool DeflateRaw(const uint8* InData, int64 InSize, TArray<uint8>& OutBuffer, const uint8*& OutData, int64& OutSize)
+{
+	if (InSize <= 0 || InSize > MAX_int32 / 2)
+	{
+		return false;
+	}
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, (int32)InSize);
+	OutBuffer.SetNumUninitialized(CompressedSize, false);
+	if (!FCompression::CompressMemory(NAME_Zlib, OutBuffer.GetData(), CompressedSize, InData, (int32)InSize) || CompressedSize <= 6)
+	{
+		return false;
+	}
+
+	OutData = OutBuffer.GetData() + 2;
+	OutSize = CompressedSize - 6;
+	return true;
+}
+
+bool FExtractArchiveWriter::IsArchivePath(const FString& InOutputPath)
+{
+	const FString Extension = FPaths::GetExtension(InOutputPath);
+	return Extension.Equals(TEXT("tar"), ESearchCase::IgnoreCase) || Extension.Equals(TEXT("zip"), ESearchCase::IgnoreCase);
+}
+
+FExtractArchiveWriterPtr FExtractArchiveWriter::Open(const FString& InArchivePath)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*InArchivePath));
+	if (!Writer)
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Open extract archive to write failed! Path: %s"), *InArchivePath);
+		return nullptr;
+	}
+
+	const EFormat Format = FPaths::GetExtension(InArchivePath).Equals(TEXT("zip"), ESearchCase::IgnoreCase) ? EFormat::Zip : EFormat::Tar;
+	return MakeShareable(new FExtractArchiveWriter(Format, InArchivePath, MoveTemp(Writer)));
+}
+
+FExtractArchiveWriter::FExtractArchiveWriter(EFormat InFormat, const FString& InArchivePath, TUniquePtr<FArchive>&& InWriter)
+	: Format(InFormat)
+	, ArchivePath(InArchivePath)
+	, bDeflate(false)
+	, Writer(MoveTemp(InWriter))
+	, EntryCount(0)
+	, bWriteFailed(false)
+{
+	GConfig->GetBool(TEXT("UnrealPakViewer"), TEXT("ExtractZipDeflate"), bDeflate, GEngineIni);
+
+	// Every entry gets the time the extraction started
+	UnixTime = FDateTime::UtcNow().ToUnixTimestamp();
+
+	const FDateTime Now = FDateTime::Now();
+	DosTime = (uint16)((Now.GetHour() << 11) | (Now.GetMinute() << 5) | (Now.GetSecond() / 2));
+	DosDate = (uint16)((FMath::Max(Now.GetYear() - 1980, 0) << 9) | (Now.GetMonth() << 5) | Now.GetDay());
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Start extract archive: %s, deflate: %d."), *ArchivePath, Format == EFormat::Zip && bDeflate);
+}
+
+FExtractArchiveWriter::~FExtractArchiveWriter()
+{
+	FScopeLock Lock(&WriteLock);
+
+	if (Format == EFormat::Zip)
+	{
+		WriteZipDirectory();
+	}
+	else
+	{
+		// Two zero blocks end a tar
+		WriteLocked(ZeroBlock, TarBlockSize);
+		WriteLocked(ZeroBlock, TarBlockSize);
+	}
+
+	if (Writer->Close() && !bWriteFailed)
+	{
+		UE_LOG(LogPakAnalyzer, Log, TEXT("Finish extract archive: %s, entry count: %d."), *ArchivePath, EntryCount);
+	}
+	else
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Write extract archive failed! Path: %s"), *ArchivePath);
+	}
+}
+
+bool FExtractArchiveWriter::AddFile(const FString& InRelativePath, const uint8* InData, int64 InSize, const uint8* InTail, int64 InTailSize)
+{
+	TArray<uint8> Name;
+	if (!MakeEntryName(InRelativePath, Name))
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Skip archive entry outside the archive root! File: %s"), *InRelativePath);
+		return false;
+	}
+
+	return Format == EFormat::Zip ? AddZipFile(MoveTemp(Name), InData, InSize, InTail, InTailSize) : AddTarFile(MoveTemp(Name), InData, InSize, InTail, InTailSize);
+}
+
+bool FExtractArchiveWriter::AddTarFile(TArray<uint8>&& InName, const uint8* InData, int64 InSize, const uint8* InTail, int64 InTailSize)
+{
+	const int64 Size = InSize + InTailSize;
+
+	TArray<uint8> Header;
+	MakeTarHeaders(InName, Size, Header);
+
+	FScopeLock Lock(&WriteLock);
+
+	WriteLocked(Header.GetData(), Header.Num());
+	WriteLocked(InData, InSize);
+	WriteLocked(InTail, InTailSize);
+	WriteLocked(ZeroBlock, (TarBlockSize - Size % TarBlockSize) % TarBlockSize);
+	++EntryCount;
+
+	return !bWriteFailed;
+}
+
+void FExtractArchiveWriter::MakeTarHeaders(const TArray<uint8>& InName, int64 InSize, TArray<uint8>& OutHeader) const
+{
+	// ustar splits a long path at a '/' into prefix and name
+	int32 PrefixSize = 0;
+	if (InName.Num() > 100)
+	{
+		for (int32 Index = 0; Index < InName.Num() && Index <= 155; ++Index)
+		{
+			if (InName[Index] == '/' && InName.Num() - Index - 1 <= 100)
+			{
+				PrefixSize = Index;
+				break;
+			}
+		}
+	}
+
+	// Paths that can't be split and sizes past 8 GB go to a pax header in front of the entry
+	const bool bPaxPath = InName.Num() > 100 && PrefixSize == 0;
+	if (bPaxPath || InSize > TarMaxOctalSize)
+	{
+		TArray<uint8> Records;
+		if (bPaxPath)
+		{
+			AppendPaxRecord(Records, TEXT("path"), InName.GetData(), InName.Num());
+		}
+		if (InSize > TarMaxOctalSize)
+		{
+			const FString SizeText = FString::Printf(TEXT("%lld"), InSize);
+			AppendPaxRecord(Records, TEXT("size"), (const uint8*)TCHAR_TO_ANSI(*SizeText), SizeText.Len());
+		}
+
+		static const uint8 PaxName[] = "PaxHeader";
+		OutHeader.AddUninitialized(TarBlockSize);
+		MakeTarHeader(OutHeader.GetData(), PaxName, sizeof(PaxName) - 1, nullptr, 0, Records.Num(), UnixTime, 'x');
+		OutHeader.Append(Records);
+		OutHeader.AddZeroed((TarBlockSize - Records.Num() % TarBlockSize) % TarBlockSize);
+	}
+
+	const int32 HeaderOffset = OutHeader.AddUninitialized(TarBlockSize);
+	if (PrefixSize > 0)
+	{
+		MakeTarHeader(OutHeader.GetData() + HeaderOffset, InName.GetData() + PrefixSize + 1, InName.Num() - PrefixSize - 1, InName.GetData(), PrefixSize, InSize, UnixTime, '0');
+	}
+	else
+	{
+		// Cut to 100 bytes when the pax header has the whole path
+		MakeTarHeader(OutHeader.GetData() + HeaderOffset, InName.GetData(), InName.Num(), nullptr, 0, InSize, UnixTime, '0');
+	}
+}
+
+bool FExtractArchiveWriter::AddZipFile(TArray<uint8>&& InName, const uint8* InData, int64 InSize, const uint8* InTail, int64 InTailSize)
+{
+	FZipMember Member;
+	Member.Name = MoveTemp(InName);
+	Member.UncompressedSize = InSize + InTailSize;
+	Member.Crc = MemCrc32Large(InTail, InTailSize, MemCrc32Large(InData, InSize, 0));
+	Member.Method = ZipMethodStore;
+	Member.CompressedSize = Member.UncompressedSize;
+	Member.HeaderOffset = 0;
+
+	// Deflated on the calling worker, the lock is only held to append the member
+	TArray<uint8> JoinedData;
+	TArray<uint8> DeflatedBuffer;
+	const uint8* DeflatedData = nullptr;
+	int64 DeflatedSize = 0;
+	if (bDeflate && Member.UncompressedSize <= MAX_int32 / 2)
+	{
+		const uint8* Source = InData;
+		if (InTailSize > 0)
+		{
+			JoinedData.Append(InData, (int32)InSize);
+			JoinedData.Append(InTail, (int32)InTailSize);
+			Source = JoinedData.GetData();
+		}
+
+		// Members deflate doesn't shrink are stored
+		if (DeflateRaw(Source, Member.UncompressedSize, DeflatedBuffer, DeflatedData, DeflatedSize) && DeflatedSize < Member.UncompressedSize)
+		{
+			Member.Method = ZipMethodDeflate;
+			Member.CompressedSize = DeflatedSize;
+		}
+	}
+
+	TArray<uint8> Header;
+	MakeZipLocalHeader(Member, Header);
+
+	FScopeLock Lock(&WriteLock);
+
+	Member.HeaderOffset = Writer->Tell();
+	WriteLocked(Header.GetData(), Header.Num());
+	if (Member.Method == ZipMethodDeflate)
+	{
+		WriteLocked(DeflatedData, DeflatedSize);
+	}
+	else
+	{
+		WriteLocked(InData, InSize);
+		WriteLocked(InTail, InTailSize);
+	}
+
+	ZipMembers.Add(MoveTemp(Member));
+	++EntryCount;
+
+	return !bWriteFailed;
+}
+
+void FExtractArchiveWriter::MakeZipLocalHeader(const FZipMember& InMember, TArray<uint8>& OutHeader) const
+{
+	const bool bZip64 = InMember.UncompressedSize >= ZipMaxSize32 || InMember.CompressedSize >= ZipMaxSize32;
+
+	FMemoryWriter HeaderWriter(OutHeader);
+	WriteValue<uint32>(HeaderWriter, 0x04034b50);
+	WriteValue<uint16>(HeaderWriter, bZip64 ? 45 : 20);
+	WriteValue<uint16>(HeaderWriter, ZipFlagUtf8);
+	WriteValue<uint16>(HeaderWriter, InMember.Method);
+	WriteValue<uint16>(HeaderWriter, DosTime);
+	WriteValue<uint16>(HeaderWriter, DosDate);
+	WriteValue<uint32>(HeaderWriter, InMember.Crc);
+	WriteValue<uint32>(HeaderWriter, bZip64 ? (uint32)ZipMaxSize32 : (uint32)InMember.CompressedSize);
+	WriteValue<uint32>(HeaderWriter, bZip64 ? (uint32)ZipMaxSize32 : (uint32)InMember.UncompressedSize);
+	WriteValue<uint16>(HeaderWriter, (uint16)InMember.Name.Num());
+	WriteValue<uint16>(HeaderWriter, bZip64 ? 20 : 0);
+	HeaderWriter.Serialize(const_cast<uint8*>(InMember.Name.GetData()), InMember.Name.Num());
+	if (bZip64)
+	{
+		WriteValue<uint16>(HeaderWriter, 0x0001);
+		WriteValue<uint16>(HeaderWriter, 16);
+		WriteValue<uint64>(HeaderWriter, InMember.UncompressedSize);
+		WriteValue<uint64>(HeaderWriter, InMember.CompressedSize);
+	}
+}
+
+bool FExtractArchiveWriter::AddFileStreamed(const FString& InRelativePath, int64 InSize, TFunctionRef<bool(FArchive&)> InWriteContent)
+{
+	FZipMember Member;
+	if (!MakeEntryName(InRelativePath, Member.Name))
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Skip archive entry outside the archive root! File: %s"), *InRelativePath);
+		return false;
+	}
+	Member.Crc = 0;
+	Member.Method = ZipMethodStore;
+	Member.CompressedSize = InSize;
+	Member.UncompressedSize = InSize;
+	Member.HeaderOffset = 0;
+
+	TArray<uint8> Header;
+	if (Format == EFormat::Zip)
+	{
+		MakeZipLocalHeader(Member, Header);
+	}
+	else
+	{
+		MakeTarHeaders(Member.Name, InSize, Header);
+	}
+
+	FScopeLock Lock(&WriteLock);
+
+	if (bWriteFailed)
+	{
+		return false;
+	}
+
+	Member.HeaderOffset = Writer->Tell();
+	WriteLocked(Header.GetData(), Header.Num());
+
+	FExtractArchiveMemberWriter MemberWriter(*Writer);
+	const bool bContentWritten = InWriteContent(MemberWriter) && !MemberWriter.IsError() && MemberWriter.Size == InSize;
+	if (MemberWriter.IsError())
+	{
+		bWriteFailed = true;
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Write extract archive failed! Path: %s"), *ArchivePath);
+	}
+	else if (MemberWriter.Size > InSize)
+	{
+		// The headers already hold the size, the entries after this one would be unreadable
+		bWriteFailed = true;
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Extract archive member is larger than its header says! Member: %s, size: %lld, written: %lld"), *InRelativePath, InSize, MemberWriter.Size);
+	}
+	else if (MemberWriter.Size < InSize)
+	{
+		// A member cut short keeps its size, so the entries after it stay readable
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Extract archive member is incomplete, the rest is zero filled! Member: %s, size: %lld, written: %lld"), *InRelativePath, InSize, MemberWriter.Size);
+		WriteZerosLocked(InSize - MemberWriter.Size);
+	}
+
+	if (Format == EFormat::Zip)
+	{
+		// The crc field follows signature, version, flags, method, time and date
+		Member.Crc = MemberWriter.Crc;
+		const int64 EndOffset = Writer->Tell();
+		Writer->Seek(Member.HeaderOffset + 14);
+		WriteValue<uint32>(*Writer, Member.Crc);
+		Writer->Seek(EndOffset);
+
+		ZipMembers.Add(MoveTemp(Member));
+	}
+	else
+	{
+		WriteLocked(ZeroBlock, (TarBlockSize - InSize % TarBlockSize) % TarBlockSize);
+	}
+	++EntryCount;
+
+	return bContentWritten && !bWriteFailed;
+}
+
+void FExtractArchiveWriter::WriteZerosLocked(int64 InSize)
+{
+	while (InSize > 0 && !bWriteFailed)
+	{
+		const int64 BlockSize = FMath::Min<int64>(InSize, TarBlockSize);
+		WriteLocked(ZeroBlock, BlockSize);
+		InSize -= BlockSize;
+	}
+}
+
+void FExtractArchiveWriter::WriteLocked(const void* InData, int64 InSize)
+{
+	if (bWriteFailed || !InData || InSize <= 0)
+	{
+		return;
+	}
+
+	Writer->Serialize(const_cast<void*>(InData), InSize);
+	if (Writer->IsError())
+	{
+		bWriteFailed = true;
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Write extract archive failed! Path: %s"), *ArchivePath);
+	}
+}
+
+void FExtractArchiveWriter::WriteZipDirectory()
+{
+	const int64 DirectoryOffset = Writer->Tell();
+
+	// Written in batches, the directory of a large extraction is tens of megabytes
+	TArray<uint8> Directory;
+	for (const FZipMember& Member : ZipMembers)
+	{
+		// Only the values that don't fit 32 bits are in the zip64 extra field, in this order
+		TArray<uint8> Extra;
+		FMemoryWriter ExtraWriter(Extra);
+		if (Member.UncompressedSize >= ZipMaxSize32)
+		{
+			WriteValue<uint64>(ExtraWriter, Member.UncompressedSize);
+		}
+		if (Member.CompressedSize >= ZipMaxSize32)
+		{
+			WriteValue<uint64>(ExtraWriter, Member.CompressedSize);
+		}
+		if (Member.HeaderOffset >= ZipMaxSize32)
+		{
+			WriteValue<uint64>(ExtraWriter, Member.HeaderOffset);
+		}
+
+		const bool bZip64 = Extra.Num() > 0;
+
+		FMemoryWriter DirectoryWriter(Directory, false, true);
+		WriteValue<uint32>(DirectoryWriter, 0x02014b50);
+		WriteValue<uint16>(DirectoryWriter, bZip64 ? 45 : 20);
+		WriteValue<uint16>(DirectoryWriter, bZip64 ? 45 : 20);
+		WriteValue<uint16>(DirectoryWriter, ZipFlagUtf8);
+		WriteValue<uint16>(DirectoryWriter, Member.Method);
+		WriteValue<uint16>(DirectoryWriter, DosTime);
+		WriteValue<uint16>(DirectoryWriter, DosDate);
+		WriteValue<uint32>(DirectoryWriter, Member.Crc);
+		WriteValue<uint32>(DirectoryWriter, (uint32)FMath::Min(Member.CompressedSize, ZipMaxSize32));
+		WriteValue<uint32>(DirectoryWriter, (uint32)FMath::Min(Member.UncompressedSize, ZipMaxSize32));
+		WriteValue<uint16>(DirectoryWriter, (uint16)Member.Name.Num());
+		WriteValue<uint16>(DirectoryWriter, bZip64 ? (uint16)(Extra.Num() + 4) : 0);
+		WriteValue<uint16>(DirectoryWriter, 0);
+		WriteValue<uint16>(DirectoryWriter, 0);
+		WriteValue<uint16>(DirectoryWriter, 0);
+		WriteValue<uint32>(DirectoryWriter, 0);
+		WriteValue<uint32>(DirectoryWriter, (uint32)FMath::Min(Member.HeaderOffset, ZipMaxSize32));
+		DirectoryWriter.Serialize(const_cast<uint8*>(Member.Name.GetData()), Member.Name.Num());
+		if (bZip64)
+		{
+			WriteValue<uint16>(DirectoryWriter, 0x0001);
+			WriteValue<uint16>(DirectoryWriter, (uint16)Extra.Num());
+			DirectoryWriter.Serialize(Extra.GetData(), Extra.Num());
+		}
+
+		if (Directory.Num() >= 1024 * 1024)
+		{
+			WriteLocked(Directory.GetData(), Directory.Num());
+			Directory.Reset();
+		}
+	}
+	WriteLocked(Directory.GetData(), Directory.Num());
+
+	const int64 DirectoryEnd = Writer->Tell();
+	const int64 DirectorySize = DirectoryEnd - DirectoryOffset;
+	const int64 MemberCount = ZipMembers.Num();
+
+	TArray<uint8> End;
+	FMemoryWriter EndWriter(End);
+	if (MemberCount >= 0xFFFF || DirectorySize >= ZipMaxSize32 || DirectoryOffset >= ZipMaxSize32)
+	{
+		// Zip64 end of central directory record and its locator
+		WriteValue<uint32>(EndWriter, 0x06064b50);
+		WriteValue<uint64>(EndWriter, 44);
+		WriteValue<uint16>(EndWriter, 45);
+		WriteValue<uint16>(EndWriter, 45);
+		WriteValue<uint32>(EndWriter, 0);
+		WriteValue<uint32>(EndWriter, 0);
+		WriteValue<uint64>(EndWriter, MemberCount);
+		WriteValue<uint64>(EndWriter, MemberCount);
+		WriteValue<uint64>(EndWriter, DirectorySize);
+		WriteValue<uint64>(EndWriter, DirectoryOffset);
+
+		WriteValue<uint32>(EndWriter, 0x07064b50);
+		WriteValue<uint32>(EndWriter, 0);
+		WriteValue<uint64>(EndWriter, DirectoryEnd);
+		WriteValue<uint32>(EndWriter, 1);
+	}
+
+	WriteValue<uint32>(EndWriter, 0x06054b50);
+	WriteValue<uint16>(EndWriter, 0);
+	WriteValue<uint16>(EndWriter, 0);
+	WriteValue<uint16>(EndWriter, (uint16)FMath::Min<int64>(MemberCount, 0xFFFF));
+	WriteValue<uint16>(EndWriter, (uint16)FMath::Min<int64>(MemberCount, 0xFFFF));
+	WriteValue<uint32>(EndWriter, (uint32)FMath::Min(DirectorySize, ZipMaxSize32));
+	WriteValue<uint32>(EndWriter, (uint32)FMath::Min(DirectoryOffset, ZipMaxSize32));
+	WriteValue<uint16>(EndWriter, 0);
+	WriteLocked(End.GetData(), End.Num());
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Templates/UniquePtr.h"
+
+typedef TSharedPtr<class FExtractArchiveWriter, ESPMode::ThreadSafe> FExtractArchiveWriterPtr;
+
+/**
+ * Single .tar or .zip file an extraction streams its entries into, instead of creating a file and its folders per entry.
+ * Workers decode an entry and, for a zip, checksum and deflate it on their own thread, only appending the finished member takes the lock.
+ * The archive is closed when the last worker releases it, a cancelled extraction still leaves a valid archive of the entries done so far.
+ */
+class FExtractArchiveWriter
+{
+public:
+	enum class EFormat : uint8
+	{
+		Tar,
+		Zip,
+	};
+
+	// Extracting to a path ending with .tar or .zip writes an archive instead of a folder
+	static bool IsArchivePath(const FString& InOutputPath);
+	// Null when the archive can't be created
+	static FExtractArchiveWriterPtr Open(const FString& InArchivePath);
+
+	~FExtractArchiveWriter();
+
+	// Any thread. InTail is appended to the content, IoStore ends a .uexp with the package tag that way.
+	// Both fail for a path that resolves outside the archive root
+	bool AddFile(const FString& InRelativePath, const uint8* InData, int64 InSize, const uint8* InTail = nullptr, int64 InTailSize = 0);
+	// Any thread. InWriteContent serializes the InSize bytes of the member into the archive it gets, block by block, a zip member is stored and its crc patched in afterwards.
+	// The archive stays locked meanwhile, so it is only meant for files of StreamedFileMinSize and more, which are too large to decode in memory first.
+	bool AddFileStreamed(const FString& InRelativePath, int64 InSize, TFunctionRef<bool(FArchive&)> InWriteContent);
+
+	static constexpr int64 StreamedFileMinSize = 256 * 1024 * 1024;
+
+protected:
+	struct FZipMember
+	{
+		TArray<uint8> Name;
+		uint32 Crc;
+		uint16 Method;
+		int64 CompressedSize;
+		int64 UncompressedSize;
+		int64 HeaderOffset;
+	};
+
+	FExtractArchiveWriter(EFormat InFormat, const FString& InArchivePath, TUniquePtr<FArchive>&& InWriter);
+
+	bool AddTarFile(TArray<uint8>&& InName, const uint8* InData, int64 InSize, const uint8* InTail, int64 InTailSize);
+	bool AddZipFile(TArray<uint8>&& InName, const uint8* InData, int64 InSize, const uint8* InTail, int64 InTailSize);
+	// Headers in front of the content of a member, a pax header included when the tar needs one
+	void MakeTarHeaders(const TArray<uint8>& InName, int64 InSize, TArray<uint8>& OutHeader) const;
+	void MakeZipLocalHeader(const FZipMember& InMember, TArray<uint8>& OutHeader) const;
+	// Writes InSize bytes of InData, callers hold WriteLock
+	void WriteLocked(const void* InData, int64 InSize);
+	void WriteZerosLocked(int64 InSize);
+	void WriteZipDirectory();
+
+protected:
+	EFormat Format;
+	FString ArchivePath;
+	// Zip members are deflated when ExtractZipDeflate is set in the [UnrealPakViewer] section of the engine ini, stored otherwise
+	bool bDeflate;
+	int64 UnixTime;
+	uint16 DosTime;
+	uint16 DosDate;
+
+	FCriticalSection WriteLock;
+	TUniquePtr<FArchive> Writer;
+	// Central directory of a zip, written when the archive is closed
+	TArray<FZipMember> ZipMembers;
+	int32 EntryCount;
+	bool bWriteFailed;
+};
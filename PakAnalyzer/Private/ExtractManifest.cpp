@@ -0,0 +1,197 @@
+#include "ExtractManifest.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFile.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#include "CommonDefines.h"
+
+const TCHAR* const FExtractManifest::FileName = TEXT(".UnrealPakViewerManifest");
+
+FExtractManifestPtr FExtractManifest::Open(const FString& InOutputPath)
+{
+	const FString ManifestPath = InOutputPath / FileName;
+
+	FExtractManifestPtr Manifest = MakeShareable(new FExtractManifest());
+
+	bool bNeedsCompact = false;
+	if (!Manifest->Load(ManifestPath, bNeedsCompact) || bNeedsCompact)
+	{
+		// A torn tail or records overwritten many times, start from the live records so appends stay readable
+		if (!Manifest->Compact(ManifestPath))
+		{
+			UE_LOG(LogPakAnalyzer, Warning, TEXT("Write extract manifest failed, every file is extracted! Path: %s."), *ManifestPath);
+			return nullptr;
+		}
+	}
+
+	Manifest->Handle.Reset(IPlatformFile::GetPlatformPhysical().OpenWrite(*ManifestPath, true));
+	if (!Manifest->Handle)
+	{
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Open extract manifest failed, every file is extracted! Path: %s."), *ManifestPath);
+		return nullptr;
+	}
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Open extract manifest: %s, record count: %d."), *ManifestPath, Manifest->Records.Num());
+	return Manifest;
+}
+
+FExtractManifest::FExtractManifest()
+{
+
+}
+
+FExtractManifest::~FExtractManifest()
+{
+	Flush();
+
+	if (SkippedCount.GetValue() > 0)
+	{
+		UE_LOG(LogPakAnalyzer, Log, TEXT("Extract manifest skipped %d up to date files."), SkippedCount.GetValue());
+	}
+}
+
+bool FExtractManifest::IsUpToDate(const FString& InRelativePath, const FString& InOutputFilePath, int64 InSourceSize, const uint8 (&InHash)[20], uint32 InFlags) const
+{
+	if (!HasRecord(InRelativePath, InOutputFilePath, InSourceSize, InHash, InFlags))
+	{
+		return false;
+	}
+
+	SkippedCount.Increment();
+	return true;
+}
+
+bool FExtractManifest::HasRecord(const FString& InRelativePath, const FString& InOutputFilePath, int64 InSourceSize, const uint8 (&InHash)[20], uint32 InFlags) const
+{
+	// Without a hash a changed entry of the same size can't be told apart, it is always written
+	static const uint8 NoHash[20] = {};
+	if (FMemory::Memcmp(InHash, NoHash, sizeof(NoHash)) == 0)
+	{
+		return false;
+	}
+
+	const FRecord* Record = Records.Find(InRelativePath);
+	if (!Record || Record->SourceSize != InSourceSize || Record->Flags != InFlags || FMemory::Memcmp(Record->Hash, InHash, sizeof(Record->Hash)) != 0)
+	{
+		return false;
+	}
+
+	// A file changed or removed since is written again
+	return IFileManager::Get().FileSize(*InOutputFilePath) == Record->OutputSize;
+}
+
+void FExtractManifest::Add(const FString& InRelativePath, int64 InSourceSize, int64 InOutputSize, const uint8 (&InHash)[20], uint32 InFlags)
+{
+	FRecord Record;
+	Record.SourceSize = InSourceSize;
+	Record.OutputSize = InOutputSize;
+	Record.Flags = InFlags;
+	FMemory::Memcpy(Record.Hash, InHash, sizeof(Record.Hash));
+
+	FString Path = InRelativePath;
+
+	FScopeLock Lock(&WriteLock);
+
+	FMemoryWriter Writer(PendingData, false, true);
+	SerializeRecord(Writer, Path, Record);
+
+	if (PendingData.Num() >= FlushSize)
+	{
+		FlushLocked();
+	}
+}
+
+void FExtractManifest::Flush()
+{
+	FScopeLock Lock(&WriteLock);
+	FlushLocked();
+}
+
+void FExtractManifest::FlushLocked()
+{
+	if (Handle && PendingData.Num() > 0)
+	{
+		Handle->Write(PendingData.GetData(), PendingData.Num());
+		Handle->Flush();
+	}
+
+	PendingData.Reset();
+}
+
+bool FExtractManifest::Load(const FString& InManifestPath, bool& bOutNeedsCompact)
+{
+	TArray<uint8> Data;
+	if (!FPaths::FileExists(InManifestPath) || !FFileHelper::LoadFileToArray(Data, *InManifestPath))
+	{
+		// Nothing extracted here yet
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 FileMagic = 0;
+	int32 FileVersion = 0;
+	Reader << FileMagic;
+	Reader << FileVersion;
+	if (Reader.IsError() || FileMagic != Magic || FileVersion != Version)
+	{
+		return false;
+	}
+
+	int32 RecordCount = 0;
+	while (!Reader.AtEnd())
+	{
+		FString Path;
+		FRecord Record;
+		SerializeRecord(Reader, Path, Record);
+		if (Reader.IsError())
+		{
+			// Torn by a crash in the middle of a write, the records before it are fine
+			UE_LOG(LogPakAnalyzer, Warning, TEXT("Extract manifest truncated after %d records! Path: %s."), RecordCount, *InManifestPath);
+			bOutNeedsCompact = true;
+			break;
+		}
+
+		Records.Add(MoveTemp(Path), Record);
+		++RecordCount;
+	}
+
+	// Later records of a path replace earlier ones, rewrite once most of the file is stale
+	bOutNeedsCompact |= RecordCount > Records.Num() * 2 + 1024;
+	return true;
+}
+
+bool FExtractManifest::Compact(const FString& InManifestPath)
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 FileMagic = Magic;
+	int32 FileVersion = Version;
+	Writer << FileMagic;
+	Writer << FileVersion;
+
+	for (TPair<FString, FRecord>& Pair : Records)
+	{
+		FString Path = Pair.Key;
+		SerializeRecord(Writer, Path, Pair.Value);
+	}
+
+	// Written aside and moved over, a crash never leaves a half written manifest behind
+	const FString TempPath = InManifestPath + TEXT(".tmp");
+	return FFileHelper::SaveArrayToFile(Data, *TempPath) && IFileManager::Get().Move(*InManifestPath, *TempPath, true, true);
+}
+
+void FExtractManifest::SerializeRecord(FArchive& Ar, FString& InOutPath, FRecord& InOutRecord)
+{
+	Ar << InOutPath;
+	Ar << InOutRecord.SourceSize;
+	Ar << InOutRecord.OutputSize;
+	Ar << InOutRecord.Flags;
+	Ar.Serialize(InOutRecord.Hash, sizeof(InOutRecord.Hash));
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Templates/UniquePtr.h"
+
+class IFileHandle;
+
+typedef TSharedPtr<class FExtractManifest, ESPMode::ThreadSafe> FExtractManifestPtr;
+
+/**
+ * Files already written to one output folder, kept in the folder itself.
+ * The next extraction into the folder skips an entry whose size and hash match its record while the output file still has the size it was written with,
+ * so a cancelled or crashed extraction resumes where it stopped and a new build over the output of the previous one only writes what changed.
+ * Records are appended as files finish, a crash loses the records not flushed yet and those files are extracted again.
+ */
+class FExtractManifest
+{
+public:
+	// How an entry was written, a record only matches the same layout
+	enum EFlags : uint32
+	{
+		None = 0,
+		// IoStore package written as .zenheader and .uexp, one record per output.
+		// 1 << 0 was the raw zen header written as .uasset, those records never match again.
+		SplitZenHeader = 1 << 1,
+	};
+
+	// Loads the records of the folder and opens the manifest to append, null when it can't be written
+	static FExtractManifestPtr Open(const FString& InOutputPath);
+
+	~FExtractManifest();
+
+	// Same test as IsUpToDate without counting a skip, for an entry written to several outputs
+	bool HasRecord(const FString& InRelativePath, const FString& InOutputFilePath, int64 InSourceSize, const uint8 (&InHash)[20], uint32 InFlags) const;
+	// Any thread, the records loaded by Open don't change while extracting
+	bool IsUpToDate(const FString& InRelativePath, const FString& InOutputFilePath, int64 InSourceSize, const uint8 (&InHash)[20], uint32 InFlags) const;
+	// Any thread, records are written in batches
+	void Add(const FString& InRelativePath, int64 InSourceSize, int64 InOutputSize, const uint8 (&InHash)[20], uint32 InFlags);
+	void Flush();
+
+	int32 GetSkippedCount() const { return SkippedCount.GetValue(); }
+
+protected:
+	struct FRecord
+	{
+		// Uncompressed size of the entry
+		int64 SourceSize = 0;
+		int64 OutputSize = 0;
+		uint32 Flags = 0;
+		uint8 Hash[20];
+	};
+
+	static const uint32 Magic = 0x4D565055; // UPVM
+	static const int32 Version = 1;
+	static constexpr int32 FlushSize = 64 * 1024;
+	static const TCHAR* const FileName;
+
+	FExtractManifest();
+
+	bool Load(const FString& InManifestPath, bool& bOutNeedsCompact);
+	bool Compact(const FString& InManifestPath);
+	static void SerializeRecord(FArchive& Ar, FString& InOutPath, FRecord& InOutRecord);
+	void FlushLocked();
+
+protected:
+	TMap<FString, FRecord> Records;
+
+	FCriticalSection WriteLock;
+	TUniquePtr<IFileHandle> Handle;
+	TArray<uint8> PendingData;
+
+	mutable FThreadSafeCounter SkippedCount;
+};
@@ -1,17 +1,25 @@
 #include "ExtractThreadWorker.h"
 
+#include "Async/Async.h"
+#include "Async/AsyncFileHandle.h"
 #include "HAL/FileManager.h"
+#include "HAL/PlatformFile.h"
 #include "HAL/PlatformProcess.h"
 #include "HAL/RunnableThread.h"
 #include "IPlatformFilePak.h"
 #include "Misc/Compression.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
 #include "Serialization/Archive.h"
+#include "Serialization/MemoryWriter.h"
 
 #include "CommonDefines.h"
+#include "MappedPakReader.h"
 
 FExtractThreadWorker::FExtractThreadWorker()
 	: Thread(nullptr)
+	, bMappedReads(false)
+	, ProgressCounters(nullptr)
 {
 	Guid = FGuid::NewGuid();
 }
@@ -26,62 +34,325 @@ bool FExtractThreadWorker::Init()
 	return true;
 }
 
-uint32 FExtractThreadWorker::Run()
+// Readers of one pak held by an extract worker for the whole extraction.
+// Payload headers go through the archive and contents through the async handle, or both through the mapping when mapped reads are on
+struct FExtractPakReaders
 {
-	const int64 BufferSize = 8 * 1024 * 1024; // 8MB buffer for extracting
-	void* Buffer = FMemory::Malloc(BufferSize);
-	uint8* PersistantCompressionBuffer = NULL;
-	int64 CompressionBufferSize = 0;
+	TUniquePtr<FMappedPakReader> MappedReader;
+	TUniquePtr<FArchive> ReaderArchive;
+	TUniquePtr<IAsyncReadFileHandle> AsyncReader;
+	bool bMapFailed = false;
 
-	int32 CompleteCount = 0;
-	int32 ErrorCount = 0;
-	const int32 TotalCount = Files.Num();
+	bool Open(const FString& InPakFilePath, bool bInMappedReads)
+	{
+		if (bInMappedReads && !MappedReader && !bMapFailed)
+		{
+			// Extraction walks every pak in offset order
+			MappedReader = FMappedPakReader::Open(InPakFilePath, FMappedPakReader::EAccessPattern::Sequential);
+			bMapFailed = !MappedReader;
+		}
+
+		if (MappedReader)
+		{
+			return true;
+		}
+
+		if (!ReaderArchive || ReaderArchive->IsError())
+		{
+			ReaderArchive.Reset(IFileManager::Get().CreateFileReader(*InPakFilePath));
+		}
 
-	FArchive* ReaderArchive = nullptr;
-	int32 LastReaderIndex = -1;
+		if (!AsyncReader)
+		{
+			AsyncReader.Reset(IPlatformFile::GetPlatformPhysical().OpenAsyncRead(*InPakFilePath));
+		}
+
+		return ReaderArchive && AsyncReader;
+	}
+};
 
-	for (const FPakFileEntry& File : Files)
+// Reads the payload header of one file, its hash and size are checked against the manifest before anything is decoded
+static bool ReadPayloadEntry(FExtractPakReaders& Readers, const FPakFileEntry& File, const FPakFileSumary& Summary, FPakEntry& OutEntryInfo, int64& OutPayloadOffset)
+{
+	if (Readers.MappedReader)
 	{
-		if (StopTaskCounter.GetValue() > 0)
+		if (!Readers.MappedReader->ReadEntry(File.PakEntry.Offset, Summary.PakInfo.Version, OutEntryInfo, OutPayloadOffset))
 		{
-			break;
+			UE_LOG(LogPakAnalyzer, Error, TEXT("Extract file failed! PakEntry out of pak file! File: %s"), *File.GetPath());
+			return false;
 		}
+	}
+	else
+	{
+		Readers.ReaderArchive->Seek(File.PakEntry.Offset);
+		OutEntryInfo.Serialize(*Readers.ReaderArchive, Summary.PakInfo.Version);
+		OutPayloadOffset = Readers.ReaderArchive->Tell();
+	}
 
-		if (!Summaries.IsValidIndex(File.OwnerPakIndex))
+	if (!FExtractThreadWorker::ResolvePayloadEntry(File.PakEntry, OutEntryInfo))
+	{
+		// mismatch
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Extract file failed! PakEntry mismatch! File: %s"), *File.GetPath());
+		return false;
+	}
+
+	return true;
+}
+
+// Decodes [InOffset, InOffset + InSize) of one file into Dest, a negative size copies the whole file.
+// Only a Dest on disk takes threaded writes
+static bool CopyFileRange(FArchive& Dest, FExtractPakReaders& Readers, FExtractPipeline& Pipeline, const FPakFileEntry& File, const FPakFileSumary& Summary, const FPakEntry& EntryInfo, int64 InPayloadOffset, int64 InOffset, int64 InSize, bool bInThreadedWrites)
+{
+	const bool bHasRelativeCompressedChunkOffsets = Summary.PakInfo.Version >= FPakInfo::PakFile_Version_RelativeChunkOffsets;
+
+	const bool bCopied = Readers.MappedReader
+		? Pipeline.CopyFile(Dest, *Readers.MappedReader, EntryInfo, InPayloadOffset, Summary.DecryptAESKey, File.CompressionMethod, bHasRelativeCompressedChunkOffsets, InSize, InOffset, bInThreadedWrites)
+		: Pipeline.CopyFile(Dest, *Readers.AsyncReader, EntryInfo, InPayloadOffset, Summary.DecryptAESKey, File.CompressionMethod, bHasRelativeCompressedChunkOffsets, InSize, InOffset, bInThreadedWrites);
+	if (!bCopied)
+	{
+		if (EntryInfo.CompressionMethodIndex == 0)
+		{
+			UE_LOG(LogPakAnalyzer, Error, TEXT("Extract none-compressed file failed! File: %s"), *File.GetPath());
+		}
+		else
+		{
+			UE_LOG(LogPakAnalyzer, Error, TEXT("Extract compressed file failed! File: %s"), *File.GetPath());
+		}
+		return false;
+	}
+
+	return true;
+}
+
+FExtractTaskQueue::FExtractTaskQueue(TArray<FPakFileEntry>&& InFiles, bool bInSplitLargeFiles)
+	: Files(MoveTemp(InFiles))
+{
+	Files.Sort([](const FPakFileEntry& A, const FPakFileEntry& B) -> bool
 		{
+			if (A.OwnerPakIndex != B.OwnerPakIndex)
+			{
+				return A.OwnerPakIndex < B.OwnerPakIndex;
+			}
+
+			return A.PakEntry.Offset < B.PakEntry.Offset;
+		});
+
+	Tasks.Reserve(Files.Num());
+	for (int32 FileIndex = 0; FileIndex < Files.Num(); ++FileIndex)
+	{
+		const FPakEntry& Entry = Files[FileIndex].PakEntry;
+
+		// Parts start on a compression block, uncompressed parts stay aligned to AES blocks
+		int64 PartSize = SplitPartSize;
+		if (Entry.CompressionMethodIndex != 0)
+		{
+			PartSize = Entry.CompressionBlockSize > 0 ? (int64)Entry.CompressionBlockSize * FMath::Max<int64>(1, SplitPartSize / Entry.CompressionBlockSize) : 0;
+		}
+
+		if (!bInSplitLargeFiles || PartSize <= 0 || Entry.UncompressedSize <= PartSize * 2)
+		{
+			Tasks.Add({ FileIndex, 0, -1 });
 			continue;
 		}
 
-		const FPakFileSumary& Summary = Summaries[File.OwnerPakIndex];
+		const int32 PartCount = (int32)FMath::DivideAndRoundUp(Entry.UncompressedSize, PartSize);
+
+		TUniquePtr<FSplitFile>& SplitFile = SplitFiles.Add(FileIndex, MakeUnique<FSplitFile>());
+		SplitFile->RemainingParts.Set(PartCount);
+
+		for (int32 PartIndex = 0; PartIndex < PartCount; ++PartIndex)
+		{
+			const int64 Offset = PartIndex * PartSize;
+			Tasks.Add({ FileIndex, Offset, FMath::Min(PartSize, Entry.UncompressedSize - Offset) });
+		}
+	}
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Extract task queue: file count: %d, task count: %d, split file count: %d."), Files.Num(), Tasks.Num(), SplitFiles.Num());
+}
+
+FExtractTaskQueue::~FExtractTaskQueue()
+{
+	// Split files of a cancelled extraction, their outputs were never touched
+	for (TPair<int32, TUniquePtr<FSplitFile>>& It : SplitFiles)
+	{
+		FSplitFile& SplitFile = *It.Value;
+		SplitFile.Handle.Reset();
+		if (!SplitFile.TempFilePath.IsEmpty())
+		{
+			IFileManager::Get().Delete(*SplitFile.TempFilePath, false, true, true);
+		}
+	}
+}
+
+bool FExtractTaskQueue::Dequeue(FTask& OutTask)
+{
+	const int32 TaskIndex = NextTaskIndex.Increment() - 1;
+	if (TaskIndex >= Tasks.Num())
+	{
+		return false;
+	}
+
+	OutTask = Tasks[TaskIndex];
+	return true;
+}
+
+FExtractTaskQueue::FSplitFile* FExtractTaskQueue::FindSplitFile(int32 InFileIndex) const
+{
+	const TUniquePtr<FSplitFile>* SplitFile = SplitFiles.Find(InFileIndex);
+	return SplitFile ? SplitFile->Get() : nullptr;
+}
+
+bool FExtractTaskQueue::CheckSplitFileUpToDate(int32 InFileIndex, TFunctionRef<bool()> InIsUpToDate)
+{
+	FSplitFile* SplitFile = FindSplitFile(InFileIndex);
+	check(SplitFile);
+
+	FScopeLock Lock(&SplitFile->WriteMutex);
+	if (!SplitFile->bUpToDateChecked)
+	{
+		SplitFile->bUpToDate = InIsUpToDate();
+		SplitFile->bUpToDateChecked = true;
+	}
+
+	return SplitFile->bUpToDate;
+}
+
+bool FExtractTaskQueue::WritePart(int32 InFileIndex, const FString& InOutputFilePath, int64 InOffset, const TArray<uint8>& InData, bool bInSuccess, bool& bOutFileFailed)
+{
+	FSplitFile* SplitFile = FindSplitFile(InFileIndex);
+	check(SplitFile);
+
+	if (!bInSuccess)
+	{
+		SplitFile->bFailed = true;
+	}
+	else if (!SplitFile->bFailed && !SplitFile->bUpToDate)
+	{
+		FScopeLock Lock(&SplitFile->WriteMutex);
 
-		if (!ReaderArchive || File.OwnerPakIndex != LastReaderIndex)
+		if (!SplitFile->Handle)
 		{
-			if (ReaderArchive)
+			const FString BasePath = FPaths::GetPath(InOutputFilePath);
+			if (!FPaths::DirectoryExists(BasePath))
 			{
-				ReaderArchive->Close();
-				delete ReaderArchive;
-				ReaderArchive = nullptr;
+				IFileManager::Get().MakeDirectory(*BasePath, true);
 			}
 
-			ReaderArchive = IFileManager::Get().CreateFileReader(*Summary.PakFilePath);
-			LastReaderIndex = File.OwnerPakIndex;
+			SplitFile->TempFilePath = InOutputFilePath + TEXT(".tmp");
+			SplitFile->Handle.Reset(IPlatformFile::GetPlatformPhysical().OpenWrite(*SplitFile->TempFilePath));
+			if (!SplitFile->Handle)
+			{
+				// open to write failed
+				SplitFile->bFailed = true;
+				SplitFile->TempFilePath.Empty();
+				UE_LOG(LogPakAnalyzer, Error, TEXT("Open local file to write failed! File: %s"), *InOutputFilePath);
+			}
 		}
 
-		if (!ReaderArchive)
+		if (SplitFile->Handle && !(SplitFile->Handle->Seek(InOffset) && SplitFile->Handle->Write(InData.GetData(), InData.Num())))
 		{
-			++ErrorCount;
+			SplitFile->bFailed = true;
+			UE_LOG(LogPakAnalyzer, Error, TEXT("Write local file failed! File: %s, offset: %lld"), *InOutputFilePath, InOffset);
 		}
-		else
+	}
+
+	if (SplitFile->RemainingParts.Decrement() > 0)
+	{
+		return false;
+	}
+
+	{
+		FScopeLock Lock(&SplitFile->WriteMutex);
+		SplitFile->Handle.Reset();
+
+		if (!SplitFile->TempFilePath.IsEmpty())
 		{
-			const bool bHasRelativeCompressedChunkOffsets = Summary.PakInfo.Version >= FPakInfo::PakFile_Version_RelativeChunkOffsets;
+			if (SplitFile->bFailed)
+			{
+				IFileManager::Get().Delete(*SplitFile->TempFilePath, false, true, true);
+			}
+			else if (!IFileManager::Get().Move(*InOutputFilePath, *SplitFile->TempFilePath, true, true))
+			{
+				SplitFile->bFailed = true;
+				IFileManager::Get().Delete(*SplitFile->TempFilePath, false, true, true);
+				UE_LOG(LogPakAnalyzer, Error, TEXT("Move local file failed! File: %s"), *InOutputFilePath);
+			}
+			SplitFile->TempFilePath.Empty();
+		}
+	}
+
+	bOutFileFailed = SplitFile->bFailed;
+	return true;
+}
 
-			ReaderArchive->Seek(File.PakEntry.Offset);
+uint32 FExtractThreadWorker::Run()
+{
+	FExtractPipeline Pipeline;
+	TArray<uint8> PartBuffer;
 
-			FPakEntry EntryInfo;
-			EntryInfo.Serialize(*ReaderArchive, Summary.PakInfo.Version);
-			if (File.PakEntry == EntryInfo)
+	// Files this worker finished, only logged, the window samples the job counters
+	int32 CompleteCount = 0;
+	int32 ErrorCount = 0;
+
+	TArray<FExtractPakReaders> Readers;
+
+	FExtractTaskQueue::FTask Task;
+	while (StopTaskCounter.GetValue() <= 0 && TaskQueue->Dequeue(Task))
+	{
+		const FPakFileEntry& File = TaskQueue->GetFile(Task.FileIndex);
+		if (!Summaries.IsValidIndex(File.OwnerPakIndex))
+		{
+			continue;
+		}
+
+		const FPakFileSumary& Summary = Summaries[File.OwnerPakIndex];
+
+		if (!Readers.IsValidIndex(File.OwnerPakIndex))
+		{
+			Readers.SetNum(File.OwnerPakIndex + 1);
+		}
+
+		FExtractPakReaders& PakReaders = Readers[File.OwnerPakIndex];
+		const bool bReadersOpened = PakReaders.Open(Summary.PakFilePath, bMappedReads);
+
+		const FString RelativePath = File.GetPath();
+		const FString OutputFilePath = OutputPath / RelativePath;
+		bool bSuccess = false;
+
+		FPakEntry EntryInfo;
+		int64 PayloadOffset = 0;
+		const bool bEntryRead = bReadersOpened && ReadPayloadEntry(PakReaders, File, Summary, EntryInfo, PayloadOffset);
+
+		// The hash of the payload header changes with the content, a file of the previous run with the same one is kept
+		auto IsUpToDate = [this, &RelativePath, &OutputFilePath, &EntryInfo]() -> bool
+		{
+			return Manifest && Manifest->IsUpToDate(RelativePath, OutputFilePath, EntryInfo.UncompressedSize, EntryInfo.Hash, FExtractManifest::None);
+		};
+
+		if (Task.Size < 0)
+		{
+			if (bEntryRead && Archive && EntryInfo.UncompressedSize >= FExtractArchiveWriter::StreamedFileMinSize)
+			{
+				// Too large to decode in memory, decoded block by block straight into the locked archive
+				bSuccess = Archive->AddFileStreamed(RelativePath, EntryInfo.UncompressedSize, [&](FArchive& InMemberWriter)
+					{
+						return CopyFileRange(InMemberWriter, PakReaders, Pipeline, File, Summary, EntryInfo, PayloadOffset, 0, -1, true);
+					});
+			}
+			else if (bEntryRead && Archive)
+			{
+				// Decoded in memory, only the append to the archive is serialized between workers
+				PartBuffer.Reset();
+				FMemoryWriter FileWriter(PartBuffer, false, true);
+				bSuccess = CopyFileRange(FileWriter, PakReaders, Pipeline, File, Summary, EntryInfo, PayloadOffset, 0, -1, false)
+					&& Archive->AddFile(RelativePath, PartBuffer.GetData(), PartBuffer.Num());
+			}
+			else if (bEntryRead && IsUpToDate())
+			{
+				bSuccess = true;
+			}
+			else if (bEntryRead)
 			{
-				const FString OutputFilePath = OutputPath / File.Path;
 				const FString BasePath = FPaths::GetPath(OutputFilePath);
 				if (!FPaths::DirectoryExists(BasePath))
 				{
@@ -91,63 +362,83 @@ uint32 FExtractThreadWorker::Run()
 				TUniquePtr<FArchive> FileHandle(IFileManager::Get().CreateFileWriter(*OutputFilePath));
 				if (FileHandle)
 				{
-					if (EntryInfo.CompressionMethodIndex == 0)
-					{
-						if (!BufferedCopyFile(*FileHandle, *ReaderArchive, File.PakEntry, Buffer, BufferSize, Summary.DecryptAESKey))
-						{
-							// Add to failed list
-							++ErrorCount;
-							UE_LOG(LogPakAnalyzer, Error, TEXT("Extract none-compressed file failed! File: %s"), *File.Path);
-						}
-					}
-					else
-					{
-						if (!UncompressCopyFile(*FileHandle, *ReaderArchive, File.PakEntry, PersistantCompressionBuffer, CompressionBufferSize, Summary.DecryptAESKey, File.CompressionMethod, bHasRelativeCompressedChunkOffsets))
-						{
-							// Add to failed list
-							++ErrorCount;
-							UE_LOG(LogPakAnalyzer, Error, TEXT("Extract compressed file failed! File: %s"), *File.Path);
-						}
-					}
+					bSuccess = CopyFileRange(*FileHandle, PakReaders, Pipeline, File, Summary, EntryInfo, PayloadOffset, 0, -1, true);
+					bSuccess = FileHandle->Close() && bSuccess;
 				}
 				else
 				{
 					// open to write failed
-					++ErrorCount;
 					UE_LOG(LogPakAnalyzer, Error, TEXT("Open local file to write failed! File: %s"), *OutputFilePath);
 				}
+
+				if (bSuccess && Manifest)
+				{
+					Manifest->Add(RelativePath, EntryInfo.UncompressedSize, EntryInfo.UncompressedSize, EntryInfo.Hash, FExtractManifest::None);
+				}
+			}
+
+			++CompleteCount;
+			ErrorCount += bSuccess ? 0 : 1;
+			ProgressCounters->AddBytes(File.PakEntry.UncompressedSize);
+			ProgressCounters->AddFile(bSuccess);
+		}
+		else
+		{
+			// The first part to get here decides for the whole file, parts of an up to date file decode nothing
+			const bool bUpToDate = bEntryRead && TaskQueue->CheckSplitFileUpToDate(Task.FileIndex, IsUpToDate);
+
+			PartBuffer.Reset();
+			if (bUpToDate)
+			{
+				bSuccess = true;
 			}
-			else
+			else if (bEntryRead)
 			{
-				// mismatch
-				++ErrorCount;
-				UE_LOG(LogPakAnalyzer, Error, TEXT("Extract file failed! PakEntry mismatch! File: %s"), *File.Path);
+				FMemoryWriter PartWriter(PartBuffer, false, true);
+				bSuccess = CopyFileRange(PartWriter, PakReaders, Pipeline, File, Summary, EntryInfo, PayloadOffset, Task.Offset, Task.Size, false);
 			}
-		}
 
-		++CompleteCount;
+			// Bytes move with every part, only the worker writing the last part counts the file
+			ProgressCounters->AddBytes(Task.Size);
 
-		OnUpdateExtractProgress.ExecuteIfBound(Guid, CompleteCount, ErrorCount, TotalCount);
-	}
+			bool bFileFailed = false;
+			if (!TaskQueue->WritePart(Task.FileIndex, OutputFilePath, Task.Offset, PartBuffer, bSuccess, bFileFailed))
+			{
+				continue;
+			}
+
+			if (!bFileFailed && !bUpToDate && Manifest)
+			{
+				Manifest->Add(RelativePath, EntryInfo.UncompressedSize, EntryInfo.UncompressedSize, EntryInfo.Hash, FExtractManifest::None);
+			}
 
-	FMemory::Free(Buffer);
-	FMemory::Free(PersistantCompressionBuffer);
+			++CompleteCount;
+			ErrorCount += bFileFailed ? 1 : 0;
+			ProgressCounters->AddFile(!bFileFailed);
+		}
+	}
 
-	if (ReaderArchive)
+	// Records of a cancelled extraction are kept too, the next one resumes from them
+	if (Manifest)
 	{
-		ReaderArchive->Close();
-		delete ReaderArchive;
-		ReaderArchive = nullptr;
+		Manifest->Flush();
 	}
-	
 
-	if (CompleteCount == TotalCount)
+	Readers.Empty();
+	TaskQueue.Reset();
+	ProgressCounters = nullptr;
+	ExtractJob.Reset();
+	Manifest.Reset();
+	// The last worker to finish closes the archive
+	Archive.Reset();
+
+	if (StopTaskCounter.GetValue() <= 0)
 	{
-		UE_LOG(LogPakAnalyzer, Log, TEXT("Extract worker: %s finished, file count: %d, error count: %d."), *Guid.ToString(), TotalCount, ErrorCount);
+		UE_LOG(LogPakAnalyzer, Log, TEXT("Extract worker: %s finished, complete count: %d, error count: %d."), *Guid.ToString(), CompleteCount, ErrorCount);
 	}
 	else
 	{
-		UE_LOG(LogPakAnalyzer, Warning, TEXT("Extract worker: %s interrupted, file count: %d, complete count: %d, error count: %d."), *Guid.ToString(), TotalCount, CompleteCount, ErrorCount);
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Extract worker: %s interrupted, complete count: %d, error count: %d."), *Guid.ToString(), CompleteCount, ErrorCount);
 	}
 
 	StopTaskCounter.Reset();
@@ -187,33 +478,62 @@ void FExtractThreadWorker::EnsureCompletion()
 	}
 }
 
-void FExtractThreadWorker::StartExtract(const TArray<FPakFileSumary>& InSummaries, const FString& InOutputPath)
+void FExtractThreadWorker::StartExtract(TSharedPtr<FExtractTaskQueue> InTaskQueue, const TArray<FPakFileSumary>& InSummaries, const FString& InOutputPath, FExtractJobPtr InExtractJob, FExtractManifestPtr InManifest, FExtractArchiveWriterPtr InArchive)
 {
 	Shutdown();
 
-	UE_LOG(LogPakAnalyzer, Log, TEXT("Start extract worker: %s, output: %s, file count: %d."), *Guid.ToString(), *InOutputPath, Files.Num());
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Start extract worker: %s, output: %s."), *Guid.ToString(), *InOutputPath);
 
+	TaskQueue = InTaskQueue;
 	Summaries = InSummaries;
 	OutputPath = InOutputPath;
+	bMappedReads = FMappedPakReader::IsEnabled();
+	ExtractJob = InExtractJob;
+	ProgressCounters = &ExtractJob->AddWorker();
+	Manifest = InManifest;
+	Archive = InArchive;
 
 	Thread = FRunnableThread::Create(this, TEXT("ExtractThreadWorker"), 0, EThreadPriority::TPri_Highest);
 }
 
-void FExtractThreadWorker::InitTaskFiles(TArray<FPakFileEntry>& InFiles)
+bool FExtractThreadWorker::ResolvePayloadEntry(const FPakEntry& InIndexEntry, FPakEntry& InOutPayloadEntry)
 {
-	Files = MoveTemp(InFiles);
-}
+	if (InOutPayloadEntry.CompressionBlocks.Num() == 1)
+	{
+		InOutPayloadEntry.CompressionBlockSize = InOutPayloadEntry.UncompressedSize;
+	}
 
-FExtractThreadWorker::FOnUpdateExtractProgress& FExtractThreadWorker::GetOnUpdateExtractProgressDelegate()
-{
-	return OnUpdateExtractProgress;
+	// Same fields as FPakEntry::IndexDataEquals, except the blocks that only live in the payload header
+	if (InIndexEntry.Size != InOutPayloadEntry.Size
+		|| InIndexEntry.UncompressedSize != InOutPayloadEntry.UncompressedSize
+		|| InIndexEntry.CompressionMethodIndex != InOutPayloadEntry.CompressionMethodIndex
+		|| InIndexEntry.Flags != InOutPayloadEntry.Flags
+		|| InIndexEntry.CompressionBlockSize != InOutPayloadEntry.CompressionBlockSize)
+	{
+		return false;
+	}
+
+	// Offset is not serialized with the payload header
+	InOutPayloadEntry.Offset = InIndexEntry.Offset;
+	return true;
 }
 
-bool FExtractThreadWorker::BufferedCopyFile(FArchive& Dest, FArchive& Source, const FPakEntry& Entry, void* Buffer, int64 BufferSize, const FAES::FAESKey& InKey)
+bool FExtractThreadWorker::BufferedCopyFile(FArchive& Dest, FArchive& Source, const FPakEntry& Entry, void* Buffer, int64 BufferSize, const FAES::FAESKey& InKey, int64 InCopySize, int64 InCopyOffset)
 {
+	if (InCopyOffset < 0 || InCopyOffset > Entry.Size || (Entry.IsEncrypted() && InCopyOffset % FAES::AESBlockSize != 0))
+	{
+		return false;
+	}
+
+	// Source is positioned at the start of the file content
+	if (InCopyOffset > 0)
+	{
+		Source.Seek(Source.Tell() + InCopyOffset);
+	}
+
 	// Align down
 	BufferSize = BufferSize & ~(FAES::AESBlockSize - 1);
-	int64 RemainingSizeToCopy = Entry.Size;
+	int64 RemainingSizeToCopy = InCopySize >= 0 ? FMath::Min(InCopySize, Entry.Size - InCopyOffset) : Entry.Size - InCopyOffset;
 	while (RemainingSizeToCopy > 0)
 	{
 		const int64 SizeToCopy = FMath::Min(BufferSize, RemainingSizeToCopy);
@@ -231,9 +551,14 @@ bool FExtractThreadWorker::BufferedCopyFile(FArchive& Dest, FArchive& Source, co
 	return true;
 }
 
-bool FExtractThreadWorker::UncompressCopyFile(FArchive& Dest, FArchive& Source, const FPakEntry& Entry, uint8*& PersistentBuffer, int64& BufferSize, const FAES::FAESKey& InKey, FName InCompressionMethod, bool bHasRelativeCompressedChunkOffsets)
+bool FExtractThreadWorker::UncompressCopyFile(FArchive& Dest, FArchive& Source, const FPakEntry& Entry, uint8*& PersistentBuffer, int64& BufferSize, const FAES::FAESKey& InKey, FName InCompressionMethod, bool bHasRelativeCompressedChunkOffsets, int64 InCopySize, int64 InCopyOffset)
 {
-	if (Entry.UncompressedSize == 0)
+	if (Entry.UncompressedSize == 0 || Entry.CompressionBlockSize == 0)
+	{
+		return false;
+	}
+
+	if (InCopyOffset < 0 || InCopyOffset > Entry.UncompressedSize || InCopyOffset % Entry.CompressionBlockSize != 0)
 	{
 		return false;
 	}
@@ -255,11 +580,12 @@ bool FExtractThreadWorker::UncompressCopyFile(FArchive& Dest, FArchive& Source,
 	}
 
 	uint8* UncompressedBuffer = PersistentBuffer + MaxCompressionBlockSize;
+	int64 RemainingSizeToCopy = InCopySize >= 0 ? FMath::Min(InCopySize, Entry.UncompressedSize - InCopyOffset) : Entry.UncompressedSize - InCopyOffset;
 
-	for (uint32 BlockIndex = 0, BlockIndexNum = Entry.CompressionBlocks.Num(); BlockIndex < BlockIndexNum; ++BlockIndex)
+	for (uint32 BlockIndex = InCopyOffset / Entry.CompressionBlockSize, BlockIndexNum = Entry.CompressionBlocks.Num(); BlockIndex < BlockIndexNum && RemainingSizeToCopy > 0; ++BlockIndex)
 	{
 		uint32 CompressedBlockSize = Entry.CompressionBlocks[BlockIndex].CompressedEnd - Entry.CompressionBlocks[BlockIndex].CompressedStart;
-		uint32 UncompressedBlockSize = (uint32)FMath::Min<int64>(Entry.UncompressedSize - Entry.CompressionBlockSize * BlockIndex, Entry.CompressionBlockSize);
+		uint32 UncompressedBlockSize = (uint32)FMath::Min<int64>(Entry.UncompressedSize - (int64)Entry.CompressionBlockSize * BlockIndex, Entry.CompressionBlockSize);
 		Source.Seek(Entry.CompressionBlocks[BlockIndex].CompressedStart + (bHasRelativeCompressedChunkOffsets ? Entry.Offset : 0));
 		uint32 SizeToRead = Entry.IsEncrypted() ? Align(CompressedBlockSize, FAES::AESBlockSize) : CompressedBlockSize;
 		Source.Serialize(PersistentBuffer, SizeToRead);
@@ -274,8 +600,389 @@ bool FExtractThreadWorker::UncompressCopyFile(FArchive& Dest, FArchive& Source,
 			return false;
 		}
 
-		Dest.Serialize(UncompressedBuffer, UncompressedBlockSize);
+		const int64 SizeToWrite = FMath::Min<int64>(UncompressedBlockSize, RemainingSizeToCopy);
+		Dest.Serialize(UncompressedBuffer, SizeToWrite);
+		RemainingSizeToCopy -= SizeToWrite;
+	}
+
+	return true;
+}
+
+FExtractPipeline::FExtractPipeline()
+	: WriteQueuedCount(0)
+	, WriteDoneCount(0)
+	, WriteDest(nullptr)
+	, bWriteFailed(false)
+	, bStopWriter(false)
+	, bThreadedWrites(false)
+{
+	WriteQueuedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	WriteDoneEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FExtractPipeline::~FExtractPipeline()
+{
+	CancelReads();
+	WaitWrites();
+
+	if (WriterTask.IsValid())
+	{
+		{
+			FScopeLock Lock(&WriteLock);
+			bStopWriter = true;
+		}
+		WriteQueuedEvent->Trigger();
+		WriterTask.Wait();
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WriteQueuedEvent);
+	FPlatformProcess::ReturnSynchEventToPool(WriteDoneEvent);
+}
+
+bool FExtractPipeline::CopyFile(FArchive& Dest, IAsyncReadFileHandle& Source, const FPakEntry& Entry, int64 InPayloadOffset, const FAES::FAESKey& InKey, FName InCompressionMethod, bool bHasRelativeCompressedChunkOffsets, int64 InCopySize, int64 InCopyOffset, bool bInThreadedWrites)
+{
+	if (!BuildBlocks(Entry, InPayloadOffset, bHasRelativeCompressedChunkOffsets, InCopySize, InCopyOffset))
+	{
+		return false;
+	}
+
+	BeginWrites(Dest, bInThreadedWrites);
+
+	for (int32 BlockIndex = 0; BlockIndex < FMath::Min(ReadAheadCount, Blocks.Num()); ++BlockIndex)
+	{
+		IssueRead(Source, BlockIndex);
+	}
+
+	bool bSuccess = true;
+	for (int32 BlockIndex = 0; BlockIndex < Blocks.Num() && bSuccess; ++BlockIndex)
+	{
+		const FBlock& Block = Blocks[BlockIndex];
+		FReadSlot& Slot = ReadSlots[BlockIndex % ReadAheadCount];
+		if (!WaitRead(BlockIndex))
+		{
+			bSuccess = false;
+			break;
+		}
+
+		if (Entry.IsEncrypted())
+		{
+			FAES::DecryptData(Slot.Buffer.GetData(), Block.ReadSize, InKey);
+		}
+
+		TArray<uint8>& WriteBuffer = AcquireWriteBuffer();
+		const uint8* WriteData = nullptr;
+		if (Block.CompressedSize <= 0)
+		{
+			// A stored block is written from the ring, so the slot can take the next read while it is written
+			Swap(WriteBuffer, Slot.Buffer);
+			WriteData = WriteBuffer.GetData();
+		}
+		else if (!DecodeBlock(BlockIndex, Slot.Buffer.GetData(), InCompressionMethod, WriteBuffer, WriteData))
+		{
+			bSuccess = false;
+			break;
+		}
+
+		// The slot is free again, keep the reads ahead of the decoding
+		if (BlockIndex + ReadAheadCount < Blocks.Num())
+		{
+			IssueRead(Source, BlockIndex + ReadAheadCount);
+		}
+
+		if (!QueueWrite(Dest, BlockIndex, WriteData))
+		{
+			bSuccess = false;
+			break;
+		}
+	}
+
+	CancelReads();
+	return WaitWrites() && bSuccess;
+}
+
+bool FExtractPipeline::CopyFile(FArchive& Dest, const FMappedPakReader& Source, const FPakEntry& Entry, int64 InPayloadOffset, const FAES::FAESKey& InKey, FName InCompressionMethod, bool bHasRelativeCompressedChunkOffsets, int64 InCopySize, int64 InCopyOffset, bool bInThreadedWrites)
+{
+	if (!BuildBlocks(Entry, InPayloadOffset, bHasRelativeCompressedChunkOffsets, InCopySize, InCopyOffset))
+	{
+		return false;
+	}
+
+	BeginWrites(Dest, bInThreadedWrites);
+
+	// Pages of the next blocks are read by the kernel while the current one is decoded
+	for (int32 BlockIndex = 0; BlockIndex < FMath::Min(ReadAheadCount, Blocks.Num()); ++BlockIndex)
+	{
+		Source.WillNeed(Blocks[BlockIndex].ReadOffset, Blocks[BlockIndex].ReadSize);
+	}
+
+	bool bSuccess = true;
+	for (int32 BlockIndex = 0; BlockIndex < Blocks.Num() && bSuccess; ++BlockIndex)
+	{
+		const FBlock& Block = Blocks[BlockIndex];
+		const uint8* BlockData = Source.GetSpan(Block.ReadOffset, Block.ReadSize);
+		if (!BlockData)
+		{
+			bSuccess = false;
+			break;
+		}
+
+		// Also bounds the blocks written straight from the mapping, the ring stays the only queue
+		TArray<uint8>& WriteBuffer = AcquireWriteBuffer();
+		const uint8* WriteData = BlockData;
+
+		// Decryption is in place, only encrypted blocks are copied out of the mapping.
+		// A stored block is written from the ring buffer it was decrypted in, a compressed one is decoded from a read slot the mapping leaves unused
+		if (Entry.IsEncrypted())
+		{
+			TArray<uint8>& DecryptBuffer = Block.CompressedSize > 0 ? ReadSlots[0].Buffer : WriteBuffer;
+			DecryptBuffer.SetNumUninitialized((int32)Block.ReadSize, false);
+			FMemory::Memcpy(DecryptBuffer.GetData(), BlockData, Block.ReadSize);
+			FAES::DecryptData(DecryptBuffer.GetData(), Block.ReadSize, InKey);
+			BlockData = DecryptBuffer.GetData();
+			WriteData = BlockData;
+		}
+
+		if (Block.CompressedSize > 0 && !DecodeBlock(BlockIndex, BlockData, InCompressionMethod, WriteBuffer, WriteData))
+		{
+			bSuccess = false;
+			break;
+		}
+
+		if (BlockIndex + ReadAheadCount < Blocks.Num())
+		{
+			Source.WillNeed(Blocks[BlockIndex + ReadAheadCount].ReadOffset, Blocks[BlockIndex + ReadAheadCount].ReadSize);
+		}
+
+		if (!QueueWrite(Dest, BlockIndex, WriteData))
+		{
+			bSuccess = false;
+			break;
+		}
+	}
+
+	return WaitWrites() && bSuccess;
+}
+
+bool FExtractPipeline::BuildBlocks(const FPakEntry& Entry, int64 InPayloadOffset, bool bHasRelativeCompressedChunkOffsets, int64 InCopySize, int64 InCopyOffset)
+{
+	Blocks.Reset();
+
+	if (Entry.CompressionMethodIndex == 0)
+	{
+		if (InCopyOffset < 0 || InCopyOffset > Entry.Size || (Entry.IsEncrypted() && InCopyOffset % FAES::AESBlockSize != 0))
+		{
+			return false;
+		}
+
+		int64 ReadOffset = InPayloadOffset + InCopyOffset;
+		int64 RemainingSizeToCopy = InCopySize >= 0 ? FMath::Min(InCopySize, Entry.Size - InCopyOffset) : Entry.Size - InCopyOffset;
+		while (RemainingSizeToCopy > 0)
+		{
+			const int64 SizeToCopy = FMath::Min(StoredBlockSize, RemainingSizeToCopy);
+			// If file is encrypted so we need to account for padding
+			const int64 SizeToRead = Entry.IsEncrypted() ? Align(SizeToCopy, FAES::AESBlockSize) : SizeToCopy;
+
+			Blocks.Add({ ReadOffset, SizeToRead, 0, SizeToCopy, SizeToCopy });
+			ReadOffset += SizeToRead;
+			RemainingSizeToCopy -= SizeToCopy;
+		}
+		return true;
 	}
 
+	if (Entry.UncompressedSize == 0 || Entry.CompressionBlockSize == 0)
+	{
+		return false;
+	}
+
+	if (InCopyOffset < 0 || InCopyOffset > Entry.UncompressedSize || InCopyOffset % Entry.CompressionBlockSize != 0)
+	{
+		return false;
+	}
+
+	int64 RemainingSizeToCopy = InCopySize >= 0 ? FMath::Min(InCopySize, Entry.UncompressedSize - InCopyOffset) : Entry.UncompressedSize - InCopyOffset;
+	for (int32 BlockIndex = (int32)(InCopyOffset / Entry.CompressionBlockSize); BlockIndex < Entry.CompressionBlocks.Num() && RemainingSizeToCopy > 0; ++BlockIndex)
+	{
+		const FPakCompressedBlock& CompressedBlock = Entry.CompressionBlocks[BlockIndex];
+		const int64 CompressedBlockSize = CompressedBlock.CompressedEnd - CompressedBlock.CompressedStart;
+		const int64 UncompressedBlockSize = FMath::Min<int64>(Entry.UncompressedSize - (int64)Entry.CompressionBlockSize * BlockIndex, Entry.CompressionBlockSize);
+		const int64 SizeToRead = Entry.IsEncrypted() ? Align(CompressedBlockSize, FAES::AESBlockSize) : CompressedBlockSize;
+		const int64 SizeToWrite = FMath::Min(UncompressedBlockSize, RemainingSizeToCopy);
+
+		Blocks.Add({ CompressedBlock.CompressedStart + (bHasRelativeCompressedChunkOffsets ? Entry.Offset : 0), SizeToRead, CompressedBlockSize, UncompressedBlockSize, SizeToWrite });
+		RemainingSizeToCopy -= SizeToWrite;
+	}
+
+	return true;
+}
+
+void FExtractPipeline::IssueRead(IAsyncReadFileHandle& Source, int32 InBlockIndex)
+{
+	const FBlock& Block = Blocks[InBlockIndex];
+	FReadSlot& Slot = ReadSlots[InBlockIndex % ReadAheadCount];
+
+	Slot.Buffer.SetNumUninitialized((int32)Block.ReadSize, false);
+	Slot.Request.Reset(Source.ReadRequest(Block.ReadOffset, Block.ReadSize, AIOP_Normal, nullptr, Slot.Buffer.GetData()));
+}
+
+bool FExtractPipeline::WaitRead(int32 InBlockIndex)
+{
+	FReadSlot& Slot = ReadSlots[InBlockIndex % ReadAheadCount];
+	if (!Slot.Request)
+	{
+		return false;
+	}
+
+	Slot.Request->WaitCompletion();
+	const bool bRead = !Slot.Request->WasCanceled() && Slot.Request->GetReadResults() != nullptr;
+	Slot.Request.Reset();
+	return bRead;
+}
+
+bool FExtractPipeline::DecodeBlock(int32 InBlockIndex, const uint8* InData, FName InCompressionMethod, TArray<uint8>& OutBuffer, const uint8*& OutWriteData)
+{
+	const FBlock& Block = Blocks[InBlockIndex];
+	OutBuffer.SetNumUninitialized((int32)Block.UncompressedSize, false);
+	if (!FCompression::UncompressMemory(InCompressionMethod, OutBuffer.GetData(), (int32)Block.UncompressedSize, InData, (int32)Block.CompressedSize))
+	{
+		return false;
+	}
+
+	OutWriteData = OutBuffer.GetData();
+	return true;
+}
+
+void FExtractPipeline::BeginWrites(FArchive& Dest, bool bInThreadedWrites)
+{
+	// The writer is idle between files, the last one was waited for
+	FScopeLock Lock(&WriteLock);
+	WriteDest = &Dest;
+	WriteQueuedCount = 0;
+	WriteDoneCount = 0;
+	bWriteFailed = false;
+	bThreadedWrites = bInThreadedWrites;
+}
+
+TArray<uint8>& FExtractPipeline::AcquireWriteBuffer()
+{
+	while (true)
+	{
+		{
+			FScopeLock Lock(&WriteLock);
+			if (WriteQueuedCount - WriteDoneCount < WriteRingCount)
+			{
+				break;
+			}
+		}
+		WriteDoneEvent->Wait();
+	}
+
+	// Only this thread queues, the count can be read without the lock
+	return WriteRing[WriteQueuedCount % WriteRingCount].Buffer;
+}
+
+bool FExtractPipeline::QueueWrite(FArchive& Dest, int32 InBlockIndex, const uint8* InData)
+{
+	const int64 WriteSize = Blocks[InBlockIndex].WriteSize;
+
+	// Nothing overlaps with a single block, which is all a small file or range has, and a copy to memory is cheaper than a handoff
+	if (Blocks.Num() == 1 || !bThreadedWrites)
+	{
+		Dest.Serialize(const_cast<uint8*>(InData), WriteSize);
+		return !Dest.IsError();
+	}
+
+	if (!WriterTask.IsValid())
+	{
+		WriterTask = Async(EAsyncExecution::Thread, [this]() { RunWriter(); });
+	}
+
+	{
+		FScopeLock Lock(&WriteLock);
+		if (bWriteFailed)
+		{
+			return false;
+		}
+
+		FWriteSlot& WriteSlot = WriteRing[WriteQueuedCount % WriteRingCount];
+		WriteSlot.Data = InData;
+		WriteSlot.Size = WriteSize;
+		++WriteQueuedCount;
+	}
+	WriteQueuedEvent->Trigger();
 	return true;
 }
+
+bool FExtractPipeline::WaitWrites()
+{
+	while (true)
+	{
+		{
+			FScopeLock Lock(&WriteLock);
+			if (WriteDoneCount == WriteQueuedCount)
+			{
+				return !bWriteFailed;
+			}
+		}
+		WriteDoneEvent->Wait();
+	}
+}
+
+void FExtractPipeline::RunWriter()
+{
+	while (true)
+	{
+		FArchive* Dest = nullptr;
+		const uint8* Data = nullptr;
+		int64 Size = 0;
+		bool bSkip = false;
+		{
+			FScopeLock Lock(&WriteLock);
+			if (WriteDoneCount < WriteQueuedCount)
+			{
+				const FWriteSlot& WriteSlot = WriteRing[WriteDoneCount % WriteRingCount];
+				Dest = WriteDest;
+				Data = WriteSlot.Data;
+				Size = WriteSlot.Size;
+				// The rest of a failed file is dropped, its blocks are still released
+				bSkip = bWriteFailed;
+			}
+			else if (bStopWriter)
+			{
+				return;
+			}
+		}
+
+		if (!Dest)
+		{
+			WriteQueuedEvent->Wait();
+			continue;
+		}
+
+		bool bWritten = true;
+		if (!bSkip)
+		{
+			Dest->Serialize(const_cast<uint8*>(Data), Size);
+			bWritten = !Dest->IsError();
+		}
+
+		{
+			FScopeLock Lock(&WriteLock);
+			bWriteFailed |= !bWritten;
+			++WriteDoneCount;
+		}
+		WriteDoneEvent->Trigger();
+	}
+}
+
+void FExtractPipeline::CancelReads()
+{
+	for (FReadSlot& Slot : ReadSlots)
+	{
+		if (Slot.Request)
+		{
+			Slot.Request->Cancel();
+			Slot.Request->WaitCompletion();
+			Slot.Request.Reset();
+		}
+	}
+}
@@ -1,17 +1,171 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "HAL/CriticalSection.h"
 #include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
 #include "Misc/AES.h"
 
+#include "ExtractArchiveWriter.h"
+#include "ExtractManifest.h"
+#include "IPakAnalyzer.h"
 #include "Misc/Guid.h"
 #include "PakFileEntry.h"
 
-class FExtractThreadWorker : public FRunnable
+class FEvent;
+class IAsyncReadFileHandle;
+class IAsyncReadRequest;
+class IFileHandle;
+class FMappedPakReader;
+
+/**
+ * Block pipeline of one extract worker, the content of a file goes through read, decrypt + decompress and write stages that overlap.
+ * Reads of the next blocks are issued ahead through IAsyncReadFileHandle into a ring of slots, the worker decodes a block while the following ones are still read,
+ * and decoded blocks go through a fixed ring of write buffers to the writer thread of the pipeline, so the disk never waits for the CPU and the other way round.
+ * The worker blocks once the ring is full, which bounds the memory of a slow disk to WriteRingCount blocks.
+ */
+class FExtractPipeline
+{
+public:
+	FExtractPipeline();
+	~FExtractPipeline();
+
+	// Same contract as FExtractThreadWorker::BufferedCopyFile and UncompressCopyFile, the content of the file starts at InPayloadOffset of the pak.
+	// bInThreadedWrites hands the blocks to the writer thread, only worth it when Dest is on disk, a memory archive is written inline
+	bool CopyFile(FArchive& Dest, IAsyncReadFileHandle& Source, const FPakEntry& Entry, int64 InPayloadOffset, const FAES::FAESKey& InKey, FName InCompressionMethod, bool bHasRelativeCompressedChunkOffsets, int64 InCopySize = -1, int64 InCopyOffset = 0, bool bInThreadedWrites = false);
+	// Same from a mapped pak, blocks are decoded from the mapping and only encrypted ones are copied before
+	bool CopyFile(FArchive& Dest, const FMappedPakReader& Source, const FPakEntry& Entry, int64 InPayloadOffset, const FAES::FAESKey& InKey, FName InCompressionMethod, bool bHasRelativeCompressedChunkOffsets, int64 InCopySize = -1, int64 InCopyOffset = 0, bool bInThreadedWrites = false);
+
+protected:
+	struct FBlock
+	{
+		int64 ReadOffset;
+		int64 ReadSize;
+		// 0 for a stored block
+		int64 CompressedSize;
+		int64 UncompressedSize;
+		int64 WriteSize;
+	};
+
+	struct FReadSlot
+	{
+		TArray<uint8> Buffer;
+		TUniquePtr<IAsyncReadRequest> Request;
+	};
+
+	bool BuildBlocks(const FPakEntry& Entry, int64 InPayloadOffset, bool bHasRelativeCompressedChunkOffsets, int64 InCopySize, int64 InCopyOffset);
+	void IssueRead(IAsyncReadFileHandle& Source, int32 InBlockIndex);
+	bool WaitRead(int32 InBlockIndex);
+	// Decompresses a block into OutBuffer, OutWriteData points to it then
+	bool DecodeBlock(int32 InBlockIndex, const uint8* InData, FName InCompressionMethod, TArray<uint8>& OutBuffer, const uint8*& OutWriteData);
+	// Every block of a file goes to Dest, the writer is idle when a file starts
+	void BeginWrites(FArchive& Dest, bool bInThreadedWrites);
+	// Buffer of the next block to queue, waits while the ring is full
+	TArray<uint8>& AcquireWriteBuffer();
+	// InData has to stay valid until WaitWrites, a file of a single block or without threaded writes is written inline
+	bool QueueWrite(FArchive& Dest, int32 InBlockIndex, const uint8* InData);
+	// False once a write of the file failed
+	bool WaitWrites();
+	// Writer thread, writes the queued blocks in order until the pipeline is destroyed
+	void RunWriter();
+	// Waits for every request still in flight, their buffers are reused by the next file
+	void CancelReads();
+
+protected:
+	// Blocks read ahead, bounds the memory of a worker to ReadAheadCount blocks
+	static constexpr int32 ReadAheadCount = 16;
+	// Stored files are read in chunks of this size, a multiple of the AES block size
+	static constexpr int64 StoredBlockSize = 512 * 1024;
+
+	// Blocks decoded ahead of the disk
+	static constexpr int32 WriteRingCount = 8;
+
+	struct FWriteSlot
+	{
+		TArray<uint8> Buffer;
+		// Buffer, or the mapping for a block written straight from it
+		const uint8* Data = nullptr;
+		int64 Size = 0;
+	};
+
+	TArray<FBlock> Blocks;
+	FReadSlot ReadSlots[ReadAheadCount];
+
+	// WriteLock guards the counts, WriteDest and the flags, a slot belongs to the writer from its queueing until WriteDoneCount passes it
+	FWriteSlot WriteRing[WriteRingCount];
+	FCriticalSection WriteLock;
+	int32 WriteQueuedCount;
+	int32 WriteDoneCount;
+	FArchive* WriteDest;
+	bool bWriteFailed;
+	bool bStopWriter;
+	// Set per file by CopyFile
+	bool bThreadedWrites;
+	FEvent* WriteQueuedEvent;
+	FEvent* WriteDoneEvent;
+	// Started by the first threaded file of more than one block, pipelines writing to memory never start it
+	TFuture<void> WriterTask;
+};
+
+/**
+ * Files of one extraction, shared by all extract workers.
+ * Tasks are ordered by pak and offset so reads stay mostly sequential, and every idle worker takes the next one.
+ * Large files are split into ranges of whole compression blocks, their parts are decoded on any worker and written at their offset.
+ * Parts go to a temporary file that replaces the output only once every part succeeded, a cancelled extraction never leaves a file with holes.
+ */
+class FExtractTaskQueue
 {
 public:
-	DECLARE_DELEGATE_FourParams(FOnUpdateExtractProgress, const FGuid& /*WorkerGuid*/, int32 /*CompleteCount*/, int32 /*ErrorCount*/, int32 /*TotalCount*/);
+	struct FTask
+	{
+		int32 FileIndex;
+		int64 Offset;
+		// Negative for a whole file
+		int64 Size;
+	};
+
+	// Shared output of a split file, the last part to finish closes it
+	struct FSplitFile
+	{
+		FCriticalSection WriteMutex;
+		TUniquePtr<IFileHandle> Handle;
+		// Set when the first part opens it, empty again once renamed or deleted
+		FString TempFilePath;
+		FThreadSafeCounter RemainingParts;
+		FThreadSafeBool bFailed;
+		// Decided once under WriteMutex, the output of an up to date file is left as it is
+		bool bUpToDateChecked = false;
+		bool bUpToDate = false;
+	};
+
+	static const int64 SplitPartSize = 16 * 1024 * 1024;
 
+	// Without bInSplitLargeFiles every file is a single task
+	FExtractTaskQueue(TArray<FPakFileEntry>&& InFiles, bool bInSplitLargeFiles);
+	~FExtractTaskQueue();
+
+	bool Dequeue(FTask& OutTask);
+	const FPakFileEntry& GetFile(int32 InFileIndex) const { return Files[InFileIndex]; }
+	FSplitFile* FindSplitFile(int32 InFileIndex) const;
+	int32 GetFileCount() const { return Files.Num(); }
+
+	// Calls InIsUpToDate for the first part of a split file only, every part gets the same answer
+	bool CheckSplitFileUpToDate(int32 InFileIndex, TFunctionRef<bool()> InIsUpToDate);
+	// Writes one decoded part at its offset in the temporary file, returns true when it was the last part of the file.
+	// The last part renames the temporary file over InOutputFilePath, or deletes it when any part failed
+	bool WritePart(int32 InFileIndex, const FString& InOutputFilePath, int64 InOffset, const TArray<uint8>& InData, bool bInSuccess, bool& bOutFileFailed);
+
+protected:
+	TArray<FPakFileEntry> Files;
+	TArray<FTask> Tasks;
+	TMap<int32, TUniquePtr<FSplitFile>> SplitFiles;
+	FThreadSafeCounter NextTaskIndex;
+};
+
+class FExtractThreadWorker : public FRunnable
+{
 public:
 	FExtractThreadWorker();
 	~FExtractThreadWorker();
@@ -23,22 +177,31 @@ public:
 
 	void Shutdown();
 	void EnsureCompletion();
-	void StartExtract(const TArray<FPakFileSumary>& InSummaries, const FString& InOutputPath);
-	void InitTaskFiles(TArray<FPakFileEntry>& InFiles);
-
-	FOnUpdateExtractProgress& GetOnUpdateExtractProgressDelegate();
+	void StartExtract(TSharedPtr<FExtractTaskQueue> InTaskQueue, const TArray<FPakFileSumary>& InSummaries, const FString& InOutputPath, FExtractJobPtr InExtractJob, FExtractManifestPtr InManifest, FExtractArchiveWriterPtr InArchive);
 
-	static bool BufferedCopyFile(FArchive& Dest, FArchive& Source, const FPakEntry& Entry, void* Buffer, int64 BufferSize, const FAES::FAESKey& InKey);
-	static bool UncompressCopyFile(FArchive& Dest, FArchive& Source, const FPakEntry& Entry, uint8*& PersistentBuffer, int64& BufferSize, const FAES::FAESKey& InKey, FName InCompressionMethod, bool bHasRelativeCompressedChunkOffsets);
+	// Index entries don't keep their compression blocks, take them from the payload header once it matches the index
+	static bool ResolvePayloadEntry(const FPakEntry& InIndexEntry, FPakEntry& InOutPayloadEntry);
+	// Copies [InCopyOffset, InCopyOffset + InCopySize) of the file content, only the blocks covering it are read. Negative size copies to the end.
+	// The offset has to be a multiple of the compression block size, or of the AES block size for encrypted uncompressed files.
+	static bool BufferedCopyFile(FArchive& Dest, FArchive& Source, const FPakEntry& Entry, void* Buffer, int64 BufferSize, const FAES::FAESKey& InKey, int64 InCopySize = -1, int64 InCopyOffset = 0);
+	static bool UncompressCopyFile(FArchive& Dest, FArchive& Source, const FPakEntry& Entry, uint8*& PersistentBuffer, int64& BufferSize, const FAES::FAESKey& InKey, FName InCompressionMethod, bool bHasRelativeCompressedChunkOffsets, int64 InCopySize = -1, int64 InCopyOffset = 0);
 
 protected:
 	class FRunnableThread* Thread;
 	FGuid Guid;
 	FThreadSafeCounter StopTaskCounter;
 
-	TArray<FPakFileEntry> Files;
+	TSharedPtr<FExtractTaskQueue> TaskQueue;
 	TArray<FPakFileSumary> Summaries;
 	FString OutputPath;
+	// Read from the config when the extraction starts
+	bool bMappedReads;
 
-	FOnUpdateExtractProgress OnUpdateExtractProgress;
+	// Finished files and bytes go to counters of this worker, the job keeps them alive
+	FExtractJobPtr ExtractJob;
+	FExtractJob::FWorkerCounters* ProgressCounters;
+	// Null when the output folder has no manifest
+	FExtractManifestPtr Manifest;
+	// Only set when extracting to an archive, files are decoded in memory and appended to it
+	FExtractArchiveWriterPtr Archive;
 };
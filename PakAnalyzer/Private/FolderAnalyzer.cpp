@@ -25,6 +25,7 @@ FFolderAnalyzer::FFolderAnalyzer()
 
 FFolderAnalyzer::~FFolderAnalyzer()
 {
+	CancelLoad();
 	ShutdownAssetParseWorker();
 	Reset();
 }
@@ -48,11 +49,10 @@ bool FFolderAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TArr
 		return false;
 	}
 
-	Reset();
+	// State of the last load was cleared on the game thread, see LoadPakFilesAsync
 
 	//这里没有真正的pak文件, 所有制造了对应的数据结构 
 	FPakFileSumaryPtr Summary = MakeShared<FPakFileSumary>();
-	PakFileSummaries.Add(Summary);
 
 	// Save pak sumary
 	Summary->MountPoint = InPakPath;
@@ -62,17 +62,30 @@ bool FFolderAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TArr
 	ShutdownAssetParseWorker();
 
 	// Make tree root
-	FPakTreeEntryPtr TreeRoot = MakeShared<FPakTreeEntry>(*FPaths::GetCleanFilename(InPakPath), Summary->MountPoint, true);
+	FPakTreeEntryPtr TreeRoot = MakeTreeRoot(InPakPath, Summary->MountPoint, 0);
+	//树里存相对路径, 文件的路径加上目录前缀就是硬盘的绝对路径
+	TreeRoot->FileTable->PathPrefix = InPakPath;
 
 	//目录下的所有文件, 大部分是uasset和uexp
 	//这里保存的都是文件的绝对路径
 	TArray<FString> FoundFiles;
 	PlatformFile.FindFilesRecursively(FoundFiles, *InPakPath, TEXT(""));
 
+	SetLoadPhase(EPakLoadPhase::LoadingIndices);
+	AddLoadSteps(FoundFiles.Num());
+
 	// 针对每个文件, 造假一个FPakEntry对象
 	int64 TotalSize = 0;
 	for (const FString& File : FoundFiles)
 	{
+		if (IsLoadCancelled())
+		{
+			UE_LOG(LogPakAnalyzer, Log, TEXT("Open folder cancelled: %s."), *InPakPath);
+			return false;
+		}
+
+		AdvanceLoadStep();
+
 		FPakEntry Entry;
 		Entry.Offset = 0;
 		Entry.UncompressedSize = PlatformFile.FileSize(*File);
@@ -83,8 +96,7 @@ bool FFolderAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TArr
 		FString RelativeFilename = File;
 		RelativeFilename.RemoveFromStart(InPakPath);
 
-		FPakTreeEntryPtr TreeEnty = InsertFileToTree(TreeRoot, *Summary, RelativeFilename, Entry);
-		TreeEnty->Path = File;
+		InsertFileToTree(TreeRoot, *Summary, RelativeFilename, Entry);
 
 		//实际上这个文件的内容不是必须
 		//if (File.Contains(TEXT("DevelopmentAssetRegistry.bin")))
@@ -98,20 +110,28 @@ bool FFolderAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TArr
 	Summary->FileCount = TreeRoot->FileCount;
 
 	RefreshTreeNode(TreeRoot);
-	RefreshTreeNodeSizePercent(TreeRoot, TreeRoot);
+	RefreshTreeNodeSizePercent(TreeRoot);
 
-	PakTreeRoots.Add(TreeRoot);
+	SetLoadPhase(EPakLoadPhase::Merging);
 
+	// A single tree, its classes are known before the views get it
 	if (!AssetRegistryPath.IsEmpty())
 	{
-		LoadAssetRegistry(AssetRegistryPath);
+		const TArray<FPakTreeEntryPtr> LoadedTreeRoots = { TreeRoot };
+		LoadAssetRegistry(AssetRegistryPath, LoadedTreeRoots);
 	}
 
+	PublishPak(Summary, TreeRoot);
+	NotifyPakLoaded(Summary, TreeRoot);
+
 	ParseAssetFile(TreeRoot);
 
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Finish load pak file: %s."), *InPakPath);
 
-	FPakAnalyzerDelegates::OnPakLoadFinish.Broadcast();
+	RunOnGameThreadForLoad([]()
+		{
+			FPakAnalyzerDelegates::OnPakLoadFinish.Broadcast();
+		});
 
 	return true;
 }
@@ -136,7 +156,8 @@ void FFolderAnalyzer::ParseAssetFile(FPakTreeEntryPtr InRoot)
 		TArray<FPakFileEntryPtr> UAssetFiles;
 		RetriveUAssetFiles(InRoot, UAssetFiles);
 
-		TArray<FPakFileSumary> Summaries = { *PakFileSummaries[0] };
+		TArray<FPakFileSumary> Summaries = { *GetPakFileSumary()[0] };
+		AssetParseWorker->PackageDependencies = PackageDependencies;
 		AssetParseWorker->StartParse(UAssetFiles, Summaries);
 	}
 }
@@ -167,17 +188,17 @@ void FFolderAnalyzer::OnAssetParseFinish(bool bCancel, const TMap<FName, FName>&
 	DefaultClassMap = ClassMap;
 	const bool bRefreshClass = ClassMap.Num() > 0;
 
-	FFunctionGraphTask::CreateAndDispatchWhenReady([this, bRefreshClass]()
+	// Skipped once the load is cancelled, by the next load or the destructor
+	RunOnGameThreadForLoad([this, bRefreshClass]()
 		{
 			if (bRefreshClass)
 			{
-				for (const FPakTreeEntryPtr& PakTreeRoot : PakTreeRoots)
+				for (const FPakTreeEntryPtr& PakTreeRoot : GetPakTreeRootNode())
 				{
-					RefreshClassMap(PakTreeRoot, PakTreeRoot);
+					RefreshClassMap(PakTreeRoot);
 				}
 			}
 
 			FPakAnalyzerDelegates::OnAssetParseFinish.Broadcast();
-		},
-		TStatId(), nullptr, ENamedThreads::GameThread);
+		});
 }
@@ -10,6 +10,7 @@
 #include "HAL/UnrealMemory.h"
 #include "Misc/Base64.h"
 #include "Misc/Compression.h"
+#include "Misc/ConfigCacheIni.h"
 #include "Misc/Paths.h"
 #include "Misc/ScopeLock.h"
 #include "Serialization/AsyncLoading2.h"
@@ -19,6 +20,10 @@
 #include "UObject/ObjectVersion.h"
 #include "IO/PackageStore.h"
 #include "CommonDefines.h"
+#include "ShardedMap.h"
+
+// First read of a package chunk, enough for FZenPackageSummary and the header of most packages
+static const uint64 IOSTORE_PACKAGE_SUMMARY_READ_SIZE = 16 * 1024;
 
 FIoStoreAnalyzer::FIoStoreAnalyzer()
 {
@@ -54,7 +59,7 @@ bool FIoStoreAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TAr
 
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Start load iostore file count: %d."), UcasFiles.Num());
 
-	Reset();
+	// State of the last load was cleared on the game thread, see LoadPakFilesAsync
 	DefaultAESKeys = UsedDefaultAESKeys;
 
 	if (!InitializeGlobalReader(UcasFiles[0]))
@@ -67,31 +72,63 @@ bool FIoStoreAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TAr
 		UE_LOG(LogPakAnalyzer, Error, TEXT("Read iostore files failed!"));
 	}
 
+	if (IsLoadCancelled())
+	{
+		UE_LOG(LogPakAnalyzer, Log, TEXT("Load iostore files cancelled."));
+		return false;
+	}
+
 	if (StoreContainers.Num() <= 0)
 	{
 		UE_LOG(LogPakAnalyzer, Error, TEXT("Read iostore files failed! Create containers failed!"));
 	}
 
-	// Make tree roots
-	PakTreeRoots.AddZeroed(StoreContainers.Num());
-	PakFileSummaries.AddZeroed(StoreContainers.Num());
-	for (int32 i = 0; i < StoreContainers.Num(); ++i)
+	// Paths and lookups are shared by every container, the trees are built per container afterwards
+	TArray<FString> PackagePaths;
+	TArray<TArray<int32>> ContainerPackages;
+	PackagePaths.AddDefaulted(PackageInfos.Num());
+	ContainerPackages.AddDefaulted(StoreContainers.Num());
+	for (int32 i = 0; i < PackageInfos.Num(); ++i)
 	{
-		PakTreeRoots[i] = MakeShared<FPakTreeEntry>(*FPaths::GetCleanFilename(StoreContainers[i].Summary.PakFilePath), StoreContainers[i].Summary.MountPoint, true);
-		PakFileSummaries[i] = MakeShared<FPakFileSumary>();
-		*PakFileSummaries[i] = StoreContainers[i].Summary;
+		const FStorePackageInfo& Package = PackageInfos[i];
+		if (!Package.PackageId.IsValid())
+		{
+			continue;
+		}
+
+		PackagePaths[i] = Package.PackageName.ToString() + TEXT(".") + Package.Extension.ToString();
+		ContainerPackages[Package.ContainerIndex].Add(i);
+
+		// Keyed like FPakFileEntry::GetPath, the tree drops leading separators and chunks named by their id have none
+		FString FilePath = PackagePaths[i];
+		while (FilePath.RemoveFromStart(TEXT("/")))
+		{
+		}
+		FileToPackageIndex.Add(MoveTemp(FilePath), i);
+		if (!Package.DefaultClassName.IsNone())
+		{
+			DefaultClassMap.Add(Package.PackageName, Package.DefaultClassName);
+		}
 	}
 
+	static const EParallelForFlags ParallelForFlags = FPlatformMisc::IsDebuggerPresent() ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced;
+
+	TArray<FPakTreeEntryPtr> LoadedTreeRoots;
+	LoadedTreeRoots.AddDefaulted(StoreContainers.Num());
+	ParallelFor(StoreContainers.Num(), [this, ContainerStartIndex, &PackagePaths, &ContainerPackages, &LoadedTreeRoots](int32 ContainerIndex)
 	{
-		FScopeLock Lock(&CriticalSection);
+		if (IsLoadCancelled())
+		{
+			return;
+		}
 
-		for (int32 i = 0; i < PackageInfos.Num(); ++i)
+		const FPakFileSumary& ContainerSummary = StoreContainers[ContainerIndex].Summary;
+		FPakFileSumaryPtr Summary = MakeShared<FPakFileSumary>(ContainerSummary);
+		FPakTreeEntryPtr TreeRoot = MakeTreeRoot(ContainerSummary.PakFilePath, ContainerSummary.MountPoint, ContainerIndex + ContainerStartIndex);
+
+		for (const int32 PackageIndex : ContainerPackages[ContainerIndex])
 		{
-			const FStorePackageInfo& Package = PackageInfos[i];
-			if (!Package.PackageId.IsValid())
-			{
-				continue;
-			}
+			const FStorePackageInfo& Package = PackageInfos[PackageIndex];
 
 			FPakEntry Entry;
 			Entry.Offset = Package.ChunkInfo.Offset;
@@ -100,13 +137,12 @@ bool FIoStoreAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TAr
 			Entry.CompressionBlockSize = Package.CompressionBlockSize;
 			Entry.CompressionBlocks.AddZeroed(Package.CompressionBlockCount);
 			HexToBytes(Package.ChunkHash, Entry.Hash);
-			Entry.SetEncrypted(StoreContainers[Package.ContainerIndex].bEncrypted);
+			Entry.SetEncrypted(StoreContainers[ContainerIndex].bEncrypted);
 
-			const FString FullPath = Package.PackageName.ToString() + TEXT(".") + Package.Extension.ToString();
-			FPakTreeEntryPtr ResultEntry = InsertFileToTree(PakTreeRoots[Package.ContainerIndex], StoreContainers[Package.ContainerIndex].Summary, FullPath, Entry);
+			FPakTreeEntryPtr ResultEntry = InsertFileToTree(TreeRoot, ContainerSummary, PackagePaths[PackageIndex], Entry);
 			if (ResultEntry.IsValid())
 			{
-				ResultEntry->OwnerPakIndex = Package.ContainerIndex + ContainerStartIndex;
+				ResultEntry->OwnerPakIndex = TreeRoot->OwnerPakIndex;
 				ResultEntry->CompressionMethod = Package.CompressionMethod;
 
 				if (Package.AssetSummary.IsValid())
@@ -114,24 +150,37 @@ bool FIoStoreAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TAr
 					ResultEntry->AssetSummary = Package.AssetSummary;
 				}
 
-				PakFileSummaries[Package.ContainerIndex]->FileCount += 1;
+				Summary->FileCount += 1;
 			}
+		}
 
-			FileToPackageIndex.Add(FullPath, i);
-			if (!Package.DefaultClassName.IsNone())
-			{
-				DefaultClassMap.Add(Package.PackageName, Package.DefaultClassName);
-			}
+		RefreshTreeNode(TreeRoot);
+		RefreshTreeNodeSizePercent(TreeRoot);
+
+		// Shown as soon as its tree is built, classes are filled in once every container is in
+		if (!IsLoadCancelled())
+		{
+			PublishPak(Summary, TreeRoot, ContainerStartIndex);
+			NotifyPakLoaded(Summary, TreeRoot);
+			LoadedTreeRoots[ContainerIndex] = TreeRoot;
 		}
-	}
+	}, ParallelForFlags);
 
-	for (const FPakTreeEntryPtr TreeRoot : PakTreeRoots)
+	if (IsLoadCancelled())
 	{
-		RefreshTreeNode(TreeRoot);
-		RefreshTreeNodeSizePercent(TreeRoot, TreeRoot);
-		RefreshClassMap(TreeRoot, TreeRoot);
+		UE_LOG(LogPakAnalyzer, Log, TEXT("Load iostore files cancelled."));
+		return false;
 	}
 
+	// The trees are shown already and the views read their class maps on the game thread
+	RunOnGameThreadForLoad([this, LoadedTreeRoots]()
+		{
+			for (const FPakTreeEntryPtr& TreeRoot : LoadedTreeRoots)
+			{
+				RefreshClassMap(TreeRoot);
+			}
+		});
+
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Finish load iostore file count: %d."), UcasFiles.Num());
 
 	//FPakAnalyzerDelegates::OnPakLoadFinish.Broadcast();
@@ -143,25 +192,95 @@ void FIoStoreAnalyzer::ExtractFiles(const FString& InOutputPath, TArray<FPakFile
 {
 	StopExtract();
 
-	FPakAnalyzerDelegates::OnExtractStart.ExecuteIfBound();
-
-	TArray<int32> Packages;
+	// Every chunk in a tree is found here, package or not, anything else is reported instead of dropped
+	int32 UnresolvedCount = 0;
 	for (FPakFileEntryPtr File : InFiles)
 	{
-		const int32* Index = FileToPackageIndex.Find(TEXT("/") / File->Path);
-		if (Index)
+		const FString FilePath = File->GetPath();
+		const int32* Index = FileToPackageIndex.Find(FilePath);
+		if (Index && PackageInfos.IsValidIndex(*Index))
 		{
-			PendingExtracePackages.AddUnique(*Index);
+			FIoStoreExtractTask& Task = PendingExtracePackages.Add_GetRef({ *Index, FilePath, (int64)File->PakEntry.UncompressedSize });
+			FMemory::Memcpy(Task.Hash, File->PakEntry.Hash, sizeof(Task.Hash));
+		}
+		else
+		{
+			++UnresolvedCount;
+			UE_LOG(LogPakAnalyzer, Error, TEXT("Extract iostore file failed! No chunk found for file: %s"), *FilePath);
+		}
+	}
+
+	if (PendingExtracePackages.Num() <= 0 && UnresolvedCount <= 0)
+	{
+		return;
+	}
+
+	FExtractJobPtr Job = BeginExtractJob(InOutputPath);
+	if (!Job)
+	{
+		return;
+	}
+
+	if (UnresolvedCount > 0)
+	{
+		Job->AddTotal(UnresolvedCount, 0);
+		FExtractJob::FWorkerCounters& Counters = Job->AddWorker();
+		for (int32 i = 0; i < UnresolvedCount; ++i)
+		{
+			Counters.AddFile(false);
 		}
 	}
 
 	if (PendingExtracePackages.Num() <= 0)
 	{
+		ReleaseExtractArchive();
 		return;
 	}
 
+	// Chunks next to each other in a .ucas are read one after another
+	PendingExtracePackages.Sort([this](const FIoStoreExtractTask& A, const FIoStoreExtractTask& B) -> bool
+		{
+			const FStorePackageInfo& PackageA = PackageInfos[A.PackageIndex];
+			const FStorePackageInfo& PackageB = PackageInfos[B.PackageIndex];
+
+			if (PackageA.ContainerIndex != PackageB.ContainerIndex)
+			{
+				return PackageA.ContainerIndex < PackageB.ContainerIndex;
+			}
+
+			return PackageA.ChunkInfo.Offset < PackageB.ChunkInfo.Offset;
+		});
+
+	bSplitZenHeaderOnExtract = false;
+	GConfig->GetBool(TEXT("UnrealPakViewer"), TEXT("IoStoreSplitZenHeader"), bSplitZenHeaderOnExtract, GEngineIni);
+
 	ExtractOutputPath = InOutputPath;
-	ExtractThread.Add(Async(EAsyncExecution::Thread, [this]() { OnExtractFiles(); }));
+	NextExtractIndex.Reset();
+
+	int64 TotalBytes = 0;
+	for (const FIoStoreExtractTask& Task : PendingExtracePackages)
+	{
+		TotalBytes += Task.Size;
+	}
+	Job->AddTotal(PendingExtracePackages.Num(), TotalBytes);
+
+	const int32 WorkerCount = FMath::Min(ExtractThreadCount, PendingExtracePackages.Num());
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Start extract iostore packages, worker count: %d, output: %s, package count: %d."), WorkerCount, *InOutputPath, PendingExtracePackages.Num());
+
+	for (int32 i = 0; i < WorkerCount; ++i)
+	{
+		// The thread holds the job, manifest and archive, its counters stay valid even when the job is replaced
+		FExtractJob::FWorkerCounters* Counters = &Job->AddWorker();
+		ExtractThread.Add(Async(EAsyncExecution::Thread, [this, Job, Manifest = ExtractManifest, Archive = ExtractArchive, Counters]() mutable
+			{
+				OnExtractFiles(*Counters, Manifest.Get(), Archive.Get());
+
+				// The last thread to finish closes the archive
+				Archive.Reset();
+			}));
+	}
+
+	ReleaseExtractArchive();
 }
 
 void FIoStoreAnalyzer::CancelExtract()
@@ -171,11 +290,20 @@ void FIoStoreAnalyzer::CancelExtract()
 
 void FIoStoreAnalyzer::SetExtractThreadCount(int32 InThreadCount)
 {
+	const int32 ClampThreadCount = FMath::Clamp(InThreadCount, 1, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	if (ClampThreadCount != ExtractThreadCount)
+	{
+		UE_LOG(LogPakAnalyzer, Log, TEXT("Set iostore extract thread count: %d."), ClampThreadCount);
 
+		// Takes effect from the next extraction
+		ExtractThreadCount = ClampThreadCount;
+	}
 }
 
 void FIoStoreAnalyzer::Reset()
 {
+	StopExtract();
+
 	FBaseAnalyzer::Reset();
 
 	GlobalIoStoreReader.Reset();
@@ -310,6 +438,13 @@ bool FIoStoreAnalyzer::InitializeReaders(const TArray<FString>& InPaks, const TA
 	TArray<FChunkInfo> AllChunkIds;
 	for (int32 PakIndex = 0; PakIndex < InPaks.Num(); ++PakIndex)
 	{
+		if (IsLoadCancelled())
+		{
+			return false;
+		}
+
+		AdvanceLoadStep();
+
 		const FString& ContainerFilePath = InPaks[PakIndex];
 		const FString& DefaultAESKey = InDefaultAESKeys.IsValidIndex(PakIndex) ? InDefaultAESKeys[PakIndex] : TEXT("");
 		FString DecryptKey;
@@ -480,17 +615,29 @@ bool FIoStoreAnalyzer::InitializeReaders(const TArray<FString>& InPaks, const TA
 		// 解析 export 数据
 		if (PackageInfo.ChunkType == EIoChunkType::ExportBundleData)
 		{
-			FIoReadOptions ReadOptions;
-
-			//根据chunk id读取buffer数据
+			// Only the package header is needed, read a small prefix to learn HeaderSize and then exactly [0, HeaderSize)
+			FIoReadOptions ReadOptions(0, FMath::Min<uint64>(PackageInfo.ChunkInfo.Size, IOSTORE_PACKAGE_SUMMARY_READ_SIZE));
 			TIoStatusOr<FIoBuffer> IoBuffer = Reader->Read(PackageInfo.ChunkId, ReadOptions);
+			if (!IoBuffer.IsOk() || IoBuffer.ValueOrDie().DataSize() < sizeof(FZenPackageSummary))
+			{
+				UE_LOG(LogPakAnalyzer, Warning, TEXT("Failed to read package summary of chunk %s in container '%s'"), *LexToString(PackageInfo.ChunkId), *ContainerInfo.Summary.PakFilePath);
+				return;
+			}
+
 			//然后获取这个 package 的 summary信息
 			const uint8* PackageSummaryData = IoBuffer.ValueOrDie().Data();
 			const FZenPackageSummary* PackageSummary = reinterpret_cast<const FZenPackageSummary*>(PackageSummaryData);
-			if (PackageSummary->HeaderSize > IoBuffer.ValueOrDie().DataSize()) //如果数据有异常, 重新读取
+			const uint32 HeaderSize = PackageSummary->HeaderSize;
+			if (HeaderSize > IoBuffer.ValueOrDie().DataSize())
 			{
-				ReadOptions.SetRange(0, PackageSummary->HeaderSize);
+				ReadOptions.SetRange(0, HeaderSize);
 				IoBuffer = Reader->Read(PackageInfo.ChunkId, ReadOptions);
+				if (!IoBuffer.IsOk() || IoBuffer.ValueOrDie().DataSize() < HeaderSize)
+				{
+					UE_LOG(LogPakAnalyzer, Warning, TEXT("Failed to read package header of chunk %s in container '%s'"), *LexToString(PackageInfo.ChunkId), *ContainerInfo.Summary.PakFilePath);
+					return;
+				}
+
 				PackageSummaryData = IoBuffer.ValueOrDie().Data();
 				PackageSummary = reinterpret_cast<const FZenPackageSummary*>(PackageSummaryData);
 			}
@@ -613,25 +760,15 @@ bool FIoStoreAnalyzer::InitializeReaders(const TArray<FString>& InPaks, const TA
 
 	UE_LOG(LogPakAnalyzer, Display, TEXT("IoStore assigning package name..."));
 
-	TMap<FPackageId, FName> PackageNameMap;
-	for (const FStorePackageInfo& PackageInfo : PackageInfos)
+	TShardedMap<FPackageId, FName> PackageNameMap;
+	PackageNameMap.Build(PackageInfos.Num(), [this](int32 Index, TArray<TPair<FPackageId, FName>>& OutPairs)
 	{
+		const FStorePackageInfo& PackageInfo = PackageInfos[Index];
 		if (PackageInfo.PackageName != NAME_None)
 		{
-			PackageNameMap.Add(PackageInfo.PackageId, PackageInfo.PackageName);
+			OutPairs.Emplace(PackageInfo.PackageId, PackageInfo.PackageName);
 		}
-
-		//if (PackageInfo.PackageId.IsValid())
-		//{
-		//	for (const FIoStoreExport& Export : PackageInfo.Exports)
-		//	{
-		//		if (!Export.GlobalImportIndex.IsNull())
-		//		{
-		//			ExportByGlobalIdMap.Add(Export.GlobalImportIndex, &Export);
-		//		}
-		//	}
-		//}
-	}
+	});
 
 	ParallelFor(PackageInfos.Num(), [this, &PackageNameMap](int32 Index)
 	{
@@ -643,7 +780,7 @@ bool FIoStoreAnalyzer::InitializeReaders(const TArray<FString>& InPaks, const TA
 
 		if (PackageInfo.PackageName == NAME_None)
 		{
-			if (FName* PackageName = PackageNameMap.Find(PackageInfo.PackageId))
+			if (const FName* PackageName = PackageNameMap.Find(PackageInfo.PackageId))
 			{
 				PackageInfo.PackageName = *PackageName;
 			}
@@ -657,19 +794,18 @@ bool FIoStoreAnalyzer::InitializeReaders(const TArray<FString>& InPaks, const TA
 	UE_LOG(LogPakAnalyzer, Display, TEXT("Connecting imports and exports..."));
 
 	//如果公开exoport hash, 将key存储到 ExportByKeyMap
-	TMap<FPublicExportKey, FIoStoreExport*> ExportByKeyMap;
-	for (FStorePackageInfo& PackageInfo : PackageInfos)
+	TShardedMap<FPublicExportKey, FIoStoreExport*> ExportByKeyMap;
+	ExportByKeyMap.Build(PackageInfos.Num(), [this](int32 Index, TArray<TPair<FPublicExportKey, FIoStoreExport*>>& OutPairs)
 	{
+		FStorePackageInfo& PackageInfo = PackageInfos[Index];
 		for (FIoStoreExport& ExportDesc : PackageInfo.Exports)
 		{
 			if (ExportDesc.PublicExportHash)
 			{
-				FPublicExportKey Key = FPublicExportKey::MakeKey(PackageInfo.PackageId, ExportDesc.PublicExportHash);
-				ExportByKeyMap.Add(Key, &ExportDesc);
+				OutPairs.Emplace(FPublicExportKey::MakeKey(PackageInfo.PackageId, ExportDesc.PublicExportHash), &ExportDesc);
 			}
 		}
-	}
-	
+	});
 
 	//构建 export 的fullname
 	ParallelFor(PackageInfos.Num(), [this](int32 Index)
@@ -721,10 +857,45 @@ bool FIoStoreAnalyzer::InitializeReaders(const TArray<FString>& InPaks, const TA
 
 	UE_LOG(LogPakAnalyzer, Display, TEXT("Filling imports and exports..."));
 
-	TMultiMap<FString, FString> DependsMap;
-	FCriticalSection Mutex;
+	// Graph ids are handed out up front, so the pass below only reads maps and writes the rows of its own package
+	TArray<int32> PackageGraphIds;
+	TShardedMap<FPackageId, int32> GraphIdByPackageId;
+	TArray<int32> EdgeOffsets;
+	TArray<FPackageEdge> Edges;
+	TArray<int32> MissingCounts;
+	{
+		// Every named package, the same pairs as PackageNameMap once names are filled in
+		TArray<FName> Names;
+		Names.Reserve(PackageInfos.Num());
+		for (const FStorePackageInfo& PackageInfo : PackageInfos)
+		{
+			Names.Add(PackageInfo.PackageName);
+		}
+
+		PackageDependencies->FindOrAddPackages(Names, PackageGraphIds);
+		GraphIdByPackageId.Build(PackageInfos.Num(), [this, &PackageGraphIds](int32 Index, TArray<TPair<FPackageId, int32>>& OutPairs)
+		{
+			if (PackageGraphIds[Index] != INDEX_NONE)
+			{
+				OutPairs.Emplace(PackageInfos[Index].PackageId, PackageGraphIds[Index]);
+			}
+		});
+
+		// Rows of every package laid out by a prefix sum of their dependency counts
+		EdgeOffsets.SetNumUninitialized(PackageInfos.Num() + 1);
+		EdgeOffsets[0] = 0;
+		for (int32 Index = 0; Index < PackageInfos.Num(); ++Index)
+		{
+			const FStorePackageInfo& PackageInfo = PackageInfos[Index];
+			const bool bHasSummary = PackageInfo.PackageId.IsValid() && PackageInfo.AssetSummary.IsValid();
+			EdgeOffsets[Index + 1] = EdgeOffsets[Index] + (bHasSummary ? PackageInfo.DependencyPackages.Num() : 0);
+		}
+
+		Edges.SetNumUninitialized(EdgeOffsets.Last());
+		MissingCounts.SetNumZeroed(PackageInfos.Num());
+	}
 
-	ParallelFor(PackageInfos.Num(), [this, &PackageNameMap, &DependsMap, &Mutex, &ExportByKeyMap](int32 Index)
+	ParallelFor(PackageInfos.Num(), [this, &PackageGraphIds, &GraphIdByPackageId, &EdgeOffsets, &Edges, &MissingCounts, &ExportByKeyMap](int32 Index)
 	{
 		FStorePackageInfo& PackageInfo = PackageInfos[Index];
 		if (!PackageInfo.PackageId.IsValid() || !PackageInfo.AssetSummary.IsValid())
@@ -837,45 +1008,50 @@ bool FIoStoreAnalyzer::InitializeReaders(const TArray<FString>& InPaks, const TA
 			PackageInfo.AssetSummary->ObjectImports[i] = ObjectImport;
 		}
 
-		PackageInfo.AssetSummary->DependencyList.SetNum(PackageInfo.DependencyPackages.Num());
+		// Dependents are the reversed edges of the package graph, across every pak and container
+		const int32 PackageGraphId = PackageGraphIds[Index];
+		PackageInfo.AssetSummary->PackageId = PackageGraphId;
+
+		FPackageEdge* PackageEdges = Edges.GetData() + EdgeOffsets[Index];
 		for (int32 i = 0; i < PackageInfo.DependencyPackages.Num(); ++i)
 		{
-			FPackageInfoPtr DependencyPackage = MakeShared<struct FPackageInfo>();
-			if (FName* PackageName = PackageNameMap.Find(PackageInfo.DependencyPackages[i]))
-			{
-				DependencyPackage->PackageName = *PackageName;
-
-				FScopeLock ScopeLock(&Mutex);
-				DependsMap.Add(DependencyPackage->PackageName.ToString().ToLower(), PackageInfo.PackageName.ToString());
-			}
-			else
-			{
-				DependencyPackage->PackageName = *FString::Printf(TEXT("Missing package: 0x%X, may be in other ucas!"), PackageInfo.DependencyPackages[i].ValueForDebugging());
-			}
-
-			PackageInfo.AssetSummary->DependencyList[i] = DependencyPackage;
+			const int32* DependencyGraphId = GraphIdByPackageId.Find(PackageInfo.DependencyPackages[i]);
+			PackageEdges[i] = { PackageGraphId, DependencyGraphId ? *DependencyGraphId : INDEX_NONE };
+			MissingCounts[Index] += DependencyGraphId ? 0 : 1;
 		}
 	}, ParallelForFlags);
 
-	UE_LOG(LogPakAnalyzer, Display, TEXT("Parsing dependents..."));
-
-	ParallelFor(PackageInfos.Num(), [this, &DependsMap](int32 Index) {
-		FStorePackageInfo& PackageInfo = PackageInfos[Index];
-		if (!PackageInfo.PackageId.IsValid() || !PackageInfo.AssetSummary.IsValid())
+	// Packages of other containers only get a name, one per package id
+	TMap<FPackageId, int32> MissingGraphIds;
+	for (int32 Index = 0; Index < PackageInfos.Num(); ++Index)
+	{
+		if (MissingCounts[Index] <= 0)
 		{
-			return;
+			continue;
 		}
 
-		TArray<FString> Assets;
-		DependsMap.MultiFind(PackageInfo.PackageName.ToString().ToLower(), Assets);
-
-		for (const FString& Asset : Assets)
+		const FStorePackageInfo& PackageInfo = PackageInfos[Index];
+		for (int32 i = 0; i < PackageInfo.DependencyPackages.Num(); ++i)
 		{
-			FPackageInfoPtr Depends = MakeShared<FPackageInfo>();
-			Depends->PackageName = *Asset;
-			PackageInfo.AssetSummary->DependentList.Add(Depends);
+			FPackageEdge& Edge = Edges[EdgeOffsets[Index] + i];
+			if (Edge.To == INDEX_NONE)
+			{
+				const FPackageId DependencyPackage = PackageInfo.DependencyPackages[i];
+				if (const int32* MissingGraphId = MissingGraphIds.Find(DependencyPackage))
+				{
+					Edge.To = *MissingGraphId;
+				}
+				else
+				{
+					Edge.To = MissingGraphIds.Add(DependencyPackage, PackageDependencies->FindOrAddPackage(*FString::Printf(TEXT("Missing package: 0x%X, may be in other ucas!"), DependencyPackage.ValueForDebugging())));
+				}
+			}
 		}
-	}, ParallelForFlags);
+	}
+
+	UE_LOG(LogPakAnalyzer, Display, TEXT("Building package graph..."));
+
+	PackageDependencies->UpdateEdges(TArrayView<const int32>(), Edges);
 
 	UE_LOG(LogPakAnalyzer, Display, TEXT("IoStore creating container readers finish."));
 
@@ -1072,7 +1248,7 @@ bool FIoStoreAnalyzer::PreLoadIoStore(const FString& InTocPath, const FString& I
 				bool bCancel = true;
 				do
 				{
-					OutDecryptKey = FPakAnalyzerDelegates::OnGetAESKey.Execute(InCasPath, Header.EncryptionKeyGuid, bCancel);
+					OutDecryptKey = RequestAESKey(InCasPath, Header.EncryptionKeyGuid, bCancel);
 
 					bShouldLoad = !bCancel ? TryDecryptIoStore(TocResource, ChunkOffsetLengthsArray[0], TocResource.ChunkMetas[0], InCasPath, OutDecryptKey, AESKey) : false;
 				} while (!bShouldLoad && !bCancel);
@@ -1257,89 +1433,245 @@ bool FIoStoreAnalyzer::FillPackageInfo(const FIoStoreTocResourceInfo& TocResourc
 	return true;
 }
 
-void FIoStoreAnalyzer::OnExtractFiles()
+// The zen header of a split package is not a legacy package summary, the editor can't load it, so it doesn't pose as a .uasset
+static const TCHAR* const ZenHeaderExtension = TEXT("zenheader");
+
+bool FIoStoreAnalyzer::IsSplitOnExtract(const FStorePackageInfo& InPackageInfo) const
 {
-	//TAtomic<int32> TotalErrorCount{ 0 };
-	//TAtomic<int32> TotalCompleteCount{ 0 };
-	//const int32 TotalTotalCount = PendingExtracePackages.Num();
+	return bSplitZenHeaderOnExtract && InPackageInfo.ChunkType == EIoChunkType::ExportBundleData && InPackageInfo.ChunkInfo.Size >= sizeof(FZenPackageSummary);
+}
 
-	//ParallelFor(PendingExtracePackages.Num(), [this, TotalTotalCount, &TotalErrorCount, &TotalCompleteCount](int32 Index)
-	//{
-	//	if (IsStopExtract)
-	//	{
-	//		return;
-	//	}
-
-	//	const int32 PackageIndex = PendingExtracePackages[Index];
-	//	if (!PackageInfos.IsValidIndex(PackageIndex))
-	//	{
-	//		TotalCompleteCount.IncrementExchange();
-	//		TotalErrorCount.IncrementExchange();
-	//		UpdateExtractProgress(TotalTotalCount, TotalCompleteCount, TotalErrorCount);
-	//		return;
-	//	}
-
-	//	const FStorePackageInfo& PackageInfo = PackageInfos[PackageIndex];
-	//	TSharedPtr<FIoStoreReader>& Reader = StoreContainers[PackageInfo.ContainerIndex].Reader;
-	//	if (!Reader.IsValid())
-	//	{
-	//		TotalCompleteCount.IncrementExchange();
-	//		TotalErrorCount.IncrementExchange();
-	//		UpdateExtractProgress(TotalTotalCount, TotalCompleteCount, TotalErrorCount);
-	//		return;
-	//	}
-
-	//	FIoReadOptions ReadOptions;
-	//	TIoStatusOr<FIoBuffer> IoBuffer = Reader->Read(PackageInfo.ChunkId, ReadOptions);
-	//	if (!IoBuffer.IsOk())
-	//	{
-	//		TotalCompleteCount.IncrementExchange();
-	//		TotalErrorCount.IncrementExchange();
-	//		UpdateExtractProgress(TotalTotalCount, TotalCompleteCount, TotalErrorCount);
-	//		return;
-	//	}
-
-	//	const FString OutputFilePath = ExtractOutputPath / PackageInfo.PackageName.ToString() + TEXT(".") + PackageInfo.Extension.ToString();
-	//	const FString BasePath = FPaths::GetPath(OutputFilePath);
-	//	if (!FPaths::DirectoryExists(BasePath))
-	//	{
-	//		IFileManager::Get().MakeDirectory(*BasePath, true);
-	//	}
-
-	//	IPlatformFile& PlatformFile = IPlatformFile::GetPlatformPhysical();
-	//	TUniquePtr<IFileHandle>	FileHandle(PlatformFile.OpenWrite(*OutputFilePath));
-	//	if (!FileHandle.IsValid())
-	//	{
-	//		TotalCompleteCount.IncrementExchange();
-	//		TotalErrorCount.IncrementExchange();
-	//		UpdateExtractProgress(TotalTotalCount, TotalCompleteCount, TotalErrorCount);
-	//		return;
-	//	}
-
-	//	if (PackageInfo.ChunkType == EIoChunkType::ExportBundleData)
-	//	{
-	//		const uint8* PackageSummaryData = IoBuffer.ValueOrDie().Data();
-	//		const FPackageSummary* PackageSummary = reinterpret_cast<const FPackageSummary*>(PackageSummaryData);
-
-	//		const uint8* Start = PackageSummaryData + PackageSummary->GraphDataOffset + PackageSummary->GraphDataSize;
-	//		const uint8* End = PackageSummaryData + IoBuffer.ValueOrDie().DataSize();
-
-	//		FileHandle->Write(Start, End - Start);
-
-	//		const uint32 PackageTag = PACKAGE_FILE_TAG;
-	//		FileHandle->Write((const uint8*)&PackageTag, 4);
-	//	}
-	//	else
-	//	{
-	//		FileHandle->Write(IoBuffer.ValueOrDie().Data(), IoBuffer.ValueOrDie().DataSize());
-	//	}
-
-	//	FileHandle->Flush();
-
-	//	TotalCompleteCount.IncrementExchange();
-
-	//	UpdateExtractProgress(TotalTotalCount, TotalCompleteCount, TotalErrorCount);
-	//}, EParallelForFlags::Unbalanced);
+void FIoStoreAnalyzer::OnExtractFiles(FExtractJob::FWorkerCounters& InCounters, FExtractManifest* InManifest, FExtractArchiveWriter* InArchive)
+{
+	// Decompressed chunks of this thread, reused by every package it picks up
+	TArray<uint8> Buffer;
+
+	// Threads take the next package from a shared cursor, one big chunk never holds up the packages behind it
+	int32 TaskIndex = NextExtractIndex.Increment() - 1;
+	while (!IsStopExtract && TaskIndex < PendingExtracePackages.Num())
+	{
+		const FIoStoreExtractTask& Task = PendingExtracePackages[TaskIndex];
+
+		// Relative path of every output of the package, a record only matches a package written with the same layout
+		TArray<FString, TInlineAllocator<2>> OutputPaths;
+		uint32 ManifestFlags = FExtractManifest::None;
+		if (IsSplitOnExtract(PackageInfos[Task.PackageIndex]))
+		{
+			OutputPaths.Add(FPaths::ChangeExtension(Task.FilePath, ZenHeaderExtension));
+			OutputPaths.Add(FPaths::ChangeExtension(Task.FilePath, TEXT("uexp")));
+			ManifestFlags = FExtractManifest::SplitZenHeader;
+		}
+		else
+		{
+			OutputPaths.Add(Task.FilePath);
+		}
+
+		// Skipped only while every output is as it was written
+		bool bUpToDate = InManifest != nullptr;
+		for (int32 Index = 0; bUpToDate && Index < OutputPaths.Num(); ++Index)
+		{
+			const FString OutputFilePath = ExtractOutputPath / OutputPaths[Index];
+			bUpToDate = Index + 1 < OutputPaths.Num()
+				? InManifest->HasRecord(OutputPaths[Index], OutputFilePath, Task.Size, Task.Hash, ManifestFlags)
+				: InManifest->IsUpToDate(OutputPaths[Index], OutputFilePath, Task.Size, Task.Hash, ManifestFlags);
+		}
+
+		bool bSuccess = true;
+		if (!bUpToDate)
+		{
+			bSuccess = ExtractPackage(Task, Buffer, InArchive);
+			if (bSuccess && InManifest)
+			{
+				for (const FString& OutputPath : OutputPaths)
+				{
+					InManifest->Add(OutputPath, Task.Size, IFileManager::Get().FileSize(*(ExtractOutputPath / OutputPath)), Task.Hash, ManifestFlags);
+				}
+			}
+		}
+
+		InCounters.AddBytes(Task.Size);
+		InCounters.AddFile(bSuccess);
+
+		TaskIndex = NextExtractIndex.Increment() - 1;
+	}
+
+	// Records of a cancelled extraction are kept too, the next one resumes from them
+	if (InManifest)
+	{
+		InManifest->Flush();
+	}
+}
+
+static bool WriteExtractFile(const FString& InFilePath, const uint8* InData, int64 InSize, const uint8* InTail = nullptr, int64 InTailSize = 0)
+{
+	TUniquePtr<FArchive> FileHandle(IFileManager::Get().CreateFileWriter(*InFilePath));
+	if (!FileHandle)
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Open local file to write failed! File: %s"), *InFilePath);
+		return false;
+	}
+
+	FileHandle->Serialize(const_cast<uint8*>(InData), InSize);
+	if (InTail)
+	{
+		FileHandle->Serialize(const_cast<uint8*>(InTail), InTailSize);
+	}
+
+	return FileHandle->Close() && !FileHandle->IsError();
+}
+
+// Opens one output, an archive member or a file of the output folder, and lets InWriteContent serialize its InSize bytes
+static bool WriteExtractStream(FExtractArchiveWriter* InArchive, const FString& InFilePath, int64 InSize, TFunctionRef<bool(FArchive&)> InWriteContent)
+{
+	if (InArchive)
+	{
+		return InArchive->AddFileStreamed(InFilePath, InSize, InWriteContent);
+	}
+
+	TUniquePtr<FArchive> FileHandle(IFileManager::Get().CreateFileWriter(*InFilePath));
+	if (!FileHandle)
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Open local file to write failed! File: %s"), *InFilePath);
+		return false;
+	}
+
+	const bool bWritten = InWriteContent(*FileHandle);
+	return FileHandle->Close() && !FileHandle->IsError() && bWritten;
+}
+
+bool FIoStoreAnalyzer::ExtractPackage(const FIoStoreExtractTask& InTask, TArray<uint8>& InOutBuffer, FExtractArchiveWriter* InArchive)
+{
+	const FStorePackageInfo& PackageInfo = PackageInfos[InTask.PackageIndex];
+	if (!StoreContainers.IsValidIndex(PackageInfo.ContainerIndex) || !StoreContainers[PackageInfo.ContainerIndex].Reader.IsValid())
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Extract file failed! Container reader is invalid! File: %s"), *InTask.FilePath);
+		return false;
+	}
+
+	if ((int64)PackageInfo.ChunkInfo.Size >= FExtractArchiveWriter::StreamedFileMinSize)
+	{
+		return ExtractLargePackage(InTask, InOutBuffer, InArchive);
+	}
+
+	// The reader decodes straight into the buffer of this thread
+	InOutBuffer.SetNumUninitialized(PackageInfo.ChunkInfo.Size, false);
+
+	FIoReadOptions ReadOptions;
+	ReadOptions.SetTargetVa(InOutBuffer.GetData());
+
+	TIoStatusOr<FIoBuffer> IoBuffer = StoreContainers[PackageInfo.ContainerIndex].Reader->Read(PackageInfo.ChunkId, ReadOptions);
+	if (!IoBuffer.IsOk())
+	{
+		UE_LOG(LogPakAnalyzer, Error, TEXT("Extract file failed! Read chunk failed: %s! File: %s"), *IoBuffer.Status().ToString(), *InTask.FilePath);
+		return false;
+	}
+
+	const uint8* Data = IoBuffer.ValueOrDie().Data();
+	const int64 DataSize = IoBuffer.ValueOrDie().DataSize();
+
+	// Relative paths go to the archive as they are, no folder is created for them
+	const FString OutputFilePath = InArchive ? InTask.FilePath : ExtractOutputPath / InTask.FilePath;
+	if (!InArchive)
+	{
+		const FString BasePath = FPaths::GetPath(OutputFilePath);
+		if (!FPaths::DirectoryExists(BasePath))
+		{
+			IFileManager::Get().MakeDirectory(*BasePath, true);
+		}
+	}
+
+	auto WriteFile = [InArchive](const FString& InFilePath, const uint8* InData, int64 InSize, const uint8* InTail = nullptr, int64 InTailSize = 0) -> bool
+	{
+		return InArchive ? InArchive->AddFile(InFilePath, InData, InSize, InTail, InTailSize) : WriteExtractFile(InFilePath, InData, InSize, InTail, InTailSize);
+	};
+
+	if (IsSplitOnExtract(PackageInfo) && DataSize >= (int64)sizeof(FZenPackageSummary))
+	{
+		// The zen header as stored goes to .zenheader, the export data to .uexp ending with the package tag like a legacy .uexp
+		const int64 HeaderSize = FMath::Min<int64>(reinterpret_cast<const FZenPackageSummary*>(Data)->HeaderSize, DataSize);
+		const uint32 PackageTag = PACKAGE_FILE_TAG;
+
+		return WriteFile(FPaths::ChangeExtension(OutputFilePath, ZenHeaderExtension), Data, HeaderSize)
+			&& WriteFile(FPaths::ChangeExtension(OutputFilePath, TEXT("uexp")), Data + HeaderSize, DataSize - HeaderSize, reinterpret_cast<const uint8*>(&PackageTag), sizeof(PackageTag));
+	}
+
+	return WriteFile(OutputFilePath, Data, DataSize);
+}
+
+bool FIoStoreAnalyzer::ExtractLargePackage(const FIoStoreExtractTask& InTask, TArray<uint8>& InOutBuffer, FExtractArchiveWriter* InArchive)
+{
+	const FStorePackageInfo& PackageInfo = PackageInfos[InTask.PackageIndex];
+	FIoStoreReader& Reader = *StoreContainers[PackageInfo.ContainerIndex].Reader;
+	const int64 ChunkSize = PackageInfo.ChunkInfo.Size;
+
+	// The chunk never fits the int32 buffer of this thread, it is read and written one window at a time
+	static constexpr int64 ReadWindowSize = 16 * 1024 * 1024;
+	auto CopyRange = [this, &Reader, &PackageInfo, &InTask, &InOutBuffer](FArchive& OutWriter, int64 InOffset, int64 InSize) -> bool
+	{
+		for (int64 Offset = InOffset; Offset < InOffset + InSize && !IsStopExtract; Offset += ReadWindowSize)
+		{
+			const int64 WindowSize = FMath::Min(ReadWindowSize, InOffset + InSize - Offset);
+			InOutBuffer.SetNumUninitialized((int32)WindowSize, false);
+
+			FIoReadOptions ReadOptions(Offset, WindowSize);
+			ReadOptions.SetTargetVa(InOutBuffer.GetData());
+
+			TIoStatusOr<FIoBuffer> IoBuffer = Reader.Read(PackageInfo.ChunkId, ReadOptions);
+			if (!IoBuffer.IsOk() || (int64)IoBuffer.ValueOrDie().DataSize() != WindowSize)
+			{
+				UE_LOG(LogPakAnalyzer, Error, TEXT("Extract file failed! Read chunk failed: %s! File: %s"), *IoBuffer.Status().ToString(), *InTask.FilePath);
+				return false;
+			}
+
+			OutWriter.Serialize(const_cast<uint8*>(IoBuffer.ValueOrDie().Data()), WindowSize);
+		}
+
+		return !IsStopExtract && !OutWriter.IsError();
+	};
+
+	const FString OutputFilePath = InArchive ? InTask.FilePath : ExtractOutputPath / InTask.FilePath;
+	if (!InArchive)
+	{
+		const FString BasePath = FPaths::GetPath(OutputFilePath);
+		if (!FPaths::DirectoryExists(BasePath))
+		{
+			IFileManager::Get().MakeDirectory(*BasePath, true);
+		}
+	}
+
+	if (IsSplitOnExtract(PackageInfo))
+	{
+		// Same layout as ExtractPackage, the header size comes from the summary at the start of the chunk
+		FIoReadOptions SummaryOptions(0, sizeof(FZenPackageSummary));
+		TIoStatusOr<FIoBuffer> SummaryBuffer = Reader.Read(PackageInfo.ChunkId, SummaryOptions);
+		if (!SummaryBuffer.IsOk() || SummaryBuffer.ValueOrDie().DataSize() < sizeof(FZenPackageSummary))
+		{
+			UE_LOG(LogPakAnalyzer, Error, TEXT("Extract file failed! Read package summary failed! File: %s"), *InTask.FilePath);
+			return false;
+		}
+
+		const int64 HeaderSize = FMath::Min<int64>(reinterpret_cast<const FZenPackageSummary*>(SummaryBuffer.ValueOrDie().Data())->HeaderSize, ChunkSize);
+		uint32 PackageTag = PACKAGE_FILE_TAG;
+
+		return WriteExtractStream(InArchive, FPaths::ChangeExtension(OutputFilePath, ZenHeaderExtension), HeaderSize, [&CopyRange, HeaderSize](FArchive& OutWriter)
+				{
+					return CopyRange(OutWriter, 0, HeaderSize);
+				})
+			&& WriteExtractStream(InArchive, FPaths::ChangeExtension(OutputFilePath, TEXT("uexp")), ChunkSize - HeaderSize + sizeof(PackageTag), [&CopyRange, HeaderSize, ChunkSize, &PackageTag](FArchive& OutWriter)
+				{
+					if (!CopyRange(OutWriter, HeaderSize, ChunkSize - HeaderSize))
+					{
+						return false;
+					}
+					OutWriter << PackageTag;
+					return !OutWriter.IsError();
+				});
+	}
+
+	return WriteExtractStream(InArchive, OutputFilePath, ChunkSize, [&CopyRange, ChunkSize](FArchive& OutWriter)
+		{
+			return CopyRange(OutWriter, 0, ChunkSize);
+		});
 }
 
 void FIoStoreAnalyzer::StopExtract()
@@ -1356,16 +1688,6 @@ void FIoStoreAnalyzer::StopExtract()
 	PendingExtracePackages.Empty();
 }
 
-void FIoStoreAnalyzer::UpdateExtractProgress(int32 InTotal, int32 InComplete, int32 InError)
-{
-	FFunctionGraphTask::CreateAndDispatchWhenReady(
-		[InTotal, InComplete, InError]()
-		{
-			FPakAnalyzerDelegates::OnUpdateExtractProgress.ExecuteIfBound(InComplete, InError, InTotal);
-		},
-		TStatId(), nullptr, ENamedThreads::GameThread);
-}
-
 void FIoStoreAnalyzer::ParseChunkInfo(const FIoChunkId& InChunkId, FPackageId& OutPackageId, EIoChunkType& OutChunkType)
 {
 	const uint8* Data = (const uint8*)(&InChunkId);
@@ -8,6 +8,7 @@
 
 #include "Async/Async.h"
 #include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
 #include "IO/IoDispatcher.h"
 #include "Misc/AES.h"
 #include "Misc/Guid.h"
@@ -38,9 +39,23 @@ protected:
 	bool PreLoadIoStore(const FString& InTocPath, const FString& InCasPath, const FString& InDefaultAESKey, TMap<FGuid, FAES::FAESKey>& OutKeys, FString& OutDecryptKey);
 	bool TryDecryptIoStore(const FIoStoreTocResourceInfo& TocResource, const FIoOffsetAndLength& OffsetAndLength, const FIoStoreTocEntryMeta& Meta, const FString& InCasPath, const FString& InKey, FAES::FAESKey& OutAESKey);
 	bool FillPackageInfo(const FIoStoreTocResourceInfo& TocResource, FStorePackageInfo& OutPackageInfo);
-	void OnExtractFiles();
+	struct FIoStoreExtractTask
+	{
+		int32 PackageIndex;
+		FString FilePath;
+		int64 Size;
+		// Chunk hash, matched against the manifest of the output folder
+		uint8 Hash[20];
+	};
+
+	// Runs on every extract thread until the pending packages are used up, InManifest may be null and InArchive is only set when extracting to an archive
+	void OnExtractFiles(FExtractJob::FWorkerCounters& InCounters, FExtractManifest* InManifest, FExtractArchiveWriter* InArchive);
+	// The raw zen header and the export data are written apart, see IoStoreSplitZenHeader
+	bool IsSplitOnExtract(const FStorePackageInfo& InPackageInfo) const;
+	bool ExtractPackage(const FIoStoreExtractTask& InTask, TArray<uint8>& InOutBuffer, FExtractArchiveWriter* InArchive);
+	// Chunks of FExtractArchiveWriter::StreamedFileMinSize and more, read and written in windows instead of one buffer
+	bool ExtractLargePackage(const FIoStoreExtractTask& InTask, TArray<uint8>& InOutBuffer, FExtractArchiveWriter* InArchive);
 	void StopExtract();
-	void UpdateExtractProgress(int32 InTotal, int32 InComplete, int32 InError);
 	void ParseChunkInfo(const FIoChunkId& InChunkId, FPackageId& OutPackageId, EIoChunkType& OutChunkType);
 	FName FindObjectName(FPackageObjectIndex Index, const FStorePackageInfo* PackageInfo);
 
@@ -53,10 +68,13 @@ protected:
 
 	TArray<FString> DefaultAESKeys;
 
-	TArray<int32> PendingExtracePackages;
+	TArray<FIoStoreExtractTask> PendingExtracePackages;
 	TArray<TFuture<void>> ExtractThread;
 	FThreadSafeBool IsStopExtract;
 	FString ExtractOutputPath;
+	int32 ExtractThreadCount = DEFAULT_EXTRACT_THREAD_COUNT;
+	bool bSplitZenHeaderOnExtract = false;
+	FThreadSafeCounter NextExtractIndex;
 
 	//存储所有的script object的元数据
 	TMap<FPackageObjectIndex, FScriptObjectDesc> ScriptObjectByGlobalIdMap;
@@ -0,0 +1,108 @@
+#include "MappedPakReader.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFile.h"
+#include "HAL/PlatformMemory.h"
+#include "IPlatformFilePak.h"
+#include "Memory/MemoryView.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Serialization/MemoryReader.h"
+
+#include "CommonDefines.h"
+
+#if PLATFORM_UNIX || PLATFORM_MAC
+#include <sys/mman.h>
+
+// madvise works on whole pages, the span is widened to the pages it touches
+static void AdviseSpan(const uint8* InData, int64 InSize, int32 InAdvice)
+{
+	const UPTRINT PageSize = FPlatformMemory::GetConstants().PageSize;
+	const UPTRINT Start = AlignDown((UPTRINT)InData, PageSize);
+	const UPTRINT End = Align((UPTRINT)InData + InSize, PageSize);
+
+	madvise((void*)Start, End - Start, InAdvice);
+}
+#endif
+
+bool FMappedPakReader::IsEnabled()
+{
+	bool bMappedPakReads = false;
+	GConfig->GetBool(TEXT("UnrealPakViewer"), TEXT("MappedPakReads"), bMappedPakReads, GEngineIni);
+
+	return bMappedPakReads;
+}
+
+TUniquePtr<FMappedPakReader> FMappedPakReader::Open(const FString& InPakFilePath, EAccessPattern InAccessPattern)
+{
+#if PLATFORM_64BITS
+	// Physical file, paks restored from the index cache are never mounted
+	TUniquePtr<IMappedFileHandle> Handle(IPlatformFile::GetPlatformPhysical().OpenMapped(*InPakFilePath));
+	if (!Handle.IsValid() || Handle->GetFileSize() <= 0)
+	{
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Unable to map pak file, reading it through an archive! Path: %s."), *InPakFilePath);
+		return nullptr;
+	}
+
+	TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(0, Handle->GetFileSize()));
+	if (!Region.IsValid())
+	{
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Unable to map pak file, reading it through an archive! Path: %s."), *InPakFilePath);
+		return nullptr;
+	}
+
+	TUniquePtr<FMappedPakReader> Reader(new FMappedPakReader(MoveTemp(Handle), MoveTemp(Region)));
+
+#if PLATFORM_UNIX || PLATFORM_MAC
+	// Sequential doubles the read ahead and drops pages behind, random stops the kernel from reading pages nobody asked for
+	AdviseSpan(Reader->Data, Reader->Size, InAccessPattern == EAccessPattern::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+#endif
+
+	return Reader;
+#else
+	// A whole pak doesn't fit the address space of a 32 bit process
+	return nullptr;
+#endif
+}
+
+FMappedPakReader::FMappedPakReader(TUniquePtr<IMappedFileHandle>&& InHandle, TUniquePtr<IMappedFileRegion>&& InRegion)
+	: Handle(MoveTemp(InHandle))
+	, Region(MoveTemp(InRegion))
+{
+	Data = Region->GetMappedPtr();
+	Size = Region->GetMappedSize();
+}
+
+FMappedPakReader::~FMappedPakReader()
+{
+	Region.Reset();
+	Handle.Reset();
+}
+
+bool FMappedPakReader::ReadEntry(int64 InOffset, int32 InPakVersion, FPakEntry& OutEntry, int64& OutPayloadOffset) const
+{
+	const uint8* EntryData = GetSpan(InOffset, 0);
+	if (!EntryData)
+	{
+		return false;
+	}
+
+	FMemoryReaderView EntryReader(FMemoryView(EntryData, Size - InOffset));
+	OutEntry.Serialize(EntryReader, InPakVersion);
+	if (EntryReader.IsError())
+	{
+		return false;
+	}
+
+	OutPayloadOffset = InOffset + EntryReader.Tell();
+	return true;
+}
+
+void FMappedPakReader::WillNeed(int64 InOffset, int64 InSize) const
+{
+#if PLATFORM_UNIX || PLATFORM_MAC
+	if (const uint8* Span = GetSpan(InOffset, InSize))
+	{
+		AdviseSpan(Span, InSize, MADV_WILLNEED);
+	}
+#endif
+}
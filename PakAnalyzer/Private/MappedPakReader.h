@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+struct FPakEntry;
+
+/**
+ * Read only mapping of a whole pak file.
+ * Pak bytes are used in place: compressed blocks go straight to the decompressor and unencrypted stored files straight to the output, without a copy into a read buffer.
+ * Only encrypted blocks are still copied, they are decrypted in place.
+ * Reads never change the reader, a parse opens one per pak and shares it between all of its threads.
+ */
+class FMappedPakReader
+{
+public:
+	enum class EAccessPattern : uint8
+	{
+		// Extraction walks the files of a pak in offset order
+		Sequential,
+		// Parsing reads the headers of scattered assets
+		Random,
+	};
+
+	// Off unless MappedPakReads is set in the [UnrealPakViewer] section of the engine ini, see SOptionsWindow
+	static bool IsEnabled();
+	// Null when the pak can't be mapped, callers keep reading through an archive then
+	static TUniquePtr<FMappedPakReader> Open(const FString& InPakFilePath, EAccessPattern InAccessPattern);
+
+	~FMappedPakReader();
+
+	int64 GetSize() const { return Size; }
+	// Null when the span is not inside the pak
+	const uint8* GetSpan(int64 InOffset, int64 InSize) const
+	{
+		return InOffset >= 0 && InSize >= 0 && InOffset <= Size - InSize ? Data + InOffset : nullptr;
+	}
+
+	// Reads the payload header at InOffset, OutPayloadOffset is where the content of the file starts
+	bool ReadEntry(int64 InOffset, int32 InPakVersion, FPakEntry& OutEntry, int64& OutPayloadOffset) const;
+	// Hints that [InOffset, InOffset + InSize) is read soon, the kernel pages it in while earlier blocks are decoded
+	void WillNeed(int64 InOffset, int64 InSize) const;
+
+protected:
+	FMappedPakReader(TUniquePtr<IMappedFileHandle>&& InHandle, TUniquePtr<IMappedFileRegion>&& InRegion);
+
+protected:
+	// Declared first so the region is destroyed before its handle
+	TUniquePtr<IMappedFileHandle> Handle;
+	TUniquePtr<IMappedFileRegion> Region;
+	const uint8* Data;
+	int64 Size;
+};
@@ -0,0 +1,634 @@
+#include "PackageGraph.h"
+
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/ScopeLock.h"
+
+namespace
+{
+	EParallelForFlags GetParallelForFlags()
+	{
+		static const EParallelForFlags ParallelForFlags = FPlatformMisc::IsDebuggerPresent() ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced;
+		return ParallelForFlags;
+	}
+
+	// Counting sort of the edges into one row per source package, every row sorted and without duplicates.
+	// Each task counts and scatters its own slice of the edges, the slices keep their order inside a row
+	void BuildRows(int32 InRowCount, TArrayView<const FPackageEdge> InEdges, TArray<int32>& OutOffsets, TArray<int32>& OutValues)
+	{
+		// A histogram per task, never more of them than the edges are worth
+		const int32 TaskCount = FMath::Clamp(InEdges.Num() / FMath::Max(InRowCount, 65536), 1, FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads()));
+		const int32 SliceSize = FMath::DivideAndRoundUp(InEdges.Num(), TaskCount);
+
+		TArray<int32> Counts;
+		Counts.SetNumZeroed(TaskCount * InRowCount);
+		ParallelFor(TaskCount, [&InEdges, &Counts, InRowCount, SliceSize](int32 TaskIndex)
+		{
+			int32* TaskCounts = Counts.GetData() + TaskIndex * InRowCount;
+			const int32 End = FMath::Min(InEdges.Num(), (TaskIndex + 1) * SliceSize);
+			for (int32 Index = TaskIndex * SliceSize; Index < End; ++Index)
+			{
+				++TaskCounts[InEdges[Index].From];
+			}
+		}, GetParallelForFlags());
+
+		// Counts become the first slot of every task in every row
+		TArray<int32> Starts;
+		Starts.SetNumUninitialized(InRowCount + 1);
+		int32 Total = 0;
+		for (int32 Row = 0; Row < InRowCount; ++Row)
+		{
+			Starts[Row] = Total;
+			for (int32 TaskIndex = 0; TaskIndex < TaskCount; ++TaskIndex)
+			{
+				const int32 Count = Counts[TaskIndex * InRowCount + Row];
+				Counts[TaskIndex * InRowCount + Row] = Total;
+				Total += Count;
+			}
+		}
+		Starts[InRowCount] = Total;
+
+		TArray<int32> Values;
+		Values.SetNumUninitialized(InEdges.Num());
+		ParallelFor(TaskCount, [&InEdges, &Counts, &Values, InRowCount, SliceSize](int32 TaskIndex)
+		{
+			int32* Cursors = Counts.GetData() + TaskIndex * InRowCount;
+			const int32 End = FMath::Min(InEdges.Num(), (TaskIndex + 1) * SliceSize);
+			for (int32 Index = TaskIndex * SliceSize; Index < End; ++Index)
+			{
+				Values[Cursors[InEdges[Index].From]++] = InEdges[Index].To;
+			}
+		}, GetParallelForFlags());
+		Counts.Empty();
+
+		TArray<int32> RowLengths;
+		RowLengths.SetNumUninitialized(InRowCount);
+		ParallelFor(InRowCount, [&Starts, &Values, &RowLengths](int32 Row)
+		{
+			int32* RowValues = Values.GetData() + Starts[Row];
+			const int32 Count = Starts[Row + 1] - Starts[Row];
+			Sort(RowValues, Count);
+
+			int32 UniqueCount = 0;
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				if (UniqueCount == 0 || RowValues[UniqueCount - 1] != RowValues[Index])
+				{
+					RowValues[UniqueCount++] = RowValues[Index];
+				}
+			}
+			RowLengths[Row] = UniqueCount;
+		}, GetParallelForFlags());
+
+		OutOffsets.SetNumUninitialized(InRowCount + 1);
+		OutOffsets[0] = 0;
+		for (int32 Row = 0; Row < InRowCount; ++Row)
+		{
+			OutOffsets[Row + 1] = OutOffsets[Row] + RowLengths[Row];
+		}
+
+		OutValues.SetNumUninitialized(OutOffsets[InRowCount]);
+		for (int32 Row = 0; Row < InRowCount; ++Row)
+		{
+			FMemory::Memcpy(OutValues.GetData() + OutOffsets[Row], Values.GetData() + Starts[Row], RowLengths[Row] * sizeof(int32));
+		}
+	}
+
+	// Rows are visited in source order, so every reversed row comes out sorted
+	void ReverseRows(int32 InRowCount, const TArray<int32>& InOffsets, const TArray<int32>& InValues, TArray<int32>& OutOffsets, TArray<int32>& OutValues)
+	{
+		OutOffsets.SetNumZeroed(InRowCount + 1);
+		for (int32 Value : InValues)
+		{
+			++OutOffsets[Value + 1];
+		}
+		for (int32 Row = 1; Row <= InRowCount; ++Row)
+		{
+			OutOffsets[Row] += OutOffsets[Row - 1];
+		}
+
+		OutValues.SetNumUninitialized(InValues.Num());
+		TArray<int32> Cursors(OutOffsets.GetData(), InRowCount);
+		for (int32 Row = 0; Row < InRowCount; ++Row)
+		{
+			for (int32 Index = InOffsets[Row]; Index < InOffsets[Row + 1]; ++Index)
+			{
+				OutValues[Cursors[InValues[Index]]++] = Row;
+			}
+		}
+	}
+}
+
+void FPackageGraph::GetCycles(TArray<TArray<int32>>& OutCycles) const
+{
+	OutCycles.Reset();
+
+	for (int32 Component = 0; Component < GetComponentCount(); ++Component)
+	{
+		TArrayView<const int32> Packages = GetComponentPackages(Component);
+		if (CyclicPackages[Packages[0]])
+		{
+			OutCycles.Emplace(Packages.GetData(), Packages.Num());
+		}
+	}
+}
+
+void FPackageGraph::GetTransitiveDependencies(int32 InPackageId, TArray<int32>& OutPackages) const
+{
+	GetReachable(InPackageId, false, OutPackages);
+}
+
+void FPackageGraph::GetTransitiveDependents(int32 InPackageId, TArray<int32>& OutPackages) const
+{
+	GetReachable(InPackageId, true, OutPackages);
+}
+
+void FPackageGraph::GetReachable(int32 InPackageId, bool bDependents, TArray<int32>& OutPackages) const
+{
+	OutPackages.Reset();
+	if (!IsValidPackage(InPackageId))
+	{
+		return;
+	}
+
+	// Breadth first, the queue is the result
+	TBitArray<> Visited(false, Num());
+	Visited[InPackageId] = true;
+	OutPackages.Add(InPackageId);
+
+	for (int32 Head = 0; Head < OutPackages.Num(); ++Head)
+	{
+		const int32 Current = OutPackages[Head];
+		for (int32 Next : bDependents ? GetDependents(Current) : GetDependencies(Current))
+		{
+			if (!Visited[Next])
+			{
+				Visited[Next] = true;
+				OutPackages.Add(Next);
+			}
+		}
+	}
+
+	OutPackages.RemoveAt(0, 1, false);
+}
+
+bool FPackageGraph::ComputeReachableWeights(TArrayView<const int64> InWeights, int32 InChannelCount, bool bDependents, TArray<int64>& OutWeights, TFunctionRef<bool()> IsAborted) const
+{
+	check(InChannelCount > 0 && InWeights.Num() == Num() * InChannelCount);
+
+	const int32 ComponentCount = GetComponentCount();
+
+	TArray<int64> ComponentWeights;
+	ComponentWeights.SetNumZeroed(ComponentCount * InChannelCount);
+	for (int32 Package = 0; Package < Num(); ++Package)
+	{
+		for (int32 Channel = 0; Channel < InChannelCount; ++Channel)
+		{
+			ComponentWeights[ComponentIds[Package] * InChannelCount + Channel] += InWeights[Package * InChannelCount + Channel];
+		}
+	}
+
+	TArray<int32> NextOffsets;
+	TArray<int32> NextComponents;
+	BuildComponentRows(bDependents, NextOffsets, NextComponents);
+
+	// Only a component with a weight adds to the sums, the others are never tracked
+	TArray<int32> Targets;
+	for (int32 Component = 0; Component < ComponentCount; ++Component)
+	{
+		for (int32 Channel = 0; Channel < InChannelCount; ++Channel)
+		{
+			if (ComponentWeights[Component * InChannelCount + Channel] != 0)
+			{
+				Targets.Add(Component);
+				break;
+			}
+		}
+	}
+
+	// Targets are taken a block at a time, every component gets a bit mask of the targets of the block it reaches.
+	// A component reaches lower components along dependencies and higher ones along dependents, so walking the components the other way round
+	// finds every mask it ORs in already done, one pass over the condensed edges per block instead of a walk per component.
+	constexpr int32 BlockWords = 4;
+	constexpr int32 BlockSize = BlockWords * 64;
+	const int32 BlockCount = FMath::DivideAndRoundUp(Targets.Num(), BlockSize);
+	const int32 TaskCount = FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1, FMath::Max(1, BlockCount));
+
+	TArray<TArray<int64>> TaskWeights;
+	TaskWeights.SetNum(TaskCount);
+
+	ParallelFor(TaskCount, [bDependents, InChannelCount, ComponentCount, BlockCount, TaskCount, &ComponentWeights, &NextOffsets, &NextComponents, &Targets, &TaskWeights, &IsAborted](int32 TaskIndex)
+	{
+		TArray<int64>& Weights = TaskWeights[TaskIndex];
+		Weights.SetNumZeroed(ComponentCount * InChannelCount);
+
+		TArray<uint64> Masks;
+		Masks.SetNumUninitialized(ComponentCount * BlockWords);
+		// Summed weights of the targets set in every value of every byte of a mask, so a mask is added up a byte at a time
+		TArray<int64> ByteSums;
+		ByteSums.SetNumUninitialized(BlockWords * 8 * 256 * InChannelCount);
+
+		for (int32 Block = TaskIndex; Block < BlockCount; Block += TaskCount)
+		{
+			if (IsAborted())
+			{
+				return;
+			}
+
+			const int32 FirstTarget = Block * BlockSize;
+			const int32 TargetCount = FMath::Min(BlockSize, Targets.Num() - FirstTarget);
+
+			FMemory::Memzero(ByteSums.GetData(), ByteSums.Num() * sizeof(int64));
+			for (int32 Bit = 0; Bit < TargetCount; ++Bit)
+			{
+				const int64* TargetWeights = &ComponentWeights[Targets[FirstTarget + Bit] * InChannelCount];
+				int64* Sums = &ByteSums[(Bit / 8) * 256 * InChannelCount];
+				for (int32 Value = 0; Value < 256; ++Value)
+				{
+					if (Value & (1 << (Bit % 8)))
+					{
+						for (int32 Channel = 0; Channel < InChannelCount; ++Channel)
+						{
+							Sums[Value * InChannelCount + Channel] += TargetWeights[Channel];
+						}
+					}
+				}
+			}
+
+			// Components out of this range reach no target of the block and keep no mask
+			const int32 First = bDependents ? 0 : Targets[FirstTarget];
+			const int32 Last = bDependents ? Targets[FirstTarget + TargetCount - 1] : ComponentCount - 1;
+			int32 TargetBit = bDependents ? TargetCount - 1 : 0;
+
+			for (int32 Step = 0; Step <= Last - First; ++Step)
+			{
+				const int32 Component = bDependents ? Last - Step : First + Step;
+				uint64* Mask = &Masks[Component * BlockWords];
+				FMemory::Memzero(Mask, BlockWords * sizeof(uint64));
+
+				if (TargetBit >= 0 && TargetBit < TargetCount && Targets[FirstTarget + TargetBit] == Component)
+				{
+					Mask[TargetBit / 64] |= 1ull << (TargetBit % 64);
+					TargetBit += bDependents ? -1 : 1;
+				}
+
+				for (int32 Index = NextOffsets[Component]; Index < NextOffsets[Component + 1]; ++Index)
+				{
+					const int32 Next = NextComponents[Index];
+					if (Next >= First && Next <= Last)
+					{
+						const uint64* NextMask = &Masks[Next * BlockWords];
+						for (int32 Word = 0; Word < BlockWords; ++Word)
+						{
+							Mask[Word] |= NextMask[Word];
+						}
+					}
+				}
+
+				int64* ComponentSums = &Weights[Component * InChannelCount];
+				for (int32 Word = 0; Word < BlockWords; ++Word)
+				{
+					for (uint64 Bits = Mask[Word]; Bits != 0; )
+					{
+						const int32 Byte = (int32)FMath::CountTrailingZeros64(Bits) / 8;
+						const int32 Value = (int32)((Bits >> (Byte * 8)) & 0xFF);
+						Bits &= ~(0xFFull << (Byte * 8));
+
+						const int64* Sums = &ByteSums[((Word * 8 + Byte) * 256 + Value) * InChannelCount];
+						for (int32 Channel = 0; Channel < InChannelCount; ++Channel)
+						{
+							ComponentSums[Channel] += Sums[Channel];
+						}
+					}
+				}
+			}
+		}
+	}, GetParallelForFlags());
+
+	if (IsAborted())
+	{
+		return false;
+	}
+
+	OutWeights.SetNumUninitialized(Num() * InChannelCount);
+	for (int32 Package = 0; Package < Num(); ++Package)
+	{
+		for (int32 Channel = 0; Channel < InChannelCount; ++Channel)
+		{
+			int64 Weight = 0;
+			for (const TArray<int64>& Weights : TaskWeights)
+			{
+				Weight += Weights[ComponentIds[Package] * InChannelCount + Channel];
+			}
+			OutWeights[Package * InChannelCount + Channel] = Weight;
+		}
+	}
+
+	return true;
+}
+
+bool FPackageGraph::ComputeReachableCounts(bool bDependents, TArray<int32>& OutCounts, TFunctionRef<bool()> IsAborted) const
+{
+	TArray<int64> Ones;
+	Ones.Init(1, Num());
+
+	TArray<int64> Weights;
+	if (!ComputeReachableWeights(Ones, 1, bDependents, Weights, IsAborted))
+	{
+		return false;
+	}
+
+	OutCounts.SetNumUninitialized(Num());
+	for (int32 Package = 0; Package < Num(); ++Package)
+	{
+		OutCounts[Package] = (int32)Weights[Package] - 1;
+	}
+
+	return true;
+}
+
+void FPackageGraph::BuildComponentRows(bool bDependents, TArray<int32>& OutOffsets, TArray<int32>& OutComponents) const
+{
+	const int32 ComponentCount = GetComponentCount();
+
+	TArray<int32> Stamps;
+	Stamps.Init(INDEX_NONE, ComponentCount);
+
+	OutOffsets.SetNumUninitialized(ComponentCount + 1);
+	OutOffsets[0] = 0;
+	OutComponents.Reset();
+
+	for (int32 Component = 0; Component < ComponentCount; ++Component)
+	{
+		// Edges inside a cycle stay out, a component never lists itself
+		Stamps[Component] = Component;
+		for (int32 Package : GetComponentPackages(Component))
+		{
+			for (int32 Next : bDependents ? GetDependents(Package) : GetDependencies(Package))
+			{
+				const int32 NextComponent = ComponentIds[Next];
+				if (Stamps[NextComponent] != Component)
+				{
+					Stamps[NextComponent] = Component;
+					OutComponents.Add(NextComponent);
+				}
+			}
+		}
+		OutOffsets[Component + 1] = OutComponents.Num();
+	}
+}
+
+void FPackageGraph::BuildComponents()
+{
+	const int32 PackageCount = Num();
+
+	ComponentIds.Init(INDEX_NONE, PackageCount);
+	CyclicPackages.Init(false, PackageCount);
+	ComponentOffsets.Reset();
+	ComponentOffsets.Add(0);
+	ComponentPackages.Reset(PackageCount);
+
+	// Iterative Tarjan, a component is closed after every component it depends on
+	struct FFrame
+	{
+		int32 Package;
+		int32 NextEdge;
+	};
+
+	TArray<int32> Indices;
+	Indices.Init(INDEX_NONE, PackageCount);
+	TArray<int32> LowLinks;
+	LowLinks.SetNumUninitialized(PackageCount);
+	TArray<int32> Stack;
+	TArray<FFrame> CallStack;
+	int32 NextIndex = 0;
+
+	for (int32 Root = 0; Root < PackageCount; ++Root)
+	{
+		if (Indices[Root] != INDEX_NONE)
+		{
+			continue;
+		}
+
+		Indices[Root] = LowLinks[Root] = NextIndex++;
+		Stack.Push(Root);
+		CallStack.Push({ Root, DependencyOffsets[Root] });
+
+		while (CallStack.Num() > 0)
+		{
+			FFrame& Frame = CallStack.Last();
+			const int32 Package = Frame.Package;
+
+			if (Frame.NextEdge < DependencyOffsets[Package + 1])
+			{
+				const int32 Dependency = Dependencies[Frame.NextEdge++];
+				if (Indices[Dependency] == INDEX_NONE)
+				{
+					Indices[Dependency] = LowLinks[Dependency] = NextIndex++;
+					Stack.Push(Dependency);
+					CallStack.Push({ Dependency, DependencyOffsets[Dependency] });
+				}
+				else if (ComponentIds[Dependency] == INDEX_NONE)
+				{
+					// Visited and not closed yet, so still on the stack
+					LowLinks[Package] = FMath::Min(LowLinks[Package], Indices[Dependency]);
+				}
+				continue;
+			}
+
+			if (LowLinks[Package] == Indices[Package])
+			{
+				const int32 Component = ComponentOffsets.Num() - 1;
+				int32 Member = INDEX_NONE;
+				do
+				{
+					Member = Stack.Pop(false);
+					ComponentIds[Member] = Component;
+					ComponentPackages.Add(Member);
+				} while (Member != Package);
+
+				ComponentOffsets.Add(ComponentPackages.Num());
+			}
+
+			CallStack.Pop(false);
+			if (CallStack.Num() > 0)
+			{
+				const int32 Parent = CallStack.Last().Package;
+				LowLinks[Parent] = FMath::Min(LowLinks[Parent], LowLinks[Package]);
+			}
+		}
+	}
+
+	for (int32 Component = 0; Component < GetComponentCount(); ++Component)
+	{
+		TArrayView<const int32> Packages = GetComponentPackages(Component);
+		if (Packages.Num() > 1)
+		{
+			for (int32 Package : Packages)
+			{
+				CyclicPackages[Package] = true;
+			}
+		}
+		else
+		{
+			TArrayView<const int32> PackageDependencies = GetDependencies(Packages[0]);
+			CyclicPackages[Packages[0]] = Algo::BinarySearch(PackageDependencies, Packages[0]) != INDEX_NONE;
+		}
+	}
+}
+
+FPackageDependencies::FPackageDependencies()
+	: Graph(MakeShared<FPackageGraph, ESPMode::ThreadSafe>())
+{
+}
+
+void FPackageDependencies::Reset()
+{
+	FScopeLock UpdateScope(&UpdateLock);
+	FWriteScopeLock WriteLock(Lock);
+
+	PackageIds.Empty();
+	PackageNames.Empty();
+	Graph = MakeShared<FPackageGraph, ESPMode::ThreadSafe>();
+}
+
+int32 FPackageDependencies::FindOrAddPackage(FName InPackage)
+{
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const int32* PackageId = PackageIds.Find(InPackage))
+		{
+			return *PackageId;
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	return FindOrAddPackageLocked(InPackage);
+}
+
+int32 FPackageDependencies::FindPackage(FName InPackage) const
+{
+	FReadScopeLock ReadLock(Lock);
+	const int32* PackageId = PackageIds.Find(InPackage);
+	return PackageId ? *PackageId : INDEX_NONE;
+}
+
+int32 FPackageDependencies::FindOrAddPackageLocked(FName InPackage)
+{
+	if (const int32* PackageId = PackageIds.Find(InPackage))
+	{
+		return *PackageId;
+	}
+
+	const int32 PackageId = PackageNames.Add(InPackage);
+	PackageIds.Add(InPackage, PackageId);
+	return PackageId;
+}
+
+void FPackageDependencies::FindOrAddPackages(TArrayView<const FName> InPackages, TArray<int32>& OutPackageIds)
+{
+	OutPackageIds.SetNumUninitialized(InPackages.Num());
+
+	FWriteScopeLock WriteLock(Lock);
+	for (int32 Index = 0; Index < InPackages.Num(); ++Index)
+	{
+		OutPackageIds[Index] = InPackages[Index].IsNone() ? INDEX_NONE : FindOrAddPackageLocked(InPackages[Index]);
+	}
+}
+
+void FPackageDependencies::Update(TArrayView<const FName> InClearedPackages, TArrayView<const FPackageDependency> InDependencies, bool bSkipKnownPackages)
+{
+	TArray<int32> ClearedIds;
+	TArray<FPackageEdge> Edges;
+	{
+		FWriteScopeLock WriteLock(Lock);
+
+		ClearedIds.Reserve(InClearedPackages.Num());
+		for (const FName& Package : InClearedPackages)
+		{
+			ClearedIds.Add(FindOrAddPackageLocked(Package));
+		}
+
+		Edges.Reserve(InDependencies.Num());
+		for (const FPackageDependency& Dependency : InDependencies)
+		{
+			Edges.Add({ FindOrAddPackageLocked(Dependency.Package), FindOrAddPackageLocked(Dependency.Dependency) });
+		}
+	}
+
+	UpdateEdges(ClearedIds, Edges, bSkipKnownPackages);
+}
+
+void FPackageDependencies::UpdateEdges(TArrayView<const int32> InClearedPackageIds, TArrayView<const FPackageEdge> InEdges, bool bSkipKnownPackages)
+{
+	FScopeLock UpdateScope(&UpdateLock);
+
+	const FPackageGraphPtr OldGraph = GetGraph();
+	TSharedRef<FPackageGraph, ESPMode::ThreadSafe> NewGraph = MakeShared<FPackageGraph, ESPMode::ThreadSafe>();
+	{
+		FReadScopeLock ReadLock(Lock);
+		NewGraph->PackageNames = PackageNames;
+	}
+
+	const int32 PackageCount = NewGraph->Num();
+	TBitArray<> Cleared(false, PackageCount);
+	for (int32 PackageId : InClearedPackageIds)
+	{
+		Cleared[PackageId] = true;
+	}
+
+	TArray<FPackageEdge> Edges;
+	Edges.Reserve(OldGraph->GetEdgeCount() + InEdges.Num());
+	for (int32 From = 0; From < OldGraph->Num(); ++From)
+	{
+		if (!Cleared[From])
+		{
+			for (int32 To : OldGraph->GetDependencies(From))
+			{
+				Edges.Add({ From, To });
+			}
+		}
+	}
+
+	for (const FPackageEdge& Edge : InEdges)
+	{
+		check(Edge.From >= 0 && Edge.From < PackageCount && Edge.To >= 0 && Edge.To < PackageCount);
+		if (bSkipKnownPackages && !Cleared[Edge.From] && OldGraph->GetDependencyCount(Edge.From) > 0)
+		{
+			continue;
+		}
+		Edges.Add(Edge);
+	}
+
+	BuildRows(PackageCount, Edges, NewGraph->DependencyOffsets, NewGraph->Dependencies);
+	Edges.Empty();
+	ReverseRows(PackageCount, NewGraph->DependencyOffsets, NewGraph->Dependencies, NewGraph->DependentOffsets, NewGraph->Dependents);
+	NewGraph->BuildComponents();
+
+	FWriteScopeLock WriteLock(Lock);
+	Graph = NewGraph;
+}
+
+FPackageGraphPtr FPackageDependencies::GetGraph() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Graph;
+}
+
+FPackageLoadCostsPtr FPackageLoadCosts::Compute(FPackageGraphPtr InGraph, TArray<int64>&& InExclusiveSizes, TFunctionRef<bool()> IsAborted)
+{
+	check(InGraph.IsValid() && InExclusiveSizes.Num() == InGraph->Num() * 2);
+
+	TSharedPtr<FPackageLoadCosts, ESPMode::ThreadSafe> LoadCosts = MakeShared<FPackageLoadCosts, ESPMode::ThreadSafe>();
+	// One walk per component sums both sizes, members of a cycle share the result
+	if (!InGraph->ComputeReachableWeights(InExclusiveSizes, 2, false, LoadCosts->TransitiveSizes, IsAborted))
+	{
+		return nullptr;
+	}
+
+	LoadCosts->Graph = MoveTemp(InGraph);
+	LoadCosts->ExclusiveSizes = MoveTemp(InExclusiveSizes);
+	return LoadCosts;
+}
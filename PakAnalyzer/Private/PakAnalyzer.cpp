@@ -5,6 +5,8 @@
 #include "AssetRegistry/ARFilter.h"
 #include "AssetRegistry/AssetData.h"
 #include "AssetRegistry/AssetRegistryState.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "HAL/FileManager.h"
 #include "HAL/PlatformFile.h"
 #include "HAL/PlatformMisc.h"
@@ -18,6 +20,7 @@
 #include "PakParseThreadWorker.h"
 #include "CommonDefines.h"
 #include "ExtractThreadWorker.h"
+#include "MappedPakReader.h"
 
 typedef FPakFile::FPakEntryIterator RecordIterator;
 
@@ -36,12 +39,13 @@ FPakAnalyzer::~FPakAnalyzer()
 	Reset();
 }
 
-FPakTreeEntryPtr FPakAnalyzer::LoadPakFile(const FString& InPakPath, const FString& InDefaultAESKey/* = TEXT("")*/)
+bool FPakAnalyzer::PrepareLoadPakFile(FPakLoadContext& InContext, const FString& InDefaultAESKey)
 {
+	const FString& InPakPath = InContext.PakPath;
 	if (InPakPath.IsEmpty())
 	{
 		UE_LOG(LogPakAnalyzer, Error, TEXT("Load pak file failed! Pak path is empty!"));
-		return nullptr;
+		return false;
 	}
 
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Start load pak file: %s."), *InPakPath);
@@ -51,43 +55,74 @@ FPakTreeEntryPtr FPakAnalyzer::LoadPakFile(const FString& InPakPath, const FStri
 	{
 		FPakAnalyzerDelegates::OnLoadPakFailed.ExecuteIfBound(FString::Printf(TEXT("Load pak file failed! Pak file not exists! Path: %s."), *InPakPath));
 		UE_LOG(LogPakAnalyzer, Error, TEXT("Load pak file failed! Pak file not exists! Path: %s."), *InPakPath);
-		return nullptr;
+		return false;
 	}
 
-	FString DecryptAESKey;
-	if (!PreLoadPak(InPakPath, InDefaultAESKey, DecryptAESKey))
+	if (!PreLoadPak(InPakPath, InDefaultAESKey, InContext.DecryptAESKey, InContext.PakInfo))
 	{
 		UE_LOG(LogPakAnalyzer, Error, TEXT("Load pak file failed! Pre load pak file failed! Path: %s."), *InPakPath);
-		return nullptr;
+		return false;
 	}
-	
-	TRefCountPtr<FPakFile> PakFile = new FPakFile(*InPakPath, false);
-	FPakFile* PakFilePtr = PakFile.GetReference();
+
+	// The key includes the index hash from the trailer, a rebuilt pak never matches an old cache
+	if (FPakIndexCache::IsEnabled() && FPakIndexCache::MakeKey(InPakPath, InContext.PakInfo, InContext.IndexCacheKey))
+	{
+		InContext.bHasIndexCacheKey = true;
+
+		TSharedPtr<FPakIndexCache> IndexCache = MakeShared<FPakIndexCache>(InContext.IndexCacheKey);
+		if (IndexCache->Open())
+		{
+			InContext.IndexCache = IndexCache;
+		}
+	}
+
+	// FPakFile decrypts its index through the global pak encryption key delegate, which only holds the key of the pak prompted last.
+	// Open encrypted indices right away while the delegate still points at this pak's key, the rest are opened on the worker threads.
+	if (!InContext.IndexCache.IsValid() && InContext.PakInfo.bEncryptedIndex && !OpenPakFile(InContext))
+	{
+		FPakAnalyzerDelegates::OnLoadPakFailed.ExecuteIfBound(InContext.ErrorMessage);
+		return false;
+	}
+
+	return true;
+}
+
+bool FPakAnalyzer::OpenPakFile(FPakLoadContext& InContext)
+{
+	const FString& InPakPath = InContext.PakPath;
+
+	InContext.PakFile = new FPakFile(*InPakPath, false);
+	FPakFile* PakFilePtr = InContext.PakFile.GetReference();
 	if (!PakFilePtr)
 	{
-		FPakAnalyzerDelegates::OnLoadPakFailed.ExecuteIfBound(FString::Printf(TEXT("Load pak file failed! Create PakFile failed! Path: %s."), *InPakPath));
+		InContext.ErrorMessage = FString::Printf(TEXT("Load pak file failed! Create PakFile failed! Path: %s."), *InPakPath);
 		UE_LOG(LogPakAnalyzer, Error, TEXT("Load pak file failed! Create PakFile failed! Path: %s."), *InPakPath);
 
-		return nullptr;
+		return false;
 	}
 
 	if (!PakFilePtr->IsValid())
 	{
-		FPakAnalyzerDelegates::OnLoadPakFailed.ExecuteIfBound(FString::Printf(TEXT("Load pak file failed! Unable to open pak file! Path: %s."), *InPakPath));
+		InContext.PakFile.SafeRelease();
+		InContext.ErrorMessage = FString::Printf(TEXT("Load pak file failed! Unable to open pak file! Path: %s."), *InPakPath);
 		UE_LOG(LogPakAnalyzer, Error, TEXT("Load pak file failed! Unable to open pak file! Path: %s."), *InPakPath);
 
-		return nullptr;
+		return false;
 	}
 
-	// Save pak sumary
+	return true;
+}
+
+void FPakAnalyzer::MakePakFileSummary(FPakLoadContext& InContext, const FString& InMountPoint, int64 InPakFileSize)
+{
 	FPakFileSumaryPtr Summary = MakeShared<FPakFileSumary>();
-	PakFileSummaries.Add(Summary);
-	const int32 SummaryIndex = PakFileSummaries.Num() - 1;
+	InContext.Summary = Summary;
 
-	Summary->MountPoint = PakFilePtr->GetMountPoint();
-	Summary->PakInfo = PakFilePtr->GetInfo();
-	Summary->PakFilePath = InPakPath;
-	Summary->PakFileSize = PakFilePtr->TotalSize();
+	const FString& DecryptAESKey = InContext.DecryptAESKey;
+	Summary->MountPoint = InMountPoint;
+	Summary->PakInfo = InContext.PakFile.IsValid() ? InContext.PakFile->GetInfo() : InContext.PakInfo;
+	Summary->PakFilePath = InContext.PakPath;
+	Summary->PakFileSize = InPakFileSize;
 	Summary->DecryptAESKeyStr = DecryptAESKey;
 	if (!FBase64::Decode(*DecryptAESKey, DecryptAESKey.Len(), Summary->DecryptAESKey.Key))
 	{
@@ -100,63 +135,110 @@ FPakTreeEntryPtr FPakAnalyzer::LoadPakFile(const FString& InPakPath, const FStri
 		Methods.Add(Name.ToString());
 	}
 	Summary->CompressionMethods = FString::Join(Methods, TEXT(", "));
+}
 
-	// Make tree root
-	FPakTreeEntryPtr PakTreeRoot = MakeShared<FPakTreeEntry>(*FPaths::GetCleanFilename(InPakPath), Summary->MountPoint, true);
+bool FPakAnalyzer::LoadPakFileFromCache(FPakLoadContext& InContext)
+{
+	const FPakIndexCache& IndexCache = *InContext.IndexCache;
 
-	UE_LOG(LogPakAnalyzer, Log, TEXT("Load all file info from pak."));
+	MakePakFileSummary(InContext, IndexCache.GetMountPoint(), InContext.IndexCacheKey.PakFileSize);
 
-	// Iterate Files
-	struct FPakEntryWithFilename
-	{
-		FPakEntry Entry;
-		FString Filename;
-	};
+	FPakTreeEntryPtr PakTreeRoot = MakeTreeRoot(InContext.PakPath, InContext.Summary->MountPoint, InContext.PakIndex);
+	InContext.TreeRoot = PakTreeRoot;
 
-	TArray<FPakEntryWithFilename> Records;
-	for (RecordIterator It(*PakFilePtr, true); It; ++It)
+	if (!IndexCache.LoadTree(PakTreeRoot, InContext.AssetRegistryFiles))
 	{
-		const FString& Filename = *It.TryGetFilename();
-		Records.Add({ It.Info(), Filename });
+		return false;
 	}
 
+	// Classes come from the cache, only the per directory statistics need rebuilding
+	RefreshTreeNode(PakTreeRoot);
+	RefreshTreeNodeSizePercent(PakTreeRoot);
+	RefreshClassInfo(PakTreeRoot);
+
+	InContext.Summary->FileCount = PakTreeRoot->FileCount;
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Finish load pak file from index cache: %s."), *InContext.PakPath);
+
+	return true;
+}
+
+bool FPakAnalyzer::LoadPakFile(FPakLoadContext& InContext)
+{
+	const FString& InPakPath = InContext.PakPath;
+
+	if (InContext.IndexCache.IsValid())
 	{
-		FScopeLock Lock(&CriticalSection);
+		if (LoadPakFileFromCache(InContext))
+		{
+			return true;
+		}
+
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Load index cache failed, fall back to pak index! Path: %s."), *InPakPath);
 
-		for (FPakEntryWithFilename& Record : Records)
+		InContext.IndexCache->Invalidate();
+		InContext.IndexCache.Reset();
+		InContext.AssetRegistryFiles.Empty();
+
+		// The key delegate may belong to another pak by now
+		if (InContext.PakInfo.bEncryptedIndex)
 		{
-			FPakTreeEntryPtr Child = nullptr;
+			InContext.ErrorMessage = FString::Printf(TEXT("Load pak file failed! Index cache is broken, please reopen the pak! Path: %s."), *InPakPath);
+			return false;
+		}
+	}
 
-			FPakEntry& PakEntry = Record.Entry;
+	if (!InContext.PakFile.IsValid() && !OpenPakFile(InContext))
+	{
+		return false;
+	}
 
-			if (PakEntry.CompressionBlocks.Num() == 1)
-			{
-				PakEntry.CompressionBlockSize = PakEntry.UncompressedSize;
-			}
-			
-			PakFilePtr->ReadHashFromPayload(PakEntry, PakEntry.Hash);
+	FPakFile* PakFilePtr = InContext.PakFile.GetReference();
+
+	// Save pak sumary
+	MakePakFileSummary(InContext, PakFilePtr->GetMountPoint(), PakFilePtr->TotalSize());
+	FPakFileSumaryPtr Summary = InContext.Summary;
 
-			FString FullFilePath = Summary->MountPoint / Record.Filename;
-			FullFilePath.ReplaceInline(TEXT("../"), TEXT(""));
-			FullFilePath.ReplaceInline(TEXT("..\\"), TEXT(""));
+	// Make tree root
+	FPakTreeEntryPtr PakTreeRoot = MakeTreeRoot(InPakPath, Summary->MountPoint, InContext.PakIndex);
+	PakTreeRoot->FileTable->Reserve(PakFilePtr->GetNumFiles());
+	InContext.TreeRoot = PakTreeRoot;
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Load all file info from pak."));
 
-			Child = InsertFileToTree(PakTreeRoot, *Summary, FullFilePath, PakEntry);
-			Child->OwnerPakIndex = SummaryIndex;
-			if (Child.IsValid() && Child->Filename.ToString().EndsWith(TEXT("AssetRegistry.bin")))
+	// Iterate Files
+	for (RecordIterator It(*PakFilePtr, true); It; ++It)
+	{
+		FPakEntry PakEntry = It.Info();
+
+		if (PakEntry.CompressionBlocks.Num() == 1)
+		{
+			PakEntry.CompressionBlockSize = PakEntry.UncompressedSize;
+		}
+
+		FString FullFilePath = Summary->MountPoint / *It.TryGetFilename();
+		FullFilePath.ReplaceInline(TEXT("../"), TEXT(""));
+		FullFilePath.ReplaceInline(TEXT("..\\"), TEXT(""));
+
+		FPakTreeEntryPtr Child = InsertFileToTree(PakTreeRoot, *Summary, FullFilePath, PakEntry);
+		if (Child.IsValid())
+		{
+			Child->bHashLoaded = false;
+			if (Child->Filename.ToString().EndsWith(TEXT("AssetRegistry.bin")))
 			{
-				LoadAssetRegistryFromPak(PakFilePtr, Child, Summary->DecryptAESKey);
+				InContext.AssetRegistryFiles.Add(Child);
 			}
 		}
 	}
 
 	RefreshTreeNode(PakTreeRoot);
-	RefreshTreeNodeSizePercent(PakTreeRoot, PakTreeRoot);
+	RefreshTreeNodeSizePercent(PakTreeRoot);
 
 	Summary->FileCount = PakTreeRoot->FileCount;
 
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Finish load pak file: %s."), *InPakPath);
 
-	return PakTreeRoot;
+	return true;
 }
 
 bool FPakAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TArray<FString>& InDefaultAESKeys, int32 ContainerStartIndex)
@@ -182,28 +264,170 @@ bool FPakAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TArray<
 		return false;
 	}
 
-	Reset();
+	// State of the last load was cleared on the game thread, see LoadPakFilesAsync
 	DefaultAESKeys = UsedDefaultAESKeys;
 
-	for (int32 i = 0; i < PakFiles.Num(); ++i)
+	// Trailer and AES key prompt run one by one in pak order, so the key dialogs show up exactly as before
+	SetLoadPhase(EPakLoadPhase::ReadingTrailers);
+
+	TArray<FPakLoadContext> LoadContexts;
+	LoadContexts.Reserve(PakFiles.Num());
+	for (int32 i = 0; i < PakFiles.Num() && !IsLoadCancelled(); ++i)
+	{
+		AdvanceLoadStep();
+
+		FPakLoadContext Context;
+		Context.PakPath = PakFiles[i];
+		Context.PakIndex = LoadContexts.Num();
+
+		if (PrepareLoadPakFile(Context, DefaultAESKeys.IsValidIndex(i) ? DefaultAESKeys[i] : TEXT("")))
+		{
+			LoadContexts.Add(MoveTemp(Context));
+		}
+	}
+
+	// Index decode and tree build of each pak are independent
+	static const EParallelForFlags ParallelForFlags = FPlatformMisc::IsDebuggerPresent() ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced;
+	TArray<bool> LoadResults;
+	LoadResults.AddZeroed(LoadContexts.Num());
+
+	SetLoadPhase(EPakLoadPhase::LoadingIndices);
+
+	ParallelFor(LoadContexts.Num(), [this, &LoadContexts, &LoadResults](int32 Index)
+	{
+		if (IsLoadCancelled())
+		{
+			return;
+		}
+
+		FPakLoadContext& Context = LoadContexts[Index];
+		LoadResults[Index] = LoadPakFile(Context);
+
+		// Shown as soon as its tree is built, classes and dependencies are filled in once every pak is in
+		if (LoadResults[Index] && !IsLoadCancelled())
+		{
+			Context.PakIndex = PublishPak(Context.Summary, Context.TreeRoot);
+			NotifyPakLoaded(Context.Summary, Context.TreeRoot);
+		}
+
+		AdvanceLoadStep();
+	}, ParallelForFlags);
+
+	if (IsLoadCancelled())
 	{
-		FPakTreeEntryPtr PakTreeRoot = LoadPakFile(PakFiles[i], DefaultAESKeys.IsValidIndex(i) ? DefaultAESKeys[i] : TEXT(""));
-		if (PakTreeRoot.IsValid())
+		UE_LOG(LogPakAnalyzer, Log, TEXT("Load pak files cancelled."));
+		return false;
+	}
+
+	SetLoadPhase(EPakLoadPhase::Merging);
+
+	// Every loaded pak is published by now, with the index it got when it finished
+	TArray<FPakLoadContext*> LoadedContexts;
+	for (int32 i = 0; i < LoadContexts.Num(); ++i)
+	{
+		FPakLoadContext& Context = LoadContexts[i];
+		if (!LoadResults[i])
 		{
-			PakTreeRoots.Add(PakTreeRoot);
+			FPakAnalyzerDelegates::OnLoadPakFailed.ExecuteIfBound(Context.ErrorMessage);
+			continue;
+		}
+
+		LoadedContexts.Add(&Context);
+	}
+	LoadedContexts.Sort([](const FPakLoadContext& A, const FPakLoadContext& B) { return A.PakIndex < B.PakIndex; });
+
+	// Summaries, classes and dependencies of the paks that hit their cache come from it, only the other paks read AssetRegistry.bin and go to the asset parse worker
+	FString CachedAssetRegistryPath;
+	TArray<FPackageDependency> CachedDependencies;
+	TMap<FName, FName> CachedClassMap;
+	TArray<FPakTreeEntryPtr> CachedTreeRoots;
+	TArray<FPakLoadContext*> UncachedContexts;
+	for (FPakLoadContext* Context : LoadedContexts)
+	{
+		if (Context->IndexCache.IsValid())
+		{
+			const int32 DependencyCount = CachedDependencies.Num();
+			if (Context->IndexCache->LoadAssetSummaries(Context->TreeRoot, CachedDependencies, CachedClassMap, CachedAssetRegistryPath))
+			{
+				CachedTreeRoots.Add(Context->TreeRoot);
+				continue;
+			}
+
+			UE_LOG(LogPakAnalyzer, Warning, TEXT("Load asset summaries from index cache failed, parse the pak instead! Path: %s."), *Context->PakPath);
+
+			// The tree of the cache is kept, the summaries are parsed and the cache written again
+			CachedDependencies.SetNum(DependencyCount);
+			Context->IndexCache->Invalidate();
+			Context->IndexCache.Reset();
 		}
+
+		UncachedContexts.Add(Context);
 	}
 
-	if (!AssetRegistryPath.IsEmpty())
+	if (CachedTreeRoots.Num() > 0)
 	{
-		for (const FPakTreeEntryPtr& PakTreeRoot : PakTreeRoots)
+		AssetRegistryPath = CachedAssetRegistryPath;
+
+		{
+			FScopeLock Lock(&CriticalSection);
+			DefaultClassMap.Append(CachedClassMap);
+		}
+
+		// Dependents are the reversed edges of the graph, they span every loaded pak
+		PackageDependencies->Update(TArrayView<const FName>(), CachedDependencies);
+		for (const FPakTreeEntryPtr& CachedTreeRoot : CachedTreeRoots)
 		{
-			RefreshClassMap(PakTreeRoot, PakTreeRoot);
-			RefreshPackageDependency(PakTreeRoot, PakTreeRoot);
+			AssignPackageIds(CachedTreeRoot);
 		}
 	}
 
-	ParseAssetFile();
+	TArray<FPakTreeEntryPtr> UncachedTreeRoots;
+	for (FPakLoadContext* Context : UncachedContexts)
+	{
+		UncachedTreeRoots.Add(Context->TreeRoot);
+
+		FPendingIndexCache* PendingIndexCache = nullptr;
+		if (Context->bHasIndexCacheKey)
+		{
+			PendingIndexCache = &PendingIndexCaches.Add(Context->PakIndex);
+			PendingIndexCache->Key = Context->IndexCacheKey;
+			PendingIndexCache->TreeRoot = Context->TreeRoot;
+		}
+
+		for (const FPakFileEntryPtr& AssetRegistryFile : Context->AssetRegistryFiles)
+		{
+			if (LoadAssetRegistryFromPak(*Context->Summary, AssetRegistryFile) && PendingIndexCache)
+			{
+				PendingIndexCache->AssetRegistryPath = AssetRegistryPath;
+			}
+		}
+	}
+
+	if (UncachedTreeRoots.Num() > 0 && !AssetRegistryPath.IsEmpty())
+	{
+		RefreshPackageDependency(UncachedTreeRoots);
+
+		// The trees are shown already and the views read their class maps on the game thread
+		RunOnGameThreadForLoad([this, UncachedTreeRoots]()
+			{
+				for (const FPakTreeEntryPtr& PakTreeRoot : UncachedTreeRoots)
+				{
+					RefreshClassMap(PakTreeRoot);
+				}
+			});
+	}
+
+	if (UncachedTreeRoots.Num() > 0)
+	{
+		ParseAssetFile(UncachedTreeRoots);
+	}
+	else
+	{
+		RunOnGameThreadForLoad([]()
+			{
+				FPakAnalyzerDelegates::OnAssetParseFinish.Broadcast();
+			});
+	}
 
 	//FPakAnalyzerDelegates::OnPakLoadFinish.Broadcast();
 
@@ -220,51 +444,43 @@ void FPakAnalyzer::ExtractFiles(const FString& InOutputPath, TArray<FPakFileEntr
 		return;
 	}
 
-	FPakAnalyzerDelegates::OnExtractStart.ExecuteIfBound();
+	ShutdownAllExtractWorker();
 
-	if (!FPaths::DirectoryExists(InOutputPath))
+	FExtractJobPtr Job = BeginExtractJob(InOutputPath);
+	if (!Job)
 	{
-		IFileManager::Get().MakeDirectory(*InOutputPath, true);
+		return;
 	}
 
-	ShutdownAllExtractWorker();
-
-	// Sort by original size
-	InFiles.Sort([](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
-		{
-			return A->PakEntry.UncompressedSize > B->PakEntry.UncompressedSize;
-		});
-
-	// dispatch files to workers
-	TArray<TArray<FPakFileEntry>> TaskFiles;
-	TaskFiles.AddZeroed(WorkerCount);
-
-	TArray<int64> WorkerSize;
-	WorkerSize.AddZeroed(WorkerCount);
-
-	for (int32 i = 0; i < FileCount; ++i)
+	// All workers pull from one queue, a slow file never leaves the others idle
+	TArray<FPakFileEntry> Files;
+	Files.Reserve(FileCount);
+	int64 TotalBytes = 0;
+	for (const FPakFileEntryPtr& File : InFiles)
 	{
-		int32 MinIndex = 0;
-		FMath::Min(WorkerSize, &MinIndex);
-
-		TaskFiles[MinIndex].Add(*InFiles[i]);
-		WorkerSize[MinIndex] += InFiles[i]->PakEntry.UncompressedSize;
+		Files.Add(*File);
+		TotalBytes += File->PakEntry.UncompressedSize;
 	}
 
-	ResetProgress();
+	Job->AddTotal(FileCount, TotalBytes);
+
+	// Archive members are written whole, so their files are never split into parts
+	TSharedPtr<FExtractTaskQueue> TaskQueue = MakeShared<FExtractTaskQueue>(MoveTemp(Files), !ExtractArchive);
 
+	const TArray<FPakFileSumaryPtr> LoadedSummaries = GetPakFileSumary();
 	TArray<FPakFileSumary> Summaries;
-	Summaries.AddDefaulted(PakFileSummaries.Num());
-	for (int32 i = 0; i < PakFileSummaries.Num(); ++i)
+	Summaries.AddDefaulted(LoadedSummaries.Num());
+	for (int32 i = 0; i < LoadedSummaries.Num(); ++i)
 	{
-		Summaries[i] = *PakFileSummaries[i];
+		Summaries[i] = *LoadedSummaries[i];
 	}
 
 	for (int32 i = 0; i < WorkerCount; ++i)
 	{
-		ExtractWorkers[i]->InitTaskFiles(TaskFiles[i]);
-		ExtractWorkers[i]->StartExtract(Summaries, InOutputPath);
+		ExtractWorkers[i]->StartExtract(TaskQueue, Summaries, InOutputPath, Job, ExtractManifest, ExtractArchive);
 	}
+
+	ReleaseExtractArchive();
 }
 
 void FPakAnalyzer::CancelExtract()
@@ -284,54 +500,155 @@ void FPakAnalyzer::SetExtractThreadCount(int32 InThreadCount)
 	}
 }
 
+void FPakAnalyzer::LoadFileHashes(const TArray<FPakFileEntryPtr>& InFiles)
+{
+	const TArray<FPakFileSumaryPtr> LoadedSummaries = GetPakFileSumary();
+
+	TArray<FPakFileEntryPtr> PendingFiles;
+	for (const FPakFileEntryPtr& File : InFiles)
+	{
+		if (File.IsValid() && !File->bHashLoaded && LoadedSummaries.IsValidIndex(File->OwnerPakIndex))
+		{
+			PendingFiles.Add(File);
+		}
+	}
+
+	if (PendingFiles.Num() <= 0)
+	{
+		return;
+	}
+
+	// Group by pak and read payload headers in offset order, so a large batch is one forward pass over each pak
+	PendingFiles.Sort([](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			if (A->OwnerPakIndex == B->OwnerPakIndex)
+			{
+				return A->PakEntry.Offset < B->PakEntry.Offset;
+			}
+
+			return A->OwnerPakIndex < B->OwnerPakIndex;
+		});
+
+	TUniquePtr<FArchive> ReaderArchive;
+	int32 ReaderIndex = INDEX_NONE;
+
+	for (const FPakFileEntryPtr& File : PendingFiles)
+	{
+		const FPakFileSumary& Summary = *LoadedSummaries[File->OwnerPakIndex];
+		if (File->OwnerPakIndex != ReaderIndex)
+		{
+			ReaderArchive.Reset(IFileManager::Get().CreateFileReader(*Summary.PakFilePath));
+			ReaderIndex = File->OwnerPakIndex;
+
+			if (!ReaderArchive)
+			{
+				UE_LOG(LogPakAnalyzer, Error, TEXT("Load file hash failed! Unable to open pak file! Path: %s."), *Summary.PakFilePath);
+			}
+		}
+
+		FPakEntry& PakEntry = File->PakEntry;
+		if (PakEntry.IsDeleteRecord())
+		{
+			FMemory::Memzero(PakEntry.Hash, sizeof(PakEntry.Hash));
+		}
+		else if (ReaderArchive)
+		{
+			ReaderArchive->Seek(PakEntry.Offset);
+
+			FPakEntry EntryInfo;
+			EntryInfo.Serialize(*ReaderArchive, Summary.PakInfo.Version);
+			FMemory::Memcpy(PakEntry.Hash, EntryInfo.Hash, sizeof(PakEntry.Hash));
+		}
+
+		File->bHashLoaded = true;
+	}
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Load file hashes finished, file count: %d."), PendingFiles.Num());
+}
+
 void FPakAnalyzer::Reset()
 {
 	ShutdownAssetParseWorker();
 	DefaultAESKeys.Empty();
+	PendingIndexCaches.Empty();
+	ParsedTreeRoots.Empty();
+
+	// The caches of the last load are written from the class map cleared below
+	if (SaveIndexCacheTask.IsValid())
+	{
+		SaveIndexCacheTask.Wait();
+		SaveIndexCacheTask.Reset();
+	}
 
 	FBaseAnalyzer::Reset();
 }
 
-bool FPakAnalyzer::LoadAssetRegistryFromPak(FPakFile* InPakFile, FPakFileEntryPtr InPakFileEntry, const FAES::FAESKey& DecryptAESKey)
+bool FPakAnalyzer::LoadAssetRegistryFromPak(const FPakFileSumary& InSummary, FPakFileEntryPtr InPakFileEntry)
 {
-	if (!InPakFile || !InPakFile->IsValid() || !InPakFileEntry.IsValid())
+	if (!InPakFileEntry.IsValid())
 	{
 		return false;
 	}
-	
-	const bool bHasRelativeCompressedChunkOffsets = InPakFile->GetInfo().Version >= FPakInfo::PakFile_Version_RelativeChunkOffsets;
-	
-	const int64 BufferSize = 8 * 1024 * 1024; // 8MB buffer for extracting
-	void* Buffer = FMemory::Malloc(BufferSize);
-	uint8* PersistantCompressionBuffer = NULL;
-	int64 CompressionBufferSize = 0;
-	
-	bool bReadResult = true;
-	const FPakEntry& EntryInfo = InPakFileEntry->PakEntry;
-	
+
+	const FAES::FAESKey& DecryptAESKey = InSummary.DecryptAESKey;
+	const bool bHasRelativeCompressedChunkOffsets = InSummary.PakInfo.Version >= FPakInfo::PakFile_Version_RelativeChunkOffsets;
+
 	FArrayReader ContentReader;
 	ContentReader.AddZeroed(InPakFileEntry->PakEntry.UncompressedSize);
-	
+
 	FMemoryWriter ContentWriter(ContentReader);
-	
-	if (EntryInfo.CompressionMethodIndex == 0)
+
+	bool bReadResult = false;
+
+	// Read straight from the file, paks restored from the index cache have no FPakFile
+	TUniquePtr<FMappedPakReader> MappedReader = FMappedPakReader::IsEnabled() ? FMappedPakReader::Open(InSummary.PakFilePath, FMappedPakReader::EAccessPattern::Sequential) : nullptr;
+	if (MappedReader)
 	{
-		if (!FExtractThreadWorker::BufferedCopyFile(ContentWriter, InPakFile->GetSharedReader(nullptr).GetArchive(), EntryInfo, Buffer, BufferSize, DecryptAESKey))
+		FPakEntry EntryInfo;
+		int64 PayloadOffset = 0;
+		if (MappedReader->ReadEntry(InPakFileEntry->PakEntry.Offset, InSummary.PakInfo.Version, EntryInfo, PayloadOffset) && FExtractThreadWorker::ResolvePayloadEntry(InPakFileEntry->PakEntry, EntryInfo))
 		{
-			bReadResult = false;
+			FExtractPipeline Pipeline;
+			bReadResult = Pipeline.CopyFile(ContentWriter, *MappedReader, EntryInfo, PayloadOffset, DecryptAESKey, InPakFileEntry->CompressionMethod, bHasRelativeCompressedChunkOffsets);
 		}
 	}
 	else
 	{
-		if (!FExtractThreadWorker::UncompressCopyFile(ContentWriter, InPakFile->GetSharedReader(nullptr).GetArchive(), EntryInfo, PersistantCompressionBuffer, CompressionBufferSize, DecryptAESKey, InPakFileEntry->CompressionMethod, bHasRelativeCompressedChunkOffsets))
+		TUniquePtr<FArchive> ReaderArchivePtr(IFileManager::Get().CreateFileReader(*InSummary.PakFilePath));
+		if (!ReaderArchivePtr)
+		{
+			UE_LOG(LogPakAnalyzer, Error, TEXT("Load asset registry failed! Unable to open pak file! Path: %s."), *InSummary.PakFilePath);
+			return false;
+		}
+
+		const int64 BufferSize = 8 * 1024 * 1024; // 8MB buffer for extracting
+		void* Buffer = FMemory::Malloc(BufferSize);
+		uint8* PersistantCompressionBuffer = NULL;
+		int64 CompressionBufferSize = 0;
+
+		FArchive& ReaderArchive = *ReaderArchivePtr;
+		ReaderArchive.Seek(InPakFileEntry->PakEntry.Offset);
+
+		FPakEntry EntryInfo;
+		EntryInfo.Serialize(ReaderArchive, InSummary.PakInfo.Version);
+
+		if (!FExtractThreadWorker::ResolvePayloadEntry(InPakFileEntry->PakEntry, EntryInfo))
 		{
 			bReadResult = false;
 		}
+		else if (EntryInfo.CompressionMethodIndex == 0)
+		{
+			bReadResult = FExtractThreadWorker::BufferedCopyFile(ContentWriter, ReaderArchive, EntryInfo, Buffer, BufferSize, DecryptAESKey);
+		}
+		else
+		{
+			bReadResult = FExtractThreadWorker::UncompressCopyFile(ContentWriter, ReaderArchive, EntryInfo, PersistantCompressionBuffer, CompressionBufferSize, DecryptAESKey, InPakFileEntry->CompressionMethod, bHasRelativeCompressedChunkOffsets);
+		}
+
+		FMemory::Free(Buffer);
+		FMemory::Free(PersistantCompressionBuffer);
 	}
-	
-	FMemory::Free(Buffer);
-	FMemory::Free(PersistantCompressionBuffer);
-	
+
 	if (!bReadResult)
 	{
 		return false;
@@ -340,13 +657,13 @@ bool FPakAnalyzer::LoadAssetRegistryFromPak(FPakFile* InPakFile, FPakFileEntryPt
 	const bool bLoadResult = LoadAssetRegistry(ContentReader);
 	if (bLoadResult)
 	{
-		AssetRegistryPath = InPakFileEntry->Path;
+		AssetRegistryPath = InPakFileEntry->GetPath();
 	}
 	
 	return bLoadResult;
 }
 
-bool FPakAnalyzer::PreLoadPak(const FString& InPakPath, const FString& InDefaultAESKey, FString& OutDecryptKey)
+bool FPakAnalyzer::PreLoadPak(const FString& InPakPath, const FString& InDefaultAESKey, FString& OutDecryptKey, FPakInfo& OutPakInfo)
 {
 	UE_LOG(LogPakAnalyzer, Log, TEXT("Pre load pak file: %s and check file hash."), *InPakPath);
 
@@ -406,7 +723,7 @@ bool FPakAnalyzer::PreLoadPak(const FString& InPakPath, const FString& InDefault
 				bool bCancel = true;
 				do
 				{
-					OutDecryptKey = FPakAnalyzerDelegates::OnGetAESKey.Execute(InPakPath, Info.EncryptionKeyGuid, bCancel);
+					OutDecryptKey = RequestAESKey(InPakPath, Info.EncryptionKeyGuid, bCancel);
 
 					bShouldLoad = !bCancel ? TryDecryptPak(Reader, Info, OutDecryptKey, true) : false;
 				} while (!bShouldLoad && !bCancel);
@@ -423,6 +740,8 @@ bool FPakAnalyzer::PreLoadPak(const FString& InPakPath, const FString& InDefault
 	Reader->Close();
 	delete Reader;
 
+	OutPakInfo = Info;
+
 	return bShouldLoad;
 }
 
@@ -517,13 +836,8 @@ void FPakAnalyzer::InitializeExtractWorker()
 	ExtractWorkers.Empty();
 	for (int32 i = 0; i < ExtractWorkerCount; ++i)
 	{
-		TSharedPtr<FExtractThreadWorker> Worker = MakeShared<FExtractThreadWorker>();
-		Worker->GetOnUpdateExtractProgressDelegate().BindRaw(this, &FPakAnalyzer::OnUpdateExtractProgress);
-
-		ExtractWorkers.Add(Worker);
+		ExtractWorkers.Add(MakeShared<FExtractThreadWorker>());
 	}
-
-	ResetProgress();
 }
 
 void FPakAnalyzer::ShutdownAllExtractWorker()
@@ -534,28 +848,39 @@ void FPakAnalyzer::ShutdownAllExtractWorker()
 	}
 }
 
-void FPakAnalyzer::ParseAssetFile()
+void FPakAnalyzer::ParseAssetFile(const TArray<FPakTreeEntryPtr>& InTreeRoots)
 {
 	if (PakParseWorker.IsValid())
 	{
 		TArray<FPakFileEntryPtr> UAssetFiles;
 
-		for (const FPakTreeEntryPtr& PakTreeRoot : PakTreeRoots)
+		for (const FPakTreeEntryPtr& PakTreeRoot : InTreeRoots)
 		{
 			RetriveUAssetFiles(PakTreeRoot, UAssetFiles);
 		}
 
 		if (UAssetFiles.Num() > 0)
 		{
+			// Summaries stay indexed by OwnerPakIndex, so every pak is passed
+			const TArray<FPakFileSumaryPtr> LoadedSummaries = GetPakFileSumary();
 			TArray<FPakFileSumary> Summaries;
-			Summaries.AddDefaulted(PakFileSummaries.Num());
-			for (int32 i = 0; i < PakFileSummaries.Num(); ++i)
+			Summaries.AddDefaulted(LoadedSummaries.Num());
+			for (int32 i = 0; i < LoadedSummaries.Num(); ++i)
 			{
-				Summaries[i] = *PakFileSummaries[i];
+				Summaries[i] = *LoadedSummaries[i];
 			}
 
+			ParsedTreeRoots = InTreeRoots;
+			PakParseWorker->PackageDependencies = PackageDependencies;
 			PakParseWorker->StartParse(UAssetFiles, Summaries);
 		}
+		else
+		{
+			// Nothing to parse, the caches are complete already and this is the load thread
+			TMap<int32, FPendingIndexCache> IndexCaches = MoveTemp(PendingIndexCaches);
+			SnapshotIndexCaches(IndexCaches);
+			SaveIndexCaches(IndexCaches);
+		}
 	}
 }
 
@@ -585,50 +910,88 @@ void FPakAnalyzer::OnAssetParseFinish(bool bCancel, const TMap<FName, FName>& Cl
 		return;
 	}
 
-	DefaultClassMap = ClassMap;
+	// Classes of the paks restored from their caches are kept
+	{
+		FScopeLock Lock(&CriticalSection);
+		DefaultClassMap.Append(ClassMap);
+	}
 	const bool bRefreshClass = ClassMap.Num() > 0;
 
-	FFunctionGraphTask::CreateAndDispatchWhenReady([this, bRefreshClass]()
+	// Taken now, a later LoadPakFiles fills them again before its own parse finishes
+	TMap<int32, FPendingIndexCache> IndexCaches = MoveTemp(PendingIndexCaches);
+	TArray<FPakTreeEntryPtr> TreeRoots = MoveTemp(ParsedTreeRoots);
+
+	// Skipped once the load is cancelled, by the next load or the destructor
+	RunOnGameThreadForLoad([this, bRefreshClass, IndexCaches = MoveTemp(IndexCaches), TreeRoots]() mutable
 		{
 			if (bRefreshClass)
 			{
-				for (const FPakTreeEntryPtr& PakTreeRoot : PakTreeRoots)
+				for (const FPakTreeEntryPtr& PakTreeRoot : TreeRoots)
 				{
-					RefreshClassMap(PakTreeRoot, PakTreeRoot);
+					RefreshClassMap(PakTreeRoot);
 				}
 			}
 
+			// The class column is final now, it is copied before writing the caches and trimming the folder off the game thread
+			SnapshotIndexCaches(IndexCaches);
+			if (IndexCaches.Num() > 0)
+			{
+				SaveIndexCacheTask = Async(EAsyncExecution::Thread, [this, IndexCaches = MoveTemp(IndexCaches)]()
+					{
+						SaveIndexCaches(IndexCaches);
+					});
+			}
+
 			FPakAnalyzerDelegates::OnAssetParseFinish.Broadcast();
-		},
-		TStatId(), nullptr, ENamedThreads::GameThread);
+		});
 }
 
-void FPakAnalyzer::OnUpdateExtractProgress(const FGuid& WorkerGuid, int32 CompleteCount, int32 ErrorCount, int32 TotalCount)
+void FPakAnalyzer::SnapshotIndexCaches(TMap<int32, FPendingIndexCache>& InOutIndexCaches)
 {
-	FFunctionGraphTask::CreateAndDispatchWhenReady([this, &WorkerGuid, CompleteCount, ErrorCount, TotalCount]()
+	FScopeLock Lock(&CriticalSection);
+
+	for (auto It = InOutIndexCaches.CreateIterator(); It; ++It)
+	{
+		const int32 PakIndex = It.Key();
+		FPendingIndexCache& IndexCache = It.Value();
+
+		// Paks closed or reopened since the parse started are skipped
+		if (!PakTreeRoots.IsValidIndex(PakIndex) || PakTreeRoots[PakIndex] != IndexCache.TreeRoot || !IndexCache.TreeRoot->FileTable.IsValid())
 		{
-			FExtractProgress& Progress = ExtractWorkerProgresses.FindOrAdd(WorkerGuid);
+			It.RemoveCurrent();
+			continue;
+		}
 
-			Progress.CompleteCount = CompleteCount;
-			Progress.ErrorCount = ErrorCount;
-			Progress.TotalCount = TotalCount;
+		const FPakFileTable& FileTable = *IndexCache.TreeRoot->FileTable;
+		IndexCache.Summary = *PakFileSummaries[PakIndex];
+		IndexCache.FileClasses.SetNum(FileTable.Num());
+		IndexCache.ClassMap.Reset();
+		for (int32 Index = 0; Index < FileTable.Num(); ++Index)
+		{
+			IndexCache.FileClasses[Index] = FileTable.Classes[FileTable.ClassIds[Index]];
 
-			int32 TotalCompleteCount = 0;
-			int32 TotalErrorCount = 0;
-			int32 TotalTotalCount = 0;
-			for (const auto& It : ExtractWorkerProgresses)
+			const FName PackagePath = FileTable.Entries[Index]->PackagePath;
+			if (const FName* ClassName = DefaultClassMap.Find(PackagePath))
 			{
-				TotalCompleteCount += It.Value.CompleteCount;
-				TotalErrorCount += It.Value.ErrorCount;
-				TotalTotalCount += It.Value.TotalCount;
+				IndexCache.ClassMap.Add(PackagePath, *ClassName);
 			}
-
-			FPakAnalyzerDelegates::OnUpdateExtractProgress.ExecuteIfBound(TotalCompleteCount, TotalErrorCount, TotalTotalCount);
-		},
-		TStatId(), nullptr, ENamedThreads::GameThread);
+		}
+	}
 }
 
-void FPakAnalyzer::ResetProgress()
+void FPakAnalyzer::SaveIndexCaches(const TMap<int32, FPendingIndexCache>& InIndexCaches)
 {
-	ExtractWorkerProgresses.Empty(ExtractWorkers.Num());
+	if (InIndexCaches.Num() <= 0)
+	{
+		return;
+	}
+
+	const FPackageGraphPtr PackageGraph = GetPackageGraph();
+	for (const auto& It : InIndexCaches)
+	{
+		const FPendingIndexCache& IndexCache = It.Value;
+		FPakIndexCache::Save(IndexCache.Key, IndexCache.Summary, IndexCache.TreeRoot, *PackageGraph, IndexCache.FileClasses, IndexCache.ClassMap, IndexCache.AssetRegistryPath);
+	}
+
+	FPakIndexCache::Trim();
 }
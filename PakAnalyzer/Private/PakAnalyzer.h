@@ -12,6 +12,7 @@
 #include "Serialization/ArrayReader.h"
 
 #include "BaseAnalyzer.h"
+#include "PakIndexCache.h"
 
 struct FPakEntry;
 
@@ -25,42 +26,75 @@ public:
 	virtual void ExtractFiles(const FString& InOutputPath, TArray<FPakFileEntryPtr>& InFiles) override;
 	virtual void CancelExtract() override;
 	virtual void SetExtractThreadCount(int32 InThreadCount) override;
+	virtual void LoadFileHashes(const TArray<FPakFileEntryPtr>& InFiles) override;
 	virtual void Reset() override;
 
 protected:
-	FPakTreeEntryPtr LoadPakFile(const FString& InPakPath, const FString& InDefaultAESKey = TEXT(""));
-	bool LoadAssetRegistryFromPak(FPakFile* InPakFile, FPakFileEntryPtr InPakFileEntry, const FAES::FAESKey& DecryptAESKey);
+	struct FPakLoadContext
+	{
+		FString PakPath;
+		FString DecryptAESKey;
+		FPakInfo PakInfo;
+		TRefCountPtr<FPakFile> PakFile;
+		FPakFileSumaryPtr Summary;
+		FPakTreeEntryPtr TreeRoot;
+		TArray<FPakFileEntryPtr> AssetRegistryFiles;
+		FString ErrorMessage;
+		int32 PakIndex = INDEX_NONE;
+		FPakIndexCacheKey IndexCacheKey;
+		bool bHasIndexCacheKey = false;
+		TSharedPtr<FPakIndexCache> IndexCache;
+	};
+
+	// Paks loaded without a valid index cache, written once their assets are parsed
+	struct FPendingIndexCache
+	{
+		FPakIndexCacheKey Key;
+		FPakTreeEntryPtr TreeRoot;
+		FString AssetRegistryPath;
+		// Copied by SnapshotIndexCaches, the class column and the class map keep changing while the cache is written
+		FPakFileSumary Summary;
+		TArray<FName> FileClasses;
+		TMap<FName, FName> ClassMap;
+	};
 
-	bool PreLoadPak(const FString& InPakPath, const FString& InDefaultAESKey, FString& OutDecryptKey);
+	// Trailer check and AES key prompt, must run on the calling thread in pak order
+	bool PrepareLoadPakFile(FPakLoadContext& InContext, const FString& InDefaultAESKey);
+	// Index decode and tree build, safe to run concurrently for different paks
+	bool LoadPakFile(FPakLoadContext& InContext);
+	bool OpenPakFile(FPakLoadContext& InContext);
+	bool LoadPakFileFromCache(FPakLoadContext& InContext);
+	void MakePakFileSummary(FPakLoadContext& InContext, const FString& InMountPoint, int64 InPakFileSize);
+	bool LoadAssetRegistryFromPak(const FPakFileSumary& InSummary, FPakFileEntryPtr InPakFileEntry);
+	// Copies what the caches need under CriticalSection, paks closed or reopened since their load are dropped
+	void SnapshotIndexCaches(TMap<int32, FPendingIndexCache>& InOutIndexCaches);
+	// Hits the disk, runs on the load thread or SaveIndexCacheTask, never on the game thread. Only reads the snapshots
+	void SaveIndexCaches(const TMap<int32, FPendingIndexCache>& InIndexCaches);
+
+	bool PreLoadPak(const FString& InPakPath, const FString& InDefaultAESKey, FString& OutDecryptKey, FPakInfo& OutPakInfo);
 	bool ValidateEncryptionKey(TArray<uint8>& IndexData, const FSHAHash& InExpectedHash, const FAES::FAESKey& InAESKey);
 	bool TryDecryptPak(FArchive* InReader, const FPakInfo& InPakInfo, const FString& InKey, bool bShowWarning);
 
 	void InitializeExtractWorker();
 	void ShutdownAllExtractWorker();
 
-	void ParseAssetFile();
+	// Parses the uassets of InTreeRoots, the paks restored from their index caches are left out
+	void ParseAssetFile(const TArray<FPakTreeEntryPtr>& InTreeRoots);
 	void InitializeAssetParseWorker();
 	void ShutdownAssetParseWorker();
 	void OnAssetParseFinish(bool bCancel, const TMap<FName, FName>& ClassMap);
 
-	// Extract progress
-	void OnUpdateExtractProgress(const FGuid& WorkerGuid, int32 CompleteCount, int32 ErrorCount, int32 TotalCount);
-
-	struct FExtractProgress
-	{
-		int32 CompleteCount;
-		int32 ErrorCount;
-		int32 TotalCount;
-	};
-
-	void ResetProgress();
-
 protected:
 	int32 ExtractWorkerCount;
 	TArray<TSharedPtr<class FExtractThreadWorker>> ExtractWorkers;
-	TMap<FGuid, FExtractProgress> ExtractWorkerProgresses;
 
 	TArray<FString> DefaultAESKeys;
 
 	TSharedPtr<class FPakParseThreadWorker> PakParseWorker;
+
+	TMap<int32, FPendingIndexCache> PendingIndexCaches;
+	// Trees handed to the asset parse worker, their classes are refreshed once it finishes
+	TArray<FPakTreeEntryPtr> ParsedTreeRoots;
+	// Writes the pending caches and trims the cache folder
+	TFuture<void> SaveIndexCacheTask;
 };
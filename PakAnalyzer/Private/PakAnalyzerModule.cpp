@@ -3,6 +3,7 @@
 #include "PakAnalyzerModule.h"
 
 #include "HAL/PlatformFile.h"
+#include "Misc/ConfigCacheIni.h"
 #include "Misc/Paths.h"
 #include "Modules/ModuleManager.h"
 
@@ -17,10 +18,11 @@ DEFINE_LOG_CATEGORY(LogPakAnalyzer);
 
 FPakAnalyzerDelegates::FOnGetAESKey FPakAnalyzerDelegates::OnGetAESKey;
 FPakAnalyzerDelegates::FOnLoadPakFailed FPakAnalyzerDelegates::OnLoadPakFailed;
-FPakAnalyzerDelegates::FOnUpdateExtractProgress FPakAnalyzerDelegates::OnUpdateExtractProgress;
 FPakAnalyzerDelegates::FOnExtractStart FPakAnalyzerDelegates::OnExtractStart;
 FPakAnalyzerDelegates::FOnAssetParseFinish FPakAnalyzerDelegates::OnAssetParseFinish;
 FPakAnalyzerDelegates::FOnPakLoadFinish FPakAnalyzerDelegates::OnPakLoadFinish;
+FPakAnalyzerDelegates::FOnPakLoadStart FPakAnalyzerDelegates::OnPakLoadStart;
+FPakAnalyzerDelegates::FOnPakLoaded FPakAnalyzerDelegates::OnPakLoaded;
 
 class FPakAnalyzerModule : public IPakAnalyzerModule
 {
@@ -45,6 +47,11 @@ void FPakAnalyzerModule::StartupModule()
 
 void FPakAnalyzerModule::ShutdownModule()
 {
+	if (AnalyzerInstance.IsValid())
+	{
+		AnalyzerInstance->CancelLoad();
+	}
+
 	AnalyzerInstance.Reset();
 }
 
@@ -54,6 +61,12 @@ void FPakAnalyzerModule::InitializeAnalyzerBackend(const FString& InFullPath)
 
 	const FString Extension = FPaths::GetExtension(InFullPath);
 
+	// The load thread of the old backend must not outlive it
+	if (AnalyzerInstance.IsValid())
+	{
+		AnalyzerInstance->CancelLoad();
+	}
+
 	if (PlatformFile.DirectoryExists(*InFullPath))
 	{
 		AnalyzerInstance = MakeShared<FFolderAnalyzer>();
@@ -62,6 +75,11 @@ void FPakAnalyzerModule::InitializeAnalyzerBackend(const FString& InFullPath)
 	{
 		AnalyzerInstance = MakeShared<FUnrealAnalyzer>();
 	}
+
+	// A new backend is created for every open, keep the thread count from the options
+	int32 ExtractThreadCount = DEFAULT_EXTRACT_THREAD_COUNT;
+	GConfig->GetInt(TEXT("UnrealPakViewer"), TEXT("ExtractThreadCount"), ExtractThreadCount, GEngineIni);
+	AnalyzerInstance->SetExtractThreadCount(ExtractThreadCount);
 }
 
 IPakAnalyzer* FPakAnalyzerModule::GetPakAnalyzer()
@@ -1 +1,154 @@
-#include "PakFileEntry.h"
\ No newline at end of file
+#include "PakFileEntry.h"
+
+#include "Misc/StringBuilder.h"
+
+int32 FPakFileEntry::GetCompressionBlockCount() const
+{
+	return FileTable.IsValid() && FileTable->CompressionBlockCounts.IsValidIndex(FileIndex) ? FileTable->CompressionBlockCounts[FileIndex] : 0;
+}
+
+FName FPakFileEntry::GetClass() const
+{
+	return FileTable.IsValid() && FileTable->ClassIds.IsValidIndex(FileIndex) ? FileTable->Classes[FileTable->ClassIds[FileIndex]] : NAME_None;
+}
+
+int32 FPakFileEntry::GetPackageId() const
+{
+	return AssetSummary.IsValid() ? AssetSummary->PackageId : INDEX_NONE;
+}
+
+FString FPakFileEntry::GetFilename() const
+{
+	if (FileTable.IsValid() && FileIndex != INDEX_NONE)
+	{
+		const FStringView Name = FileTable->GetFileName(FileIndex);
+		return FString(Name.Len(), Name.GetData());
+	}
+	else if (FileTable.IsValid() && DirectoryIndex > 0)
+	{
+		const FStringView Name = FileTable->GetDirectoryName(DirectoryIndex);
+		return FString(Name.Len(), Name.GetData());
+	}
+
+	return Filename.ToString();
+}
+
+FString FPakFileEntry::GetPath() const
+{
+	TStringBuilder<256> PathBuilder;
+	AppendPath(PathBuilder);
+	return FString(PathBuilder.Len(), PathBuilder.GetData());
+}
+
+void FPakFileEntry::AppendPath(FStringBuilderBase& OutBuilder) const
+{
+	if (!FileTable.IsValid())
+	{
+		Filename.AppendString(OutBuilder);
+	}
+	else if (FileIndex != INDEX_NONE)
+	{
+		FileTable->AppendFilePath(FileIndex, OutBuilder);
+	}
+	else if (DirectoryIndex == 0)
+	{
+		OutBuilder << FileTable->MountPoint;
+	}
+	else
+	{
+		FileTable->AppendDirectoryPath(DirectoryIndex, OutBuilder);
+	}
+}
+
+void FPakFileTable::AppendDirectoryPath(int32 InDirectoryIndex, FStringBuilderBase& OutBuilder, bool bWithPrefix) const
+{
+	// Parent chain up to the tree root, whose name is empty
+	TArray<int32, TInlineAllocator<32>> Chain;
+	for (int32 DirectoryIndex = InDirectoryIndex; DirectoryIndex > 0; DirectoryIndex = DirectoryParents[DirectoryIndex])
+	{
+		Chain.Add(DirectoryIndex);
+	}
+
+	if (bWithPrefix && !PathPrefix.IsEmpty())
+	{
+		OutBuilder << PathPrefix;
+		if (Chain.Num() > 0 && !PathPrefix.EndsWith(TEXT("/")) && !PathPrefix.EndsWith(TEXT("\\")))
+		{
+			OutBuilder << TEXT('/');
+		}
+	}
+
+	for (int32 ChainIndex = Chain.Num() - 1; ChainIndex >= 0; --ChainIndex)
+	{
+		OutBuilder << GetDirectoryName(Chain[ChainIndex]);
+		if (ChainIndex > 0)
+		{
+			OutBuilder << TEXT('/');
+		}
+	}
+}
+
+void FPakFileTable::AppendFilePath(int32 InFileIndex, FStringBuilderBase& OutBuilder, bool bWithPrefix) const
+{
+	const int32 StartLen = OutBuilder.Len();
+	AppendDirectoryPath(ParentDirectories[InFileIndex], OutBuilder, bWithPrefix);
+
+	if (OutBuilder.Len() > StartLen)
+	{
+		const TCHAR LastChar = OutBuilder.LastChar();
+		if (LastChar != TEXT('/') && LastChar != TEXT('\\'))
+		{
+			OutBuilder << TEXT('/');
+		}
+	}
+	OutBuilder << GetFileName(InFileIndex);
+}
+
+int32 FPakFileTable::AddName(FStringView InName)
+{
+	const int32 Offset = NameBuffer.Num();
+	NameBuffer.Append(InName.GetData(), InName.Len());
+	return Offset;
+}
+
+int32 FPakFileTable::AddDirectory(FPakTreeEntry* InDirectory, int32 InParentDirectory, FStringView InName)
+{
+	DirectoryNameOffsets.Add(AddName(InName));
+	DirectoryNameLengths.Add(InName.Len());
+	DirectoryParents.Add(InParentDirectory);
+	return Directories.Add(InDirectory);
+}
+
+int32 FPakFileTable::AddFile(FPakTreeEntry* InFile, int32 InParentDirectory, FStringView InName, int32 InCompressionBlockCount, FName InClassName)
+{
+	FileNameOffsets.Add(AddName(InName));
+	FileNameLengths.Add(InName.Len());
+	CompressionBlockCounts.Add(InCompressionBlockCount);
+	ClassIds.Add(FindOrAddClass(InClassName));
+	ParentDirectories.Add(InParentDirectory);
+	return Entries.Add(InFile);
+}
+
+int32 FPakFileTable::FindOrAddClass(FName InClassName)
+{
+	const int32* ClassId = ClassLookup.Find(InClassName);
+	if (ClassId)
+	{
+		return *ClassId;
+	}
+
+	const int32 NewClassId = Classes.Add(InClassName);
+	ClassLookup.Add(InClassName, NewClassId);
+
+	return NewClassId;
+}
+
+void FPakFileTable::Reserve(int32 InFileCount)
+{
+	CompressionBlockCounts.Reserve(InFileCount);
+	ClassIds.Reserve(InFileCount);
+	ParentDirectories.Reserve(InFileCount);
+	FileNameOffsets.Reserve(InFileCount);
+	FileNameLengths.Reserve(InFileCount);
+	Entries.Reserve(InFileCount);
+}
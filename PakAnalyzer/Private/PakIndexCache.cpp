@@ -0,0 +1,766 @@
+#include "PakIndexCache.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Crc.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Templates/UniquePtr.h"
+
+#include "CommonDefines.h"
+#include "IPakAnalyzer.h"
+
+static const uint32 PAK_INDEX_CACHE_MAGIC = 0x55505643; // UPVC
+static const int32 PAK_INDEX_CACHE_VERSION = 4;
+static const TCHAR* const PAK_INDEX_CACHE_EXTENSION = TEXT(".upvindex");
+
+// FNames are written as indices into a name table stored once in front of the body
+class FPakIndexCacheWriter : public FMemoryWriter64
+{
+public:
+	explicit FPakIndexCacheWriter(TArray64<uint8>& InBytes)
+		: FMemoryWriter64(InBytes)
+	{
+	}
+
+	using FMemoryWriter64::operator<<;
+
+	virtual FArchive& operator<<(FName& InName) override
+	{
+		int32 NameIndex = INDEX_NONE;
+		const int32* ExistingIndex = NameIndices.Find(InName);
+		if (ExistingIndex)
+		{
+			NameIndex = *ExistingIndex;
+		}
+		else
+		{
+			NameIndex = Names.Add(InName);
+			NameIndices.Add(InName, NameIndex);
+		}
+
+		*this << NameIndex;
+		return *this;
+	}
+
+	TArray<FName> Names;
+
+protected:
+	TMap<FName, int32> NameIndices;
+};
+
+class FPakIndexCacheReader : public FMemoryReaderView
+{
+public:
+	FPakIndexCacheReader(FMemoryView InBytes, const TArray<FName>& InNames)
+		: FMemoryReaderView(InBytes)
+		, Names(InNames)
+	{
+	}
+
+	using FMemoryReaderView::operator<<;
+
+	virtual FArchive& operator<<(FName& InName) override
+	{
+		int32 NameIndex = INDEX_NONE;
+		*this << NameIndex;
+
+		if (Names.IsValidIndex(NameIndex))
+		{
+			InName = Names[NameIndex];
+		}
+		else
+		{
+			InName = NAME_None;
+			SetError();
+		}
+
+		return *this;
+	}
+
+protected:
+	const TArray<FName>& Names;
+};
+
+// FCrc::MemCrc32 takes an int32 length, a section may be larger
+static uint32 MemCrc32(const void* InData, int64 InSize)
+{
+	const uint8* Data = (const uint8*)InData;
+	uint32 Crc = 0;
+	while (InSize > 0)
+	{
+		const int32 ChunkSize = (int32)FMath::Min<int64>(InSize, MAX_int32);
+		Crc = FCrc::MemCrc32(Data, ChunkSize, Crc);
+		Data += ChunkSize;
+		InSize -= ChunkSize;
+	}
+	return Crc;
+}
+
+static void SerializeHeader(FArchive& Ar, uint32& Magic, int32& Version, FString& EngineVersion, FPakIndexCacheKey& Key, FString& MountPoint, FPakIndexCache::FSection (&Sections)[FPakIndexCache::Section_Count])
+{
+	Ar << Magic;
+	Ar << Version;
+	if (Magic != PAK_INDEX_CACHE_MAGIC || Version != PAK_INDEX_CACHE_VERSION)
+	{
+		return;
+	}
+
+	Ar << EngineVersion;
+	Ar << Key.PakPath;
+	Ar << Key.PakFileSize;
+	Ar << Key.TimeStamp;
+	Ar << Key.IndexHash;
+	Ar << MountPoint;
+
+	for (FPakIndexCache::FSection& Section : Sections)
+	{
+		Ar << Section.Offset;
+		Ar << Section.Size;
+		Ar << Section.Crc;
+	}
+}
+
+static void SerializePackageInfos(FArchive& Ar, TArray<FPackageInfoPtr>& InOutInfos)
+{
+	int32 Count = InOutInfos.Num();
+	Ar << Count;
+
+	if (Ar.IsLoading())
+	{
+		InOutInfos.Empty(Count);
+		for (int32 i = 0; i < Count && !Ar.IsError(); ++i)
+		{
+			InOutInfos.Add(MakeShared<FPackageInfo>());
+		}
+	}
+
+	for (FPackageInfoPtr& Info : InOutInfos)
+	{
+		Ar << Info->PackageName;
+		Ar << Info->ExtraInfo;
+	}
+}
+
+static void SerializeAssetSummary(FArchive& Ar, FAssetSummary& InOutSummary, TArray<FName>& InOutDependencies)
+{
+	Ar << InOutSummary.PackageSummary;
+
+	int32 NameCount = InOutSummary.Names.Num();
+	Ar << NameCount;
+	if (Ar.IsLoading())
+	{
+		InOutSummary.Names.Empty(NameCount);
+		for (int32 i = 0; i < NameCount && !Ar.IsError(); ++i)
+		{
+			InOutSummary.Names.Add(MakeShared<FName>());
+		}
+	}
+
+	for (FNamePtrType& Name : InOutSummary.Names)
+	{
+		Ar << *Name;
+	}
+
+	int32 ExportCount = InOutSummary.ObjectExports.Num();
+	Ar << ExportCount;
+	if (Ar.IsLoading())
+	{
+		InOutSummary.ObjectExports.Empty(ExportCount);
+		for (int32 i = 0; i < ExportCount && !Ar.IsError(); ++i)
+		{
+			InOutSummary.ObjectExports.Add(MakeShared<FObjectExportEx>());
+		}
+	}
+
+	for (FObjectExportPtrType& Export : InOutSummary.ObjectExports)
+	{
+		Ar << Export->ObjectName;
+		Ar << Export->SerialSize;
+		Ar << Export->SerialOffset;
+		Ar << Export->bIsAsset;
+		Ar << Export->bNotForClient;
+		Ar << Export->bNotForServer;
+		Ar << Export->Index;
+		Ar << Export->ObjectPath;
+		Ar << Export->ClassName;
+		Ar << Export->TemplateObject;
+		Ar << Export->Super;
+		SerializePackageInfos(Ar, Export->DependencyList);
+	}
+
+	int32 ImportCount = InOutSummary.ObjectImports.Num();
+	Ar << ImportCount;
+	if (Ar.IsLoading())
+	{
+		InOutSummary.ObjectImports.Empty(ImportCount);
+		for (int32 i = 0; i < ImportCount && !Ar.IsError(); ++i)
+		{
+			InOutSummary.ObjectImports.Add(MakeShared<FObjectImportEx>());
+		}
+	}
+
+	for (FObjectImportPtrType& Import : InOutSummary.ObjectImports)
+	{
+		Ar << Import->Index;
+		Ar << Import->ClassPackage;
+		Ar << Import->ClassName;
+		Ar << Import->ObjectName;
+		Ar << Import->ObjectPath;
+	}
+
+	// Dependents span every loaded pak, they are the reversed edges of the package graph after loading
+	Ar << InOutDependencies;
+}
+
+FPakIndexCache::FPakIndexCache(const FPakIndexCacheKey& InKey)
+	: Key(InKey)
+{
+}
+
+FPakIndexCache::~FPakIndexCache()
+{
+	Close();
+}
+
+bool FPakIndexCache::IsEnabled()
+{
+	return GetCacheSizeLimit() > 0;
+}
+
+FString FPakIndexCache::GetCacheDirectory()
+{
+	FString CacheDirectory;
+	GConfig->GetString(TEXT("UnrealPakViewer"), TEXT("IndexCacheDirectory"), CacheDirectory, GEngineIni);
+
+	return CacheDirectory.IsEmpty() ? FPaths::ProjectSavedDir() / DEFAULT_INDEX_CACHE_FOLDER : CacheDirectory;
+}
+
+int64 FPakIndexCache::GetCacheSizeLimit()
+{
+	int32 CacheSizeMB = DEFAULT_INDEX_CACHE_SIZE_MB;
+	GConfig->GetInt(TEXT("UnrealPakViewer"), TEXT("IndexCacheSizeMB"), CacheSizeMB, GEngineIni);
+
+	return FMath::Max(CacheSizeMB, 0) * 1024LL * 1024LL;
+}
+
+bool FPakIndexCache::MakeKey(const FString& InPakPath, const FPakInfo& InPakInfo, FPakIndexCacheKey& OutKey)
+{
+	const FFileStatData StatData = IFileManager::Get().GetStatData(*InPakPath);
+	if (!StatData.bIsValid || StatData.bIsDirectory)
+	{
+		return false;
+	}
+
+	OutKey.PakPath = FPaths::ConvertRelativePathToFull(InPakPath);
+	OutKey.PakFileSize = StatData.FileSize;
+	OutKey.TimeStamp = StatData.ModificationTime;
+	OutKey.IndexHash = InPakInfo.IndexHash;
+
+	return true;
+}
+
+FString FPakIndexCache::GetCacheFilePath(const FString& InPakPath)
+{
+	const FString FullPath = FPaths::ConvertRelativePathToFull(InPakPath).ToLower();
+	return GetCacheDirectory() / FMD5::HashAnsiString(*FullPath) + PAK_INDEX_CACHE_EXTENSION;
+}
+
+bool FPakIndexCache::Open()
+{
+	Close();
+
+	CacheFilePath = GetCacheFilePath(Key.PakPath);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*CacheFilePath))
+	{
+		return false;
+	}
+
+	MappedHandle.Reset(PlatformFile.OpenMapped(*CacheFilePath));
+	if (MappedHandle.IsValid())
+	{
+		MappedRegion.Reset(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+	}
+
+	if (MappedRegion.IsValid())
+	{
+		Data = FMemoryView(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+	}
+	else
+	{
+		// Platforms without file mapping fall back to a plain read
+		MappedHandle.Reset();
+		if (!FFileHelper::LoadFileToArray(FileData, *CacheFilePath))
+		{
+			return false;
+		}
+
+		Data = FMemoryView(FileData.GetData(), FileData.Num());
+	}
+
+	// Only the header is read here, sections are read in place from the mapping and checked the first time they are used
+	uint32 Magic = 0;
+	int32 Version = 0;
+	FString EngineVersion;
+	FPakIndexCacheKey CachedKey;
+
+	FMemoryReaderView HeaderReader(Data);
+	SerializeHeader(HeaderReader, Magic, Version, EngineVersion, CachedKey, MountPoint, Sections);
+
+	bool bValid = !HeaderReader.IsError()
+		&& Magic == PAK_INDEX_CACHE_MAGIC
+		&& Version == PAK_INDEX_CACHE_VERSION
+		&& EngineVersion == FEngineVersion::Current().ToString()
+		&& CachedKey.PakPath.Equals(Key.PakPath, ESearchCase::IgnoreCase)
+		&& CachedKey.PakFileSize == Key.PakFileSize
+		&& CachedKey.TimeStamp == Key.TimeStamp
+		&& CachedKey.IndexHash == Key.IndexHash;
+
+	for (const FSection& Section : Sections)
+	{
+		bValid &= Section.Offset >= HeaderReader.Tell() && Section.Size >= 0 && Section.Offset + Section.Size <= (int64)Data.GetSize();
+	}
+
+	if (!bValid)
+	{
+		UE_LOG(LogPakAnalyzer, Log, TEXT("Index cache of %s is stale, it will be rebuilt."), *Key.PakPath);
+
+		Invalidate();
+		return false;
+	}
+
+	// Modification time doubles as the last use time for Trim
+	IFileManager::Get().SetTimeStamp(*CacheFilePath, FDateTime::UtcNow());
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Use index cache %s for %s."), *CacheFilePath, *Key.PakPath);
+
+	return true;
+}
+
+void FPakIndexCache::Close()
+{
+	Data.Reset();
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+	FileData.Empty();
+	Names.Empty();
+	bNamesLoaded = false;
+	for (int32 Index = 0; Index < Section_Count; ++Index)
+	{
+		Sections[Index] = FSection();
+		bSectionChecked[Index] = false;
+	}
+}
+
+bool FPakIndexCache::GetSection(ESection InSection, FMemoryView& OutView) const
+{
+	const FSection& Section = Sections[InSection];
+	if (Data.IsEmpty())
+	{
+		return false;
+	}
+
+	OutView = Data.Mid(Section.Offset, Section.Size);
+	if (!bSectionChecked[InSection])
+	{
+		if (MemCrc32(OutView.GetData(), OutView.GetSize()) != Section.Crc)
+		{
+			UE_LOG(LogPakAnalyzer, Warning, TEXT("Index cache %s is corrupted, section: %d."), *CacheFilePath, (int32)InSection);
+			return false;
+		}
+		bSectionChecked[InSection] = true;
+	}
+
+	return true;
+}
+
+bool FPakIndexCache::LoadNames() const
+{
+	if (bNamesLoaded)
+	{
+		return true;
+	}
+
+	FMemoryView NameSection;
+	if (!GetSection(Section_Names, NameSection))
+	{
+		return false;
+	}
+
+	FMemoryReaderView NameReader(NameSection);
+	int32 NameCount = 0;
+	NameReader << NameCount;
+
+	FString NameString;
+	Names.Empty(FMath::Max(NameCount, 0));
+	for (int32 i = 0; i < NameCount && !NameReader.IsError(); ++i)
+	{
+		NameReader << NameString;
+		Names.Add(*NameString);
+	}
+
+	bNamesLoaded = !NameReader.IsError();
+	return bNamesLoaded;
+}
+
+void FPakIndexCache::Invalidate()
+{
+	Close();
+
+	if (!CacheFilePath.IsEmpty())
+	{
+		IFileManager::Get().Delete(*CacheFilePath, false, true, true);
+	}
+}
+
+bool FPakIndexCache::LoadTree(FPakTreeEntryPtr InTreeRoot, TArray<FPakFileEntryPtr>& OutAssetRegistryFiles) const
+{
+	FMemoryView TreeSection;
+	if (!InTreeRoot.IsValid() || !InTreeRoot->FileTable.IsValid() || !LoadNames() || !GetSection(Section_Tree, TreeSection))
+	{
+		return false;
+	}
+
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	FPakIndexCacheReader Reader(TreeSection, Names);
+
+	int32 DirectoryCount = 0;
+	Reader << DirectoryCount;
+
+	// Directory 0 is the tree root made by the caller, parents always come first
+	for (int32 i = 1; i < DirectoryCount && !Reader.IsError(); ++i)
+	{
+		// Names are written as strings, an FName would lose the case of the pak index
+		int32 ParentIndex = INDEX_NONE;
+		FString DirectoryName;
+		Reader << ParentIndex;
+		Reader << DirectoryName;
+
+		if (!FileTable->Directories.IsValidIndex(ParentIndex))
+		{
+			return false;
+		}
+
+		FPakTreeEntry* Parent = FileTable->Directories[ParentIndex];
+
+		const FName DirectoryKey(*DirectoryName);
+		FPakTreeEntryPtr Directory = MakeShared<FPakTreeEntry>(DirectoryKey, true);
+		Directory->FileTable = FileTable;
+		Directory->OwnerPakIndex = FileTable->PakIndex;
+		Directory->DirectoryIndex = FileTable->AddDirectory(Directory.Get(), ParentIndex, DirectoryName);
+
+		Parent->ChildrenMap.Add(DirectoryKey, Directory);
+	}
+
+	int32 FileCount = 0;
+	Reader << FileCount;
+	FileTable->Reserve(FileCount);
+
+	for (int32 i = 0; i < FileCount && !Reader.IsError(); ++i)
+	{
+		int32 ParentIndex = INDEX_NONE;
+		FString Filename;
+		FName Class;
+		int32 CompressionBlockCount = 0;
+
+		Reader << ParentIndex;
+		Reader << Filename;
+
+		if (!FileTable->Directories.IsValidIndex(ParentIndex))
+		{
+			return false;
+		}
+
+		const FName FileKey(*Filename);
+		FPakTreeEntryPtr File = MakeShared<FPakTreeEntry>(FileKey, false);
+		File->FileTable = FileTable;
+		File->OwnerPakIndex = FileTable->PakIndex;
+		File->bHashLoaded = false;
+
+		FPakEntry& PakEntry = File->PakEntry;
+		Reader << File->PackagePath;
+		Reader << File->CompressionMethod;
+		Reader << Class;
+		Reader << PakEntry.Offset;
+		Reader << PakEntry.Size;
+		Reader << PakEntry.UncompressedSize;
+		Reader << PakEntry.CompressionMethodIndex;
+		Reader << PakEntry.CompressionBlockSize;
+		Reader << PakEntry.Flags;
+		Reader << CompressionBlockCount;
+
+		File->FileIndex = FileTable->AddFile(File.Get(), ParentIndex, Filename, CompressionBlockCount, Class);
+		FileTable->Directories[ParentIndex]->ChildrenMap.Add(FileKey, File);
+
+		if (Filename.EndsWith(TEXT("AssetRegistry.bin")))
+		{
+			OutAssetRegistryFiles.Add(File);
+		}
+	}
+
+	return !Reader.IsError();
+}
+
+bool FPakIndexCache::LoadAssetSummaries(FPakTreeEntryPtr InTreeRoot, TArray<FPackageDependency>& OutDependencies, TMap<FName, FName>& OutClassMap, FString& OutAssetRegistryPath) const
+{
+	FMemoryView AssetSection;
+	if (!InTreeRoot.IsValid() || !InTreeRoot->FileTable.IsValid() || !LoadNames() || !GetSection(Section_Assets, AssetSection))
+	{
+		return false;
+	}
+
+	const FPakFileTablePtr& FileTable = InTreeRoot->FileTable;
+	FPakIndexCacheReader Reader(AssetSection, Names);
+
+	FString AssetRegistryPath;
+	Reader << AssetRegistryPath;
+	if (!AssetRegistryPath.IsEmpty())
+	{
+		OutAssetRegistryPath = AssetRegistryPath;
+	}
+
+	int32 ClassCount = 0;
+	Reader << ClassCount;
+	for (int32 i = 0; i < ClassCount && !Reader.IsError(); ++i)
+	{
+		FName PackagePath;
+		FName ClassName;
+		Reader << PackagePath;
+		Reader << ClassName;
+
+		OutClassMap.Add(PackagePath, ClassName);
+	}
+
+	int32 SummaryCount = 0;
+	Reader << SummaryCount;
+	TArray<FName> Dependencies;
+	for (int32 i = 0; i < SummaryCount && !Reader.IsError(); ++i)
+	{
+		int32 FileIndex = INDEX_NONE;
+		Reader << FileIndex;
+
+		if (!FileTable->Entries.IsValidIndex(FileIndex))
+		{
+			return false;
+		}
+
+		FAssetSummaryPtr AssetSummary = MakeShared<FAssetSummary>();
+		SerializeAssetSummary(Reader, *AssetSummary, Dependencies);
+
+		FPakTreeEntry* File = FileTable->Entries[FileIndex];
+		File->AssetSummary = AssetSummary;
+		for (const FName& Dependency : Dependencies)
+		{
+			OutDependencies.Add({ File->PackagePath, Dependency });
+		}
+	}
+
+	return !Reader.IsError();
+}
+
+bool FPakIndexCache::Save(const FPakIndexCacheKey& InKey, const FPakFileSumary& InSummary, FPakTreeEntryPtr InTreeRoot, const FPackageGraph& InPackageGraph, const TArray<FName>& InFileClasses, const TMap<FName, FName>& InClassMap, const FString& InAssetRegistryPath)
+{
+	if (!InTreeRoot.IsValid() || !InTreeRoot->FileTable.IsValid() || InFileClasses.Num() != InTreeRoot->FileTable->Num())
+	{
+		return false;
+	}
+
+	const FPakFileTable& FileTable = *InTreeRoot->FileTable;
+
+	// Tree and asset sections share the name table of the writer, which becomes its own section
+	TArray64<uint8> Body;
+	FPakIndexCacheWriter Writer(Body);
+
+	int32 DirectoryCount = FileTable.Directories.Num();
+	Writer << DirectoryCount;
+	for (int32 i = 1; i < DirectoryCount; ++i)
+	{
+		int32 ParentIndex = FileTable.DirectoryParents[i];
+		FString DirectoryName(FileTable.GetDirectoryName(i));
+		Writer << ParentIndex;
+		Writer << DirectoryName;
+	}
+
+	int32 FileCount = FileTable.Num();
+	Writer << FileCount;
+	for (int32 i = 0; i < FileCount; ++i)
+	{
+		FPakTreeEntry* File = FileTable.Entries[i];
+		FPakEntry& PakEntry = File->PakEntry;
+		int32 ParentIndex = FileTable.ParentDirectories[i];
+		int32 CompressionBlockCount = FileTable.CompressionBlockCounts[i];
+		FName Class = InFileClasses[i];
+		FString Filename(FileTable.GetFileName(i));
+
+		Writer << ParentIndex;
+		Writer << Filename;
+		Writer << File->PackagePath;
+		Writer << File->CompressionMethod;
+		Writer << Class;
+		Writer << PakEntry.Offset;
+		Writer << PakEntry.Size;
+		Writer << PakEntry.UncompressedSize;
+		Writer << PakEntry.CompressionMethodIndex;
+		Writer << PakEntry.CompressionBlockSize;
+		Writer << PakEntry.Flags;
+		Writer << CompressionBlockCount;
+	}
+
+	const int64 AssetSectionOffset = Writer.Tell();
+
+	FString AssetRegistryPath = InAssetRegistryPath;
+	Writer << AssetRegistryPath;
+
+	TArray<FPakTreeEntry*> AssetFiles;
+	TArray<TPair<FName, FName>> Classes;
+	for (FPakTreeEntry* File : FileTable.Entries)
+	{
+		const FName* ClassName = InClassMap.Find(File->PackagePath);
+		if (ClassName)
+		{
+			Classes.Emplace(File->PackagePath, *ClassName);
+		}
+
+		if (File->AssetSummary.IsValid())
+		{
+			AssetFiles.Add(File);
+		}
+	}
+
+	int32 ClassCount = Classes.Num();
+	Writer << ClassCount;
+	for (TPair<FName, FName>& Class : Classes)
+	{
+		Writer << Class.Key;
+		Writer << Class.Value;
+	}
+
+	int32 SummaryCount = AssetFiles.Num();
+	Writer << SummaryCount;
+	TArray<FName> Dependencies;
+	for (FPakTreeEntry* File : AssetFiles)
+	{
+		int32 FileIndex = File->FileIndex;
+		Writer << FileIndex;
+
+		Dependencies.Reset();
+		for (int32 Dependency : InPackageGraph.GetDependencies(File->AssetSummary->PackageId))
+		{
+			Dependencies.Add(InPackageGraph.GetPackageName(Dependency));
+		}
+		SerializeAssetSummary(Writer, *File->AssetSummary, Dependencies);
+	}
+
+	TArray64<uint8> NameData;
+	FMemoryWriter64 NameWriter(NameData);
+	int32 NameCount = Writer.Names.Num();
+	NameWriter << NameCount;
+	for (const FName& Name : Writer.Names)
+	{
+		FString NameString = Name.ToString();
+		NameWriter << NameString;
+	}
+
+	uint32 Magic = PAK_INDEX_CACHE_MAGIC;
+	int32 Version = PAK_INDEX_CACHE_VERSION;
+	FString EngineVersion = FEngineVersion::Current().ToString();
+	FPakIndexCacheKey Key = InKey;
+	FString MountPoint = InSummary.MountPoint;
+
+	// Section offsets are known once the header size is, it doesn't depend on their values
+	FSection Sections[Section_Count];
+	TArray<uint8> HeaderData;
+	FMemoryWriter HeaderWriter(HeaderData);
+	SerializeHeader(HeaderWriter, Magic, Version, EngineVersion, Key, MountPoint, Sections);
+
+	Sections[Section_Names] = { HeaderData.Num(), NameData.Num(), MemCrc32(NameData.GetData(), NameData.Num()) };
+	Sections[Section_Tree] = { Sections[Section_Names].Offset + NameData.Num(), AssetSectionOffset, MemCrc32(Body.GetData(), AssetSectionOffset) };
+	Sections[Section_Assets] = { Sections[Section_Tree].Offset + AssetSectionOffset, Body.Num() - AssetSectionOffset, MemCrc32(Body.GetData() + AssetSectionOffset, Body.Num() - AssetSectionOffset) };
+
+	HeaderData.Reset();
+	FMemoryWriter FinalHeaderWriter(HeaderData);
+	SerializeHeader(FinalHeaderWriter, Magic, Version, EngineVersion, Key, MountPoint, Sections);
+
+	// Write aside and move over, a crash mid write never leaves a truncated cache behind
+	const FString CacheFilePath = GetCacheFilePath(InKey.PakPath);
+	const FString TempFilePath = CacheFilePath + TEXT(".tmp");
+
+	bool bSaved = false;
+	TUniquePtr<FArchive> FileWriter(IFileManager::Get().CreateFileWriter(*TempFilePath));
+	if (FileWriter.IsValid())
+	{
+		FileWriter->Serialize(HeaderData.GetData(), HeaderData.Num());
+		FileWriter->Serialize(NameData.GetData(), NameData.Num());
+		FileWriter->Serialize(Body.GetData(), Body.Num());
+		bSaved = FileWriter->Close() && !FileWriter->IsError();
+		FileWriter.Reset();
+	}
+
+	if (!bSaved || !IFileManager::Get().Move(*CacheFilePath, *TempFilePath, true, true))
+	{
+		UE_LOG(LogPakAnalyzer, Warning, TEXT("Save index cache failed! Pak: %s, cache: %s."), *InKey.PakPath, *CacheFilePath);
+		IFileManager::Get().Delete(*TempFilePath, false, true, true);
+		return false;
+	}
+
+	UE_LOG(LogPakAnalyzer, Log, TEXT("Save index cache %s for %s, size: %lld."), *CacheFilePath, *InKey.PakPath, Sections[Section_Assets].Offset + Sections[Section_Assets].Size);
+
+	return true;
+}
+
+void FPakIndexCache::Trim()
+{
+	const FString CacheDirectory = GetCacheDirectory();
+	const int64 CacheSizeLimit = GetCacheSizeLimit();
+
+	struct FCacheFile
+	{
+		FString Path;
+		int64 Size;
+		FDateTime LastUsed;
+	};
+
+	TArray<FCacheFile> CacheFiles;
+	int64 TotalSize = 0;
+
+	IFileManager::Get().IterateDirectoryStat(*CacheDirectory, [&CacheFiles, &TotalSize](const TCHAR* InFilenameOrDirectory, const FFileStatData& InStatData) -> bool
+		{
+			if (!InStatData.bIsDirectory && FStringView(InFilenameOrDirectory).EndsWith(PAK_INDEX_CACHE_EXTENSION))
+			{
+				CacheFiles.Add({ InFilenameOrDirectory, InStatData.FileSize, InStatData.ModificationTime });
+				TotalSize += InStatData.FileSize;
+			}
+			return true;
+		});
+
+	if (TotalSize <= CacheSizeLimit)
+	{
+		return;
+	}
+
+	CacheFiles.Sort([](const FCacheFile& A, const FCacheFile& B) -> bool
+		{
+			return A.LastUsed < B.LastUsed;
+		});
+
+	for (const FCacheFile& CacheFile : CacheFiles)
+	{
+		if (TotalSize <= CacheSizeLimit)
+		{
+			break;
+		}
+
+		if (IFileManager::Get().Delete(*CacheFile.Path, false, true, true))
+		{
+			UE_LOG(LogPakAnalyzer, Log, TEXT("Remove index cache %s to fit the size limit."), *CacheFile.Path);
+			TotalSize -= CacheFile.Size;
+		}
+	}
+}
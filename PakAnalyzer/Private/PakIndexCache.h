@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Memory/MemoryView.h"
+#include "Misc/DateTime.h"
+#include "Misc/SecureHash.h"
+#include "Templates/UniquePtr.h"
+
+#include "PackageGraph.h"
+#include "PakFileEntry.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Identifies one pak on disk, a cache file is only used when every field matches
+struct FPakIndexCacheKey
+{
+	FString PakPath;
+	int64 PakFileSize = 0;
+	FDateTime TimeStamp;
+	FSHAHash IndexHash;
+};
+
+/**
+ * Persistent cache of the file table, classes and parsed asset summaries of one pak.
+ * A warm reopen maps the cache file and rebuilds the tree from it, skipping index decoding, AssetRegistry.bin and the asset parse worker.
+ * Location and size cap come from the [UnrealPakViewer] section of the engine ini, see SOptionsWindow.
+ */
+class FPakIndexCache
+{
+public:
+	// Parts of the file after the header, each one with its own checksum
+	enum ESection
+	{
+		Section_Names,
+		Section_Tree,
+		Section_Assets,
+		Section_Count,
+	};
+
+	struct FSection
+	{
+		int64 Offset = 0;
+		int64 Size = 0;
+		uint32 Crc = 0;
+	};
+
+	explicit FPakIndexCache(const FPakIndexCacheKey& InKey);
+	~FPakIndexCache();
+
+	static bool IsEnabled();
+	static FString GetCacheDirectory();
+	static int64 GetCacheSizeLimit();
+	static bool MakeKey(const FString& InPakPath, const FPakInfo& InPakInfo, FPakIndexCacheKey& OutKey);
+
+	// Maps the cache file and validates key, version and section bounds, stale caches are deleted
+	bool Open();
+	void Close();
+	// Closes and deletes the cache file, it is written again after the next full load
+	void Invalidate();
+
+	const FString& GetMountPoint() const { return MountPoint; }
+
+	// Both read their section in place from the mapping, a corrupted section fails the load and the caller invalidates the cache
+	// Directories and files go into the table of InTreeRoot, sizes are not aggregated here
+	bool LoadTree(FPakTreeEntryPtr InTreeRoot, TArray<FPakFileEntryPtr>& OutAssetRegistryFiles) const;
+	// Restores asset summaries and the class map entries of this pak, the dependencies of its packages are appended to OutDependencies
+	bool LoadAssetSummaries(FPakTreeEntryPtr InTreeRoot, TArray<FPackageDependency>& OutDependencies, TMap<FName, FName>& OutClassMap, FString& OutAssetRegistryPath) const;
+
+	// InFileClasses holds the class of every file in table order and InClassMap at least the entries of this pak, both copied by the caller so the save runs without the analyzer lock
+	static bool Save(const FPakIndexCacheKey& InKey, const FPakFileSumary& InSummary, FPakTreeEntryPtr InTreeRoot, const FPackageGraph& InPackageGraph, const TArray<FName>& InFileClasses, const TMap<FName, FName>& InClassMap, const FString& InAssetRegistryPath);
+	// Removes the least recently used cache files until the directory fits the size cap
+	static void Trim();
+
+protected:
+	static FString GetCacheFilePath(const FString& InPakPath);
+
+	// View of a section of Data, its checksum is verified the first time it is asked for
+	bool GetSection(ESection InSection, FMemoryView& OutView) const;
+	bool LoadNames() const;
+
+protected:
+	FPakIndexCacheKey Key;
+	FString CacheFilePath;
+	FString MountPoint;
+
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray64<uint8> FileData;
+	// Whole cache file, mapped or read into FileData
+	FMemoryView Data;
+	FSection Sections[Section_Count];
+
+	// Filled from the name section by the first load, a cache is only read by one thread at a time
+	mutable bool bSectionChecked[Section_Count] = {};
+	mutable bool bNamesLoaded = false;
+	mutable TArray<FName> Names;
+};
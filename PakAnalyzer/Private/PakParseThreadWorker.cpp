@@ -8,6 +8,7 @@
 #include "IPlatformFilePak.h"
 #include "Misc/Compression.h"
 #include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
 #include "Misc/ScopeLock.h"
 #include "Serialization/Archive.h"
 #include "Serialization/MemoryWriter.h"
@@ -19,6 +20,7 @@
 
 #include "CommonDefines.h"
 #include "ExtractThreadWorker.h"
+#include "MappedPakReader.h"
 
 class FPakParseMemoryReader : public FMemoryReader
 {
@@ -53,6 +55,89 @@ protected:
 	const TArray<FNameEntryId>& NameMap;
 };
 
+// Pak readers and scratch buffers of one parse task, reused by every asset the task picks up
+struct FPakParseContext
+{
+	static const int64 CopyBufferSize = 8 * 1024 * 1024; // 8MB buffer for extracting
+	static const int32 MaxRetainedFileBufferSize = 64 * 1024 * 1024;
+	static const int64 SummaryReadSize = 64 * 1024; // Large enough for the package summary, usually one compression block
+
+	~FPakParseContext()
+	{
+		FMemory::Free(CopyBuffer);
+		FMemory::Free(CompressionBuffer);
+	}
+
+	// Files are ordered by pak, a context only keeps the reader of the pak it is in and moves on with its range
+	FArchive* GetReader(int32 InPakIndex, const FString& InPakFilePath)
+	{
+		// A reader left in error state by a broken asset is reopened
+		if (!Reader || Reader->IsError() || ReaderPakIndex != InPakIndex)
+		{
+			Reader.Reset(IFileManager::Get().CreateFileReader(*InPakFilePath));
+			ReaderPakIndex = InPakIndex;
+		}
+
+		return Reader.Get();
+	}
+
+	void* GetCopyBuffer()
+	{
+		if (!CopyBuffer)
+		{
+			CopyBuffer = FMemory::Malloc(CopyBufferSize);
+		}
+
+		return CopyBuffer;
+	}
+
+	TUniquePtr<FArchive> Reader;
+	int32 ReaderPakIndex = INDEX_NONE;
+	FExtractPipeline Pipeline;
+	void* CopyBuffer = nullptr;
+	uint8* CompressionBuffer = nullptr;
+	int64 CompressionBufferSize = 0;
+	TArray<uint8> FileBuffer;
+};
+
+// Hands out one context per running task, a context is never used by two threads at the same time
+class FPakParseContextPool
+{
+public:
+	// Prefers a context that has InPakIndex open already, with one context per thread there are never more readers than threads
+	TUniquePtr<FPakParseContext> Acquire(int32 InPakIndex)
+	{
+		FScopeLock ScopeLock(&Mutex);
+		for (int32 Index = FreeContexts.Num() - 1; Index >= 0; --Index)
+		{
+			if (FreeContexts[Index]->ReaderPakIndex == InPakIndex)
+			{
+				TUniquePtr<FPakParseContext> Context = MoveTemp(FreeContexts[Index]);
+				FreeContexts.RemoveAtSwap(Index, 1, false);
+				return Context;
+			}
+		}
+
+		return FreeContexts.Num() > 0 ? FreeContexts.Pop(false) : MakeUnique<FPakParseContext>();
+	}
+
+	void Release(TUniquePtr<FPakParseContext>&& InContext)
+	{
+		// Don't keep the content of a huge asset around for the rest of the parse
+		if (InContext->FileBuffer.Max() > FPakParseContext::MaxRetainedFileBufferSize)
+		{
+			InContext->FileBuffer.Empty();
+		}
+
+		FScopeLock ScopeLock(&Mutex);
+		FreeContexts.Add(MoveTemp(InContext));
+	}
+
+protected:
+	FCriticalSection Mutex;
+	TArray<TUniquePtr<FPakParseContext>> FreeContexts;
+};
+
 template<class T>
 FString FindFullPath(const TArray<T>& InMaps, int32 Index, const FString& InPathSpliter = TEXT("/"))
 {
@@ -73,8 +158,33 @@ FString FindFullPath(const TArray<T>& InMaps, int32 Index, const FString& InPath
 	return ObjectPath;
 }
 
+// Only the package header is parsed, the summary is read first to learn its size.
+// InReadRange decodes [0, InSize) of the asset into InBuffer
+static bool ReadAssetHeader(const FPakEntry& InEntry, const TArray<uint8>& InBuffer, TFunctionRef<bool(int64 InSize)> InReadRange)
+{
+	if (!InReadRange(FPakParseContext::SummaryReadSize))
+	{
+		return false;
+	}
+
+	FMemoryReader SummaryReader(InBuffer);
+	FPackageFileSummary PackageSummary;
+	SummaryReader << PackageSummary;
+
+	int64 HeaderSize = InEntry.UncompressedSize;
+	if (!SummaryReader.IsError() && PackageSummary.TotalHeaderSize > 0)
+	{
+		// Preload dependencies are part of the header in cooked packages, keep them covered anyway
+		const int64 PreloadDependencyEnd = PackageSummary.PreloadDependencyCount > 0 ? PackageSummary.PreloadDependencyOffset + (int64)PackageSummary.PreloadDependencyCount * sizeof(FPackageIndex) : 0;
+		HeaderSize = FMath::Min<int64>(FMath::Max<int64>(PackageSummary.TotalHeaderSize, PreloadDependencyEnd), InEntry.UncompressedSize);
+	}
+
+	return HeaderSize <= InBuffer.Num() || InReadRange(HeaderSize);
+}
+
 FPakParseThreadWorker::FPakParseThreadWorker()
 	: Thread(nullptr)
+	, bMappedReads(false)
 {
 }
 
@@ -96,17 +206,40 @@ uint32 FPakParseThreadWorker::Run()
 	const static bool bForceSingleThread = false;
 	const int32 TotalCount = Files.Num();
 	
-	TMultiMap<FName, FName> DependsMap;
+	TArray<FPackageDependency> Dependencies;
 	TMap<FName, FName> ClassMap;
 
+	// Readers stay open for the whole parse, they are closed when the pool goes out of scope
+	FPakParseContextPool ContextPool;
+
+	// One read only mapping per pak, shared by every task and unmapped once the parse is over. Null for a pak that can't be mapped
+	TArray<TUniquePtr<FMappedPakReader>> MappedReaders;
+	MappedReaders.SetNum(Summaries.Num());
+	if (bMappedReads && !OnReadAssetContent.IsBound())
+	{
+		TBitArray<> ParsedPaks(false, Summaries.Num());
+		for (const FPakFileEntryPtr& File : Files)
+		{
+			if (Summaries.IsValidIndex(File->OwnerPakIndex))
+			{
+				ParsedPaks[File->OwnerPakIndex] = true;
+			}
+		}
+
+		for (TConstSetBitIterator<> It(ParsedPaks); It; ++It)
+		{
+			// Only the headers of the assets are read, scattered over the pak
+			MappedReaders[It.GetIndex()] = FMappedPakReader::Open(Summaries[It.GetIndex()].PakFilePath, FMappedPakReader::EAccessPattern::Random);
+		}
+	}
+
 	// Parse assets
-	ParallelFor(TotalCount, [this, &DependsMap, &ClassMap, &Mutex](int32 InIndex){
+	ParallelFor(TotalCount, [this, &Dependencies, &ClassMap, &Mutex, &ContextPool, &MappedReaders](int32 InIndex){
 		if (StopTaskCounter.GetValue() > 0)
 		{
 			return;
 		}
 
-		TArray<uint8> FileBuffer;
 		bool SerializeSuccess = false;
 
 		FPakFileEntryPtr File = Files[InIndex];
@@ -115,56 +248,80 @@ uint32 FPakParseThreadWorker::Run()
 			return;
 		}
 
+		TUniquePtr<FPakParseContext> Context = ContextPool.Acquire(File->OwnerPakIndex);
+		ON_SCOPE_EXIT
+		{
+			ContextPool.Release(MoveTemp(Context));
+		};
+
+		TArray<uint8>& FileBuffer = Context->FileBuffer;
+		FileBuffer.Reset();
+
 		const FPakFileSumary& Summary = Summaries[File->OwnerPakIndex];
-		const FString PakFilePath = Summary.PakFilePath;
 		const int32 PakVersion = Summary.PakInfo.Version;
-		const FAES::FAESKey AESKey = Summary.DecryptAESKey;
+		const FAES::FAESKey& AESKey = Summary.DecryptAESKey;
 
 		if (OnReadAssetContent.IsBound())
 		{
 			OnReadAssetContent.Execute(File, SerializeSuccess, FileBuffer);
 		}
+		else if (const FMappedPakReader* MappedReader = MappedReaders[File->OwnerPakIndex].Get())
+		{
+			FPakEntry EntryInfo;
+			int64 DataOffset = 0;
+			if (MappedReader->ReadEntry(File->PakEntry.Offset, PakVersion, EntryInfo, DataOffset) && FExtractThreadWorker::ResolvePayloadEntry(File->PakEntry, EntryInfo))
+			{
+				const bool bHasRelativeCompressedChunkOffsets = PakVersion >= FPakInfo::PakFile_Version_RelativeChunkOffsets;
+
+				// Blocks are decoded straight from the mapping
+				auto ReadAssetRange = [&](int64 InSize) -> bool
+				{
+					FileBuffer.Reset();
+					FMemoryWriter Writer(FileBuffer, false, true);
+					return Context->Pipeline.CopyFile(Writer, *MappedReader, EntryInfo, DataOffset, AESKey, File->CompressionMethod, bHasRelativeCompressedChunkOffsets, InSize);
+				};
+
+				SerializeSuccess = ReadAssetHeader(EntryInfo, FileBuffer, ReadAssetRange);
+			}
+		}
 		else
 		{
-			FArchive* ReaderArchive = IFileManager::Get().CreateFileReader(*PakFilePath);
+			FArchive* ReaderArchive = Context->GetReader(File->OwnerPakIndex, Summary.PakFilePath);
+			if (!ReaderArchive)
+			{
+				UE_LOG(LogPakAnalyzer, Error, TEXT("Parse asset failed! Unable to open pak file! Path: %s."), *Summary.PakFilePath);
+				return;
+			}
+
 			ReaderArchive->Seek(File->PakEntry.Offset);
 
 			FPakEntry EntryInfo;
 			EntryInfo.Serialize(*ReaderArchive, PakVersion);
 
-			if (EntryInfo.IndexDataEquals(File->PakEntry))
+			if (FExtractThreadWorker::ResolvePayloadEntry(File->PakEntry, EntryInfo))
 			{
-				FMemoryWriter Writer(FileBuffer, false, true);
+				const int64 DataOffset = File->PakEntry.Offset + EntryInfo.GetSerializedSize(PakVersion);
+				const bool bHasRelativeCompressedChunkOffsets = PakVersion >= FPakInfo::PakFile_Version_RelativeChunkOffsets;
 
-				if (EntryInfo.CompressionMethodIndex == 0)
+				// Decodes [0, InSize) of the asset, only the compression blocks covering it are read
+				auto ReadAssetRange = [&](int64 InSize) -> bool
 				{
-					const int64 BufferSize = 8 * 1024 * 1024; // 8MB buffer for extracting
-					void* Buffer = FMemory::Malloc(BufferSize);
+					FileBuffer.Reset();
+					FMemoryWriter Writer(FileBuffer, false, true);
 
-					if (FExtractThreadWorker::BufferedCopyFile(Writer, *ReaderArchive, File->PakEntry, Buffer, BufferSize, AESKey))
+					if (EntryInfo.CompressionMethodIndex == 0)
 					{
-						SerializeSuccess = true;
+						ReaderArchive->Seek(DataOffset);
+						return FExtractThreadWorker::BufferedCopyFile(Writer, *ReaderArchive, EntryInfo, Context->GetCopyBuffer(), FPakParseContext::CopyBufferSize, AESKey, InSize);
 					}
-
-					FMemory::Free(Buffer);
-				}
-				else
-				{
-					uint8* PersistantCompressionBuffer = NULL;
-					int64 CompressionBufferSize = 0;
-					const bool bHasRelativeCompressedChunkOffsets = PakVersion >= FPakInfo::PakFile_Version_RelativeChunkOffsets;
-
-					if (FExtractThreadWorker::UncompressCopyFile(Writer, *ReaderArchive, File->PakEntry, PersistantCompressionBuffer, CompressionBufferSize, AESKey, File->CompressionMethod, bHasRelativeCompressedChunkOffsets))
+					else
 					{
-						SerializeSuccess = true;
+						return FExtractThreadWorker::UncompressCopyFile(Writer, *ReaderArchive, EntryInfo, Context->CompressionBuffer, Context->CompressionBufferSize, AESKey, File->CompressionMethod, bHasRelativeCompressedChunkOffsets, InSize);
 					}
+				};
 
-					FMemory::Free(PersistantCompressionBuffer);
-				}
+				SerializeSuccess = ReadAssetHeader(EntryInfo, FileBuffer, ReadAssetRange);
 			}
-
-			ReaderArchive->Close();
-			delete ReaderArchive;
 		}
 
 		if (SerializeSuccess)
@@ -366,7 +523,7 @@ uint32 FPakParseThreadWorker::Run()
 				ClassMap.Add(File->PackagePath, MainObjectClassName != NAME_None ? MainObjectClassName : MainClassObjectClassName);
 			}
 
-			const bool bFillDependency = File->AssetSummary->DependencyList.Num() <= 0;
+			TArray<FPackageDependency> FileDependencies;
 			for (int32 i = 0; i < File->AssetSummary->ObjectImports.Num(); ++i)
 			{
 				const FObjectImport& Import = Imports[i];
@@ -374,17 +531,17 @@ uint32 FPakParseThreadWorker::Run()
 
 				ImportEx->ObjectPath = *FindFullPath(Imports, i);
 
-				if (bFillDependency && Import.ClassName == "Package" && !ImportEx->ObjectPath.ToString().StartsWith(TEXT("/Script")))
+				if (Import.ClassName == "Package" && !ImportEx->ObjectPath.ToString().StartsWith(TEXT("/Script")))
 				{
-					FPackageInfoPtr Depends = MakeShared<FPackageInfo>();
-					Depends->PackageName = ImportEx->ObjectPath;
-					File->AssetSummary->DependencyList.Add(Depends);
-
-					FScopeLock ScopeLock(&Mutex);
-					DependsMap.Add(ImportEx->ObjectPath, File->PackagePath);
+					FileDependencies.Add({ File->PackagePath, ImportEx->ObjectPath });
 				}
 			}
-			File->AssetSummary->DependencyList.Shrink();
+
+			if (FileDependencies.Num() > 0)
+			{
+				FScopeLock ScopeLock(&Mutex);
+				Dependencies.Append(FileDependencies);
+			}
 
 			// Serialize Preload Dependency
 			TArray<FPackageIndex> PreloadDependencies;
@@ -470,34 +627,19 @@ uint32 FPakParseThreadWorker::Run()
 		}
 	}, bForceSingleThread);
 
-	// Parse depends
-	ParallelFor(TotalCount, [this, &DependsMap](int32 InIndex) {
-		if (StopTaskCounter.GetValue() > 0)
-		{
-			return;
-		}
-
-		FPakFileEntryPtr File = Files[InIndex];
-		if (!File->AssetSummary.IsValid())
-		{
-			return;
-		}
-		if (File->AssetSummary->DependentList.Num() > 0)
-		{
-			return;
-		}
-
-		TArray<FName> Assets;
-		DependsMap.MultiFind(File->PackagePath, Assets);
+	// Packages the asset registry already described keep its dependencies, dependents are the reversed edges
+	if (StopTaskCounter.GetValue() <= 0 && PackageDependencies.IsValid())
+	{
+		PackageDependencies->Update(TArrayView<const FName>(), Dependencies, true);
 
-		for (const FName& Asset : Assets)
+		for (const FPakFileEntryPtr& File : Files)
 		{
-			FPackageInfoPtr Depends = MakeShared<FPackageInfo>();
-			Depends->PackageName = Asset;
-			File->AssetSummary->DependentList.Add(Depends);
+			if (File->AssetSummary.IsValid())
+			{
+				File->AssetSummary->PackageId = PackageDependencies->FindOrAddPackage(File->PackagePath);
+			}
 		}
-		File->AssetSummary->DependentList.Shrink();
-	}, bForceSingleThread);
+	}
 
 	OnParseFinish.ExecuteIfBound(StopTaskCounter.GetValue() > 0, ClassMap);
 
@@ -549,6 +691,18 @@ void FPakParseThreadWorker::StartParse(TArray<FPakFileEntryPtr>& InFiles, TArray
 
 	Files = MoveTemp(InFiles);
 	Summaries = MoveTemp(InSummaries);
+	bMappedReads = FMappedPakReader::IsEnabled();
+
+	// ParallelFor hands out contiguous ranges, so a task stays in one pak and reads forward through it
+	Files.Sort([](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			if (A->OwnerPakIndex == B->OwnerPakIndex)
+			{
+				return A->PakEntry.Offset < B->PakEntry.Offset;
+			}
+
+			return A->OwnerPakIndex < B->OwnerPakIndex;
+		});
 
 	Thread = FRunnableThread::Create(this, TEXT("AssetParseThreadWorker"), 0, EThreadPriority::TPri_Highest);
 }
@@ -5,6 +5,7 @@
 #include "Misc/AES.h"
 
 #include "Misc/Guid.h"
+#include "PackageGraph.h"
 #include "PakFileEntry.h"
 
 typedef TMap<FName, FName> ClassTypeMap;
@@ -27,6 +28,8 @@ public:
 	void StartParse(TArray<FPakFileEntryPtr>& InFiles, TArray<FPakFileSumary>& InSummaries);
 
 	TSharedPtr<class FAssetRegistryState> AssetRegistryState;
+	// Import tables fill the packages the asset registry left without dependencies
+	FPackageDependenciesPtr PackageDependencies;
 	FOnReadAssetContent OnReadAssetContent;
 	FOnParseFinish OnParseFinish;
 
@@ -41,4 +44,6 @@ protected:
 	//本pak中有几个upackage(uasset和uexp对应一个)
 	TArray<FPakFileEntryPtr> Files;
 	TArray<FPakFileSumary> Summaries;
+	// Read from the config when the parse starts
+	bool bMappedReads;
 };
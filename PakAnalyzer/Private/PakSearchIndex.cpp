@@ -0,0 +1,322 @@
+#include "PakSearchIndex.h"
+
+#include "Containers/StringConv.h"
+#include "Misc/StringBuilder.h"
+
+static FORCEINLINE bool IsPathSeparator(ANSICHAR InChar)
+{
+	return InChar == '/' || InChar == '\\';
+}
+
+void FPakSearchIndex::Build(const FPakFileTable& InFileTable)
+{
+	// Directory path as AppendFilePath writes it in front of a file name
+	TStringBuilder<256> PathBuilder;
+	const int32 DirectoryCount = InFileTable.Directories.Num();
+	DirectoryBuffer.Reset();
+	DirectoryOffsets.Reset(DirectoryCount + 1);
+	DirectoryParentLengths.Reset(DirectoryCount);
+	DirectoryParents.Reset(DirectoryCount);
+	for (int32 DirectoryIndex = 0; DirectoryIndex < DirectoryCount; ++DirectoryIndex)
+	{
+		PathBuilder.Reset();
+		InFileTable.AppendDirectoryPath(DirectoryIndex, PathBuilder);
+		if (PathBuilder.Len() > 0 && PathBuilder.LastChar() != TEXT('/') && PathBuilder.LastChar() != TEXT('\\'))
+		{
+			PathBuilder << TEXT('/');
+		}
+
+		const int32 Offset = DirectoryBuffer.Num();
+		DirectoryOffsets.Add(Offset);
+		AppendLower(PathBuilder.ToView(), DirectoryBuffer);
+
+		// Parents are added before their children, their path is complete
+		const int32 ParentIndex = DirectoryIndex > 0 ? InFileTable.DirectoryParents[DirectoryIndex] : INDEX_NONE;
+		int32 ParentLength = INDEX_NONE;
+		if (DirectoryParents.IsValidIndex(ParentIndex))
+		{
+			const FAnsiStringView ParentPath = GetDirectory(ParentIndex);
+			const FAnsiStringView DirectoryPath(DirectoryBuffer.GetData() + Offset, DirectoryBuffer.Num() - Offset);
+			if (DirectoryPath.StartsWith(ParentPath, ESearchCase::CaseSensitive))
+			{
+				ParentLength = ParentPath.Len();
+			}
+		}
+		DirectoryParents.Add(ParentIndex);
+		DirectoryParentLengths.Add(ParentLength);
+	}
+	DirectoryOffsets.Add(DirectoryBuffer.Num());
+
+	const int32 FileCount = InFileTable.Num();
+	DirectoryFileOffsets.Reset(DirectoryCount + 1);
+	DirectoryFileOffsets.SetNumZeroed(DirectoryCount + 1);
+	for (int32 FileIndex = 0; FileIndex < FileCount; ++FileIndex)
+	{
+		++DirectoryFileOffsets[InFileTable.ParentDirectories[FileIndex] + 1];
+	}
+	for (int32 DirectoryIndex = 0; DirectoryIndex < DirectoryCount; ++DirectoryIndex)
+	{
+		DirectoryFileOffsets[DirectoryIndex + 1] += DirectoryFileOffsets[DirectoryIndex];
+	}
+
+	DirectoryFiles.Reset(FileCount);
+	DirectoryFiles.SetNumUninitialized(FileCount);
+	{
+		TArray<int32> FillOffsets(DirectoryFileOffsets.GetData(), DirectoryCount);
+		for (int32 FileIndex = 0; FileIndex < FileCount; ++FileIndex)
+		{
+			DirectoryFiles[FillOffsets[InFileTable.ParentDirectories[FileIndex]]++] = FileIndex;
+		}
+	}
+
+	NameBuffer.Reset();
+	NameOffsets.Reset(FileCount + 1);
+	for (int32 FileIndex = 0; FileIndex < FileCount; ++FileIndex)
+	{
+		NameOffsets.Add(NameBuffer.Num());
+		AppendLower(InFileTable.GetFileName(FileIndex), NameBuffer);
+	}
+	NameOffsets.Add(NameBuffer.Num());
+
+	// Counted first then filled, LastBlocks keeps a block once in the list of a trigram it has several times
+	TArray<int32> LastBlocks;
+	LastBlocks.Init(INDEX_NONE, TrigramHashCount);
+	TrigramBlockOffsets.Reset(TrigramHashCount + 1);
+	TrigramBlockOffsets.SetNumZeroed(TrigramHashCount + 1);
+	for (int32 FileIndex = 0; FileIndex < FileCount; ++FileIndex)
+	{
+		const int32 BlockIndex = FileIndex / NamesPerBlock;
+		for (int32 CharIndex = NameOffsets[FileIndex]; CharIndex + 3 <= NameOffsets[FileIndex + 1]; ++CharIndex)
+		{
+			const uint32 Hash = HashTrigram(NameBuffer.GetData() + CharIndex);
+			if (LastBlocks[Hash] != BlockIndex)
+			{
+				LastBlocks[Hash] = BlockIndex;
+				++TrigramBlockOffsets[Hash + 1];
+			}
+		}
+	}
+	for (int32 Hash = 0; Hash < TrigramHashCount; ++Hash)
+	{
+		TrigramBlockOffsets[Hash + 1] += TrigramBlockOffsets[Hash];
+	}
+
+	TrigramBlocks.Reset(TrigramBlockOffsets[TrigramHashCount]);
+	TrigramBlocks.SetNumUninitialized(TrigramBlockOffsets[TrigramHashCount]);
+	TArray<int32> FillOffsets(TrigramBlockOffsets.GetData(), TrigramHashCount);
+	LastBlocks.Init(INDEX_NONE, TrigramHashCount);
+	for (int32 FileIndex = 0; FileIndex < FileCount; ++FileIndex)
+	{
+		const int32 BlockIndex = FileIndex / NamesPerBlock;
+		for (int32 CharIndex = NameOffsets[FileIndex]; CharIndex + 3 <= NameOffsets[FileIndex + 1]; ++CharIndex)
+		{
+			const uint32 Hash = HashTrigram(NameBuffer.GetData() + CharIndex);
+			if (LastBlocks[Hash] != BlockIndex)
+			{
+				LastBlocks[Hash] = BlockIndex;
+				TrigramBlocks[FillOffsets[Hash]++] = BlockIndex;
+			}
+		}
+	}
+
+	NameBuffer.Shrink();
+	DirectoryBuffer.Shrink();
+}
+
+void FPakSearchIndex::Search(const FPakFileTable& InFileTable, const FString& InText, TArray<int32>& OutFileIndices) const
+{
+	const int32 FileCount = NameOffsets.Num() - 1;
+
+	TArray<ANSICHAR> SearchBuffer;
+	AppendLower(InText, SearchBuffer);
+	const FAnsiStringView SearchText(SearchBuffer.GetData(), SearchBuffer.Num());
+	if (SearchText.Len() <= 0)
+	{
+		for (int32 FileIndex = 0; FileIndex < FileCount; ++FileIndex)
+		{
+			OutFileIndices.Add(FileIndex);
+		}
+		return;
+	}
+
+	int32 LastSeparator = INDEX_NONE;
+	for (int32 CharIndex = SearchText.Len() - 1; CharIndex >= 0; --CharIndex)
+	{
+		if (IsPathSeparator(SearchText[CharIndex]))
+		{
+			LastSeparator = CharIndex;
+			break;
+		}
+	}
+
+	// Names never contain a separator, text with one can only match a directory path or span into a name
+	const bool bSearchNames = LastSeparator == INDEX_NONE;
+	const bool bCanSpan = LastSeparator != INDEX_NONE && LastSeparator + 1 < SearchText.Len();
+	const FAnsiStringView DirectoryPart = SearchText.Left(LastSeparator + 1);
+	const FAnsiStringView NamePart = SearchText.RightChop(LastSeparator + 1);
+
+	// Rows are marked first and listed in table order at the end
+	TBitArray<> MatchedFiles(false, FileCount);
+	bool bAnyMatch = false;
+
+	// 0: no match, 1: every file in the directory matches, 2: files whose name starts with NamePart match
+	TArray<uint8> DirectoryMatches;
+	DirectoryMatches.AddZeroed(DirectoryOffsets.Num() - 1);
+	for (int32 DirectoryIndex = 0; DirectoryIndex < DirectoryMatches.Num(); ++DirectoryIndex)
+	{
+		const FAnsiStringView DirectoryPath = GetDirectory(DirectoryIndex);
+		const int32 ParentLength = DirectoryParentLengths[DirectoryIndex];
+		if (ParentLength != INDEX_NONE && DirectoryMatches[DirectoryParents[DirectoryIndex]] == 1)
+		{
+			DirectoryMatches[DirectoryIndex] = 1;
+		}
+		// A match that starts early enough to end in the parent path was found in the parent already
+		else if (FindText(DirectoryPath.RightChop(ParentLength != INDEX_NONE ? FMath::Max(0, ParentLength - SearchText.Len() + 1) : 0), SearchText) != INDEX_NONE)
+		{
+			DirectoryMatches[DirectoryIndex] = 1;
+		}
+		else if (bCanSpan && DirectoryPath.EndsWith(DirectoryPart, ESearchCase::CaseSensitive))
+		{
+			DirectoryMatches[DirectoryIndex] = 2;
+		}
+
+		if (DirectoryMatches[DirectoryIndex] != 0)
+		{
+			for (int32 FileOffset = DirectoryFileOffsets[DirectoryIndex]; FileOffset < DirectoryFileOffsets[DirectoryIndex + 1]; ++FileOffset)
+			{
+				const int32 FileIndex = DirectoryFiles[FileOffset];
+				if (DirectoryMatches[DirectoryIndex] == 1 || GetName(FileIndex).StartsWith(NamePart, ESearchCase::CaseSensitive))
+				{
+					MatchedFiles[FileIndex] = true;
+					bAnyMatch = true;
+				}
+			}
+		}
+	}
+
+	if (bSearchNames)
+	{
+		TArray<int32> CandidateBlocks;
+		FindCandidateBlocks(SearchText, CandidateBlocks);
+		for (const int32 BlockIndex : CandidateBlocks)
+		{
+			const int32 LastFileIndex = FMath::Min(FileCount, (BlockIndex + 1) * NamesPerBlock);
+			for (int32 FileIndex = BlockIndex * NamesPerBlock; FileIndex < LastFileIndex; ++FileIndex)
+			{
+				if (!MatchedFiles[FileIndex] && FindText(GetName(FileIndex), SearchText) != INDEX_NONE)
+				{
+					MatchedFiles[FileIndex] = true;
+					bAnyMatch = true;
+				}
+			}
+		}
+	}
+
+	if (bAnyMatch)
+	{
+		for (TConstSetBitIterator<> It(MatchedFiles); It; ++It)
+		{
+			OutFileIndices.Add(It.GetIndex());
+		}
+	}
+}
+
+void FPakSearchIndex::FindCandidateBlocks(FAnsiStringView InSearch, TArray<int32>& OutBlocks) const
+{
+	const int32 BlockCount = FMath::DivideAndRoundUp(NameOffsets.Num() - 1, NamesPerBlock);
+
+	TArray<uint32, TInlineAllocator<32>> SearchTrigrams;
+	for (int32 CharIndex = 0; CharIndex + 3 <= InSearch.Len(); ++CharIndex)
+	{
+		SearchTrigrams.AddUnique(HashTrigram(InSearch.GetData() + CharIndex));
+	}
+
+	// Text shorter than a trigram can be in any block
+	if (SearchTrigrams.Num() == 0)
+	{
+		for (int32 BlockIndex = 0; BlockIndex < BlockCount; ++BlockIndex)
+		{
+			OutBlocks.Add(BlockIndex);
+		}
+		return;
+	}
+
+	// The shortest list bounds the result, the others only remove blocks from it
+	SearchTrigrams.Sort([this](uint32 A, uint32 B)
+	{
+		return TrigramBlockOffsets[A + 1] - TrigramBlockOffsets[A] < TrigramBlockOffsets[B + 1] - TrigramBlockOffsets[B];
+	});
+
+	OutBlocks.Append(TrigramBlocks.GetData() + TrigramBlockOffsets[SearchTrigrams[0]], TrigramBlockOffsets[SearchTrigrams[0] + 1] - TrigramBlockOffsets[SearchTrigrams[0]]);
+	for (int32 TrigramIndex = 1; TrigramIndex < SearchTrigrams.Num() && OutBlocks.Num() > 0; ++TrigramIndex)
+	{
+		const uint32 Hash = SearchTrigrams[TrigramIndex];
+		int32 ListOffset = TrigramBlockOffsets[Hash];
+		const int32 ListEnd = TrigramBlockOffsets[Hash + 1];
+		int32 KeptCount = 0;
+		for (const int32 BlockIndex : OutBlocks)
+		{
+			while (ListOffset < ListEnd && TrigramBlocks[ListOffset] < BlockIndex)
+			{
+				++ListOffset;
+			}
+			if (ListOffset < ListEnd && TrigramBlocks[ListOffset] == BlockIndex)
+			{
+				OutBlocks[KeptCount++] = BlockIndex;
+			}
+		}
+		OutBlocks.SetNum(KeptCount, false);
+	}
+}
+
+void FPakSearchIndex::AppendLower(FStringView InText, TArray<ANSICHAR>& OutBuffer)
+{
+	// Same folding as ESearchCase::IgnoreCase, only ASCII letters
+	FTCHARToUTF8 Converted(InText.GetData(), InText.Len());
+
+	const int32 Offset = OutBuffer.Num();
+	OutBuffer.Append((const ANSICHAR*)Converted.Get(), Converted.Length());
+	for (int32 Index = Offset; Index < OutBuffer.Num(); ++Index)
+	{
+		ANSICHAR& Char = OutBuffer[Index];
+		if (Char >= 'A' && Char <= 'Z')
+		{
+			Char += 'a' - 'A';
+		}
+	}
+}
+
+uint32 FPakSearchIndex::HashTrigram(const ANSICHAR* InChars)
+{
+	const uint32 Trigram = (uint32)(uint8)InChars[0] | ((uint32)(uint8)InChars[1] << 8) | ((uint32)(uint8)InChars[2] << 16);
+	return (Trigram * 2654435761u) >> (32 - TrigramHashBits);
+}
+
+int32 FPakSearchIndex::FindText(FAnsiStringView InText, FAnsiStringView InSearch)
+{
+	const int32 LastStart = InText.Len() - InSearch.Len();
+	if (LastStart < 0)
+	{
+		return INDEX_NONE;
+	}
+
+	// memchr finds the candidates for the first char, the rest is compared only there
+	const ANSICHAR* Data = InText.GetData();
+	const ANSICHAR FirstChar = InSearch[0];
+	for (int32 Start = 0; Start <= LastStart; ++Start)
+	{
+		const ANSICHAR* Found = (const ANSICHAR*)memchr(Data + Start, FirstChar, LastStart - Start + 1);
+		if (!Found)
+		{
+			return INDEX_NONE;
+		}
+
+		Start = (int32)(Found - Data);
+		if (FMemory::Memcmp(Found + 1, InSearch.GetData() + 1, InSearch.Len() - 1) == 0)
+		{
+			return Start;
+		}
+	}
+
+	return INDEX_NONE;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "PakFileEntry.h"
+
+/**
+ * Case insensitive substring index over the file paths of one file table, built once after load.
+ * File names are lowercased into one packed UTF-8 buffer, split in blocks of NamesPerBlock names. Every trigram has the sorted list of the blocks that contain it,
+ * a search only scans the blocks in all the lists of its trigrams.
+ * Directory paths are matched once per directory, a file matches when its directory path does, its name does, or the text spans the last separator.
+ * A directory path starts with the path of its parent, so a subdirectory of a match matches too and the others only search past what the parent already covered.
+ */
+class FPakSearchIndex
+{
+public:
+	void Build(const FPakFileTable& InFileTable);
+
+	// Rows of the matched files in table order, same result as searching every full path with ESearchCase::IgnoreCase
+	void Search(const FPakFileTable& InFileTable, const FString& InText, TArray<int32>& OutFileIndices) const;
+
+protected:
+	static const int32 NamesPerBlock = 16;
+	static const int32 TrigramHashBits = 16;
+	static const int32 TrigramHashCount = 1 << TrigramHashBits;
+
+	static void AppendLower(FStringView InText, TArray<ANSICHAR>& OutBuffer);
+	static uint32 HashTrigram(const ANSICHAR* InChars);
+	static int32 FindText(FAnsiStringView InText, FAnsiStringView InSearch);
+	// Blocks of the names that may contain every trigram of InSearch, in ascending order
+	void FindCandidateBlocks(FAnsiStringView InSearch, TArray<int32>& OutBlocks) const;
+
+	FORCEINLINE FAnsiStringView GetName(int32 InFileIndex) const
+	{
+		return FAnsiStringView(NameBuffer.GetData() + NameOffsets[InFileIndex], NameOffsets[InFileIndex + 1] - NameOffsets[InFileIndex]);
+	}
+
+	FORCEINLINE FAnsiStringView GetDirectory(int32 InDirectoryIndex) const
+	{
+		return FAnsiStringView(DirectoryBuffer.GetData() + DirectoryOffsets[InDirectoryIndex], DirectoryOffsets[InDirectoryIndex + 1] - DirectoryOffsets[InDirectoryIndex]);
+	}
+
+protected:
+	// Lowercased file names, NameOffsets has one extra entry for the end of the last name
+	TArray<ANSICHAR> NameBuffer;
+	TArray<int32> NameOffsets;
+
+	// Lowercased directory paths with the path prefix and the separator written before file names
+	TArray<ANSICHAR> DirectoryBuffer;
+	TArray<int32> DirectoryOffsets;
+	// Length of the parent path each directory path starts with, INDEX_NONE when it doesn't
+	TArray<int32> DirectoryParentLengths;
+	TArray<int32> DirectoryParents;
+
+	// Files of each directory in table order, DirectoryFileOffsets has one extra entry for the end
+	TArray<int32> DirectoryFiles;
+	TArray<int32> DirectoryFileOffsets;
+
+	// Ascending blocks of every trigram hash, TrigramBlockOffsets has one extra entry for the end
+	TArray<int32> TrigramBlocks;
+	TArray<int32> TrigramBlockOffsets;
+};
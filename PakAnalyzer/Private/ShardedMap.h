@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformMisc.h"
+
+/**
+ * Read only map built on every worker at once.
+ * Keys are split by the high bits of their hash into shards, every shard is a TMap filled by a single task, so neither the build nor a lookup takes a lock.
+ * Items are added in index order, a later pair replaces an earlier one with the same key as TMap::Add does.
+ */
+template <typename KeyType, typename ValueType>
+class TShardedMap
+{
+public:
+	typedef TPair<KeyType, ValueType> FPair;
+
+	// InCollectPairs appends the pairs of item Index to OutPairs, it runs on several threads at once
+	void Build(int32 InItemCount, TFunctionRef<void(int32 Index, TArray<FPair>& OutPairs)> InCollectPairs)
+	{
+		static const EParallelForFlags ParallelForFlags = FPlatformMisc::IsDebuggerPresent() ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced;
+
+		const int32 TaskCount = FMath::Clamp(InItemCount / 256, 1, FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads()));
+		const int32 SliceSize = FMath::DivideAndRoundUp(InItemCount, TaskCount);
+
+		// Pairs of every task bucketed by shard, then each shard merges its buckets in task order
+		TArray<TArray<FPair>> Buckets;
+		Buckets.SetNum(TaskCount * ShardCount);
+		ParallelFor(TaskCount, [&Buckets, &InCollectPairs, InItemCount, SliceSize](int32 TaskIndex)
+		{
+			TArray<FPair> Pairs;
+			const int32 End = FMath::Min(InItemCount, (TaskIndex + 1) * SliceSize);
+			for (int32 Index = TaskIndex * SliceSize; Index < End; ++Index)
+			{
+				Pairs.Reset();
+				InCollectPairs(Index, Pairs);
+				for (FPair& Pair : Pairs)
+				{
+					Buckets[TaskIndex * ShardCount + GetShard(Pair.Key)].Add(MoveTemp(Pair));
+				}
+			}
+		}, ParallelForFlags);
+
+		ParallelFor(ShardCount, [this, &Buckets, TaskCount](int32 Shard)
+		{
+			int32 PairCount = 0;
+			for (int32 TaskIndex = 0; TaskIndex < TaskCount; ++TaskIndex)
+			{
+				PairCount += Buckets[TaskIndex * ShardCount + Shard].Num();
+			}
+
+			TMap<KeyType, ValueType>& Map = Shards[Shard];
+			Map.Empty(PairCount);
+			for (int32 TaskIndex = 0; TaskIndex < TaskCount; ++TaskIndex)
+			{
+				for (FPair& Pair : Buckets[TaskIndex * ShardCount + Shard])
+				{
+					Map.Add(MoveTemp(Pair.Key), MoveTemp(Pair.Value));
+				}
+			}
+		}, ParallelForFlags);
+	}
+
+	const ValueType* Find(const KeyType& InKey) const
+	{
+		return Shards[GetShard(InKey)].Find(InKey);
+	}
+
+	ValueType FindRef(const KeyType& InKey) const
+	{
+		return Shards[GetShard(InKey)].FindRef(InKey);
+	}
+
+	int32 Num() const
+	{
+		int32 Count = 0;
+		for (const TMap<KeyType, ValueType>& Map : Shards)
+		{
+			Count += Map.Num();
+		}
+		return Count;
+	}
+
+protected:
+	static const int32 ShardBits = 6;
+	static const int32 ShardCount = 1 << ShardBits;
+
+	// High bits of the mixed hash, the maps of the shards bucket by the low bits
+	static int32 GetShard(const KeyType& InKey)
+	{
+		return (int32)((GetTypeHash(InKey) * 0x9E3779B9u) >> (32 - ShardBits));
+	}
+
+protected:
+	TMap<KeyType, ValueType> Shards[ShardCount];
+};
@@ -2,16 +2,27 @@
 
 #include "UnrealAnalyzer.h"
 
+#include "Misc/ScopeLock.h"
+
 FUnrealAnalyzer::FUnrealAnalyzer()
 {
 	IoStoreAnalyzer = MakeShared<FIoStoreAnalyzer>();
 	PakAnalyzer = MakeShared<FPakAnalyzer>();
+
+	// Paks and containers depend on each other, both fill one graph
+	PakAnalyzer->SetPackageDependencies(PackageDependencies);
+	IoStoreAnalyzer->SetPackageDependencies(PackageDependencies);
+
+	// Each pak or container shows up here as soon as its part publishes it
+	PakAnalyzer->SetPublishOwner(this);
+	IoStoreAnalyzer->SetPublishOwner(this);
 	
 	Reset();
 }
 
 FUnrealAnalyzer::~FUnrealAnalyzer()
 {
+	CancelLoad();
 	Reset();
 
 	IoStoreAnalyzer.Reset();
@@ -22,44 +33,96 @@ bool FUnrealAnalyzer::LoadPakFiles(const TArray<FString>& InPakPaths, const TArr
 {
 	bool bResult = true;
 
+	// Every pak takes a trailer step and an index step, every container one step
+	int32 LoadStepCount = 0;
+	for (const FString& PakPath : InPakPaths)
+	{
+		LoadStepCount += PakPath.EndsWith(TEXT(".pak")) ? 2 : (PakPath.EndsWith(TEXT(".ucas")) ? 1 : 0);
+	}
+	AddLoadSteps(LoadStepCount);
+
+	// Both parts were reset on the game thread with this analyzer, see LoadPakFilesAsync.
+	// They publish into this analyzer too, paks first and containers after them
 	if (PakAnalyzer)
 	{
+		PakAnalyzer->SetLoadJob(LoadJob);
 		bResult &= PakAnalyzer->LoadPakFiles(InPakPaths, InDefaultAESKeys);
-		PakTreeRoots = PakAnalyzer->GetPakTreeRootNode();
-		PakFileSummaries = PakAnalyzer->GetPakFileSumary();
 	}
 	
-	if (IoStoreAnalyzer)
+	if (IoStoreAnalyzer && !IsLoadCancelled())
 	{
+		IoStoreAnalyzer->SetLoadJob(LoadJob);
 		bResult &= IoStoreAnalyzer->LoadPakFiles(InPakPaths, InDefaultAESKeys, PakAnalyzer ? PakAnalyzer->GetPakFileSumary().Num() : 0);
-		PakTreeRoots += IoStoreAnalyzer->GetPakTreeRootNode();
-		PakFileSummaries += IoStoreAnalyzer->GetPakFileSumary();
 	}
 
-	FPakAnalyzerDelegates::OnPakLoadFinish.Broadcast();
+	if (IsLoadCancelled())
+	{
+		return false;
+	}
+
+	RunOnGameThreadForLoad([]()
+		{
+			FPakAnalyzerDelegates::OnPakLoadFinish.Broadcast();
+		});
 	
 	return bResult;
 }
 
 void FUnrealAnalyzer::ExtractFiles(const FString& InOutputPath, TArray<FPakFileEntryPtr>& InFiles)
 {
-	// if (IoStoreAnalyzer)
-	// {
-	// 	IoStoreAnalyzer->ExtractFiles(InOutputPath, InFiles);
-	// }
+	// Pak summaries come first, IoStore containers are indexed after them
+	const int32 PakCount = PakAnalyzer ? PakAnalyzer->GetPakFileSumary().Num() : 0;
 
-	if (PakAnalyzer)
+	TArray<FPakFileEntryPtr> PakFiles;
+	TArray<FPakFileEntryPtr> IoStoreFiles;
+	for (const FPakFileEntryPtr& File : InFiles)
+	{
+		if (File->OwnerPakIndex < PakCount)
+		{
+			PakFiles.Add(File);
+		}
+		else
+		{
+			IoStoreFiles.Add(File);
+		}
+	}
+
+	if (PakFiles.Num() <= 0 && IoStoreFiles.Num() <= 0)
+	{
+		return;
+	}
+
+	// The previous extraction writes its last manifest records, or closes its archive, before the next one starts
+	CancelExtract();
+
+	// Pak and IoStore files are extracted at the same time, the window shows the sum of both
+	FExtractJobPtr Job = BeginExtractJob(InOutputPath);
+	if (!Job)
+	{
+		return;
+	}
+
+	if (PakAnalyzer && PakFiles.Num() > 0)
+	{
+		PakAnalyzer->SetExtractJob(Job, ExtractManifest, ExtractArchive);
+		PakAnalyzer->ExtractFiles(InOutputPath, PakFiles);
+	}
+
+	if (IoStoreAnalyzer && IoStoreFiles.Num() > 0)
 	{
-		PakAnalyzer->ExtractFiles(InOutputPath, InFiles);
+		IoStoreAnalyzer->SetExtractJob(Job, ExtractManifest, ExtractArchive);
+		IoStoreAnalyzer->ExtractFiles(InOutputPath, IoStoreFiles);
 	}
+
+	ReleaseExtractArchive();
 }
 
 void FUnrealAnalyzer::CancelExtract()
 {
-	// if (IoStoreAnalyzer)
-	// {
-	// 	IoStoreAnalyzer->CancelExtract();
-	// }
+	if (IoStoreAnalyzer)
+	{
+		IoStoreAnalyzer->CancelExtract();
+	}
 
 	if (PakAnalyzer)
 	{
@@ -69,10 +132,10 @@ void FUnrealAnalyzer::CancelExtract()
 
 void FUnrealAnalyzer::SetExtractThreadCount(int32 InThreadCount)
 {
-	// if (IoStoreAnalyzer)
-	// {
-	// 	IoStoreAnalyzer->SetExtractThreadCount(InThreadCount);
-	// }
+	if (IoStoreAnalyzer)
+	{
+		IoStoreAnalyzer->SetExtractThreadCount(InThreadCount);
+	}
 
 	if (PakAnalyzer)
 	{
@@ -80,6 +143,15 @@ void FUnrealAnalyzer::SetExtractThreadCount(int32 InThreadCount)
 	}
 }
 
+void FUnrealAnalyzer::LoadFileHashes(const TArray<FPakFileEntryPtr>& InFiles)
+{
+	// IoStore chunk hashes come from the toc, only pak entries are loaded lazily
+	if (PakAnalyzer)
+	{
+		PakAnalyzer->LoadFileHashes(InFiles);
+	}
+}
+
 void FUnrealAnalyzer::Reset()
 {
 	if (IoStoreAnalyzer)
@@ -91,4 +163,6 @@ void FUnrealAnalyzer::Reset()
 	{
 		PakAnalyzer->Reset();
 	}
+
+	FBaseAnalyzer::Reset();
 }
\ No newline at end of file
@@ -27,6 +27,7 @@ public:
 	virtual void ExtractFiles(const FString& InOutputPath, TArray<FPakFileEntryPtr>& InFiles) override;
 	virtual void CancelExtract() override;
 	virtual void SetExtractThreadCount(int32 InThreadCount) override;
+	virtual void LoadFileHashes(const TArray<FPakFileEntryPtr>& InFiles) override;
 	virtual void Reset() override;
 
 protected:
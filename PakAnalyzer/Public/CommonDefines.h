@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Logging/LogMacros.h"
 
+#include "PakFileEntry.h"
+
 DECLARE_LOG_CATEGORY_EXTERN(LogPakAnalyzer, Log, All);
 
 class FPakAnalyzerDelegates
@@ -12,16 +14,20 @@ class FPakAnalyzerDelegates
 public:
 	DECLARE_DELEGATE_RetVal_ThreeParams(FString, FOnGetAESKey, const FString&/* PakPath*/, const FGuid&/* Guid*/, bool& /*bCancel*/);
 	DECLARE_DELEGATE_OneParam(FOnLoadPakFailed, const FString&)
-	DECLARE_DELEGATE_ThreeParams(FOnUpdateExtractProgress, int32 /*CompleteCount*/, int32 /*ErrorCount*/, int32 /*TotalCount*/);
 	DECLARE_DELEGATE(FOnExtractStart);
 	DECLARE_MULTICAST_DELEGATE(FOnAssetParseFinish);
 	DECLARE_MULTICAST_DELEGATE(FOnPakLoadFinish);
+	DECLARE_MULTICAST_DELEGATE(FOnPakLoadStart);
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPakLoaded, FPakFileSumaryPtr /*Summary*/, FPakTreeEntryPtr /*TreeRoot*/);
 
 public:
 	static FOnGetAESKey OnGetAESKey;
 	static FOnLoadPakFailed OnLoadPakFailed;
-	static FOnUpdateExtractProgress OnUpdateExtractProgress;
 	static FOnExtractStart OnExtractStart;
 	static FOnAssetParseFinish OnAssetParseFinish;
 	static FOnPakLoadFinish OnPakLoadFinish;
+	static FOnPakLoadStart OnPakLoadStart;
+	// Fired during an async load as soon as the tree of one pak is built and published, its pak index is final.
+	// Classes and dependencies of the pak are filled in once every pak is in, before OnPakLoadFinish
+	static FOnPakLoaded OnPakLoaded;
 };
@@ -3,12 +3,147 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Misc/ScopeLock.h"
 
+#include "PackageGraph.h"
 #include "PakFileEntry.h"
 
 struct FPakEntry;
 
 static const int32 DEFAULT_EXTRACT_THREAD_COUNT = 4;
+static const int32 DEFAULT_INDEX_CACHE_SIZE_MB = 1024;
+static const TCHAR* const DEFAULT_INDEX_CACHE_FOLDER = TEXT("IndexCache");
+
+enum class EPakLoadPhase : uint8
+{
+	Pending,
+	ReadingTrailers,
+	LoadingIndices,
+	Merging,
+	Finished,
+};
+
+// Progress and cancellation of one LoadPakFilesAsync call, shared by the load thread and the caller
+class FPakLoadJob
+{
+public:
+	void Cancel() { bCancelled = true; }
+	bool IsCancelled() const { return bCancelled; }
+	bool IsFinished() const { return bFinished; }
+	// Valid once finished, false when cancelled
+	bool GetResult() const { return bResult; }
+
+	EPakLoadPhase GetPhase() const { return (EPakLoadPhase)Phase.GetValue(); }
+	float GetPercent() const
+	{
+		if (bFinished)
+		{
+			return 1.f;
+		}
+
+		const int32 Total = TotalSteps.GetValue();
+		return Total > 0 ? FMath::Clamp((float)CompletedSteps.GetValue() / Total, 0.f, 1.f) : 0.f;
+	}
+
+	// Analyzers report here from the load thread
+	void SetPhase(EPakLoadPhase InPhase) { Phase.Set((int32)InPhase); }
+	void AddSteps(int32 InStepCount) { TotalSteps.Add(InStepCount); }
+	void AdvanceStep() { CompletedSteps.Increment(); }
+	void Finish(bool bInResult)
+	{
+		bResult = bInResult;
+		Phase.Set((int32)EPakLoadPhase::Finished);
+		bFinished = true;
+	}
+
+protected:
+	FThreadSafeCounter Phase;
+	FThreadSafeCounter CompletedSteps;
+	FThreadSafeCounter TotalSteps;
+	FThreadSafeBool bCancelled;
+	FThreadSafeBool bFinished;
+	FThreadSafeBool bResult;
+};
+
+typedef TSharedPtr<FPakLoadJob, ESPMode::ThreadSafe> FPakLoadJobPtr;
+
+/**
+ * Progress of one ExtractFiles call, shared by the extract threads and the progress window.
+ * Every thread adds to counters of its own, the window sums them at its own rate, so a finished file costs an atomic add instead of a game thread task.
+ */
+class FExtractJob
+{
+public:
+	// Counters of one extract thread, kept on their own cache line
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FWorkerCounters
+	{
+		void AddBytes(int64 InByteCount) { CompleteBytes.Add(InByteCount); }
+		void AddFile(bool bInSuccess)
+		{
+			if (!bInSuccess)
+			{
+				ErrorCount.Increment();
+			}
+			CompleteCount.Increment();
+		}
+
+		FThreadSafeCounter CompleteCount;
+		FThreadSafeCounter ErrorCount;
+		FThreadSafeCounter64 CompleteBytes;
+	};
+
+	struct FSnapshot
+	{
+		int32 CompleteCount = 0;
+		int32 ErrorCount = 0;
+		int32 TotalCount = 0;
+		int64 CompleteBytes = 0;
+		int64 TotalBytes = 0;
+	};
+
+	// Analyzers add their files and threads before the threads start, counters live as long as the job
+	void AddTotal(int32 InFileCount, int64 InByteCount)
+	{
+		TotalCount.Add(InFileCount);
+		TotalBytes.Add(InByteCount);
+	}
+
+	FWorkerCounters& AddWorker()
+	{
+		FScopeLock Lock(&WorkersLock);
+		return *Workers.Add_GetRef(MakeUnique<FWorkerCounters>());
+	}
+
+	FSnapshot Sample() const
+	{
+		FSnapshot Snapshot;
+		Snapshot.TotalCount = TotalCount.GetValue();
+		Snapshot.TotalBytes = TotalBytes.GetValue();
+
+		FScopeLock Lock(&WorkersLock);
+		for (const TUniquePtr<FWorkerCounters>& Worker : Workers)
+		{
+			Snapshot.CompleteCount += Worker->CompleteCount.GetValue();
+			Snapshot.ErrorCount += Worker->ErrorCount.GetValue();
+			Snapshot.CompleteBytes += Worker->CompleteBytes.GetValue();
+		}
+		return Snapshot;
+	}
+
+protected:
+	FThreadSafeCounter TotalCount;
+	FThreadSafeCounter64 TotalBytes;
+
+	// Only taken when a thread starts and when the window samples
+	mutable FCriticalSection WorkersLock;
+	TArray<TUniquePtr<FWorkerCounters>> Workers;
+};
+
+typedef TSharedPtr<FExtractJob, ESPMode::ThreadSafe> FExtractJobPtr;
 
 class IPakAnalyzer
 {
@@ -17,14 +152,33 @@ public:
 	virtual ~IPakAnalyzer() {}
 
 	virtual bool LoadPakFiles(const TArray<FString>& InPakPaths, const TArray<FString>& InDefaultAESKeys, int32 ContainerStartIndex = 0) = 0;
+	// Loads on a worker thread, OnPakLoaded fires on the game thread for each pak as soon as its tree is built, OnPakLoadFinish once classes and dependencies are in
+	virtual FPakLoadJobPtr LoadPakFilesAsync(const TArray<FString>& InPakPaths, const TArray<FString>& InDefaultAESKeys) = 0;
+	// Cancels the running async load and waits for its thread to exit
+	virtual void CancelLoad() = 0;
+	// Job of the last LoadPakFilesAsync, null before the first one
+	virtual FPakLoadJobPtr GetLoadJob() const = 0;
 	virtual void GetFiles(const FString& InFilterText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InPakIndexFilter, TArray<FPakFileEntryPtr>& OutFiles) const = 0;
-	virtual const TArray<FPakFileSumaryPtr>& GetPakFileSumary() const = 0;
-	virtual const TArray<FPakTreeEntryPtr>& GetPakTreeRootNode() const = 0;
+	// Copies taken under the lock, a load appends each pak once its tree is built, in the order they finish
+	virtual TArray<FPakFileSumaryPtr> GetPakFileSumary() const = 0;
+	virtual TArray<FPakTreeEntryPtr> GetPakTreeRootNode() const = 0;
+	// A path ending with .tar or .zip streams the files into that archive instead of a folder
 	virtual void ExtractFiles(const FString& InOutputPath, TArray<FPakFileEntryPtr>& InFiles) = 0;
 	virtual void CancelExtract() = 0;
+	// Progress of the last ExtractFiles, null before the first one
+	virtual FExtractJobPtr GetExtractJob() const = 0;
 	virtual bool ExportToJson(const FString& InOutputPath, const TArray<FPakFileEntryPtr>& InFiles) = 0;
 	virtual bool ExportToCsv(const FString& InOutputPath, const TArray<FPakFileEntryPtr>& InFiles) = 0;
+	// Columnar binary file, see PakExportFormat.h
+	virtual bool ExportToBinary(const FString& InOutputPath, const TArray<FPakFileEntryPtr>& InFiles) = 0;
 	virtual void SetExtractThreadCount(int32 InThreadCount) = 0;
 	virtual bool LoadAssetRegistry(const FString& InRegristryPath) = 0;
 	virtual FString GetAssetRegistryPath() const = 0;
+	virtual void LoadFileHashes(const TArray<FPakFileEntryPtr>& InFiles) = 0;
+	// Dependencies of every package of the loaded paks, FAssetSummary::PackageId is the row of a file
+	virtual FPackageGraphPtr GetPackageGraph() const = 0;
+	// Load costs last computed by UpdatePackageLoadCosts, null before that, never blocks
+	virtual FPackageLoadCostsPtr GetPackageLoadCosts() const = 0;
+	// Load costs of the current package graph, computed once per graph, null when aborted. Any thread
+	virtual FPackageLoadCostsPtr UpdatePackageLoadCosts(TFunctionRef<bool()> IsAborted) = 0;
 };
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+
+// Package depends on Dependency
+struct FPackageDependency
+{
+	FName Package;
+	FName Dependency;
+};
+
+// Package From depends on package To, both ids of one FPackageDependencies
+struct FPackageEdge
+{
+	int32 From;
+	int32 To;
+};
+
+typedef TSharedPtr<const class FPackageGraph, ESPMode::ThreadSafe> FPackageGraphPtr;
+typedef TSharedPtr<class FPackageDependencies, ESPMode::ThreadSafe> FPackageDependenciesPtr;
+typedef TSharedPtr<const class FPackageLoadCosts, ESPMode::ThreadSafe> FPackageLoadCostsPtr;
+
+/**
+ * Immutable dependency graph of every known package in compressed sparse row form.
+ * The dependencies of package i are Dependencies[DependencyOffsets[i], DependencyOffsets[i + 1]), sorted and unique, dependents hold the same edges reversed.
+ * Strongly connected components are built with the graph, so cycles and transitive reachability never walk a cycle twice.
+ */
+class FPackageGraph
+{
+public:
+	int32 Num() const { return PackageNames.Num(); }
+	int32 GetEdgeCount() const { return Dependencies.Num(); }
+	bool IsValidPackage(int32 InPackageId) const { return PackageNames.IsValidIndex(InPackageId); }
+	FName GetPackageName(int32 InPackageId) const { return IsValidPackage(InPackageId) ? PackageNames[InPackageId] : NAME_None; }
+
+	// Empty for an unknown package
+	TArrayView<const int32> GetDependencies(int32 InPackageId) const { return GetRow(DependencyOffsets, Dependencies, InPackageId); }
+	TArrayView<const int32> GetDependents(int32 InPackageId) const { return GetRow(DependentOffsets, Dependents, InPackageId); }
+	int32 GetDependencyCount(int32 InPackageId) const { return GetDependencies(InPackageId).Num(); }
+	int32 GetDependentCount(int32 InPackageId) const { return GetDependents(InPackageId).Num(); }
+
+	// Components are numbered dependencies first, a component never depends on a higher one
+	int32 GetComponentCount() const { return ComponentOffsets.Num() > 0 ? ComponentOffsets.Num() - 1 : 0; }
+	int32 GetComponent(int32 InPackageId) const { return IsValidPackage(InPackageId) ? ComponentIds[InPackageId] : INDEX_NONE; }
+	TArrayView<const int32> GetComponentPackages(int32 InComponent) const { return GetRow(ComponentOffsets, ComponentPackages, InComponent); }
+	// Part of a dependency cycle, a package depending on itself included
+	bool IsInCycle(int32 InPackageId) const { return IsValidPackage(InPackageId) && CyclicPackages[InPackageId]; }
+	// Packages of every cycle, one array per strongly connected component
+	void GetCycles(TArray<TArray<int32>>& OutCycles) const;
+
+	// Every package reached from InPackageId, without itself, nearest first
+	void GetTransitiveDependencies(int32 InPackageId, TArray<int32>& OutPackages) const;
+	void GetTransitiveDependents(int32 InPackageId, TArray<int32>& OutPackages) const;
+
+	// Sums of InWeights over every package each package reaches, itself included.
+	// InWeights holds InChannelCount weights per package one after another, OutWeights gets the sums in the same layout.
+	// Reachability is carried as bit masks over the condensed graph, a block of weighted components per pass.
+	// Runs on the task graph and IsAborted is polled from its threads, false when aborted
+	bool ComputeReachableWeights(TArrayView<const int64> InWeights, int32 InChannelCount, bool bDependents, TArray<int64>& OutWeights, TFunctionRef<bool()> IsAborted) const;
+	// Number of packages each package reaches, without itself
+	bool ComputeReachableCounts(bool bDependents, TArray<int32>& OutCounts, TFunctionRef<bool()> IsAborted) const;
+
+protected:
+	friend class FPackageDependencies;
+
+	static TArrayView<const int32> GetRow(const TArray<int32>& InOffsets, const TArray<int32>& InValues, int32 InRow)
+	{
+		return InRow >= 0 && InRow + 1 < InOffsets.Num() ? TArrayView<const int32>(InValues.GetData() + InOffsets[InRow], InOffsets[InRow + 1] - InOffsets[InRow]) : TArrayView<const int32>();
+	}
+
+	void GetReachable(int32 InPackageId, bool bDependents, TArray<int32>& OutPackages) const;
+	// Components each component reaches in one step, the condensed graph in the same row layout as the packages
+	void BuildComponentRows(bool bDependents, TArray<int32>& OutOffsets, TArray<int32>& OutComponents) const;
+	void BuildComponents();
+
+protected:
+	TArray<FName> PackageNames;
+
+	TArray<int32> DependencyOffsets;
+	TArray<int32> Dependencies;
+	TArray<int32> DependentOffsets;
+	TArray<int32> Dependents;
+
+	// Indexed by package id
+	TArray<int32> ComponentIds;
+	TBitArray<> CyclicPackages;
+	// Packages of component c are ComponentPackages[ComponentOffsets[c], ComponentOffsets[c + 1])
+	TArray<int32> ComponentOffsets;
+	TArray<int32> ComponentPackages;
+};
+
+/**
+ * Thread safe owner of the package graph of an analyzer, an owning analyzer shares one with its parts.
+ * Ids are handed out as packages show up and stay stable until Reset, every Update publishes a new FPackageGraph so readers never wait for a rebuild.
+ */
+class FPackageDependencies
+{
+public:
+	FPackageDependencies();
+
+	void Reset();
+
+	int32 FindOrAddPackage(FName InPackage);
+	int32 FindPackage(FName InPackage) const;
+	// Id of every package of InPackages under one lock, INDEX_NONE for NAME_None
+	void FindOrAddPackages(TArrayView<const FName> InPackages, TArray<int32>& OutPackageIds);
+
+	// Dependencies of InClearedPackages are dropped, then InDependencies are merged in.
+	// With bSkipKnownPackages the edges of a package that already has dependencies are ignored.
+	void Update(TArrayView<const FName> InClearedPackages, TArrayView<const FPackageDependency> InDependencies, bool bSkipKnownPackages = false);
+	// Same as Update for packages already given ids by this object
+	void UpdateEdges(TArrayView<const int32> InClearedPackageIds, TArrayView<const FPackageEdge> InEdges, bool bSkipKnownPackages = false);
+
+	// Latest graph, never null
+	FPackageGraphPtr GetGraph() const;
+
+protected:
+	int32 FindOrAddPackageLocked(FName InPackage);
+
+protected:
+	// Guards ids and the graph pointer, UpdateLock keeps rebuilds in order
+	mutable FRWLock Lock;
+	FCriticalSection UpdateLock;
+
+	TMap<FName, int32> PackageIds;
+	TArray<FName> PackageNames;
+	FPackageGraphPtr Graph;
+};
+
+/**
+ * Load cost of every package of one graph, what loading the package reads from the paks.
+ * The exclusive size sums the files of the package itself, the transitive size adds every package it depends on directly or not, a shared dependency counted once.
+ */
+class FPackageLoadCosts
+{
+public:
+	// InExclusiveSizes holds the size then the compressed size of every package of InGraph, null when aborted
+	static FPackageLoadCostsPtr Compute(FPackageGraphPtr InGraph, TArray<int64>&& InExclusiveSizes, TFunctionRef<bool()> IsAborted);
+
+	const FPackageGraphPtr& GetGraph() const { return Graph; }
+
+	// 0 for an unknown package
+	int64 GetExclusiveSize(int32 InPackageId) const { return GetCost(ExclusiveSizes, InPackageId, 0); }
+	int64 GetExclusiveCompressedSize(int32 InPackageId) const { return GetCost(ExclusiveSizes, InPackageId, 1); }
+	int64 GetTransitiveSize(int32 InPackageId) const { return GetCost(TransitiveSizes, InPackageId, 0); }
+	int64 GetTransitiveCompressedSize(int32 InPackageId) const { return GetCost(TransitiveSizes, InPackageId, 1); }
+
+protected:
+	static int64 GetCost(const TArray<int64>& InCosts, int32 InPackageId, int32 InChannel)
+	{
+		return InPackageId >= 0 && InPackageId * 2 + InChannel < InCosts.Num() ? InCosts[InPackageId * 2 + InChannel] : 0;
+	}
+
+protected:
+	FPackageGraphPtr Graph;
+	// Size and compressed size of every package one after another
+	TArray<int64> ExclusiveSizes;
+	TArray<int64> TransitiveSizes;
+};
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Columnar binary export written by IPakAnalyzer::ExportToBinary.
+ * Little endian, every section starts at a multiple of 8 bytes so a mapped file is read in place without parsing.
+ * Layout: FPakExportHeader, ColumnCount FPakExportColumn, the rows of every column, then the dictionaries.
+ * A file path is the Directory string followed by the Name string, the separator is part of the directory.
+ */
+namespace PakExport
+{
+	// Distinct from the magic of the pak index cache, so neither file is ever taken for the other
+	static const uint32 Magic = 0x58565055; // "UPVX"
+	static const uint32 Version = 1;
+}
+
+enum class EPakExportColumnType : uint32
+{
+	Int64,
+	Int32,
+	// 0 or 1
+	Bool,
+	// 20 bytes SHA1
+	Hash,
+	// uint32 index into the dictionary of the column
+	Dictionary,
+};
+
+struct FPakExportHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint64 RowCount;
+	uint32 ColumnCount;
+	uint32 Reserved;
+};
+
+struct FPakExportColumn
+{
+	// Zero padded
+	ANSICHAR Name[32];
+	EPakExportColumnType Type;
+	uint32 ElementSize;
+	// RowCount * ElementSize bytes from the start of the file
+	uint64 DataOffset;
+	// Dictionary columns: DictionaryCount + 1 uint32 offsets into the UTF-8 bytes that directly follow them
+	uint64 DictionaryOffset;
+	uint32 DictionaryCount;
+	uint32 Reserved;
+};
+
+static_assert(sizeof(FPakExportHeader) == 24, "FPakExportHeader is part of the file format");
+static_assert(sizeof(FPakExportColumn) == 64, "FPakExportColumn is part of the file format");
+
+// Reads a whole export file held in memory, nothing is copied.
+// Open validates every size, offset and index of the file once, the accessors trust it afterwards
+class FPakExportReader
+{
+public:
+	static uint32 GetElementSize(EPakExportColumnType InType)
+	{
+		switch (InType)
+		{
+		case EPakExportColumnType::Int64: return sizeof(int64);
+		case EPakExportColumnType::Int32: return sizeof(int32);
+		case EPakExportColumnType::Bool: return sizeof(uint8);
+		case EPakExportColumnType::Hash: return 20;
+		case EPakExportColumnType::Dictionary: return sizeof(uint32);
+		default: return 0;
+		}
+	}
+
+	bool Open(const uint8* InData, uint64 InSize)
+	{
+		Data = nullptr;
+		Size = 0;
+
+		if (!InData || InSize < sizeof(FPakExportHeader))
+		{
+			return false;
+		}
+
+		const FPakExportHeader* Header = (const FPakExportHeader*)InData;
+		if (Header->Magic != PakExport::Magic || Header->Version != PakExport::Version)
+		{
+			return false;
+		}
+
+		if (sizeof(FPakExportHeader) + (uint64)Header->ColumnCount * sizeof(FPakExportColumn) > InSize)
+		{
+			return false;
+		}
+
+		const FPakExportColumn* Columns = (const FPakExportColumn*)(InData + sizeof(FPakExportHeader));
+		for (uint32 Index = 0; Index < Header->ColumnCount; ++Index)
+		{
+			const FPakExportColumn& Column = Columns[Index];
+			// Unknown types and sizes are refused, the reader never interprets a column it can't bound
+			if (Column.ElementSize == 0 || Column.ElementSize != GetElementSize(Column.Type))
+			{
+				return false;
+			}
+
+			// Divided rather than multiplied, a huge row count can't wrap around
+			if (Column.DataOffset > InSize || Header->RowCount > (InSize - Column.DataOffset) / Column.ElementSize)
+			{
+				return false;
+			}
+
+			if (Column.Type == EPakExportColumnType::Dictionary)
+			{
+				const uint64 OffsetsSize = ((uint64)Column.DictionaryCount + 1) * sizeof(uint32);
+				if (Column.DictionaryOffset > InSize || OffsetsSize > InSize - Column.DictionaryOffset)
+				{
+					return false;
+				}
+
+				// Every entry has to lie within the bytes of the dictionary
+				const uint32* Offsets = (const uint32*)(InData + Column.DictionaryOffset);
+				const uint64 CharsSize = InSize - Column.DictionaryOffset - OffsetsSize;
+				for (uint32 EntryIndex = 0; EntryIndex < Column.DictionaryCount; ++EntryIndex)
+				{
+					if (Offsets[EntryIndex] > Offsets[EntryIndex + 1])
+					{
+						return false;
+					}
+				}
+				if (Offsets[Column.DictionaryCount] > CharsSize)
+				{
+					return false;
+				}
+
+				const uint32* Rows = (const uint32*)(InData + Column.DataOffset);
+				for (uint64 Row = 0; Row < Header->RowCount; ++Row)
+				{
+					if (Rows[Row] >= Column.DictionaryCount)
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		Data = InData;
+		Size = InSize;
+		return true;
+	}
+
+	const FPakExportHeader& GetHeader() const { return *(const FPakExportHeader*)Data; }
+	uint64 GetRowCount() const { return GetHeader().RowCount; }
+
+	TArrayView<const FPakExportColumn> GetColumns() const
+	{
+		return TArrayView<const FPakExportColumn>((const FPakExportColumn*)(Data + sizeof(FPakExportHeader)), GetHeader().ColumnCount);
+	}
+
+	const FPakExportColumn* FindColumn(const ANSICHAR* InName) const
+	{
+		for (const FPakExportColumn& Column : GetColumns())
+		{
+			if (FCStringAnsi::Strncmp(Column.Name, InName, sizeof(Column.Name)) == 0)
+			{
+				return &Column;
+			}
+		}
+		return nullptr;
+	}
+
+	// Null when ElementType doesn't match the size of the column
+	template <typename ElementType>
+	const ElementType* GetColumnData(const FPakExportColumn& InColumn) const
+	{
+		if (sizeof(ElementType) != InColumn.ElementSize)
+		{
+			return nullptr;
+		}
+		return (const ElementType*)(Data + InColumn.DataOffset);
+	}
+
+	// Empty for a column that isn't a dictionary or an index past it
+	FUtf8StringView GetDictionaryEntry(const FPakExportColumn& InColumn, uint32 InIndex) const
+	{
+		if (InColumn.Type != EPakExportColumnType::Dictionary || InIndex >= InColumn.DictionaryCount)
+		{
+			return FUtf8StringView();
+		}
+
+		const uint32* Offsets = (const uint32*)(Data + InColumn.DictionaryOffset);
+		const UTF8CHAR* Chars = (const UTF8CHAR*)(Offsets + InColumn.DictionaryCount + 1);
+		return FUtf8StringView(Chars + Offsets[InIndex], Offsets[InIndex + 1] - Offsets[InIndex]);
+	}
+
+	FUtf8StringView GetString(const FPakExportColumn& InColumn, uint64 InRow) const
+	{
+		const uint32* Rows = GetColumnData<uint32>(InColumn);
+		if (!Rows || InRow >= GetRowCount())
+		{
+			return FUtf8StringView();
+		}
+		return GetDictionaryEntry(InColumn, Rows[InRow]);
+	}
+
+protected:
+	const uint8* Data = nullptr;
+	uint64 Size = 0;
+};
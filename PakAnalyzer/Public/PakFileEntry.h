@@ -15,6 +15,7 @@ typedef TSharedPtr<struct FPakFileEntry> FPakFileEntryPtr;
 typedef TSharedPtr<struct FPakTreeEntry> FPakTreeEntryPtr;
 typedef TSharedPtr<struct FPackageInfo> FPackageInfoPtr;
 typedef TSharedPtr<struct FPakFileSumary> FPakFileSumaryPtr;
+typedef TSharedPtr<struct FPakFileTable> FPakFileTablePtr;
 
 struct FPakClassEntry
 {
@@ -74,29 +75,44 @@ struct FAssetSummary
 	TArray<FNamePtrType> Names;
 	TArray<FObjectExportPtrType> ObjectExports;
 	TArray<FObjectImportPtrType> ObjectImports;
-	TArray<FPackageInfoPtr> DependencyList; // this asset depends on
-	TArray<FPackageInfoPtr> DependentList; // assets depends on this
+	// Row of this package in the package graph of the analyzer, dependencies and dependents are read from there, see IPakAnalyzer::GetPackageGraph
+	int32 PackageId = INDEX_NONE;
 };
 
 struct FPakFileEntry : TSharedFromThis<FPakFileEntry>
 {
-	FPakFileEntry(FName InFilename, const FString& InPath)
+	FPakFileEntry(FName InFilename)
 		: Filename(InFilename)
-		, Path(InPath)
 	{
 
 	}
 
 	FPakEntry PakEntry;
 	FName Filename;
-	//如果是cooked的文件, 那么这里就是硬盘的绝对路径
-	//对于pak, 就和PackagePath一样
-	FString Path;
 	FName CompressionMethod;
-	FName Class;
 	FName PackagePath;
 	FAssetSummaryPtr AssetSummary;
 	int16 OwnerPakIndex = 0;
+	// PakEntry.Hash is read from the payload header on demand, see IPakAnalyzer::LoadFileHashes
+	bool bHashLoaded = true;
+	// Row of this file in the file table of the owner pak, PakEntry.CompressionBlocks is not kept in memory
+	int32 FileIndex = INDEX_NONE;
+	// Row of this directory in the file table, 0 for the tree root
+	int32 DirectoryIndex = INDEX_NONE;
+	FPakFileTablePtr FileTable;
+
+	int32 GetCompressionBlockCount() const;
+	// Kept once per file in the class column of the file table
+	FName GetClass() const;
+	// Row in the package graph, INDEX_NONE without an asset summary
+	int32 GetPackageId() const;
+	// Name as written in the pak index, Filename only keys ChildrenMap and keeps the case its FName was first made with
+	FString GetFilename() const;
+
+	//路径不再逐个存储, 由所在目录的路径和文件名拼出来
+	//如果是cooked的文件, 那么这里就是硬盘的绝对路径
+	FString GetPath() const;
+	void AppendPath(FStringBuilderBase& OutBuilder) const;
 };
 
 struct FPakTreeEntry : public FPakFileEntry
@@ -111,8 +127,8 @@ struct FPakTreeEntry : public FPakFileEntry
 	TMap<FName, TSharedPtr<FPakTreeEntry>> ChildrenMap;
 	TMap<FName, FPakClassEntryPtr> FileClassMap;
 
-	FPakTreeEntry(FName InFilename, const FString& InPath, bool bInIsDirectory)
-		: FPakFileEntry(InFilename, InPath)
+	FPakTreeEntry(FName InFilename, bool bInIsDirectory)
+		: FPakFileEntry(InFilename)
 		, FileCount(0)
 		, Size(0)
 		, CompressedSize(0)
@@ -124,6 +140,63 @@ struct FPakTreeEntry : public FPakFileEntry
 	}
 };
 
+/**
+ * Index of all files of one pak or container, in insertion order, next to the tree nodes that own the per file data.
+ * Offsets and sizes stay in FPakFileEntry::PakEntry, the table only adds what the nodes don't carry: the parent directory, compression block count and class id of each file.
+ * Walking Entries replaces the recursive ChildrenMap walks, and the class column resolves a class filter once per class instead of once per file.
+ * Directories are interned as (parent index, name) pairs, a directory is always added after its parent.
+ * Names keep the case of the pak index and are packed once into NameBuffer, paths are built from the parent chain when asked for.
+ */
+struct FPakFileTable
+{
+	int32 AddDirectory(FPakTreeEntry* InDirectory, int32 InParentDirectory, FStringView InName);
+	int32 AddFile(FPakTreeEntry* InFile, int32 InParentDirectory, FStringView InName, int32 InCompressionBlockCount, FName InClassName);
+	int32 FindOrAddClass(FName InClassName);
+	void Reserve(int32 InFileCount);
+
+	FORCEINLINE int32 Num() const { return Entries.Num(); }
+
+	FORCEINLINE FStringView GetFileName(int32 InFileIndex) const { return GetName(FileNameOffsets[InFileIndex], FileNameLengths[InFileIndex]); }
+	// Empty for the tree root
+	FORCEINLINE FStringView GetDirectoryName(int32 InDirectoryIndex) const { return GetName(DirectoryNameOffsets[InDirectoryIndex], DirectoryNameLengths[InDirectoryIndex]); }
+	void AppendFilePath(int32 InFileIndex, FStringBuilderBase& OutBuilder, bool bWithPrefix = true) const;
+	void AppendDirectoryPath(int32 InDirectoryIndex, FStringBuilderBase& OutBuilder, bool bWithPrefix = true) const;
+
+	int32 PakIndex = INDEX_NONE;
+	// Path of the tree root
+	FString MountPoint;
+	// Prepended to every file and directory path, the cooked folder for FFolderAnalyzer
+	FString PathPrefix;
+
+	// Files
+	TArray<int32> CompressionBlockCounts;
+	TArray<int32> ClassIds;
+	TArray<int32> ParentDirectories;
+	TArray<int32> FileNameOffsets;
+	TArray<int32> FileNameLengths;
+	TArray<FPakTreeEntry*> Entries;
+
+	// Directories, index 0 is the tree root
+	TArray<int32> DirectoryParents;
+	TArray<FPakTreeEntry*> Directories;
+	TArray<int32> DirectoryNameOffsets;
+	TArray<int32> DirectoryNameLengths;
+
+	// Name of every file and directory, one segment each
+	TArray<TCHAR> NameBuffer;
+
+	// Class dictionary referenced by ClassIds
+	TArray<FName> Classes;
+	TMap<FName, int32> ClassLookup;
+
+	// Built once the table is complete, see FBaseAnalyzer::PublishPak
+	TSharedPtr<class FPakSearchIndex> SearchIndex;
+
+protected:
+	FORCEINLINE FStringView GetName(int32 InOffset, int32 InLength) const { return FStringView(NameBuffer.GetData() + InOffset, InLength); }
+	int32 AddName(FStringView InName);
+};
+
 struct FPakFileSumary
 {
 	FPakInfo PakInfo;
@@ -14,3 +14,7 @@ const FName FFileColumn::IsEncryptedColumnName(TEXT("IsEncrypted"));
 const FName FFileColumn::OwnerPakColumnName(TEXT("OwnerPak"));
 const FName FFileColumn::DependencyCountColumnName(TEXT("DependencyCount"));
 const FName FFileColumn::DependentCountColumnName(TEXT("DependentCount"));
+const FName FFileColumn::ExclusiveSizeColumnName(TEXT("ExclusiveSize"));
+const FName FFileColumn::ExclusiveCompressedSizeColumnName(TEXT("ExclusiveCompressedSize"));
+const FName FFileColumn::TransitiveSizeColumnName(TEXT("TransitiveSize"));
+const FName FFileColumn::TransitiveCompressedSizeColumnName(TEXT("TransitiveCompressedSize"));
@@ -3,6 +3,7 @@
 #include "CoreMinimal.h"
 
 #include "PakFileEntry.h"
+#include "ViewModels/FileSortKeys.h"
 
 enum class EFileColumnFlags : uint32
 {
@@ -18,6 +19,7 @@ class FFileColumn
 {
 public:
 	typedef TFunction<bool(const FPakFileEntryPtr& A, const FPakFileEntryPtr& B)> FFileCompareFunc;
+	typedef FFileSortKeys::FSortKeyFunc FFileSortKeyFunc;
 
 	static const FName NameColumnName;
 	static const FName PathColumnName;
@@ -33,6 +35,10 @@ public:
 	static const FName OwnerPakColumnName;
 	static const FName DependencyCountColumnName;
 	static const FName DependentCountColumnName;
+	static const FName ExclusiveSizeColumnName;
+	static const FName ExclusiveCompressedSizeColumnName;
+	static const FName TransitiveSizeColumnName;
+	static const FName TransitiveCompressedSizeColumnName;
 
 	FFileColumn() = delete;
 	FFileColumn(int32 InIndex, const FName InId, const FText& InTitleName, const FText& InDescription, float InFillWidth, const EFileColumnFlags& InFlags, FFileCompareFunc InAscendingCompareDelegate = nullptr, FFileCompareFunc InDescendingCompareDelegate = nullptr)
@@ -79,6 +85,11 @@ public:
 	FFileCompareFunc GetAscendingCompareDelegate() const { return AscendingCompareDelegate; }
 	FFileCompareFunc GetDescendingCompareDelegate() const { return DescendingCompareDelegate; }
 
+	/** Integer key in the same order as the ascending comparator, the file list then sorts by radix instead of comparisons. */
+	void SetSortKeyDelegate(FFileSortKeyFunc InSortKeyDelegate, EFileSortKeyInputs InSortKeyInputs = EFileSortKeyInputs::None) { SortKeyDelegate = InSortKeyDelegate; SortKeyInputs = InSortKeyInputs; }
+	FFileSortKeyFunc GetSortKeyDelegate() const { return SortKeyDelegate; }
+	EFileSortKeyInputs GetSortKeyInputs() const { return SortKeyInputs; }
+
 protected:
 	int32 Index;
 	FName Id;
@@ -88,6 +99,8 @@ protected:
 	EFileColumnFlags Flags;
 	FFileCompareFunc AscendingCompareDelegate;
 	FFileCompareFunc DescendingCompareDelegate;
+	FFileSortKeyFunc SortKeyDelegate;
+	EFileSortKeyInputs SortKeyInputs = EFileSortKeyInputs::None;
 
 	bool bIsVisible;
 };
\ No newline at end of file
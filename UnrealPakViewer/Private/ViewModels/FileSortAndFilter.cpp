@@ -1,10 +1,49 @@
 #include "FileSortAndFilter.h"
 
 #include "Misc/ScopeLock.h"
+#include "Misc/StringBuilder.h"
 #include "PakAnalyzerModule.h"
+#include "String/Find.h"
 #include "ViewModels/FileColumn.h"
 #include "Widgets/SPakFileView.h"
 
+// Same rule as the analyzer, an empty filter shows everything and a missing key is hidden
+template <typename KeyType>
+static bool IsShownByFilter(const TMap<KeyType, bool>& InFilterMap, const KeyType& InKey)
+{
+	if (InFilterMap.Num() <= 0)
+	{
+		return true;
+	}
+
+	const bool* bShow = InFilterMap.Find(InKey);
+	return bShow && *bShow;
+}
+
+template <typename KeyType>
+static bool IsNarrowerFilter(const TMap<KeyType, bool>& InFilterMap, const TMap<KeyType, bool>& InLastFilterMap)
+{
+	if (InLastFilterMap.Num() <= 0)
+	{
+		return true;
+	}
+
+	if (InFilterMap.Num() <= 0)
+	{
+		return false;
+	}
+
+	for (const auto& Pair : InFilterMap)
+	{
+		if (Pair.Value && !IsShownByFilter(InLastFilterMap, Pair.Key))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void FFileSortAndFilterTask::DoWork()
 {
 	TSharedPtr<SPakFileView> PakFileViewPin = WeakPakFileView.Pin();
@@ -13,9 +52,6 @@ void FFileSortAndFilterTask::DoWork()
 		return;
 	}
 
-	TArray<FPakFileEntryPtr> FilterResult;
-	IPakAnalyzerModule::Get().GetPakAnalyzer()->GetFiles(CurrentSearchText, ClassFilterMap, IndexFilterMap, FilterResult);
-
 	const FFileColumn* Column = PakFileViewPin->FindCoulum(CurrentSortedColumn);
 	if (!Column)
 	{
@@ -27,15 +63,67 @@ void FFileSortAndFilterTask::DoWork()
 		return;
 	}
 
-	if (CurrentSortMode == EColumnSortMode::Ascending)
+	// A longer search text or a narrower class/pak filter only removes files from the last result, its order stays valid
+	const bool bRefine = IsNarrowerThanLastResult();
+	const bool bSameSort = bRefine && LastSortedColumn == CurrentSortedColumn && LastSortMode == CurrentSortMode;
+
+	TArray<FPakFileEntryPtr> FilterResult;
+	if (bRefine)
 	{
-		FilterResult.Sort(Column->GetAscendingCompareDelegate());
+		if (!RefineLastResult(FilterResult))
+		{
+			return;
+		}
 	}
 	else
 	{
-		FilterResult.Sort(Column->GetDescendingCompareDelegate());
+		IPakAnalyzerModule::Get().GetPakAnalyzer()->GetFiles(CurrentSearchText, ClassFilterMap, IndexFilterMap, FilterResult);
+	}
+
+	if (IsAborted())
+	{
+		return;
 	}
 
+	const FFileColumn::FFileSortKeyFunc SortKeyFunc = Column->GetSortKeyDelegate();
+	if (!bSameSort && SortKeyFunc && UpdateSortKeys(Column->GetSortKeyInputs()))
+	{
+		if (!SortKeys.SortFiles(FilterResult, SortKeyFunc, CurrentSortMode == EColumnSortMode::Descending, [this]() { return IsAborted(); }))
+		{
+			return;
+		}
+	}
+	else if (!bSameSort)
+	{
+		const FFileColumn::FFileCompareFunc CompareFunc = CurrentSortMode == EColumnSortMode::Ascending ? Column->GetAscendingCompareDelegate() : Column->GetDescendingCompareDelegate();
+
+		// Once aborted every pair compares equal, so the sort runs out quickly
+		int32 CompareCount = 0;
+		bool bAborted = false;
+		FilterResult.Sort([this, &CompareFunc, &CompareCount, &bAborted](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B)
+			{
+				if ((++CompareCount & 0xFFF) == 0)
+				{
+					bAborted = IsAborted();
+				}
+
+				return !bAborted && CompareFunc(A, B);
+			});
+
+		if (bAborted || IsAborted())
+		{
+			return;
+		}
+	}
+
+	bHasLastResult = true;
+	LastSortedColumn = CurrentSortedColumn;
+	LastSortMode = CurrentSortMode;
+	LastSearchText = CurrentSearchText;
+	LastClassFilterMap = ClassFilterMap;
+	LastIndexFilterMap = IndexFilterMap;
+	LastResult = FilterResult;
+
 	{
 		FScopeLock Lock(&CriticalSection);
 		Result = MoveTemp(FilterResult);
@@ -44,13 +132,21 @@ void FFileSortAndFilterTask::DoWork()
 	OnWorkFinished.ExecuteIfBound(CurrentSortedColumn, CurrentSortMode, CurrentSearchText);
 }
 
-void FFileSortAndFilterTask::SetWorkInfo(FName InSortedColumn, EColumnSortMode::Type InSortMode, const FString& InSearchText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InIndexFilterMap)
+void FFileSortAndFilterTask::SetWorkInfo(FName InSortedColumn, EColumnSortMode::Type InSortMode, const FString& InSearchText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InIndexFilterMap, bool bInFilesChanged)
 {
 	CurrentSortedColumn = InSortedColumn;
 	CurrentSortMode = InSortMode;
 	CurrentSearchText = InSearchText;
 	ClassFilterMap = InClassFilterMap;
 	IndexFilterMap = InIndexFilterMap;
+	WorkGeneration = Generation.Increment();
+
+	if (bInFilesChanged)
+	{
+		bHasLastResult = false;
+		LastResult.Empty();
+		bRanksDirty = true;
+	}
 }
 
 void FFileSortAndFilterTask::RetriveResult(TArray<FPakFileEntryPtr>& OutResult)
@@ -58,3 +154,108 @@ void FFileSortAndFilterTask::RetriveResult(TArray<FPakFileEntryPtr>& OutResult)
 	FScopeLock Lock(&CriticalSection);
 	OutResult = MoveTemp(Result);
 }
+
+bool FFileSortAndFilterTask::IsNarrowerThanLastResult() const
+{
+	if (!bHasLastResult)
+	{
+		return false;
+	}
+
+	// Every path containing the new text also contains the old one
+	if (!LastSearchText.IsEmpty() && !CurrentSearchText.Contains(LastSearchText, ESearchCase::IgnoreCase))
+	{
+		return false;
+	}
+
+	return IsNarrowerFilter(ClassFilterMap, LastClassFilterMap) && IsNarrowerFilter(IndexFilterMap, LastIndexFilterMap);
+}
+
+bool FFileSortAndFilterTask::RefineLastResult(TArray<FPakFileEntryPtr>& OutFiles) const
+{
+	const bool bCheckText = !CurrentSearchText.IsEmpty() && !CurrentSearchText.Equals(LastSearchText, ESearchCase::IgnoreCase);
+	const bool bCheckClass = !ClassFilterMap.OrderIndependentCompareEqual(LastClassFilterMap);
+	const bool bCheckPak = !IndexFilterMap.OrderIndependentCompareEqual(LastIndexFilterMap);
+
+	if (!bCheckText && !bCheckClass && !bCheckPak)
+	{
+		OutFiles = LastResult;
+		return true;
+	}
+
+	OutFiles.Reserve(LastResult.Num());
+
+	TStringBuilder<256> FilePath;
+	for (int32 Index = 0; Index < LastResult.Num(); ++Index)
+	{
+		if ((Index & 0xFFF) == 0 && IsAborted())
+		{
+			return false;
+		}
+
+		const FPakFileEntryPtr& File = LastResult[Index];
+		if (bCheckClass && !IsShownByFilter(ClassFilterMap, File->GetClass()))
+		{
+			continue;
+		}
+
+		if (bCheckPak && !IsShownByFilter(IndexFilterMap, (int32)File->OwnerPakIndex))
+		{
+			continue;
+		}
+
+		if (bCheckText)
+		{
+			FilePath.Reset();
+			File->AppendPath(FilePath);
+			if (UE::String::FindFirst(FilePath.ToView(), CurrentSearchText, ESearchCase::IgnoreCase) == INDEX_NONE)
+			{
+				continue;
+			}
+		}
+
+		OutFiles.Add(File);
+	}
+
+	return true;
+}
+
+bool FFileSortAndFilterTask::UpdateSortKeys(EFileSortKeyInputs InInputs)
+{
+	IPakAnalyzer* PakAnalyzer = IPakAnalyzerModule::Get().GetPakAnalyzer();
+
+	if (EnumHasAnyFlags(InInputs, EFileSortKeyInputs::Ranks))
+	{
+		if (bRanksDirty)
+		{
+			TArray<FPakFileEntryPtr> AllFiles;
+			PakAnalyzer->GetFiles(TEXT(""), TMap<FName, bool>(), TMap<int32, bool>(), AllFiles);
+
+			bRanksValid = SortKeys.UpdateRanks(AllFiles, [this]() { return IsAborted(); });
+			// An aborted build runs again with the next query
+			bRanksDirty = !bRanksValid && IsAborted();
+		}
+
+		if (!bRanksValid)
+		{
+			return false;
+		}
+	}
+
+	if (EnumHasAnyFlags(InInputs, EFileSortKeyInputs::LoadCosts))
+	{
+		// Load costs are computed once per package graph, the first sort by a load cost column pays for them
+		const FPackageLoadCostsPtr LoadCosts = PakAnalyzer->UpdatePackageLoadCosts([this]() { return IsAborted(); });
+		if (!LoadCosts.IsValid())
+		{
+			return false;
+		}
+		SortKeys.SetLoadCosts(LoadCosts);
+	}
+	else if (EnumHasAnyFlags(InInputs, EFileSortKeyInputs::PackageGraph))
+	{
+		SortKeys.SetPackageGraph(PakAnalyzer->GetPackageGraph());
+	}
+
+	return !IsAborted();
+}
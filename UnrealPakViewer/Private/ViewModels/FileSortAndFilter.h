@@ -3,9 +3,11 @@
 #include "Async/AsyncWork.h"
 #include "CoreMinimal.h"
 #include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeCounter.h"
 #include "Stats/Stats.h"
 
 #include "PakFileEntry.h"
+#include "ViewModels/FileSortKeys.h"
 
 DECLARE_DELEGATE_ThreeParams(FOnSortAndFilterFinished, const FName, EColumnSortMode::Type, const FString&);
 
@@ -24,7 +26,10 @@ public:
 	}
 
 	void DoWork();
-	void SetWorkInfo(FName InSortedColumn, EColumnSortMode::Type InSortMode, const FString& InSearchText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InIndexFilterMap);
+	// bInFilesChanged drops the cached result, the next query then starts from all files again
+	void SetWorkInfo(FName InSortedColumn, EColumnSortMode::Type InSortMode, const FString& InSearchText, const TMap<FName, bool>& InClassFilterMap, const TMap<int32, bool>& InIndexFilterMap, bool bInFilesChanged);
+	// Game thread, the running query stops at its next check and publishes nothing
+	void Abort() { Generation.Increment(); }
 	FOnSortAndFilterFinished& GetOnSortAndFilterFinishedDelegate() { return OnWorkFinished; }
 
 	FORCEINLINE TStatId GetStatId() const
@@ -34,6 +39,15 @@ public:
 
 	void RetriveResult(TArray<FPakFileEntryPtr>& OutResult);
 
+protected:
+	FORCEINLINE bool IsAborted() const { return Generation.GetValue() != WorkGeneration; }
+
+	// Every file of the current query is also in the last result
+	bool IsNarrowerThanLastResult() const;
+	bool RefineLastResult(TArray<FPakFileEntryPtr>& OutFiles) const;
+	// Builds only what the key of the sorted column reads, ranks once after files changed, false when the column comparators have to be used
+	bool UpdateSortKeys(EFileSortKeyInputs InInputs);
+
 protected:
 	FName CurrentSortedColumn;
 	EColumnSortMode::Type CurrentSortMode;
@@ -49,4 +63,21 @@ protected:
 
 	TMap<FName, bool> ClassFilterMap;
 	TMap<int32, bool> IndexFilterMap;
+
+	FThreadSafeCounter Generation;
+	int32 WorkGeneration = 0;
+
+	// Last query that ran to the end and its sorted result, only touched by DoWork and by SetWorkInfo while the task is idle
+	bool bHasLastResult = false;
+	FName LastSortedColumn;
+	EColumnSortMode::Type LastSortMode = EColumnSortMode::None;
+	FString LastSearchText;
+	TMap<FName, bool> LastClassFilterMap;
+	TMap<int32, bool> LastIndexFilterMap;
+	TArray<FPakFileEntryPtr> LastResult;
+
+	// Ranks of the string columns, rebuilt on the first sort by one of them after files changed
+	FFileSortKeys SortKeys;
+	bool bRanksDirty = true;
+	bool bRanksValid = false;
 };
\ No newline at end of file
@@ -0,0 +1,625 @@
+#include "FileSortKeys.h"
+
+#include "Algo/Sort.h"
+#include "Async/ParallelFor.h"
+#include "Misc/StringBuilder.h"
+
+static const int32 MinItemsPerChunk = 16 * 1024;
+static const int32 MaxChunks = 64;
+
+static EParallelForFlags GetParallelForFlags()
+{
+	static const EParallelForFlags ParallelForFlags = FPlatformMisc::IsDebuggerPresent() ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced;
+	return ParallelForFlags;
+}
+
+static int32 GetChunkCount(int32 InItemCount)
+{
+	return FMath::Clamp(InItemCount / MinItemsPerChunk, 1, MaxChunks);
+}
+
+// Chunks are sorted in parallel, then merged pairwise, each round of merges in parallel as well
+template <typename ItemType, typename PredicateType>
+static void ParallelSort(TArray<ItemType>& InOutItems, const PredicateType& Predicate)
+{
+	const int32 ItemCount = InOutItems.Num();
+	const int32 ChunkCount = GetChunkCount(ItemCount);
+	if (ChunkCount <= 1)
+	{
+		Algo::Sort(InOutItems, Predicate);
+		return;
+	}
+
+	const int32 ChunkSize = FMath::DivideAndRoundUp(ItemCount, ChunkCount);
+	ParallelFor(ChunkCount, [&InOutItems, &Predicate, ItemCount, ChunkSize](int32 ChunkIndex)
+	{
+		const int32 Start = ChunkIndex * ChunkSize;
+		const int32 Count = FMath::Min(ChunkSize, ItemCount - Start);
+		if (Count > 0)
+		{
+			TArrayView<ItemType> Chunk(InOutItems.GetData() + Start, Count);
+			Algo::Sort(Chunk, Predicate);
+		}
+	}, GetParallelForFlags());
+
+	TArray<ItemType> Temp;
+	Temp.SetNumUninitialized(ItemCount);
+
+	ItemType* Source = InOutItems.GetData();
+	ItemType* Dest = Temp.GetData();
+	for (int32 Width = ChunkSize; Width < ItemCount; Width *= 2)
+	{
+		const int32 PairCount = FMath::DivideAndRoundUp(ItemCount, Width * 2);
+		ParallelFor(PairCount, [Source, Dest, &Predicate, ItemCount, Width](int32 PairIndex)
+		{
+			const int32 Start = PairIndex * Width * 2;
+			const int32 Middle = FMath::Min(Start + Width, ItemCount);
+			const int32 End = FMath::Min(Start + Width * 2, ItemCount);
+
+			int32 Left = Start;
+			int32 Right = Middle;
+			int32 Out = Start;
+			while (Left < Middle && Right < End)
+			{
+				Dest[Out++] = Predicate(Source[Right], Source[Left]) ? Source[Right++] : Source[Left++];
+			}
+			while (Left < Middle)
+			{
+				Dest[Out++] = Source[Left++];
+			}
+			while (Right < End)
+			{
+				Dest[Out++] = Source[Right++];
+			}
+		}, GetParallelForFlags());
+
+		Swap(Source, Dest);
+	}
+
+	if (Source != InOutItems.GetData())
+	{
+		FMemory::Memcpy(InOutItems.GetData(), Source, ItemCount * sizeof(ItemType));
+	}
+}
+
+static void AppendLower(FStringView InText, TArray<TCHAR>& OutBuffer)
+{
+	// Same folding as FCString::Stricmp, only ASCII letters
+	OutBuffer.Reserve(OutBuffer.Num() + InText.Len());
+	for (TCHAR Char : InText)
+	{
+		OutBuffer.Add(Char >= TEXT('A') && Char <= TEXT('Z') ? (TCHAR)(Char + (TEXT('a') - TEXT('A'))) : Char);
+	}
+}
+
+// Ordinal compare of two lowercased texts, each given as two slices joined together
+static int32 CompareJoined(FStringView InA0, FStringView InA1, FStringView InB0, FStringView InB1)
+{
+	const int32 LenA = InA0.Len() + InA1.Len();
+	const int32 LenB = InB0.Len() + InB1.Len();
+	const int32 Len = FMath::Min(LenA, LenB);
+	for (int32 Index = 0; Index < Len; ++Index)
+	{
+		const TCHAR CharA = Index < InA0.Len() ? InA0[Index] : InA1[Index - InA0.Len()];
+		const TCHAR CharB = Index < InB0.Len() ? InB0[Index] : InB1[Index - InB0.Len()];
+		if (CharA != CharB)
+		{
+			return CharA < CharB ? -1 : 1;
+		}
+	}
+
+	return LenA - LenB;
+}
+
+static int32 CompareText(FStringView InA, FStringView InB)
+{
+	return CompareJoined(InA, FStringView(), InB, FStringView());
+}
+
+void FFileSortKeys::Reset()
+{
+	ResetRanks();
+	PackageGraph.Reset();
+	LoadCosts.Reset();
+}
+
+void FFileSortKeys::ResetRanks()
+{
+	Tables.Empty();
+	CompressionMethods.Empty();
+}
+
+bool FFileSortKeys::UpdateRanks(const TArray<FPakFileEntryPtr>& InAllFiles, TFunctionRef<bool()> IsAborted)
+{
+	TArray<FPakFileTablePtr> NewTables;
+	if (!CollectTables(InAllFiles, NewTables))
+	{
+		ResetRanks();
+		return false;
+	}
+
+	// Names and paths never change once a table is loaded, only the class of a file does
+	bool bSameTables = NewTables.Num() == Tables.Num();
+	for (int32 Index = 0; bSameTables && Index < NewTables.Num(); ++Index)
+	{
+		const int32 FileCount = NewTables[Index].IsValid() ? NewTables[Index]->Num() : 0;
+		bSameTables = Tables[Index].Table == NewTables[Index] && Tables[Index].FileCount == FileCount;
+	}
+
+	if (!bSameTables)
+	{
+		ResetRanks();
+		Tables.SetNum(NewTables.Num());
+		for (int32 Index = 0; Index < NewTables.Num(); ++Index)
+		{
+			Tables[Index].Table = NewTables[Index];
+			Tables[Index].FileCount = NewTables[Index].IsValid() ? NewTables[Index]->Num() : 0;
+		}
+
+		if (!BuildNameAndPathRanks(IsAborted))
+		{
+			ResetRanks();
+			return false;
+		}
+	}
+
+	BuildClassAndCompressionRanks();
+	return true;
+}
+
+void FFileSortKeys::SetPackageGraph(FPackageGraphPtr InPackageGraph)
+{
+	PackageGraph = InPackageGraph;
+	LoadCosts.Reset();
+}
+
+void FFileSortKeys::SetLoadCosts(FPackageLoadCostsPtr InLoadCosts)
+{
+	LoadCosts = InLoadCosts;
+	PackageGraph = LoadCosts.IsValid() ? LoadCosts->GetGraph() : nullptr;
+}
+
+bool FFileSortKeys::SortFiles(TArray<FPakFileEntryPtr>& InOutFiles, const FSortKeyFunc& InKeyFunc, bool bDescending, TFunctionRef<bool()> IsAborted) const
+{
+	struct FSortItem
+	{
+		uint64 Key;
+		int32 Index;
+	};
+
+	const int32 ItemCount = InOutFiles.Num();
+	const int32 ChunkCount = GetChunkCount(ItemCount);
+	const int32 ChunkSize = FMath::Max(1, FMath::DivideAndRoundUp(ItemCount, ChunkCount));
+
+	TArray<FSortItem> Items;
+	Items.SetNumUninitialized(ItemCount);
+	TArray<uint64> ChunkMaxKeys;
+	ChunkMaxKeys.SetNumZeroed(ChunkCount);
+	ParallelFor(ChunkCount, [this, &InOutFiles, &InKeyFunc, &Items, &ChunkMaxKeys, ItemCount, ChunkSize](int32 ChunkIndex)
+	{
+		const int32 End = FMath::Min(ItemCount, (ChunkIndex + 1) * ChunkSize);
+		uint64 MaxKey = 0;
+		for (int32 Index = ChunkIndex * ChunkSize; Index < End; ++Index)
+		{
+			const uint64 Key = InKeyFunc(*this, *InOutFiles[Index]);
+			Items[Index] = { Key, Index };
+			MaxKey = FMath::Max(MaxKey, Key);
+		}
+		ChunkMaxKeys[ChunkIndex] = MaxKey;
+	}, GetParallelForFlags());
+
+	uint64 MaxKey = 0;
+	for (uint64 ChunkMaxKey : ChunkMaxKeys)
+	{
+		MaxKey = FMath::Max(MaxKey, ChunkMaxKey);
+	}
+
+	// Flipping the keys keeps equal keys in input order, same as the ascending sort
+	if (bDescending)
+	{
+		for (FSortItem& Item : Items)
+		{
+			Item.Key = MaxKey - Item.Key;
+		}
+	}
+
+	// LSD radix sort with 8 bit digits, only over the bytes the largest key uses
+	const int32 PassCount = MaxKey > 0 ? FMath::FloorLog2_64(MaxKey) / 8 + 1 : 0;
+
+	TArray<FSortItem> Temp;
+	Temp.SetNumUninitialized(ItemCount);
+	TArray<int32> Counts;
+	Counts.SetNumUninitialized(ChunkCount * 256);
+	for (int32 Pass = 0; Pass < PassCount; ++Pass)
+	{
+		if (IsAborted())
+		{
+			return false;
+		}
+
+		const int32 Shift = Pass * 8;
+		ParallelFor(ChunkCount, [&Items, &Counts, ItemCount, ChunkSize, Shift](int32 ChunkIndex)
+		{
+			int32* ChunkCounts = Counts.GetData() + ChunkIndex * 256;
+			FMemory::Memzero(ChunkCounts, 256 * sizeof(int32));
+
+			const int32 End = FMath::Min(ItemCount, (ChunkIndex + 1) * ChunkSize);
+			for (int32 Index = ChunkIndex * ChunkSize; Index < End; ++Index)
+			{
+				++ChunkCounts[(Items[Index].Key >> Shift) & 0xFF];
+			}
+		}, GetParallelForFlags());
+
+		// Digit major, chunk minor, so every chunk scatters into its own range and the sort stays stable
+		int32 Offset = 0;
+		bool bSingleDigit = false;
+		for (int32 Digit = 0; Digit < 256 && !bSingleDigit; ++Digit)
+		{
+			int32 DigitCount = 0;
+			for (int32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex)
+			{
+				int32& Count = Counts[ChunkIndex * 256 + Digit];
+				const int32 ChunkCountOfDigit = Count;
+				Count = Offset;
+				Offset += ChunkCountOfDigit;
+				DigitCount += ChunkCountOfDigit;
+			}
+			bSingleDigit = DigitCount == ItemCount;
+		}
+
+		if (bSingleDigit)
+		{
+			continue;
+		}
+
+		ParallelFor(ChunkCount, [&Items, &Temp, &Counts, ItemCount, ChunkSize, Shift](int32 ChunkIndex)
+		{
+			int32* ChunkOffsets = Counts.GetData() + ChunkIndex * 256;
+
+			const int32 End = FMath::Min(ItemCount, (ChunkIndex + 1) * ChunkSize);
+			for (int32 Index = ChunkIndex * ChunkSize; Index < End; ++Index)
+			{
+				Temp[ChunkOffsets[(Items[Index].Key >> Shift) & 0xFF]++] = Items[Index];
+			}
+		}, GetParallelForFlags());
+
+		Swap(Items, Temp);
+	}
+
+	if (IsAborted())
+	{
+		return false;
+	}
+
+	TArray<FPakFileEntryPtr> SortedFiles;
+	SortedFiles.SetNum(ItemCount);
+	ParallelFor(ChunkCount, [&InOutFiles, &SortedFiles, &Items, ItemCount, ChunkSize](int32 ChunkIndex)
+	{
+		const int32 End = FMath::Min(ItemCount, (ChunkIndex + 1) * ChunkSize);
+		for (int32 Index = ChunkIndex * ChunkSize; Index < End; ++Index)
+		{
+			SortedFiles[Index] = MoveTemp(InOutFiles[Items[Index].Index]);
+		}
+	}, GetParallelForFlags());
+
+	InOutFiles = MoveTemp(SortedFiles);
+	return true;
+}
+
+uint64 FFileSortKeys::GetNameRank(const FPakFileEntry& InFile) const
+{
+	const FTableKeys* TableKeys = FindTable(InFile);
+	return TableKeys ? TableKeys->NameRanks[InFile.FileIndex] : MAX_uint32;
+}
+
+uint64 FFileSortKeys::GetPathRank(const FPakFileEntry& InFile) const
+{
+	const FTableKeys* TableKeys = FindTable(InFile);
+	return TableKeys ? TableKeys->PathRanks[InFile.FileIndex] : MAX_uint32;
+}
+
+uint64 FFileSortKeys::GetClassRank(const FPakFileEntry& InFile) const
+{
+	const FTableKeys* TableKeys = FindTable(InFile);
+	if (!TableKeys || !TableKeys->Table->ClassIds.IsValidIndex(InFile.FileIndex))
+	{
+		return MAX_uint32;
+	}
+
+	const int32 ClassId = TableKeys->Table->ClassIds[InFile.FileIndex];
+	return TableKeys->ClassRanks.IsValidIndex(ClassId) ? TableKeys->ClassRanks[ClassId] : MAX_uint32;
+}
+
+uint64 FFileSortKeys::GetCompressionMethodRank(const FPakFileEntry& InFile) const
+{
+	// Only a handful of methods, a linear search is cheaper than a map
+	const int32 Index = CompressionMethods.IndexOfByKey(InFile.CompressionMethod);
+	return Index != INDEX_NONE ? Index : MAX_uint32;
+}
+
+uint64 FFileSortKeys::GetDependencyCount(const FPakFileEntry& InFile) const
+{
+	return PackageGraph.IsValid() ? PackageGraph->GetDependencyCount(InFile.GetPackageId()) : 0;
+}
+
+uint64 FFileSortKeys::GetDependentCount(const FPakFileEntry& InFile) const
+{
+	return PackageGraph.IsValid() ? PackageGraph->GetDependentCount(InFile.GetPackageId()) : 0;
+}
+
+uint64 FFileSortKeys::GetExclusiveSize(const FPakFileEntry& InFile) const
+{
+	return LoadCosts.IsValid() ? LoadCosts->GetExclusiveSize(InFile.GetPackageId()) : 0;
+}
+
+uint64 FFileSortKeys::GetExclusiveCompressedSize(const FPakFileEntry& InFile) const
+{
+	return LoadCosts.IsValid() ? LoadCosts->GetExclusiveCompressedSize(InFile.GetPackageId()) : 0;
+}
+
+uint64 FFileSortKeys::GetTransitiveSize(const FPakFileEntry& InFile) const
+{
+	return LoadCosts.IsValid() ? LoadCosts->GetTransitiveSize(InFile.GetPackageId()) : 0;
+}
+
+uint64 FFileSortKeys::GetTransitiveCompressedSize(const FPakFileEntry& InFile) const
+{
+	return LoadCosts.IsValid() ? LoadCosts->GetTransitiveCompressedSize(InFile.GetPackageId()) : 0;
+}
+
+bool FFileSortKeys::CollectTables(const TArray<FPakFileEntryPtr>& InAllFiles, TArray<FPakFileTablePtr>& OutTables) const
+{
+	// Files come grouped by table, see FBaseAnalyzer::GetFiles
+	const FPakFileTable* LastTable = nullptr;
+	for (const FPakFileEntryPtr& File : InAllFiles)
+	{
+		if (!File->FileTable.IsValid() || File->FileIndex == INDEX_NONE)
+		{
+			return false;
+		}
+
+		if (File->FileTable.Get() == LastTable)
+		{
+			continue;
+		}
+		LastTable = File->FileTable.Get();
+
+		const int32 PakIndex = LastTable->PakIndex;
+		if (PakIndex < 0)
+		{
+			return false;
+		}
+
+		if (OutTables.Num() <= PakIndex)
+		{
+			OutTables.SetNum(PakIndex + 1);
+		}
+
+		if (OutTables[PakIndex].IsValid() && OutTables[PakIndex] != File->FileTable)
+		{
+			return false;
+		}
+		OutTables[PakIndex] = File->FileTable;
+	}
+
+	return true;
+}
+
+bool FFileSortKeys::BuildNameAndPathRanks(TFunctionRef<bool()> IsAborted)
+{
+	struct FFileRef
+	{
+		int32 TableIndex;
+		int32 FileIndex;
+	};
+
+	// Distinct file names lowercased, the plain part without the number suffix is what FName::LexicalLess compares first
+	TMap<FName, int32> NameLookup;
+	TArray<FName> Names;
+	TArray<TCHAR> NameBuffer;
+	TArray<int32> NameOffsets;
+	TArray<int32> PlainNameLengths;
+	TArray<TArray<int32>> FileNameIds;
+	FileNameIds.SetNum(Tables.Num());
+
+	// Directory paths lowercased, as AppendFilePath writes them in front of a file name
+	TArray<TCHAR> DirectoryBuffer;
+	TArray<TArray<int32>> DirectoryOffsets;
+	DirectoryOffsets.SetNum(Tables.Num());
+
+	TArray<FFileRef> Files;
+	TStringBuilder<256> Builder;
+	for (int32 TableIndex = 0; TableIndex < Tables.Num(); ++TableIndex)
+	{
+		const FPakFileTable* Table = Tables[TableIndex].Table.Get();
+		if (!Table)
+		{
+			continue;
+		}
+
+		TArray<int32>& Offsets = DirectoryOffsets[TableIndex];
+		Offsets.Reserve(Table->Directories.Num() + 1);
+		for (int32 DirectoryIndex = 0; DirectoryIndex < Table->Directories.Num(); ++DirectoryIndex)
+		{
+			Builder.Reset();
+			Table->AppendDirectoryPath(DirectoryIndex, Builder);
+			if (Builder.Len() > 0 && Builder.LastChar() != TEXT('/') && Builder.LastChar() != TEXT('\\'))
+			{
+				Builder << TEXT('/');
+			}
+
+			Offsets.Add(DirectoryBuffer.Num());
+			AppendLower(Builder.ToView(), DirectoryBuffer);
+		}
+		Offsets.Add(DirectoryBuffer.Num());
+
+		TArray<int32>& NameIds = FileNameIds[TableIndex];
+		NameIds.SetNumUninitialized(Table->Num());
+		Files.Reserve(Files.Num() + Table->Num());
+		for (int32 FileIndex = 0; FileIndex < Table->Num(); ++FileIndex)
+		{
+			const FName Name = Table->Entries[FileIndex]->Filename;
+			const int32* FoundId = NameLookup.Find(Name);
+			if (FoundId)
+			{
+				NameIds[FileIndex] = *FoundId;
+			}
+			else
+			{
+				const int32 NameId = Names.Add(Name);
+				NameLookup.Add(Name, NameId);
+				NameIds[FileIndex] = NameId;
+
+				Builder.Reset();
+				Name.AppendString(Builder);
+				NameOffsets.Add(NameBuffer.Num());
+				AppendLower(Builder.ToView(), NameBuffer);
+
+				// AppendString writes the number as "_<Number - 1>"
+				int32 SuffixLength = 0;
+				if (Name.GetNumber() != NAME_NO_NUMBER_INTERNAL)
+				{
+					SuffixLength = 2;
+					for (int32 Value = NAME_INTERNAL_TO_EXTERNAL(Name.GetNumber()); Value >= 10; Value /= 10)
+					{
+						++SuffixLength;
+					}
+				}
+				PlainNameLengths.Add(Builder.Len() - SuffixLength);
+			}
+
+			Files.Add({ TableIndex, FileIndex });
+		}
+
+		if (IsAborted())
+		{
+			return false;
+		}
+	}
+	NameOffsets.Add(NameBuffer.Num());
+
+	auto GetName = [&NameBuffer, &NameOffsets](int32 InNameId)
+	{
+		return FStringView(NameBuffer.GetData() + NameOffsets[InNameId], NameOffsets[InNameId + 1] - NameOffsets[InNameId]);
+	};
+
+	auto CompareNames = [&GetName, &PlainNameLengths, &Names](int32 InA, int32 InB)
+	{
+		const int32 Result = CompareText(GetName(InA).Left(PlainNameLengths[InA]), GetName(InB).Left(PlainNameLengths[InB]));
+		return Result != 0 ? Result : (int32)Names[InA].GetNumber() - (int32)Names[InB].GetNumber();
+	};
+
+	TArray<int32> NameOrder;
+	NameOrder.SetNumUninitialized(Names.Num());
+	for (int32 NameId = 0; NameId < Names.Num(); ++NameId)
+	{
+		NameOrder[NameId] = NameId;
+	}
+
+	ParallelSort(NameOrder, [&CompareNames](int32 A, int32 B) { return CompareNames(A, B) < 0; });
+	if (IsAborted())
+	{
+		return false;
+	}
+
+	TArray<uint32> NameRanks;
+	NameRanks.SetNumUninitialized(Names.Num());
+	uint32 Rank = 0;
+	for (int32 Index = 0; Index < NameOrder.Num(); ++Index)
+	{
+		if (Index > 0 && CompareNames(NameOrder[Index - 1], NameOrder[Index]) != 0)
+		{
+			++Rank;
+		}
+		NameRanks[NameOrder[Index]] = Rank;
+	}
+
+	// Same order as FCString::Stricmp over the full paths
+	auto ComparePaths = [this, &GetName, &FileNameIds, &DirectoryBuffer, &DirectoryOffsets](const FFileRef& A, const FFileRef& B)
+	{
+		const int32 DirectoryA = Tables[A.TableIndex].Table->ParentDirectories[A.FileIndex];
+		const int32 DirectoryB = Tables[B.TableIndex].Table->ParentDirectories[B.FileIndex];
+		const FStringView NameA = GetName(FileNameIds[A.TableIndex][A.FileIndex]);
+		const FStringView NameB = GetName(FileNameIds[B.TableIndex][B.FileIndex]);
+		if (A.TableIndex == B.TableIndex && DirectoryA == DirectoryB)
+		{
+			return CompareText(NameA, NameB);
+		}
+
+		const TArray<int32>& OffsetsA = DirectoryOffsets[A.TableIndex];
+		const TArray<int32>& OffsetsB = DirectoryOffsets[B.TableIndex];
+		const FStringView PathA(DirectoryBuffer.GetData() + OffsetsA[DirectoryA], OffsetsA[DirectoryA + 1] - OffsetsA[DirectoryA]);
+		const FStringView PathB(DirectoryBuffer.GetData() + OffsetsB[DirectoryB], OffsetsB[DirectoryB + 1] - OffsetsB[DirectoryB]);
+		return CompareJoined(PathA, NameA, PathB, NameB);
+	};
+
+	ParallelSort(Files, [&ComparePaths](const FFileRef& A, const FFileRef& B) { return ComparePaths(A, B) < 0; });
+	if (IsAborted())
+	{
+		return false;
+	}
+
+	for (int32 TableIndex = 0; TableIndex < Tables.Num(); ++TableIndex)
+	{
+		FTableKeys& TableKeys = Tables[TableIndex];
+		TableKeys.NameRanks.SetNumUninitialized(TableKeys.FileCount);
+		TableKeys.PathRanks.SetNumUninitialized(TableKeys.FileCount);
+		for (int32 FileIndex = 0; FileIndex < TableKeys.FileCount; ++FileIndex)
+		{
+			TableKeys.NameRanks[FileIndex] = NameRanks[FileNameIds[TableIndex][FileIndex]];
+		}
+	}
+
+	Rank = 0;
+	for (int32 Index = 0; Index < Files.Num(); ++Index)
+	{
+		if (Index > 0 && ComparePaths(Files[Index - 1], Files[Index]) != 0)
+		{
+			++Rank;
+		}
+		Tables[Files[Index].TableIndex].PathRanks[Files[Index].FileIndex] = Rank;
+	}
+
+	return true;
+}
+
+void FFileSortKeys::BuildClassAndCompressionRanks()
+{
+	TArray<FName> Classes;
+	CompressionMethods.Reset();
+	for (const FTableKeys& TableKeys : Tables)
+	{
+		if (!TableKeys.Table.IsValid())
+		{
+			continue;
+		}
+
+		for (const FName& Class : TableKeys.Table->Classes)
+		{
+			Classes.AddUnique(Class);
+		}
+
+		for (int32 FileIndex = 0; FileIndex < TableKeys.FileCount; ++FileIndex)
+		{
+			CompressionMethods.AddUnique(TableKeys.Table->Entries[FileIndex]->CompressionMethod);
+		}
+	}
+
+	Classes.Sort([](const FName& A, const FName& B) { return A.LexicalLess(B); });
+	CompressionMethods.Sort([](const FName& A, const FName& B) { return A.LexicalLess(B); });
+
+	for (FTableKeys& TableKeys : Tables)
+	{
+		TableKeys.ClassRanks.Reset();
+		if (!TableKeys.Table.IsValid())
+		{
+			continue;
+		}
+
+		TableKeys.ClassRanks.SetNumUninitialized(TableKeys.Table->Classes.Num());
+		for (int32 ClassId = 0; ClassId < TableKeys.Table->Classes.Num(); ++ClassId)
+		{
+			TableKeys.ClassRanks[ClassId] = Classes.IndexOfByKey(TableKeys.Table->Classes[ClassId]);
+		}
+	}
+}
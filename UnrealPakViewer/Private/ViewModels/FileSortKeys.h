@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "PackageGraph.h"
+#include "PakFileEntry.h"
+
+// What the key of a column reads besides the file itself, the sort task only builds those
+enum class EFileSortKeyInputs : uint8
+{
+	None = 0,
+
+	Ranks = (1 << 0),
+	PackageGraph = (1 << 1),
+	LoadCosts = (1 << 2),
+};
+ENUM_CLASS_FLAGS(EFileSortKeyInputs);
+
+/**
+ * Integer ranks of the string columns of every loaded file, so each column of the file list sorts as integer keys.
+ * Name and path ranks are built once per set of file tables, class and compression method ranks again whenever files change (asset registry, asset parse).
+ * Equal keys keep the order of the input, ascending keys give the order of the ascending column comparator.
+ */
+class FFileSortKeys
+{
+public:
+	typedef TFunction<uint64(const FFileSortKeys& Keys, const FPakFileEntry& File)> FSortKeyFunc;
+
+	void Reset();
+
+	// InAllFiles is every file of the analyzer in table order, false when aborted or when a file has no file table
+	bool UpdateRanks(const TArray<FPakFileEntryPtr>& InAllFiles, TFunctionRef<bool()> IsAborted);
+	void SetPackageGraph(FPackageGraphPtr InPackageGraph);
+	// Also takes the graph of the costs, so every key of one sort reads the same graph
+	void SetLoadCosts(FPackageLoadCostsPtr InLoadCosts);
+
+	// Stable parallel radix sort by the key of every file, false when aborted and InOutFiles is left as it was
+	bool SortFiles(TArray<FPakFileEntryPtr>& InOutFiles, const FSortKeyFunc& InKeyFunc, bool bDescending, TFunctionRef<bool()> IsAborted) const;
+
+	uint64 GetNameRank(const FPakFileEntry& InFile) const;
+	uint64 GetPathRank(const FPakFileEntry& InFile) const;
+	uint64 GetClassRank(const FPakFileEntry& InFile) const;
+	uint64 GetCompressionMethodRank(const FPakFileEntry& InFile) const;
+	uint64 GetDependencyCount(const FPakFileEntry& InFile) const;
+	uint64 GetDependentCount(const FPakFileEntry& InFile) const;
+	uint64 GetExclusiveSize(const FPakFileEntry& InFile) const;
+	uint64 GetExclusiveCompressedSize(const FPakFileEntry& InFile) const;
+	uint64 GetTransitiveSize(const FPakFileEntry& InFile) const;
+	uint64 GetTransitiveCompressedSize(const FPakFileEntry& InFile) const;
+
+protected:
+	struct FTableKeys
+	{
+		// Strong reference, so a table of a closed pak never aliases a new one at the same address
+		FPakFileTablePtr Table;
+		int32 FileCount = 0;
+
+		// Indexed by FPakFileEntry::FileIndex
+		TArray<uint32> NameRanks;
+		TArray<uint32> PathRanks;
+
+		// Indexed by class id of the table
+		TArray<uint32> ClassRanks;
+	};
+
+	FORCEINLINE const FTableKeys* FindTable(const FPakFileEntry& InFile) const
+	{
+		const FPakFileTable* Table = InFile.FileTable.Get();
+		if (!Table || !Tables.IsValidIndex(Table->PakIndex))
+		{
+			return nullptr;
+		}
+
+		const FTableKeys& TableKeys = Tables[Table->PakIndex];
+		return TableKeys.Table.Get() == Table && TableKeys.NameRanks.IsValidIndex(InFile.FileIndex) ? &TableKeys : nullptr;
+	}
+
+	void ResetRanks();
+	bool CollectTables(const TArray<FPakFileEntryPtr>& InAllFiles, TArray<FPakFileTablePtr>& OutTables) const;
+	bool BuildNameAndPathRanks(TFunctionRef<bool()> IsAborted);
+	void BuildClassAndCompressionRanks();
+
+protected:
+	// Indexed by FPakFileTable::PakIndex, slots of unused indices stay empty
+	TArray<FTableKeys> Tables;
+	// Sorted by FName::LexicalLess
+	TArray<FName> CompressionMethods;
+	FPackageGraphPtr PackageGraph;
+	FPackageLoadCostsPtr LoadCosts;
+};
@@ -11,6 +11,7 @@
 #include "Widgets/Views/STableRow.h"
 #include "Widgets/Views/STableViewBase.h"
 
+#include "PakAnalyzerModule.h"
 #include "SKeyValueRow.h"
 
 #include "UnrealPakViewerStyle.h"
@@ -585,8 +586,26 @@ void SAssetSummaryView::SetViewingPackage(FPakFileEntryPtr InPackage)
 	ImportObjects = InPackage->AssetSummary->ObjectImports;
 	ExportObjects = InPackage->AssetSummary->ObjectExports;
 	//PreloadDependency = InPackage->AssetSummary->PreloadDependency;
-	DependencyList = InPackage->AssetSummary->DependencyList;
-	DependentList = InPackage->AssetSummary->DependentList;
+
+	// Only the viewed package gets list items, the graph keeps plain ids
+	const FPackageGraphPtr PackageGraph = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPackageGraph();
+	const int32 PackageId = InPackage->AssetSummary->PackageId;
+
+	DependencyList.Reset();
+	for (int32 Dependency : PackageGraph->GetDependencies(PackageId))
+	{
+		FPackageInfoPtr Depends = MakeShared<FPackageInfo>();
+		Depends->PackageName = PackageGraph->GetPackageName(Dependency);
+		DependencyList.Add(Depends);
+	}
+
+	DependentList.Reset();
+	for (int32 Dependent : PackageGraph->GetDependents(PackageId))
+	{
+		FPackageInfoPtr Depends = MakeShared<FPackageInfo>();
+		Depends->PackageName = PackageGraph->GetPackageName(Dependent);
+		DependentList.Add(Depends);
+	}
 
 	TotalExportSize = 0;
 	for (FObjectExportPtrType ExportObject : ExportObjects)
@@ -769,12 +788,12 @@ FORCEINLINE FText SAssetSummaryView::GetExportSizeTooltip() const
 
 FORCEINLINE FText SAssetSummaryView::GetDependencyCount() const
 {
-	return ViewingPackage.IsValid() ? FText::AsNumber(ViewingPackage->AssetSummary->DependencyList.Num()) : FText();
+	return ViewingPackage.IsValid() ? FText::AsNumber(DependencyList.Num()) : FText();
 }
 
 FORCEINLINE FText SAssetSummaryView::GetDependentCount() const
 {
-	return ViewingPackage.IsValid() ? FText::AsNumber(ViewingPackage->AssetSummary->DependentList.Num()) : FText();
+	return ViewingPackage.IsValid() ? FText::AsNumber(DependentList.Num()) : FText();
 }
 
 DEFINE_GET_MEMBER_FUNCTION_NUMBER(TotalHeaderSize)
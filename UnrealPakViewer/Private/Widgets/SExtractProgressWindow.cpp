@@ -12,12 +12,10 @@
 #define LOCTEXT_NAMESPACE "SExtractProgressWindow"
 
 SExtractProgressWindow::SExtractProgressWindow()
-	: CompleteCount(0)
-	, TotalCount(0)
-	, ErrorCount(0)
+	: BytesPerSecond(0.0)
+	, FilesPerSecond(0.0)
 	, bExtractFinished(false)
 {
-	FPakAnalyzerDelegates::OnUpdateExtractProgress.BindRaw(this, &SExtractProgressWindow::OnUpdateExtractProgress);
 }
 
 SExtractProgressWindow::~SExtractProgressWindow()
@@ -28,7 +26,7 @@ SExtractProgressWindow::~SExtractProgressWindow()
 void SExtractProgressWindow::Construct(const FArguments& Args)
 {
 	const float DPIScaleFactor = FPlatformApplicationMisc::GetDPIScaleFactorAtPoint(10.0f, 10.0f);
-	const FVector2D InitialWindowDimensions(600, 60);
+	const FVector2D InitialWindowDimensions(600, 85);
 
 	SWindow::Construct(SWindow::FArguments()
 		.Title(LOCTEXT("WindowTitle", "Extracting..."))
@@ -109,6 +107,31 @@ void SExtractProgressWindow::Construct(const FArguments& Args)
 						SNew(SKeyValueRow).KeyStretchCoefficient(0.8f).KeyText(LOCTEXT("Time", "Time:")).ValueText(this, &SExtractProgressWindow::GetTimeElapsed)
 					]
 				]
+
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0.f, 4.f)
+				[
+					SNew(SHorizontalBox)
+
+					+ SHorizontalBox::Slot()
+					.FillWidth(1.f)
+					[
+						SNew(SKeyValueRow).KeyStretchCoefficient(1.f).KeyText(LOCTEXT("ByteRateText", "Speed:")).ValueText(this, &SExtractProgressWindow::GetByteRate)
+					]
+
+					+ SHorizontalBox::Slot()
+					.FillWidth(1.f)
+					[
+						SNew(SKeyValueRow).KeyStretchCoefficient(1.f).KeyText(LOCTEXT("FileRateText", "Files:")).ValueText(this, &SExtractProgressWindow::GetFileRate)
+					]
+
+					+ SHorizontalBox::Slot()
+					.FillWidth(2.f)
+					[
+						SNew(SKeyValueRow).KeyStretchCoefficient(0.4f).KeyText(LOCTEXT("RemainingText", "Remaining:")).ValueText(this, &SExtractProgressWindow::GetRemainingTime)
+					]
+				]
 			]
 		]
 	);
@@ -118,6 +141,11 @@ void SExtractProgressWindow::Construct(const FArguments& Args)
 	LastTime = Args._StartTime.Get();
 	bExtractFinished = false;
 
+	// The window opens once the extraction started, so the job is already there
+	IPakAnalyzer* PakAnalyzer = IPakAnalyzerModule::Get().GetPakAnalyzer();
+	ExtractJob = PakAnalyzer ? PakAnalyzer->GetExtractJob() : nullptr;
+	RegisterActiveTimer(SampleInterval, FWidgetActiveTimerDelegate::CreateSP(this, &SExtractProgressWindow::SampleProgress));
+
 	SetCanTick(true);
 }
 
@@ -125,7 +153,7 @@ void SExtractProgressWindow::Tick(const FGeometry& AllottedGeometry, const doubl
 {
 	SWindow::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
 
-	bExtractFinished = CompleteCount == TotalCount;
+	bExtractFinished = Progress.CompleteCount == Progress.TotalCount;
 	if (!bExtractFinished)
 	{
 		LastTime = FDateTime::Now();
@@ -134,27 +162,27 @@ void SExtractProgressWindow::Tick(const FGeometry& AllottedGeometry, const doubl
 
 FORCEINLINE FText SExtractProgressWindow::GetCompleteCount() const
 {
-	return FText::AsNumber(CompleteCount);
+	return FText::AsNumber(Progress.CompleteCount);
 }
 
 FORCEINLINE FText SExtractProgressWindow::GetErrorCount() const
 {
-	return FText::AsNumber(ErrorCount);
+	return FText::AsNumber(Progress.ErrorCount);
 }
 
 FORCEINLINE FText SExtractProgressWindow::GetTotalCount() const
 {
-	return FText::AsNumber(TotalCount);
+	return FText::AsNumber(Progress.TotalCount);
 }
 
 FORCEINLINE TOptional<float> SExtractProgressWindow::GetExtractProgress() const
 {
-	return TotalCount > 0 ? (float)CompleteCount / TotalCount : 0.f;
+	return Progress.TotalCount > 0 ? (float)Progress.CompleteCount / Progress.TotalCount : 0.f;
 }
 
 FORCEINLINE FText SExtractProgressWindow::GetExtractProgressText() const
 {
-	return TotalCount > 0 ? FText::FromString(FString::Printf(TEXT("%.2f%%"), (float)CompleteCount / TotalCount * 100)) : FText();
+	return Progress.TotalCount > 0 ? FText::FromString(FString::Printf(TEXT("%.2f%%"), (float)Progress.CompleteCount / Progress.TotalCount * 100)) : FText();
 }
 
 FORCEINLINE FText SExtractProgressWindow::GetTimeElapsed() const
@@ -164,16 +192,67 @@ FORCEINLINE FText SExtractProgressWindow::GetTimeElapsed() const
 	return FText::FromString(ElapsedTime.ToString());
 }
 
+FORCEINLINE FText SExtractProgressWindow::GetByteRate() const
+{
+	return FText::FromString(FString::Printf(TEXT("%.1f MB/s"), BytesPerSecond / (1024.0 * 1024.0)));
+}
+
+FORCEINLINE FText SExtractProgressWindow::GetFileRate() const
+{
+	return FText::FromString(FString::Printf(TEXT("%.0f/s"), FilesPerSecond));
+}
+
+FORCEINLINE FText SExtractProgressWindow::GetRemainingTime() const
+{
+	if (bExtractFinished)
+	{
+		return FText::FromString(FTimespan::Zero().ToString());
+	}
+
+	// Bytes give a steadier estimate than files when small and large files are mixed
+	double RemainingSeconds = -1.0;
+	if (Progress.TotalBytes > 0 && BytesPerSecond > 0.0)
+	{
+		RemainingSeconds = FMath::Max<int64>(Progress.TotalBytes - Progress.CompleteBytes, 0) / BytesPerSecond;
+	}
+	else if (FilesPerSecond > 0.0)
+	{
+		RemainingSeconds = FMath::Max(Progress.TotalCount - Progress.CompleteCount, 0) / FilesPerSecond;
+	}
+
+	return RemainingSeconds >= 0.0 ? FText::FromString(FTimespan::FromSeconds(FMath::CeilToDouble(RemainingSeconds)).ToString()) : LOCTEXT("UnknownRemainingTime", "--");
+}
+
 void SExtractProgressWindow::OnExit(const TSharedRef<SWindow>& InWindow)
 {
 	IPakAnalyzerModule::Get().GetPakAnalyzer()->CancelExtract();
 }
 
-void SExtractProgressWindow::OnUpdateExtractProgress(int32 InCompleteCount, int32 InErrorCount, int32 InTotalCount)
+EActiveTimerReturnType SExtractProgressWindow::SampleProgress(double InCurrentTime, float InDeltaTime)
 {
-	CompleteCount = InCompleteCount;
-	ErrorCount = InErrorCount;
-	TotalCount = InTotalCount;
+	if (!ExtractJob.IsValid())
+	{
+		return EActiveTimerReturnType::Stop;
+	}
+
+	Progress = ExtractJob->Sample();
+
+	// Keep one sample older than the window, so the rates always span the whole of it
+	RateSamples.Add({ InCurrentTime, Progress.CompleteCount, Progress.CompleteBytes });
+	while (RateSamples.Num() > 2 && RateSamples[1].Time <= InCurrentTime - RateWindowSeconds)
+	{
+		RateSamples.RemoveAt(0, 1, false);
+	}
+
+	const FRateSample& Oldest = RateSamples[0];
+	const double Duration = InCurrentTime - Oldest.Time;
+	if (Duration > 0.0)
+	{
+		BytesPerSecond = (Progress.CompleteBytes - Oldest.CompleteBytes) / Duration;
+		FilesPerSecond = (Progress.CompleteCount - Oldest.CompleteCount) / Duration;
+	}
+
+	return Progress.CompleteCount < Progress.TotalCount ? EActiveTimerReturnType::Continue : EActiveTimerReturnType::Stop;
 }
 
 #undef LOCTEXT_NAMESPACE
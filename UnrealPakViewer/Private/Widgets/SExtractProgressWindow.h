@@ -4,6 +4,8 @@
 #include "Misc/DateTime.h"
 #include "Widgets/SWindow.h"
 
+#include "IPakAnalyzer.h"
+
 class SExtractProgressWindow : public SWindow
 {
 public:
@@ -35,14 +37,32 @@ protected:
 	FORCEINLINE TOptional<float> GetExtractProgress() const;
 	FORCEINLINE FText GetExtractProgressText() const;
 	FORCEINLINE FText GetTimeElapsed() const;
+	FORCEINLINE FText GetByteRate() const;
+	FORCEINLINE FText GetFileRate() const;
+	FORCEINLINE FText GetRemainingTime() const;
 
 	void OnExit(const TSharedRef<SWindow>& InWindow);
-	void OnUpdateExtractProgress(int32 InCompleteCount, int32 InErrorCount, int32 InTotalCount);
+	// Reads the counters of the extract job and updates the rolling rates
+	EActiveTimerReturnType SampleProgress(double InCurrentTime, float InDeltaTime);
 
 protected:
-	int32 CompleteCount;
-	int32 TotalCount;
-	int32 ErrorCount;
+	// Seconds between two samples of the job counters
+	static constexpr float SampleInterval = 0.2f;
+	// Rates and remaining time are averaged over this many seconds
+	static constexpr double RateWindowSeconds = 5.0;
+
+	struct FRateSample
+	{
+		double Time;
+		int32 CompleteCount;
+		int64 CompleteBytes;
+	};
+
+	FExtractJobPtr ExtractJob;
+	FExtractJob::FSnapshot Progress;
+	TArray<FRateSample> RateSamples;
+	double BytesPerSecond;
+	double FilesPerSecond;
 	TAttribute<FDateTime> StartTime;
 	FDateTime LastTime;
 	bool bExtractFinished;
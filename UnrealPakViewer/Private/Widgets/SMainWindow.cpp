@@ -14,6 +14,8 @@
 #include "Misc/Paths.h"
 #include "Styling/CoreStyle.h"
 #include "Widgets/Docking/SDockTab.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Notifications/SProgressBar.h"
 
 #include "CommonDefines.h"
 #include "PakAnalyzerModule.h"
@@ -113,6 +115,43 @@ void SMainWindow::Construct(const FArguments& Args)
 					TabManager->RestoreFrom(Layout, TSharedPtr<SWindow>()).ToSharedRef()
 				]
 			]
+			// Load progress
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(FMargin(5.f, 2.f))
+			[
+				SNew(SHorizontalBox)
+				.Visibility(this, &SMainWindow::GetLoadProgressVisibility)
+
+				+ SHorizontalBox::Slot()
+				.FillWidth(1.f)
+				.VAlign(VAlign_Center)
+				.Padding(FMargin(0.f, 0.f, 5.f, 0.f))
+				[
+					SNew(SOverlay)
+
+					+ SOverlay::Slot()
+					[
+						SNew(SProgressBar).Percent(this, &SMainWindow::GetLoadProgress)
+					]
+
+					+ SOverlay::Slot()
+					.HAlign(HAlign_Center)
+					[
+						SNew(STextBlock)
+						.Text(this, &SMainWindow::GetLoadProgressText)
+						.ColorAndOpacity(FLinearColor::Black)
+					]
+				]
+
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				[
+					SNew(SButton)
+					.Text(LOCTEXT("CancelLoad", "Cancel"))
+					.OnClicked(this, &SMainWindow::OnCancelLoad)
+				]
+			]
 		]
 	);
 
@@ -285,6 +324,11 @@ TSharedRef<class SDockTab> SMainWindow::OnSpawnTab_FileView(const FSpawnTabArgs&
 
 void SMainWindow::OnExit(const TSharedRef<SWindow>& InWindow)
 {
+	if (LoadJob.IsValid())
+	{
+		IPakAnalyzerModule::Get().GetPakAnalyzer()->CancelLoad();
+		LoadJob.Reset();
+	}
 }
 
 void SMainWindow::OnLoadPakFile()
@@ -384,14 +428,32 @@ void SMainWindow::OnLoadFolder()
 
 void SMainWindow::OnLoadPakFailed(const FString& InReason)
 {
+	if (!IsInGameThread())
+	{
+		FFunctionGraphTask::CreateAndDispatchWhenReady([InReason]()
+			{
+				FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(InReason));
+			},
+			TStatId(), nullptr, ENamedThreads::GameThread);
+		return;
+	}
+
 	FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(InReason));
 }
 
 FString SMainWindow::OnGetAESKey(const FString& InPakPath, const FGuid& PakGuid, bool& bCancel)
 {
+	// Analyzers ask on the game thread, a load thread queues the question and waits for it there
+	check(IsInGameThread());
+
 	FString EncryptionKey = TEXT("");
 	bCancel = true;
 
+	if (LoadJob.IsValid() && LoadJob->IsCancelled())
+	{
+		return EncryptionKey;
+	}
+
 	TSharedPtr<SKeyInputWindow> KeyInputWindow =
 		SNew(SKeyInputWindow)
 		.PakPath(InPakPath)
@@ -528,8 +590,6 @@ FReply SMainWindow::OnDragOver(const FGeometry& MyGeometry, const FDragDropEvent
 
 void SMainWindow::LoadPakFile(const TArray<FString>& PakFilePaths)
 {
-	static const int32 MAX_RECENT_FILE_COUNT = 30;
-
 	TArray<FString> PakFiles;
 	TArray<FString> CachedAESKeys;
 	for (const FString& PakFilePath : PakFilePaths)
@@ -544,34 +604,113 @@ void SMainWindow::LoadPakFile(const TArray<FString>& PakFilePaths)
 		return;
 	}
 
+	// Cancels and waits for the load of the previous backend
 	IPakAnalyzerModule::Get().InitializeAnalyzerBackend(PakFiles[0]);
 
-	const bool bLoadResult = IPakAnalyzerModule::Get().GetPakAnalyzer()->LoadPakFiles(PakFiles, CachedAESKeys);
-	if (bLoadResult)
+	LoadJob = IPakAnalyzerModule::Get().GetPakAnalyzer()->LoadPakFilesAsync(PakFiles, CachedAESKeys);
+	if (!LoadProgressTimer.IsValid())
 	{
-		const TArray<FPakFileSumaryPtr>& Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
-		for (const FPakFileSumaryPtr& Summary : Summaries)
-		{
-			if (!Summary.IsValid())
-			{
-				continue;
-			}
+		LoadProgressTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMainWindow::UpdateLoadProgress));
+	}
+}
 
-			RemoveRecentFile(Summary->PakFilePath);
-			if (!Summary->DecryptAESKeyStr.IsEmpty())
-			{
-				AESKeyCaches.Add(Summary->PakFilePath, Summary->DecryptAESKeyStr);
-			}
+EActiveTimerReturnType SMainWindow::UpdateLoadProgress(double InCurrentTime, float InDeltaTime)
+{
+	if (LoadJob.IsValid() && !LoadJob->IsFinished())
+	{
+		return EActiveTimerReturnType::Continue;
+	}
 
-			RecentFiles.Insert(Summary->PakFilePath, 0);
-			if (RecentFiles.Num() > MAX_RECENT_FILE_COUNT)
-			{
-				RecentFiles.SetNum(MAX_RECENT_FILE_COUNT);
-			}
+	OnLoadJobFinished();
+	return EActiveTimerReturnType::Stop;
+}
+
+void SMainWindow::OnLoadJobFinished()
+{
+	static const int32 MAX_RECENT_FILE_COUNT = 30;
 
-			SaveConfig();
+	FPakLoadJobPtr FinishedJob = LoadJob;
+	LoadJob.Reset();
+
+	if (!FinishedJob.IsValid() || !FinishedJob->GetResult())
+	{
+		return;
+	}
+
+	const TArray<FPakFileSumaryPtr> Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
+	for (const FPakFileSumaryPtr& Summary : Summaries)
+	{
+		if (!Summary.IsValid())
+		{
+			continue;
+		}
+
+		RemoveRecentFile(Summary->PakFilePath);
+		if (!Summary->DecryptAESKeyStr.IsEmpty())
+		{
+			AESKeyCaches.Add(Summary->PakFilePath, Summary->DecryptAESKeyStr);
 		}
+
+		RecentFiles.Insert(Summary->PakFilePath, 0);
+		if (RecentFiles.Num() > MAX_RECENT_FILE_COUNT)
+		{
+			RecentFiles.SetNum(MAX_RECENT_FILE_COUNT);
+		}
+
+		SaveConfig();
+	}
+}
+
+EVisibility SMainWindow::GetLoadProgressVisibility() const
+{
+	return LoadJob.IsValid() ? EVisibility::Visible : EVisibility::Collapsed;
+}
+
+TOptional<float> SMainWindow::GetLoadProgress() const
+{
+	return LoadJob.IsValid() ? LoadJob->GetPercent() : 0.f;
+}
+
+FText SMainWindow::GetLoadProgressText() const
+{
+	if (!LoadJob.IsValid())
+	{
+		return FText::GetEmpty();
 	}
+
+	if (LoadJob->IsCancelled())
+	{
+		return LOCTEXT("LoadCancelling", "Cancelling...");
+	}
+
+	FText PhaseText;
+	switch (LoadJob->GetPhase())
+	{
+	case EPakLoadPhase::ReadingTrailers:
+		PhaseText = LOCTEXT("LoadReadingTrailers", "Reading pak trailers");
+		break;
+	case EPakLoadPhase::LoadingIndices:
+		PhaseText = LOCTEXT("LoadLoadingIndices", "Loading indices");
+		break;
+	case EPakLoadPhase::Merging:
+		PhaseText = LOCTEXT("LoadMerging", "Merging");
+		break;
+	default:
+		PhaseText = LOCTEXT("LoadPending", "Loading");
+		break;
+	}
+
+	return FText::Format(LOCTEXT("LoadProgressText", "{0}... {1}"), PhaseText, FText::AsPercent(LoadJob->GetPercent()));
+}
+
+FReply SMainWindow::OnCancelLoad()
+{
+	if (LoadJob.IsValid())
+	{
+		LoadJob->Cancel();
+	}
+
+	return FReply::Handled();
 }
 
 void SMainWindow::RemoveRecentFile(const FString& InFullPath)
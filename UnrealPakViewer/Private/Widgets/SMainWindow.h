@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "Widgets/SWindow.h"
 
+#include "IPakAnalyzer.h"
+
 class SMainWindow : public SWindow
 {
 public:
@@ -62,6 +64,12 @@ protected:
 	virtual FReply OnDragOver(const FGeometry& MyGeometry, const FDragDropEvent& DragDropEvent)  override;
 
 	void LoadPakFile(const TArray<FString>& PakFilePaths);
+	EActiveTimerReturnType UpdateLoadProgress(double InCurrentTime, float InDeltaTime);
+	void OnLoadJobFinished();
+	EVisibility GetLoadProgressVisibility() const;
+	TOptional<float> GetLoadProgress() const;
+	FText GetLoadProgressText() const;
+	FReply OnCancelLoad();
 	void RemoveRecentFile(const FString& InFullPath);
 	void SaveConfig();
 	void LoadConfig();
@@ -76,4 +84,8 @@ protected:
 
 	TArray<FString> RecentFiles;
 	TMap<FString, FString> AESKeyCaches;
+
+	// Paks load on a worker thread, the status bar shows the job until it finishes
+	FPakLoadJobPtr LoadJob;
+	TWeakPtr<FActiveTimerHandle> LoadProgressTimer;
 };
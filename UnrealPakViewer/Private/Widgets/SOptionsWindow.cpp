@@ -3,6 +3,7 @@
 //#include "EditorStyleSet.h"
 #include "HAL/PlatformMisc.h"
 #include "HAL/PlatformApplicationMisc.h"
+#include "Misc/Paths.h"
 
 #include "CommonDefines.h"
 #include "PakAnalyzerModule.h"
@@ -22,8 +23,27 @@ void SOptionsWindow::Construct(const FArguments& Args)
 	int32 DefaultThreadCount = DEFAULT_EXTRACT_THREAD_COUNT;
 	GConfig->GetInt(TEXT("UnrealPakViewer"), TEXT("ExtractThreadCount"), DefaultThreadCount, GEngineIni);
 
+	FString IndexCacheDirectory;
+	GConfig->GetString(TEXT("UnrealPakViewer"), TEXT("IndexCacheDirectory"), IndexCacheDirectory, GEngineIni);
+	if (IndexCacheDirectory.IsEmpty())
+	{
+		IndexCacheDirectory = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / DEFAULT_INDEX_CACHE_FOLDER);
+	}
+
+	int32 IndexCacheSizeMB = DEFAULT_INDEX_CACHE_SIZE_MB;
+	GConfig->GetInt(TEXT("UnrealPakViewer"), TEXT("IndexCacheSizeMB"), IndexCacheSizeMB, GEngineIni);
+
+	bool bIoStoreSplitZenHeader = false;
+	GConfig->GetBool(TEXT("UnrealPakViewer"), TEXT("IoStoreSplitZenHeader"), bIoStoreSplitZenHeader, GEngineIni);
+
+	bool bMappedPakReads = false;
+	GConfig->GetBool(TEXT("UnrealPakViewer"), TEXT("MappedPakReads"), bMappedPakReads, GEngineIni);
+
+	bool bExtractZipDeflate = false;
+	GConfig->GetBool(TEXT("UnrealPakViewer"), TEXT("ExtractZipDeflate"), bExtractZipDeflate, GEngineIni);
+
 	const float DPIScaleFactor = FPlatformApplicationMisc::GetDPIScaleFactorAtPoint(10.0f, 10.0f);
-	const FVector2D InitialWindowDimensions(600, 70);
+	const FVector2D InitialWindowDimensions(600, 210);
 
 	SWindow::Construct(SWindow::FArguments()
 		.Title(LOCTEXT("WindowTitle", "Options"))
@@ -68,6 +88,93 @@ void SOptionsWindow::Construct(const FArguments& Args)
 					]
 				]
 
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0.f, 4.f, 0.f, 0.f)
+				[
+					SNew(SHorizontalBox)
+
+					+ SHorizontalBox::Slot()
+					.AutoWidth()
+					.HAlign(EHorizontalAlignment::HAlign_Left)
+					.VAlign(EVerticalAlignment::VAlign_Center)
+					.Padding(FMargin(0.f, 0.f, 5.f, 0.f))
+					[
+						SNew(STextBlock).Text(LOCTEXT("IndexCacheDirectoryText", "Index cache directory:"))
+					]
+
+					+ SHorizontalBox::Slot()
+					.FillWidth(1.f)
+					.Padding(FMargin(0.f, 0.f, 5.f, 0.f))
+					[
+						SAssignNew(IndexCacheDirectoryBox, SEditableTextBox).Text(FText::FromString(IndexCacheDirectory))
+					]
+				]
+
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0.f, 4.f, 0.f, 0.f)
+				[
+					SNew(SHorizontalBox)
+
+					+ SHorizontalBox::Slot()
+					.AutoWidth()
+					.HAlign(EHorizontalAlignment::HAlign_Left)
+					.VAlign(EVerticalAlignment::VAlign_Center)
+					.Padding(FMargin(0.f, 0.f, 5.f, 0.f))
+					[
+						SNew(STextBlock).Text(LOCTEXT("IndexCacheSizeText", "Index cache size limit (MB):"))
+					]
+
+					+ SHorizontalBox::Slot()
+					.FillWidth(1.f)
+					.Padding(FMargin(0.f, 0.f, 5.f, 0.f))
+					[
+						SAssignNew(IndexCacheSizeBox, SSpinBox<int32>).MinValue(0).MaxValue(64 * 1024).Value(IndexCacheSizeMB)
+					]
+
+					+ SHorizontalBox::Slot()
+					.AutoWidth()
+					.Padding(FMargin(0.f, 0.f, 5.f, 0.f))
+					[
+						SNew(STextBlock).Text(LOCTEXT("IndexCacheDisableText", "(0 to disable)"))
+					]
+				]
+
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0.f, 4.f, 0.f, 0.f)
+				[
+					SAssignNew(IoStoreSplitZenHeaderBox, SCheckBox)
+					.IsChecked(bIoStoreSplitZenHeader ? ECheckBoxState::Checked : ECheckBoxState::Unchecked)
+					.ToolTipText(LOCTEXT("IoStoreSplitZenHeaderTip", "The .zenheader file holds the package header as the container stores it, it is not a legacy .uasset header. The .uexp file holds the export data followed by the package tag."))
+					[
+						SNew(STextBlock).Text(LOCTEXT("IoStoreSplitZenHeaderText", "Extract IoStore packages as zen header (.zenheader) and export data (.uexp)"))
+					]
+				]
+
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0.f, 4.f, 0.f, 0.f)
+				[
+					SAssignNew(MappedPakReadsBox, SCheckBox)
+					.IsChecked(bMappedPakReads ? ECheckBoxState::Checked : ECheckBoxState::Unchecked)
+					[
+						SNew(STextBlock).Text(LOCTEXT("MappedPakReadsText", "Read paks through memory mapping when extracting and parsing"))
+					]
+				]
+
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.Padding(0.f, 4.f, 0.f, 0.f)
+				[
+					SAssignNew(ExtractZipDeflateBox, SCheckBox)
+					.IsChecked(bExtractZipDeflate ? ECheckBoxState::Checked : ECheckBoxState::Unchecked)
+					[
+						SNew(STextBlock).Text(LOCTEXT("ExtractZipDeflateText", "Deflate files extracted to a zip archive"))
+					]
+				]
+
 				+ SVerticalBox::Slot()
 				.AutoHeight()
 				.HAlign(HAlign_Right)
@@ -106,6 +213,13 @@ FReply SOptionsWindow::OnApply()
 {
 	const int32 ThreadCount = ThreadCountBox->GetValueAttribute().Get();
 	GConfig->SetInt(TEXT("UnrealPakViewer"), TEXT("ExtractThreadCount"), ThreadCount, GEngineIni);
+
+	// Read by the analyzers on every load and extraction
+	GConfig->SetString(TEXT("UnrealPakViewer"), TEXT("IndexCacheDirectory"), *IndexCacheDirectoryBox->GetText().ToString().TrimStartAndEnd(), GEngineIni);
+	GConfig->SetInt(TEXT("UnrealPakViewer"), TEXT("IndexCacheSizeMB"), IndexCacheSizeBox->GetValueAttribute().Get(), GEngineIni);
+	GConfig->SetBool(TEXT("UnrealPakViewer"), TEXT("IoStoreSplitZenHeader"), IoStoreSplitZenHeaderBox->IsChecked(), GEngineIni);
+	GConfig->SetBool(TEXT("UnrealPakViewer"), TEXT("MappedPakReads"), MappedPakReadsBox->IsChecked(), GEngineIni);
+	GConfig->SetBool(TEXT("UnrealPakViewer"), TEXT("ExtractZipDeflate"), ExtractZipDeflateBox->IsChecked(), GEngineIni);
 	GConfig->Flush(false, GEngineIni);
 
 	IPakAnalyzerModule::Get().GetPakAnalyzer()->SetExtractThreadCount(ThreadCount);
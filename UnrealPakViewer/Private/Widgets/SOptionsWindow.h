@@ -1,6 +1,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SEditableTextBox.h"
 #include "Widgets/Input/SSpinBox.h"
 #include "Widgets/SWindow.h"
 
@@ -24,4 +26,9 @@ protected:
 
 protected:
 	TSharedPtr<SSpinBox<int32>> ThreadCountBox;
+	TSharedPtr<SEditableTextBox> IndexCacheDirectoryBox;
+	TSharedPtr<SSpinBox<int32>> IndexCacheSizeBox;
+	TSharedPtr<SCheckBox> IoStoreSplitZenHeaderBox;
+	TSharedPtr<SCheckBox> MappedPakReadsBox;
+	TSharedPtr<SCheckBox> ExtractZipDeflateBox;
 };
\ No newline at end of file
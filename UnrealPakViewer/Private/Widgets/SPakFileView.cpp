@@ -1,5 +1,6 @@
 #include "SPakFileView.h"
 
+#include "Async/Async.h"
 #include "Async/AsyncWork.h"
 #include "Async/TaskGraphInterfaces.h"
 #include "DesktopPlatformModule.h"
@@ -9,6 +10,7 @@
 #include "HAL/PlatformApplicationMisc.h"
 #include "IPlatformFilePak.h"
 #include "Misc/Guid.h"
+#include "Misc/StringBuilder.h"
 #include "Styling/CoreStyle.h"
 #include "Widgets/Layout/SBorder.h"
 #include "Widgets/Layout/SBox.h"
@@ -27,6 +29,24 @@
 
 #define LOCTEXT_NAMESPACE "SPakFileView"
 
+typedef int64 (FPackageLoadCosts::*FLoadCostGetter)(int32) const;
+
+// Load cost of the package of a file, 0 until the analyzer has computed the costs of the loaded paks
+static int64 GetLoadCost(const FPakFileEntry& InFile, FLoadCostGetter InGetter)
+{
+	IPakAnalyzer* PakAnalyzer = IPakAnalyzerModule::Get().GetPakAnalyzer();
+	const FPackageLoadCostsPtr LoadCosts = PakAnalyzer ? PakAnalyzer->GetPackageLoadCosts() : FPackageLoadCostsPtr();
+	return LoadCosts.IsValid() ? (LoadCosts.Get()->*InGetter)(InFile.GetPackageId()) : 0;
+}
+
+// Load costs of the paks a copy reads, empty ones once their load is cancelled or replaced
+static FPackageLoadCostsPtr UpdateCopyLoadCosts(IPakAnalyzer* InPakAnalyzer)
+{
+	const FPakLoadJobPtr LoadJob = InPakAnalyzer ? InPakAnalyzer->GetLoadJob() : FPakLoadJobPtr();
+	const FPackageLoadCostsPtr LoadCosts = InPakAnalyzer ? InPakAnalyzer->UpdatePackageLoadCosts([&LoadJob]() { return LoadJob.IsValid() && LoadJob->IsCancelled(); }) : FPackageLoadCostsPtr();
+	return LoadCosts.IsValid() ? LoadCosts : FPackageLoadCostsPtr(MakeShared<FPackageLoadCosts, ESPMode::ThreadSafe>());
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // SPakFileRow
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -176,6 +196,38 @@ public:
 				SNew(STextBlock).Text(this, &SPakFileRow::GetDependentCount)
 			];
 		}
+		else if (ColumnName == FFileColumn::ExclusiveSizeColumnName)
+		{
+			return
+				SNew(SBox).Padding(FMargin(4.0, 0.0))
+				[
+					SNew(STextBlock).Text(this, &SPakFileRow::GetLoadCostText, &FPackageLoadCosts::GetExclusiveSize).ToolTipText(this, &SPakFileRow::GetLoadCostToolTip, &FPackageLoadCosts::GetExclusiveSize)
+				];
+		}
+		else if (ColumnName == FFileColumn::ExclusiveCompressedSizeColumnName)
+		{
+			return
+				SNew(SBox).Padding(FMargin(4.0, 0.0))
+				[
+					SNew(STextBlock).Text(this, &SPakFileRow::GetLoadCostText, &FPackageLoadCosts::GetExclusiveCompressedSize).ToolTipText(this, &SPakFileRow::GetLoadCostToolTip, &FPackageLoadCosts::GetExclusiveCompressedSize)
+				];
+		}
+		else if (ColumnName == FFileColumn::TransitiveSizeColumnName)
+		{
+			return
+				SNew(SBox).Padding(FMargin(4.0, 0.0))
+				[
+					SNew(STextBlock).Text(this, &SPakFileRow::GetLoadCostText, &FPackageLoadCosts::GetTransitiveSize).ToolTipText(this, &SPakFileRow::GetLoadCostToolTip, &FPackageLoadCosts::GetTransitiveSize)
+				];
+		}
+		else if (ColumnName == FFileColumn::TransitiveCompressedSizeColumnName)
+		{
+			return
+				SNew(SBox).Padding(FMargin(4.0, 0.0))
+				[
+					SNew(STextBlock).Text(this, &SPakFileRow::GetLoadCostText, &FPackageLoadCosts::GetTransitiveCompressedSize).ToolTipText(this, &SPakFileRow::GetLoadCostToolTip, &FPackageLoadCosts::GetTransitiveCompressedSize)
+				];
+		}
 		else
 		{
 			return SNew(STextBlock).Text(LOCTEXT("UnknownColumn", "Unknown Column"));
@@ -196,7 +248,7 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid())
 		{
-			return FText::FromName(PakFileItemPin->Filename);
+			return FText::FromString(PakFileItemPin->GetFilename());
 		}
 		else
 		{
@@ -209,7 +261,7 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid())
 		{
-			return FText::FromString(PakFileItemPin->Path);
+			return FText::FromString(PakFileItemPin->GetPath());
 		}
 		else
 		{
@@ -222,7 +274,7 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid())
 		{
-			return FText::FromName(PakFileItemPin->Class);
+			return FText::FromName(PakFileItemPin->GetClass());
 		}
 		else
 		{
@@ -235,7 +287,7 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid())
 		{
-			return FSlateColor(FClassColumn::GetColorByClass(*PakFileItemPin->Class.ToString()));
+			return FSlateColor(FClassColumn::GetColorByClass(*PakFileItemPin->GetClass().ToString()));
 		}
 		else
 		{
@@ -313,7 +365,7 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid())
 		{
-			return FText::AsNumber(PakFileItemPin->PakEntry.CompressionBlocks.Num());
+			return FText::AsNumber(PakFileItemPin->GetCompressionBlockCount());
 		}
 		else
 		{
@@ -365,6 +417,17 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid())
 		{
+			if (!PakFileItemPin->bHashLoaded)
+			{
+				// Only drawn rows ask, the view reads their hashes in one batch off the game thread
+				TSharedPtr<SPakFileView> PakFileViewPin = WeakPakFileView.Pin();
+				if (PakFileViewPin.IsValid())
+				{
+					PakFileViewPin->RequestFileHash(PakFileItemPin);
+				}
+				return LOCTEXT("SHA1_Loading", "Loading...");
+			}
+
 			return FText::FromString(BytesToHex(PakFileItemPin->PakEntry.Hash, sizeof(PakFileItemPin->PakEntry.Hash)));
 		}
 		else
@@ -391,7 +454,7 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid())
 		{
-			const TArray<FPakFileSumaryPtr>& Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
+			const TArray<FPakFileSumaryPtr> Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
 			if (Summaries.IsValidIndex(PakFileItemPin->OwnerPakIndex))
 			{
 				return FText::FromString(FPaths::GetCleanFilename(Summaries[PakFileItemPin->OwnerPakIndex]->PakFilePath));
@@ -406,7 +469,7 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid())
 		{
-			const TArray<FPakFileSumaryPtr>& Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
+			const TArray<FPakFileSumaryPtr> Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
 			if (Summaries.IsValidIndex(PakFileItemPin->OwnerPakIndex))
 			{
 				return FText::FromString(Summaries[PakFileItemPin->OwnerPakIndex]->PakFilePath);
@@ -421,7 +484,7 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid() && PakFileItemPin->AssetSummary.IsValid())
 		{
-			return FText::AsNumber(PakFileItemPin->AssetSummary->DependencyList.Num());
+			return FText::AsNumber(IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPackageGraph()->GetDependencyCount(PakFileItemPin->AssetSummary->PackageId));
 		}
 
 		return FText::AsNumber(0);
@@ -432,11 +495,37 @@ protected:
 		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
 		if (PakFileItemPin.IsValid() && PakFileItemPin->AssetSummary.IsValid())
 		{
-			return FText::AsNumber(PakFileItemPin->AssetSummary->DependentList.Num());
+			return FText::AsNumber(IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPackageGraph()->GetDependentCount(PakFileItemPin->AssetSummary->PackageId));
 		}
 
 		return FText::AsNumber(0);
 	}
+
+	FText GetLoadCostText(FLoadCostGetter InGetter) const
+	{
+		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
+		if (PakFileItemPin.IsValid())
+		{
+			return FText::AsMemory(GetLoadCost(*PakFileItemPin, InGetter), EMemoryUnitStandard::IEC);
+		}
+		else
+		{
+			return FText();
+		}
+	}
+
+	FText GetLoadCostToolTip(FLoadCostGetter InGetter) const
+	{
+		FPakFileEntryPtr PakFileItemPin = WeakPakFileItem.Pin();
+		if (PakFileItemPin.IsValid())
+		{
+			return FText::AsNumber(GetLoadCost(*PakFileItemPin, InGetter));
+		}
+		else
+		{
+			return FText();
+		}
+	}
 protected:
 	TWeakPtr<FPakFileEntry> WeakPakFileItem;
 	TWeakPtr<SPakFileView> WeakPakFileView;
@@ -449,6 +538,7 @@ protected:
 SPakFileView::SPakFileView()
 {
 	FWidgetDelegates::GetOnLoadAssetRegistryFinishedDelegate().AddRaw(this, &SPakFileView::OnLoadAssetReigstryFinished);
+	FPakAnalyzerDelegates::OnPakLoadStart.AddRaw(this, &SPakFileView::OnLoadPakStarted);
 	FPakAnalyzerDelegates::OnPakLoadFinish.AddRaw(this, &SPakFileView::OnLoadPakFinished);
 	FPakAnalyzerDelegates::OnAssetParseFinish.AddRaw(this, &SPakFileView::OnParseAssetFinished);
 }
@@ -456,11 +546,18 @@ SPakFileView::SPakFileView()
 SPakFileView::~SPakFileView()
 {
 	FWidgetDelegates::GetOnLoadAssetRegistryFinishedDelegate().RemoveAll(this);
+	FPakAnalyzerDelegates::OnPakLoadStart.RemoveAll(this);
 	FPakAnalyzerDelegates::OnPakLoadFinish.RemoveAll(this);
 	FPakAnalyzerDelegates::OnAssetParseFinish.RemoveAll(this);
 
+	if (HashLoadTask.IsValid())
+	{
+		HashLoadTask.Wait();
+	}
+
 	if (SortAndFilterTask.IsValid())
 	{
+		InnderTask->Abort();
 		SortAndFilterTask->Cancel();
 		SortAndFilterTask->EnsureCompletion();
 	}
@@ -584,7 +681,7 @@ void SPakFileView::Construct(const FArguments& InArgs)
 
 	InnderTask->GetOnSortAndFilterFinishedDelegate().BindRaw(this, &SPakFileView::OnSortAndFilterFinihed);
 
-	FilesSummary = MakeShared<FPakFileEntry>(TEXT("Total"), TEXT("Total"));
+	FilesSummary = MakeShared<FPakFileEntry>(TEXT("Total"));
 }
 
 void SPakFileView::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
@@ -604,11 +701,14 @@ void SPakFileView::Tick(const FGeometry& AllottedGeometry, const double InCurren
 					IndexFilterMap.Add(i, PakFilterMap[i].bShow);
 				}
 
-				InnderTask->SetWorkInfo(CurrentSortedColumn, CurrentSortMode, CurrentSearchText, ClassFilterMap, IndexFilterMap);
+				InnderTask->SetWorkInfo(CurrentSortedColumn, CurrentSortMode, CurrentSearchText, ClassFilterMap, IndexFilterMap, bFilesChanged);
+				bFilesChanged = false;
 				SortAndFilterTask->StartBackgroundTask();
 			}
 		}
 
+		UpdateFileHashes(PakAnalyzer);
+
 		if (!DelayHighlightItem.IsEmpty() && !IsFileListEmpty())
 		{
 			ScrollToItem(DelayHighlightItem, DelayHighlightItemPakIndex);
@@ -620,6 +720,63 @@ void SPakFileView::Tick(const FGeometry& AllottedGeometry, const double InCurren
 	SCompoundWidget::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
 }
 
+void SPakFileView::RequestFileHash(const FPakFileEntryPtr& InFile)
+{
+	if (!HashLoadFiles.Contains(InFile))
+	{
+		PendingHashFiles.Add(InFile);
+	}
+}
+
+void SPakFileView::UpdateFileHashes(IPakAnalyzer* InPakAnalyzer)
+{
+	if (HashLoadTask.IsValid())
+	{
+		if (!HashLoadTask.IsReady())
+		{
+			return;
+		}
+
+		// The task only wrote its copies, rows see the hashes from the next frame on
+		for (int32 i = 0; i < HashLoadFiles.Num(); ++i)
+		{
+			if (HashLoadCopies[i]->bHashLoaded)
+			{
+				FMemory::Memcpy(HashLoadFiles[i]->PakEntry.Hash, HashLoadCopies[i]->PakEntry.Hash, sizeof(HashLoadFiles[i]->PakEntry.Hash));
+				HashLoadFiles[i]->bHashLoaded = true;
+			}
+		}
+
+		HashLoadTask.Reset();
+		HashLoadFiles.Empty();
+		HashLoadCopies.Empty();
+	}
+
+	if (PendingHashFiles.Num() <= 0)
+	{
+		return;
+	}
+
+	for (const FPakFileEntryPtr& File : PendingHashFiles)
+	{
+		// Loaded meanwhile, by an export or the tree view
+		if (!File->bHashLoaded)
+		{
+			HashLoadFiles.Add(File);
+			HashLoadCopies.Add(MakeShared<FPakFileEntry>(*File));
+		}
+	}
+	PendingHashFiles.Empty();
+
+	if (HashLoadCopies.Num() > 0)
+	{
+		HashLoadTask = Async(EAsyncExecution::ThreadPool, [InPakAnalyzer, Copies = HashLoadCopies]()
+			{
+				InPakAnalyzer->LoadFileHashes(Copies);
+			});
+	}
+}
+
 bool SPakFileView::SearchBoxIsEnabled() const
 {
 	return true;
@@ -660,6 +817,19 @@ TSharedPtr<SWidget> SPakFileView::OnGenerateContextMenu()
 			),
 			NAME_None, EUserInterfaceActionType::Button
 		);
+
+		MenuBuilder.AddMenuEntry
+		(
+			LOCTEXT("ContextMenu_ExtractToArchive", "Extract To Archive..."),
+			LOCTEXT("ContextMenu_ExtractToArchive_Desc", "Extract selected files into a single tar or zip file"),
+			FSlateIcon(FUnrealPakViewerStyle::GetStyleSetName(), "Extract"),
+			FUIAction
+			(
+				FExecuteAction::CreateSP(this, &SPakFileView::OnExtractToArchive),
+				FCanExecuteAction::CreateSP(this, &SPakFileView::HasFileSelected)
+			),
+			NAME_None, EUserInterfaceActionType::Button
+		);
 	}
 	MenuBuilder.EndSection();
 
@@ -691,6 +861,19 @@ TSharedPtr<SWidget> SPakFileView::OnGenerateContextMenu()
 			),
 			NAME_None, EUserInterfaceActionType::Button
 		);
+
+		MenuBuilder.AddMenuEntry
+		(
+			LOCTEXT("ContextMenu_Export_To_Binary", "Export To Binary..."),
+			LOCTEXT("ContextMenu_Export_To_Binary_Desc", "Export selected file(s) info to a columnar binary file"),
+			FSlateIcon(FUnrealPakViewerStyle::GetStyleSetName(), "Export"),
+			FUIAction
+			(
+				FExecuteAction::CreateSP(this, &SPakFileView::OnExportToBinary),
+				FCanExecuteAction::CreateSP(this, &SPakFileView::HasFileSelected)
+			),
+			NAME_None, EUserInterfaceActionType::Button
+		);
 	}
 	MenuBuilder.EndSection();
 
@@ -973,7 +1156,7 @@ void SPakFileView::FillClassesFilter()
 
 	if (PakAnalyzer)
 	{
-		const TArray<FPakTreeEntryPtr>& TreeRoots = PakAnalyzer->GetPakTreeRootNode();
+		const TArray<FPakTreeEntryPtr> TreeRoots = PakAnalyzer->GetPakTreeRootNode();
 		for (const FPakTreeEntryPtr& TreeRoot : TreeRoots)
 		{
 			for (const auto& Pair : TreeRoot->FileClassMap)
@@ -1034,7 +1217,7 @@ void SPakFileView::FillPaksFilter()
 	IPakAnalyzer* PakAnalyzer = IPakAnalyzerModule::Get().GetPakAnalyzer();
 	if (PakAnalyzer)
 	{
-		const TArray<FPakFileSumaryPtr>& Summaries = PakAnalyzer->GetPakFileSumary();
+		const TArray<FPakFileSumaryPtr> Summaries = PakAnalyzer->GetPakFileSumary();
 		PakFilterMap.AddZeroed(Summaries.Num());
 
 		for (int32 i = 0; i < Summaries.Num(); ++i)
@@ -1048,6 +1231,16 @@ void SPakFileView::FillPaksFilter()
 	}
 }
 
+static int32 ComparePath(const FPakFileEntryPtr& A, const FPakFileEntryPtr& B)
+{
+	TStringBuilder<256> PathA;
+	TStringBuilder<256> PathB;
+	A->AppendPath(PathA);
+	B->AppendPath(PathB);
+
+	return FCString::Stricmp(PathA.ToString(), PathB.ToString());
+}
+
 void SPakFileView::InitializeAndShowHeaderColumns()
 {
 	FileColumns.Empty();
@@ -1066,74 +1259,113 @@ void SPakFileView::InitializeAndShowHeaderColumns()
 			return B->Filename.LexicalLess(A->Filename);
 		}
 	);
+	NameColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetNameRank(File);
+		},
+		EFileSortKeyInputs::Ranks
+	);
 
 	// Path Column
 	FFileColumn& PathColumn = FileColumns.Emplace(FFileColumn::PathColumnName, FFileColumn(1, FFileColumn::PathColumnName, LOCTEXT("PathColumn", "Path"), LOCTEXT("PathColumnTip", "File path in pak"), 3.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
 	PathColumn.SetAscendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			return A->Path < B->Path;
+			return ComparePath(A, B) < 0;
 		}
 	);
 	PathColumn.SetDescendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			return B->Path < A->Path;
+			return ComparePath(B, A) < 0;
 		}
 	);
+	PathColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetPathRank(File);
+		},
+		EFileSortKeyInputs::Ranks
+	);
 
 	// Class Column
 	FFileColumn& ClassColumn = FileColumns.Emplace(FFileColumn::ClassColumnName, FFileColumn(2, FFileColumn::ClassColumnName, LOCTEXT("ClassColumn", "Class"), LOCTEXT("ClassColumnTip", "Class name in asset registry or file extension if not found"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
 	ClassColumn.SetAscendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			return A->Class.LexicalLess(B->Class);
+			return A->GetClass().LexicalLess(B->GetClass());
 		}
 	);
 	ClassColumn.SetDescendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			return B->Class.LexicalLess(A->Class);
+			return B->GetClass().LexicalLess(A->GetClass());
 		}
 	);
+	ClassColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetClassRank(File);
+		},
+		EFileSortKeyInputs::Ranks
+	);
 
 	// Dependency Count Column
 	FFileColumn& DependencyCountColumn = FileColumns.Emplace(FFileColumn::DependencyCountColumnName, FFileColumn(3, FFileColumn::DependencyCountColumnName, LOCTEXT("DependencyCountColumn", "Dependency Count"), LOCTEXT("DependencyCountColumnTip", "Packages this package depends on"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
 	DependencyCountColumn.SetAscendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			const int32 ACount = A->AssetSummary.IsValid() ? A->AssetSummary->DependencyList.Num() : 0;
-			const int32 BCount = B->AssetSummary.IsValid() ? B->AssetSummary->DependencyList.Num() : 0;
+			const FPackageGraphPtr PackageGraph = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPackageGraph();
+			const int32 ACount = PackageGraph->GetDependencyCount(A->GetPackageId());
+			const int32 BCount = PackageGraph->GetDependencyCount(B->GetPackageId());
 			return ACount < BCount;
 		}
 	);
 	DependencyCountColumn.SetDescendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			const int32 ACount = A->AssetSummary.IsValid() ? A->AssetSummary->DependencyList.Num() : 0;
-			const int32 BCount = B->AssetSummary.IsValid() ? B->AssetSummary->DependencyList.Num() : 0;
+			const FPackageGraphPtr PackageGraph = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPackageGraph();
+			const int32 ACount = PackageGraph->GetDependencyCount(A->GetPackageId());
+			const int32 BCount = PackageGraph->GetDependencyCount(B->GetPackageId());
 			return BCount < ACount;
 		}
 	);
+	DependencyCountColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetDependencyCount(File);
+		},
+		EFileSortKeyInputs::PackageGraph
+	);
 
 	// Dependent Count Column
 	FFileColumn& DependentCountColumn = FileColumns.Emplace(FFileColumn::DependentCountColumnName, FFileColumn(4, FFileColumn::DependentCountColumnName, LOCTEXT("DependentCountColumn", "Dependent Count"), LOCTEXT("DependentCountColumnTip", "Packages depend on this package"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
 	DependentCountColumn.SetAscendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			const int32 ACount = A->AssetSummary.IsValid() ? A->AssetSummary->DependentList.Num() : 0;
-			const int32 BCount = B->AssetSummary.IsValid() ? B->AssetSummary->DependentList.Num() : 0;
+			const FPackageGraphPtr PackageGraph = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPackageGraph();
+			const int32 ACount = PackageGraph->GetDependentCount(A->GetPackageId());
+			const int32 BCount = PackageGraph->GetDependentCount(B->GetPackageId());
 			return ACount < BCount;
 		}
 	);
 	DependentCountColumn.SetDescendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			const int32 ACount = A->AssetSummary.IsValid() ? A->AssetSummary->DependentList.Num() : 0;
-			const int32 BCount = B->AssetSummary.IsValid() ? B->AssetSummary->DependentList.Num() : 0;
+			const FPackageGraphPtr PackageGraph = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPackageGraph();
+			const int32 ACount = PackageGraph->GetDependentCount(A->GetPackageId());
+			const int32 BCount = PackageGraph->GetDependentCount(B->GetPackageId());
 			return BCount < ACount;
 		}
 	);
+	DependentCountColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetDependentCount(File);
+		},
+		EFileSortKeyInputs::PackageGraph
+	);
 
 	// Offset Column
 	FFileColumn& OffsetColumn = FileColumns.Emplace(FFileColumn::OffsetColumnName, FFileColumn(5, FFileColumn::OffsetColumnName, LOCTEXT("OffsetColumn", "Offset"), LOCTEXT("OffsetColumnTip", "File offset in pak"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
@@ -1149,6 +1381,12 @@ void SPakFileView::InitializeAndShowHeaderColumns()
 			return B->PakEntry.Offset < A->PakEntry.Offset;
 		}
 	);
+	OffsetColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return (uint64)File.PakEntry.Offset;
+		}
+	);
 
 	// Size Column
 	FFileColumn& SizeColumn = FileColumns.Emplace(FFileColumn::SizeColumnName, FFileColumn(6, FFileColumn::SizeColumnName, LOCTEXT("SizeColumn", "Size"), LOCTEXT("SizeColumnTip", "File original size"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
@@ -1164,6 +1402,12 @@ void SPakFileView::InitializeAndShowHeaderColumns()
 			return B->PakEntry.UncompressedSize < A->PakEntry.UncompressedSize;
 		}
 	);
+	SizeColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return (uint64)File.PakEntry.UncompressedSize;
+		}
+	);
 	
 	// Compressed Size Column
 	FFileColumn& CompressedSizeColumn = FileColumns.Emplace(FFileColumn::CompressedSizeColumnName, FFileColumn(7, FFileColumn::CompressedSizeColumnName, LOCTEXT("CompressedSizeColumn", "Compressed Size"), LOCTEXT("CompressedSizeColumnTip", "File compressed size"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
@@ -1179,19 +1423,31 @@ void SPakFileView::InitializeAndShowHeaderColumns()
 			return B->PakEntry.Size < A->PakEntry.Size;
 		}
 	);
+	CompressedSizeColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return (uint64)File.PakEntry.Size;
+		}
+	);
 	
 	// Compressed Block Count
 	FFileColumn& CompressionBlockCountColumn = FileColumns.Emplace(FFileColumn::CompressionBlockCountColumnName, FFileColumn(8, FFileColumn::CompressionBlockCountColumnName, LOCTEXT("CompressionBlockCountColumn", "Compression Block Count"), LOCTEXT("CompressionBlockCountColumnTip", "File compression block count"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
 	CompressionBlockCountColumn.SetAscendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			return A->PakEntry.CompressionBlocks.Num() < B->PakEntry.CompressionBlocks.Num();
+			return A->GetCompressionBlockCount() < B->GetCompressionBlockCount();
 		}
 	);
 	CompressionBlockCountColumn.SetDescendingCompareDelegate(
 		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
 		{
-			return B->PakEntry.CompressionBlocks.Num() < A->PakEntry.CompressionBlocks.Num();
+			return B->GetCompressionBlockCount() < A->GetCompressionBlockCount();
+		}
+	);
+	CompressionBlockCountColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return (uint64)File.GetCompressionBlockCount();
 		}
 	);
 	
@@ -1212,6 +1468,13 @@ void SPakFileView::InitializeAndShowHeaderColumns()
 			return B->CompressionMethod.LexicalLess(A->CompressionMethod);
 		}
 	);
+	CompressionMethodColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetCompressionMethodRank(File);
+		},
+		EFileSortKeyInputs::Ranks
+	);
 	
 	// Owner Pak
 	FFileColumn& OwnerPakColumn = FileColumns.Emplace(FFileColumn::OwnerPakColumnName, FFileColumn(11, FFileColumn::OwnerPakColumnName, LOCTEXT("OwnerPakColumn", "Onwer Pak"), LOCTEXT("OnwerPakColumnTip", "Owner Pak Name"), 2.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeHidden | EFileColumnFlags::CanBeFiltered));
@@ -1227,6 +1490,12 @@ void SPakFileView::InitializeAndShowHeaderColumns()
 			return B->OwnerPakIndex < A->OwnerPakIndex;
 		}
 	);
+	OwnerPakColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return (uint64)File.OwnerPakIndex;
+		}
+	);
 
 	// SHA1
 	FileColumns.Emplace(FFileColumn::SHA1ColumnName, FFileColumn(12, FFileColumn::SHA1ColumnName, LOCTEXT("SHA1Column", "SHA1"), LOCTEXT("SHA1ColumnTip", "File sha1"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeHidden));
@@ -1245,6 +1514,100 @@ void SPakFileView::InitializeAndShowHeaderColumns()
 			return B->PakEntry.IsEncrypted() < A->PakEntry.IsEncrypted();
 		}
 	);
+	IsEncryptedColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return File.PakEntry.IsEncrypted();
+		}
+	);
+
+	// Exclusive Size Column
+	FFileColumn& ExclusiveSizeColumn = FileColumns.Emplace(FFileColumn::ExclusiveSizeColumnName, FFileColumn(14, FFileColumn::ExclusiveSizeColumnName, LOCTEXT("ExclusiveSizeColumn", "Exclusive Size"), LOCTEXT("ExclusiveSizeColumnTip", "Size of every file of this package"), 1.f, EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
+	ExclusiveSizeColumn.SetAscendingCompareDelegate(
+		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			return GetLoadCost(*A, &FPackageLoadCosts::GetExclusiveSize) < GetLoadCost(*B, &FPackageLoadCosts::GetExclusiveSize);
+		}
+	);
+	ExclusiveSizeColumn.SetDescendingCompareDelegate(
+		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			return GetLoadCost(*B, &FPackageLoadCosts::GetExclusiveSize) < GetLoadCost(*A, &FPackageLoadCosts::GetExclusiveSize);
+		}
+	);
+	ExclusiveSizeColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetExclusiveSize(File);
+		},
+		EFileSortKeyInputs::LoadCosts
+	);
+
+	// Exclusive Compressed Size Column
+	FFileColumn& ExclusiveCompressedSizeColumn = FileColumns.Emplace(FFileColumn::ExclusiveCompressedSizeColumnName, FFileColumn(15, FFileColumn::ExclusiveCompressedSizeColumnName, LOCTEXT("ExclusiveCompressedSizeColumn", "Exclusive Compressed Size"), LOCTEXT("ExclusiveCompressedSizeColumnTip", "Compressed size of every file of this package"), 1.f, EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
+	ExclusiveCompressedSizeColumn.SetAscendingCompareDelegate(
+		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			return GetLoadCost(*A, &FPackageLoadCosts::GetExclusiveCompressedSize) < GetLoadCost(*B, &FPackageLoadCosts::GetExclusiveCompressedSize);
+		}
+	);
+	ExclusiveCompressedSizeColumn.SetDescendingCompareDelegate(
+		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			return GetLoadCost(*B, &FPackageLoadCosts::GetExclusiveCompressedSize) < GetLoadCost(*A, &FPackageLoadCosts::GetExclusiveCompressedSize);
+		}
+	);
+	ExclusiveCompressedSizeColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetExclusiveCompressedSize(File);
+		},
+		EFileSortKeyInputs::LoadCosts
+	);
+
+	// Transitive Size Column
+	FFileColumn& TransitiveSizeColumn = FileColumns.Emplace(FFileColumn::TransitiveSizeColumnName, FFileColumn(16, FFileColumn::TransitiveSizeColumnName, LOCTEXT("TransitiveSizeColumn", "Transitive Size"), LOCTEXT("TransitiveSizeColumnTip", "Size of this package and everything it depends on, a shared dependency counted once"), 1.f, EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
+	TransitiveSizeColumn.SetAscendingCompareDelegate(
+		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			return GetLoadCost(*A, &FPackageLoadCosts::GetTransitiveSize) < GetLoadCost(*B, &FPackageLoadCosts::GetTransitiveSize);
+		}
+	);
+	TransitiveSizeColumn.SetDescendingCompareDelegate(
+		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			return GetLoadCost(*B, &FPackageLoadCosts::GetTransitiveSize) < GetLoadCost(*A, &FPackageLoadCosts::GetTransitiveSize);
+		}
+	);
+	TransitiveSizeColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetTransitiveSize(File);
+		},
+		EFileSortKeyInputs::LoadCosts
+	);
+
+	// Transitive Compressed Size Column
+	FFileColumn& TransitiveCompressedSizeColumn = FileColumns.Emplace(FFileColumn::TransitiveCompressedSizeColumnName, FFileColumn(17, FFileColumn::TransitiveCompressedSizeColumnName, LOCTEXT("TransitiveCompressedSizeColumn", "Transitive Compressed Size"), LOCTEXT("TransitiveCompressedSizeColumnTip", "Compressed size of this package and everything it depends on, a shared dependency counted once"), 1.f, EFileColumnFlags::ShouldBeVisible | EFileColumnFlags::CanBeFiltered | EFileColumnFlags::CanBeHidden));
+	TransitiveCompressedSizeColumn.SetAscendingCompareDelegate(
+		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			return GetLoadCost(*A, &FPackageLoadCosts::GetTransitiveCompressedSize) < GetLoadCost(*B, &FPackageLoadCosts::GetTransitiveCompressedSize);
+		}
+	);
+	TransitiveCompressedSizeColumn.SetDescendingCompareDelegate(
+		[](const FPakFileEntryPtr& A, const FPakFileEntryPtr& B) -> bool
+		{
+			return GetLoadCost(*B, &FPackageLoadCosts::GetTransitiveCompressedSize) < GetLoadCost(*A, &FPackageLoadCosts::GetTransitiveCompressedSize);
+		}
+	);
+	TransitiveCompressedSizeColumn.SetSortKeyDelegate(
+		[](const FFileSortKeys& Keys, const FPakFileEntry& File) -> uint64
+		{
+			return Keys.GetTransitiveCompressedSize(File);
+		},
+		EFileSortKeyInputs::LoadCosts
+	);
 
 	// Show columns.
 	for (const auto& ColumnPair : FileColumns)
@@ -1448,6 +1811,14 @@ void SPakFileView::OnCopyAllColumnsExecute()
 
 	if (SelectedItems.Num() > 0)
 	{
+		if (PakAnalyzer)
+		{
+			PakAnalyzer->LoadFileHashes(SelectedItems);
+		}
+
+		const FPackageGraphPtr PackageGraph = PakAnalyzer ? PakAnalyzer->GetPackageGraph() : FPackageGraphPtr(MakeShared<FPackageGraph, ESPMode::ThreadSafe>());
+		const FPackageLoadCostsPtr LoadCosts = UpdateCopyLoadCosts(PakAnalyzer);
+		const TArray<FPakFileSumaryPtr> Summaries = PakAnalyzer ? PakAnalyzer->GetPakFileSumary() : TArray<FPakFileSumaryPtr>();
 		TArray<TSharedPtr<FJsonValue>> FileObjects;
 
 		for (const FPakFileEntryPtr PakFileItem : SelectedItems)
@@ -1457,20 +1828,24 @@ void SPakFileView::OnCopyAllColumnsExecute()
 				const FPakEntry* PakEntry = &PakFileItem->PakEntry;
 				TSharedRef<FJsonObject> FileObject = MakeShareable(new FJsonObject);
 
-				FileObject->SetStringField(TEXT("Name"), PakFileItem->Filename.ToString());
-				FileObject->SetStringField(TEXT("Path"), PakFileItem->Path);
+				FileObject->SetStringField(TEXT("Name"), PakFileItem->GetFilename());
+				FileObject->SetStringField(TEXT("Path"), PakFileItem->GetPath());
 				FileObject->SetNumberField(TEXT("Offset"), PakEntry->Offset);
 				FileObject->SetNumberField(TEXT("Size"), PakEntry->UncompressedSize);
 				FileObject->SetNumberField(TEXT("Compressed Size"), PakEntry->Size);
-				FileObject->SetNumberField(TEXT("Compressed Block Count"), PakEntry->CompressionBlocks.Num());
+				FileObject->SetNumberField(TEXT("Compressed Block Count"), PakFileItem->GetCompressionBlockCount());
 				FileObject->SetNumberField(TEXT("Compressed Block Size"), PakEntry->CompressionBlockSize);
 				FileObject->SetStringField(TEXT("Compression Method"), PakFileItem->CompressionMethod.ToString());
 				FileObject->SetStringField(TEXT("SHA1"), BytesToHex(PakEntry->Hash, sizeof(PakEntry->Hash)));
 				FileObject->SetStringField(TEXT("IsEncrypted"), PakEntry->IsEncrypted() ? TEXT("True") : TEXT("False"));
-				FileObject->SetStringField(TEXT("Class"), PakFileItem->Class.ToString());
-				FileObject->SetNumberField(TEXT("Dependency Count"), PakFileItem->AssetSummary.IsValid() ? PakFileItem->AssetSummary->DependencyList.Num() : 0);
-				FileObject->SetNumberField(TEXT("Dependent Count"), PakFileItem->AssetSummary.IsValid() ? PakFileItem->AssetSummary->DependentList.Num() : 0);
-				FileObject->SetStringField(TEXT("OwnerPak"), PakAnalyzer && PakAnalyzer->GetPakFileSumary().IsValidIndex(PakFileItem->OwnerPakIndex) ? FPaths::GetCleanFilename(PakAnalyzer->GetPakFileSumary()[PakFileItem->OwnerPakIndex]->PakFilePath) : TEXT(""));
+				FileObject->SetStringField(TEXT("Class"), PakFileItem->GetClass().ToString());
+				FileObject->SetNumberField(TEXT("Dependency Count"), PackageGraph->GetDependencyCount(PakFileItem->GetPackageId()));
+				FileObject->SetNumberField(TEXT("Dependent Count"), PackageGraph->GetDependentCount(PakFileItem->GetPackageId()));
+				FileObject->SetNumberField(TEXT("Exclusive Size"), LoadCosts->GetExclusiveSize(PakFileItem->GetPackageId()));
+				FileObject->SetNumberField(TEXT("Exclusive Compressed Size"), LoadCosts->GetExclusiveCompressedSize(PakFileItem->GetPackageId()));
+				FileObject->SetNumberField(TEXT("Transitive Size"), LoadCosts->GetTransitiveSize(PakFileItem->GetPackageId()));
+				FileObject->SetNumberField(TEXT("Transitive Compressed Size"), LoadCosts->GetTransitiveCompressedSize(PakFileItem->GetPackageId()));
+				FileObject->SetStringField(TEXT("OwnerPak"), Summaries.IsValidIndex(PakFileItem->OwnerPakIndex) ? FPaths::GetCleanFilename(Summaries[PakFileItem->OwnerPakIndex]->PakFilePath) : TEXT(""));
 
 				FileObjects.Add(MakeShareable(new FJsonValueObject(FileObject)));
 			}
@@ -1492,6 +1867,15 @@ void SPakFileView::OnCopyColumnExecute(const FName ColumnId)
 	TArray<FPakFileEntryPtr> SelectedItems;
 	GetSelectedItems(SelectedItems);
 
+	if (PakAnalyzer && ColumnId == FFileColumn::SHA1ColumnName)
+	{
+		PakAnalyzer->LoadFileHashes(SelectedItems);
+	}
+
+	const FPackageGraphPtr PackageGraph = PakAnalyzer ? PakAnalyzer->GetPackageGraph() : FPackageGraphPtr(MakeShared<FPackageGraph, ESPMode::ThreadSafe>());
+	const FPackageLoadCostsPtr LoadCosts = UpdateCopyLoadCosts(PakAnalyzer);
+	const TArray<FPakFileSumaryPtr> Summaries = PakAnalyzer ? PakAnalyzer->GetPakFileSumary() : TArray<FPakFileSumaryPtr>();
+
 	for (const FPakFileEntryPtr PakFileItem : SelectedItems)
 	{
 		if (PakFileItem.IsValid())
@@ -1499,15 +1883,15 @@ void SPakFileView::OnCopyColumnExecute(const FName ColumnId)
 			const FPakEntry* PakEntry = &PakFileItem->PakEntry;
 			if (ColumnId == FFileColumn::NameColumnName)
 			{
-				Values.Add(PakFileItem->Filename.ToString());
+				Values.Add(PakFileItem->GetFilename());
 			}
 			else if (ColumnId == FFileColumn::PathColumnName)
 			{
-				Values.Add(PakFileItem->Path);
+				Values.Add(PakFileItem->GetPath());
 			}
 			else if (ColumnId == FFileColumn::ClassColumnName)
 			{
-				Values.Add(PakFileItem->Class.ToString());
+				Values.Add(PakFileItem->GetClass().ToString());
 			}
 			else if (ColumnId == FFileColumn::OffsetColumnName)
 			{
@@ -1523,7 +1907,7 @@ void SPakFileView::OnCopyColumnExecute(const FName ColumnId)
 			}
 			else if (ColumnId == FFileColumn::CompressionBlockCountColumnName)
 			{
-				Values.Add(FString::Printf(TEXT("%d"), PakEntry->CompressionBlocks.Num()));
+				Values.Add(FString::Printf(TEXT("%d"), PakFileItem->GetCompressionBlockCount()));
 			}
 			else if (ColumnId == FFileColumn::CompressionBlockSizeColumnName)
 			{
@@ -1543,15 +1927,31 @@ void SPakFileView::OnCopyColumnExecute(const FName ColumnId)
 			}
 			else if (ColumnId == FFileColumn::DependencyCountColumnName)
 			{
-				Values.Add(FString::Printf(TEXT("%d"), PakFileItem->AssetSummary.IsValid() ? PakFileItem->AssetSummary->DependencyList.Num() : 0));
+				Values.Add(FString::Printf(TEXT("%d"), PackageGraph->GetDependencyCount(PakFileItem->GetPackageId())));
 			}
 			else if (ColumnId == FFileColumn::DependentCountColumnName)
 			{
-				Values.Add(FString::Printf(TEXT("%d"), PakFileItem->AssetSummary.IsValid() ? PakFileItem->AssetSummary->DependentList.Num() : 0));
+				Values.Add(FString::Printf(TEXT("%d"), PackageGraph->GetDependentCount(PakFileItem->GetPackageId())));
+			}
+			else if (ColumnId == FFileColumn::ExclusiveSizeColumnName)
+			{
+				Values.Add(FString::Printf(TEXT("%lld"), LoadCosts->GetExclusiveSize(PakFileItem->GetPackageId())));
+			}
+			else if (ColumnId == FFileColumn::ExclusiveCompressedSizeColumnName)
+			{
+				Values.Add(FString::Printf(TEXT("%lld"), LoadCosts->GetExclusiveCompressedSize(PakFileItem->GetPackageId())));
+			}
+			else if (ColumnId == FFileColumn::TransitiveSizeColumnName)
+			{
+				Values.Add(FString::Printf(TEXT("%lld"), LoadCosts->GetTransitiveSize(PakFileItem->GetPackageId())));
+			}
+			else if (ColumnId == FFileColumn::TransitiveCompressedSizeColumnName)
+			{
+				Values.Add(FString::Printf(TEXT("%lld"), LoadCosts->GetTransitiveCompressedSize(PakFileItem->GetPackageId())));
 			}
 			else if (ColumnId == FFileColumn::OwnerPakColumnName)
 			{
-				Values.Add(FString::Printf(TEXT("%s"), PakAnalyzer && PakAnalyzer->GetPakFileSumary().IsValidIndex(PakFileItem->OwnerPakIndex) ? *FPaths::GetCleanFilename(PakAnalyzer->GetPakFileSumary()[PakFileItem->OwnerPakIndex]->PakFilePath) : TEXT("")));
+				Values.Add(FString::Printf(TEXT("%s"), Summaries.IsValidIndex(PakFileItem->OwnerPakIndex) ? *FPaths::GetCleanFilename(Summaries[PakFileItem->OwnerPakIndex]->PakFilePath) : TEXT("")));
 			}
 		}
 	}
@@ -1566,13 +1966,19 @@ void SPakFileView::OnJumpToTreeViewExecute()
 
 	if (SelectedItems.Num() > 0 && SelectedItems[0].IsValid())
 	{
-		FWidgetDelegates::GetOnSwitchToTreeViewDelegate().Broadcast(SelectedItems[0]->Path, SelectedItems[0]->OwnerPakIndex);
+		FWidgetDelegates::GetOnSwitchToTreeViewDelegate().Broadcast(SelectedItems[0]->GetPath(), SelectedItems[0]->OwnerPakIndex);
 	}
 }
 
 void SPakFileView::MarkDirty(bool bInIsDirty)
 {
 	bIsDirty = bInIsDirty;
+
+	if (bIsDirty && InnderTask)
+	{
+		// The running query is stale now, let it stop so the new one starts on the next tick
+		InnderTask->Abort();
+	}
 }
 
 void SPakFileView::OnSortAndFilterFinihed(const FName InSortedColumn, EColumnSortMode::Type InSortMode, const FString& InSearchText)
@@ -1603,7 +2009,7 @@ FText SPakFileView::GetFileCount() const
 	int32 TotalFileCount = 0;
 	if (Analyzer)
 	{
-		const TArray<FPakFileSumaryPtr>& Summaries = Analyzer->GetPakFileSumary();
+		const TArray<FPakFileSumaryPtr> Summaries = Analyzer->GetPakFileSumary();
 		for (const FPakFileSumaryPtr& Summary : Summaries)
 		{
 			TotalFileCount += Summary->FileCount;
@@ -1680,6 +2086,37 @@ void SPakFileView::OnExportToCsv()
 	IPakAnalyzerModule::Get().GetPakAnalyzer()->ExportToCsv(OutFileNames[0], SelectedItems);
 }
 
+void SPakFileView::OnExportToBinary()
+{
+	bool bOpened = false;
+	TArray<FString> OutFileNames;
+
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform)
+	{
+		FSlateApplication::Get().CloseToolTip();
+
+		bOpened = DesktopPlatform->SaveFileDialog(
+			FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr),
+			LOCTEXT("OpenExportDialogTitleText", "Select output binary file path...").ToString(),
+			TEXT(""),
+			TEXT(""),
+			TEXT("Binary Files (*.upvc)|*.upvc|All Files (*.*)|*.*"),
+			EFileDialogFlags::None,
+			OutFileNames);
+	}
+
+	if (!bOpened || OutFileNames.Num() <= 0)
+	{
+		return;
+	}
+
+	TArray<FPakFileEntryPtr> SelectedItems;
+	GetSelectedItems(SelectedItems);
+
+	IPakAnalyzerModule::Get().GetPakAnalyzer()->ExportToBinary(OutFileNames[0], SelectedItems);
+}
+
 void SPakFileView::OnExtract()
 {
 	bool bOpened = false;
@@ -1708,11 +2145,45 @@ void SPakFileView::OnExtract()
 	IPakAnalyzerModule::Get().GetPakAnalyzer()->ExtractFiles(OutputPath, SelectedItems);
 }
 
+void SPakFileView::OnExtractToArchive()
+{
+	bool bOpened = false;
+	TArray<FString> OutFileNames;
+
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform)
+	{
+		FSlateApplication::Get().CloseToolTip();
+
+		bOpened = DesktopPlatform->SaveFileDialog(
+			FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr),
+			LOCTEXT("OpenExtractArchiveDialogTitleText", "Select output archive path...").ToString(),
+			TEXT(""),
+			TEXT(""),
+			TEXT("Tar Files (*.tar)|*.tar|Zip Files (*.zip)|*.zip"),
+			EFileDialogFlags::None,
+			OutFileNames);
+	}
+
+	if (!bOpened || OutFileNames.Num() <= 0)
+	{
+		return;
+	}
+
+	TArray<FPakFileEntryPtr> SelectedItems;
+	GetSelectedItems(SelectedItems);
+
+	// The extension of the path picks the archive format
+	IPakAnalyzerModule::Get().GetPakAnalyzer()->ExtractFiles(OutFileNames[0], SelectedItems);
+}
+
 void SPakFileView::ScrollToItem(const FString& InPath, int32 PakIndex)
 {
+	// Paths are built on demand, compare the file name first
+	const FName Filename = *FPaths::GetCleanFilename(InPath);
 	for (const FPakFileEntryPtr FileEntry : FileCache)
 	{
-		if (FileEntry->Path.Equals(InPath, ESearchCase::IgnoreCase) && FileEntry->OwnerPakIndex == PakIndex)
+		if (FileEntry->OwnerPakIndex == PakIndex && FileEntry->Filename == Filename && FileEntry->GetPath().Equals(InPath, ESearchCase::IgnoreCase))
 		{
 			TArray<FPakFileEntryPtr> SelectArray = { FileEntry };
 			FileListView->SetItemSelection(SelectArray, true, ESelectInfo::Direct);
@@ -1726,6 +2197,27 @@ void SPakFileView::OnLoadAssetReigstryFinished()
 {
 	FillClassesFilter();
 
+	bFilesChanged = true;
+	MarkDirty(true);
+}
+
+void SPakFileView::OnLoadPakStarted()
+{
+	// A batch of the old paks must not read from the new ones, the load thread only starts after this
+	if (HashLoadTask.IsValid())
+	{
+		HashLoadTask.Wait();
+		HashLoadTask.Reset();
+	}
+	HashLoadFiles.Empty();
+	HashLoadCopies.Empty();
+	PendingHashFiles.Empty();
+
+	// The new backend is still empty, rows of the old paks go away until the load finishes
+	FillClassesFilter();
+	FillPaksFilter();
+
+	bFilesChanged = true;
 	MarkDirty(true);
 }
 
@@ -1734,6 +2226,7 @@ void SPakFileView::OnLoadPakFinished()
 	FillClassesFilter();
 	FillPaksFilter();
 
+	bFilesChanged = true;
 	MarkDirty(true);
 }
 
@@ -1741,6 +2234,7 @@ void SPakFileView::OnParseAssetFinished()
 {
 	FillClassesFilter();
 
+	bFilesChanged = true;
 	MarkDirty(true);
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Future.h"
 #include "Widgets/SCompoundWidget.h"
 #include "Widgets/Views/SListView.h"
 
@@ -37,6 +38,9 @@ public:
 
 	FText GetSearchText() const;
 
+	// Rows without a loaded hash ask for it while drawn, Tick reads the pending ones in one batch off the game thread
+	void RequestFileHash(const FPakFileEntryPtr& InFile);
+
 	FORCEINLINE void SetDelayHighlightItem(const FString& InPath, int32 PakIndex) { DelayHighlightItem = InPath, DelayHighlightItemPakIndex = PakIndex; }
 
 protected:
@@ -110,14 +114,20 @@ protected:
 	bool IsFileListEmpty() const;
 	void OnExportToJson();
 	void OnExportToCsv();
+	void OnExportToBinary();
 	void OnExtract();
+	void OnExtractToArchive();
 
 	void ScrollToItem(const FString& InPath, int32 PakIndex);
 
 	void OnLoadAssetReigstryFinished();
+	void OnLoadPakStarted();
 	void OnLoadPakFinished();
 	void OnParseAssetFinished();
 
+	// Applies the batch that finished and starts the next one
+	void UpdateFileHashes(class IPakAnalyzer* InPakAnalyzer);
+
 	void FillFilesSummary();
 	bool GetSelectedItems(TArray<FPakFileEntryPtr>& OutSelectedItems) const;
 
@@ -139,13 +149,21 @@ protected:
 
 	/** The async task to sort and filter file on a worker thread */
 	TUniquePtr<FAsyncTask<class FFileSortAndFilterTask>> SortAndFilterTask;
-	FFileSortAndFilterTask* InnderTask;
+	FFileSortAndFilterTask* InnderTask = nullptr;
 
 	FName CurrentSortedColumn = FFileColumn::OffsetColumnName;
 	EColumnSortMode::Type CurrentSortMode = EColumnSortMode::Ascending;
 	FString CurrentSearchText;
 
 	bool bIsDirty = false;
+	// Set when the analyzer data behind the list changes, the next query can't refine the last result
+	bool bFilesChanged = true;
+
+	TSet<FPakFileEntryPtr> PendingHashFiles;
+	// Files of the batch in flight, the task reads into copies of them so rows never see a hash being written
+	TArray<FPakFileEntryPtr> HashLoadFiles;
+	TArray<FPakFileEntryPtr> HashLoadCopies;
+	TFuture<void> HashLoadTask;
 
 	FString DelayHighlightItem;
 	int32 DelayHighlightItemPakIndex = -1;
@@ -111,11 +111,15 @@ protected:
 
 SPakSummaryView::SPakSummaryView()
 {
+	FPakAnalyzerDelegates::OnPakLoadStart.AddRaw(this, &SPakSummaryView::OnLoadPakStarted);
+	FPakAnalyzerDelegates::OnPakLoaded.AddRaw(this, &SPakSummaryView::OnPakLoaded);
 	FPakAnalyzerDelegates::OnPakLoadFinish.AddRaw(this, &SPakSummaryView::OnLoadPakFinished);
 }
 
 SPakSummaryView::~SPakSummaryView()
 {
+	FPakAnalyzerDelegates::OnPakLoadStart.RemoveAll(this);
+	FPakAnalyzerDelegates::OnPakLoaded.RemoveAll(this);
 	FPakAnalyzerDelegates::OnPakLoadFinish.RemoveAll(this);
 }
 
@@ -224,6 +228,26 @@ FORCEINLINE FText SPakSummaryView::GetAssetRegistryPath() const
 	return PakAnalyzer ? FText::FromString(PakAnalyzer->GetAssetRegistryPath()) : FText();
 }
 
+void SPakSummaryView::OnLoadPakStarted()
+{
+	Summaries.Empty();
+
+	if (SummaryListView.IsValid())
+	{
+		SummaryListView->RebuildList();
+	}
+}
+
+void SPakSummaryView::OnPakLoaded(FPakFileSumaryPtr InSummary, FPakTreeEntryPtr InTreeRoot)
+{
+	Summaries.Add(InSummary);
+
+	if (SummaryListView.IsValid())
+	{
+		SummaryListView->RebuildList();
+	}
+}
+
 void SPakSummaryView::OnLoadPakFinished()
 {
 	IPakAnalyzer* PakAnalyzer = IPakAnalyzerModule::Get().GetPakAnalyzer();
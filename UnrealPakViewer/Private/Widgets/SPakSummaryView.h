@@ -25,6 +25,8 @@ public:
 protected:
 	FORCEINLINE FText GetAssetRegistryPath() const;
 
+	void OnLoadPakStarted();
+	void OnPakLoaded(FPakFileSumaryPtr InSummary, FPakTreeEntryPtr InTreeRoot);
 	void OnLoadPakFinished();
 	FReply OnLoadAssetRegistry();
 
@@ -25,6 +25,8 @@
 SPakTreeView::SPakTreeView()
 {
 	FWidgetDelegates::GetOnLoadAssetRegistryFinishedDelegate().AddRaw(this, &SPakTreeView::OnLoadAssetReigstryFinished);
+	FPakAnalyzerDelegates::OnPakLoadStart.AddRaw(this, &SPakTreeView::OnLoadPakStarted);
+	FPakAnalyzerDelegates::OnPakLoaded.AddRaw(this, &SPakTreeView::OnPakLoaded);
 	FPakAnalyzerDelegates::OnPakLoadFinish.AddRaw(this, &SPakTreeView::OnLoadPakFinished);
 	FPakAnalyzerDelegates::OnAssetParseFinish.AddRaw(this, &SPakTreeView::OnParseAssetFinished);
 }
@@ -32,6 +34,8 @@ SPakTreeView::SPakTreeView()
 SPakTreeView::~SPakTreeView()
 {
 	FWidgetDelegates::GetOnLoadAssetRegistryFinishedDelegate().RemoveAll(this);
+	FPakAnalyzerDelegates::OnPakLoadStart.RemoveAll(this);
+	FPakAnalyzerDelegates::OnPakLoaded.RemoveAll(this);
 	FPakAnalyzerDelegates::OnPakLoadFinish.RemoveAll(this);
 	FPakAnalyzerDelegates::OnAssetParseFinish.RemoveAll(this);
 }
@@ -231,7 +235,7 @@ TSharedRef<ITableRow> SPakTreeView::OnGenerateTreeRow(FPakTreeEntryPtr TreeNode,
 				.AutoWidth()
 				.VAlign(VAlign_Center)
 				[
-					SNew(STextBlock).Text(FText::FromName(TreeNode->Filename)).ColorAndOpacity(FLinearColor::Green).ShadowOffset(FVector2D(1.f, 1.f))
+					SNew(STextBlock).Text(FText::FromString(TreeNode->GetFilename())).ColorAndOpacity(FLinearColor::Green).ShadowOffset(FVector2D(1.f, 1.f))
 				]
 
 				+ SHorizontalBox::Slot()
@@ -241,7 +245,7 @@ TSharedRef<ITableRow> SPakTreeView::OnGenerateTreeRow(FPakTreeEntryPtr TreeNode,
 					SNew(SBox)
 					.MinDesiredWidth(150.f)
 					.MaxDesiredWidth(200.f)
-					.ToolTipText(FText::Format(LOCTEXT("Tree_View_CompressedPercent", "{0}'s compressed size percent of total compressed size"), FText::FromName(TreeNode->Filename)))
+					.ToolTipText(FText::Format(LOCTEXT("Tree_View_CompressedPercent", "{0}'s compressed size percent of total compressed size"), FText::FromString(TreeNode->GetFilename())))
 					[
 						SNew(SOverlay)
 
@@ -265,7 +269,7 @@ TSharedRef<ITableRow> SPakTreeView::OnGenerateTreeRow(FPakTreeEntryPtr TreeNode,
 	{
 		return SNew(STableRow<TSharedPtr<FPakTreeEntryPtr>>, OwnerTable)
 			[
-				SNew(STextBlock).Text(FText::FromName(TreeNode->Filename))
+				SNew(STextBlock).Text(FText::FromString(TreeNode->GetFilename()))
 			];
 	}
 }
@@ -358,12 +362,12 @@ void SPakTreeView::ExpandTreeItem(const FString& InPath, int32 PakIndex)
 
 FORCEINLINE FText SPakTreeView::GetSelectionName() const
 {
-	return CurrentSelectedItem.IsValid() ? FText::FromName(CurrentSelectedItem->Filename) : FText();
+	return CurrentSelectedItem.IsValid() ? FText::FromString(CurrentSelectedItem->GetFilename()) : FText();
 }
 
 FORCEINLINE FText SPakTreeView::GetSelectionPath() const
 {
-	return CurrentSelectedItem.IsValid() ? FText::FromString(CurrentSelectedItem->Path) : FText();
+	return CurrentSelectedItem.IsValid() ? FText::FromString(CurrentSelectedItem->GetPath()) : FText();
 }
 
 FORCEINLINE FText SPakTreeView::GetSelectionOffset() const
@@ -405,7 +409,7 @@ FORCEINLINE FText SPakTreeView::GetSelectionCompressedSizePercentOfParent() cons
 FORCEINLINE FText SPakTreeView::GetSelectionCompressionBlockCount() const
 {
 	const FPakEntry* PakEntry = CurrentSelectedItem.IsValid() ? &CurrentSelectedItem->PakEntry : nullptr;
-	return PakEntry ? FText::AsNumber(PakEntry->CompressionBlocks.Num()) : FText();
+	return PakEntry ? FText::AsNumber(CurrentSelectedItem->GetCompressionBlockCount()) : FText();
 }
 
 FORCEINLINE FText SPakTreeView::GetSelectionCompressionBlockSize() const
@@ -429,6 +433,12 @@ FORCEINLINE FText SPakTreeView::GetCompressionMethod() const
 
 FORCEINLINE FText SPakTreeView::GetSelectionSHA1() const
 {
+	IPakAnalyzer* PakAnalyzer = IPakAnalyzerModule::Get().GetPakAnalyzer();
+	if (PakAnalyzer && CurrentSelectedItem.IsValid() && !CurrentSelectedItem->bHashLoaded)
+	{
+		PakAnalyzer->LoadFileHashes({ CurrentSelectedItem });
+	}
+
 	const FPakEntry* PakEntry = CurrentSelectedItem.IsValid() ? &CurrentSelectedItem->PakEntry : nullptr;
 	return PakEntry ? FText::FromString(BytesToHex(PakEntry->Hash, sizeof(PakEntry->Hash))) : FText();
 }
@@ -443,7 +453,7 @@ FORCEINLINE FText SPakTreeView::GetSelectionOwnerPakName() const
 {
 	if (CurrentSelectedItem.IsValid())
 	{
-		const TArray<FPakFileSumaryPtr>& Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
+		const TArray<FPakFileSumaryPtr> Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
 		if (Summaries.IsValidIndex(CurrentSelectedItem->OwnerPakIndex))
 		{
 			return FText::FromString(FPaths::GetCleanFilename(Summaries[CurrentSelectedItem->OwnerPakIndex]->PakFilePath));
@@ -457,7 +467,7 @@ FORCEINLINE FText SPakTreeView::GetSelectionOwnerPakPath() const
 {
 	if (CurrentSelectedItem.IsValid())
 	{
-		const TArray<FPakFileSumaryPtr>& Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
+		const TArray<FPakFileSumaryPtr> Summaries = IPakAnalyzerModule::Get().GetPakAnalyzer()->GetPakFileSumary();
 		if (Summaries.IsValidIndex(CurrentSelectedItem->OwnerPakIndex))
 		{
 			return FText::FromString(Summaries[CurrentSelectedItem->OwnerPakIndex]->PakFilePath);
@@ -479,7 +489,7 @@ FORCEINLINE const FSlateBrush* SPakTreeView::GetFolderImage(FPakTreeEntryPtr InT
 
 FORCEINLINE FText SPakTreeView::GetSelectionClass() const
 {
-	return CurrentSelectedItem.IsValid() && !CurrentSelectedItem->bIsDirectory ? FText::FromName(CurrentSelectedItem->Class) : FText();
+	return CurrentSelectedItem.IsValid() && !CurrentSelectedItem->bIsDirectory ? FText::FromName(CurrentSelectedItem->GetClass()) : FText();
 }
 
 TSharedPtr<SWidget> SPakTreeView::OnGenerateContextMenu()
@@ -500,6 +510,18 @@ TSharedPtr<SWidget> SPakTreeView::OnGenerateContextMenu()
 			LOCTEXT("ContextMenu_Extract_Desc", "Extract current selected file or folder to disk"),
 			FSlateIcon(FUnrealPakViewerStyle::GetStyleSetName(), "Extract"), Action_Extract, NAME_None, EUserInterfaceActionType::Button
 		);
+
+		FUIAction Action_ExtractToArchive
+		(
+			FExecuteAction::CreateSP(this, &SPakTreeView::OnExtractToArchiveExecute),
+			FCanExecuteAction::CreateSP(this, &SPakTreeView::HasSelection)
+		);
+		MenuBuilder.AddMenuEntry
+		(
+			LOCTEXT("ContextMenu_ExtractToArchive", "Extract To Archive..."),
+			LOCTEXT("ContextMenu_ExtractToArchive_Desc", "Extract current selected file or folder into a single tar or zip file"),
+			FSlateIcon(FUnrealPakViewerStyle::GetStyleSetName(), "Extract"), Action_ExtractToArchive, NAME_None, EUserInterfaceActionType::Button
+		);
 	}
 	MenuBuilder.EndSection();
 
@@ -531,6 +553,19 @@ TSharedPtr<SWidget> SPakTreeView::OnGenerateContextMenu()
 			),
 			NAME_None, EUserInterfaceActionType::Button
 		);
+
+		MenuBuilder.AddMenuEntry
+		(
+			LOCTEXT("ContextMenu_Export_To_Binary", "Export To Binary..."),
+			LOCTEXT("ContextMenu_Export_To_Binary_Desc", "Export selected file(s) info to a columnar binary file"),
+			FSlateIcon(FUnrealPakViewerStyle::GetStyleSetName(), "Export"),
+			FUIAction
+			(
+				FExecuteAction::CreateSP(this, &SPakTreeView::OnExportToBinary),
+				FCanExecuteAction::CreateSP(this, &SPakTreeView::HasSelection)
+			),
+			NAME_None, EUserInterfaceActionType::Button
+		);
 	}
 	MenuBuilder.EndSection();
 
@@ -588,12 +623,50 @@ void SPakTreeView::OnExtractExecute()
 	IPakAnalyzerModule::Get().GetPakAnalyzer()->ExtractFiles(OutputPath, TargetFiles);
 }
 
+void SPakTreeView::OnExtractToArchiveExecute()
+{
+	bool bOpened = false;
+	TArray<FString> OutFileNames;
+
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform)
+	{
+		FSlateApplication::Get().CloseToolTip();
+
+		bOpened = DesktopPlatform->SaveFileDialog(
+			FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr),
+			LOCTEXT("OpenExtractArchiveDialogTitleText", "Select output archive path...").ToString(),
+			TEXT(""),
+			TEXT(""),
+			TEXT("Tar Files (*.tar)|*.tar|Zip Files (*.zip)|*.zip"),
+			EFileDialogFlags::None,
+			OutFileNames);
+	}
+
+	if (!bOpened || OutFileNames.Num() <= 0)
+	{
+		return;
+	}
+
+	TArray<FPakFileEntryPtr> TargetFiles;
+	TArray<FPakTreeEntryPtr> SelectedItems;
+
+	TreeView->GetSelectedItems(SelectedItems);
+	for (FPakTreeEntryPtr PakTreeEntry : SelectedItems)
+	{
+		RetriveFiles(PakTreeEntry, TargetFiles);
+	}
+
+	// The extension of the path picks the archive format
+	IPakAnalyzerModule::Get().GetPakAnalyzer()->ExtractFiles(OutFileNames[0], TargetFiles);
+}
+
 void SPakTreeView::OnJumpToFileViewExecute()
 {
 	TArray<FPakTreeEntryPtr> SelectedItems = TreeView->GetSelectedItems();
 	if (SelectedItems.Num() > 0 && SelectedItems[0].IsValid())
 	{
-		FWidgetDelegates::GetOnSwitchToFileViewDelegate().Broadcast(SelectedItems[0]->Path, SelectedItems[0]->OwnerPakIndex);
+		FWidgetDelegates::GetOnSwitchToFileViewDelegate().Broadcast(SelectedItems[0]->GetPath(), SelectedItems[0]->OwnerPakIndex);
 	}
 }
 
@@ -687,6 +760,43 @@ void SPakTreeView::OnExportToCsv()
 	IPakAnalyzerModule::Get().GetPakAnalyzer()->ExportToCsv(OutFileNames[0], TargetFiles);
 }
 
+void SPakTreeView::OnExportToBinary()
+{
+	bool bOpened = false;
+	TArray<FString> OutFileNames;
+
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform)
+	{
+		FSlateApplication::Get().CloseToolTip();
+
+		bOpened = DesktopPlatform->SaveFileDialog(
+			FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr),
+			LOCTEXT("OpenExportDialogTitleText", "Select output binary file path...").ToString(),
+			TEXT(""),
+			TEXT(""),
+			TEXT("Binary Files (*.upvc)|*.upvc|All Files (*.*)|*.*"),
+			EFileDialogFlags::None,
+			OutFileNames);
+	}
+
+	if (!bOpened || OutFileNames.Num() <= 0)
+	{
+		return;
+	}
+
+	TArray<FPakFileEntryPtr> TargetFiles;
+	TArray<FPakTreeEntryPtr> SelectedItems;
+
+	TreeView->GetSelectedItems(SelectedItems);
+	for (FPakTreeEntryPtr PakTreeEntry : SelectedItems)
+	{
+		RetriveFiles(PakTreeEntry, TargetFiles);
+	}
+
+	IPakAnalyzerModule::Get().GetPakAnalyzer()->ExportToBinary(OutFileNames[0], TargetFiles);
+}
+
 void SPakTreeView::RetriveFiles(FPakTreeEntryPtr InRoot, TArray<FPakFileEntryPtr>& OutFiles)
 {
 	if (InRoot->bIsDirectory)
@@ -710,6 +820,28 @@ void SPakTreeView::RetriveFiles(FPakTreeEntryPtr InRoot, TArray<FPakFileEntryPtr
 	}
 }
 
+void SPakTreeView::OnLoadPakStarted()
+{
+	TreeNodes.Empty();
+	CurrentSelectedItem.Reset();
+
+	if (TreeView.IsValid())
+	{
+		TreeView->ClearSelection();
+		TreeView->RequestTreeRefresh();
+	}
+}
+
+void SPakTreeView::OnPakLoaded(FPakFileSumaryPtr InSummary, FPakTreeEntryPtr InTreeRoot)
+{
+	TreeNodes.Add(InTreeRoot);
+
+	if (TreeView.IsValid())
+	{
+		TreeView->RequestTreeRefresh();
+	}
+}
+
 void SPakTreeView::OnLoadPakFinished()
 {
 	IPakAnalyzer* PakAnalyzer = IPakAnalyzerModule::Get().GetPakAnalyzer();
@@ -75,14 +75,18 @@ protected:
 	TSharedPtr<SWidget> OnGenerateContextMenu();
 
 	void OnExtractExecute();
+	void OnExtractToArchiveExecute();
 	void OnJumpToFileViewExecute();
 	bool HasSelection() const;
 	bool HasFileSelection() const;
 	void OnExportToJson();
 	void OnExportToCsv();
+	void OnExportToBinary();
 
 	void RetriveFiles(FPakTreeEntryPtr InRoot, TArray<FPakFileEntryPtr>& OutFiles);
 
+	void OnLoadPakStarted();
+	void OnPakLoaded(FPakFileSumaryPtr InSummary, FPakTreeEntryPtr InTreeRoot);
 	void OnLoadPakFinished();
 	void OnLoadAssetReigstryFinished();
 	void OnParseAssetFinished();